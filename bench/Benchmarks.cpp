@@ -0,0 +1,570 @@
+#include "TreeGenerator.h"
+#include "FileManager.h"
+#include "FileSearcher.h"
+#include "FileSorter.h"
+#include "OrganizeEngine.h"
+#include "OrganizeJournal.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * =============================================================================
+ * SMARTFILEMANAGER BENCHMARKS - REPRODUCIBLE NUMBERS FOR THE HOT PATHS
+ * =============================================================================
+ *
+ *   SmartFileManagerBench --entries 1m --output results.json
+ *
+ * 1. Generates (or reuses) a deterministic synthetic tree - see TreeGenerator
+ * 2. Times scanDirectory, searchByName, findDuplicates,
+ *    getCategoryForExtension and organize (plan, apply, undo)
+ * 3. Prints one JSON document: tree spec, build, and per benchmark every
+ *    iteration's seconds plus median / min / items per second - so two
+ *    runs can be compared by a script
+ *
+ * Teaching Point: BENCHMARK HYGIENE
+ * - Same input every run (seeded tree), stated in the output
+ * - Several iterations, report the median (robust to one slow outlier)
+ *   and the minimum (closest to "no interference")
+ * - Results feed a sink the optimizer cannot remove
+ * - Logging is raised to warnings so the log file is not what we measure
+ * - The build type is part of the output: Debug numbers are not comparable
+ */
+
+namespace {
+
+    struct BenchOptions {
+        TreeSpec spec;
+        std::string label = "10k";
+        std::string root;                       // Default: <temp>/sfm-bench-<label>
+        std::size_t iterations = 3;
+        std::size_t queries = 200;
+        std::set<std::string> only;             // Empty = all
+        std::string output;                     // Empty = stdout
+        bool clean = false;
+    };
+
+    struct Result {
+        explicit Result(std::string benchmark) : name(std::move(benchmark)) {}
+
+        std::string name;
+        std::uint64_t items = 0;                // Work units per iteration
+        std::vector<double> seconds;
+        std::vector<std::pair<std::string, double>> extra;
+
+        double median() const {
+            if (seconds.empty()) {
+                return 0.0;
+            }
+            std::vector<double> sorted = seconds;
+            std::sort(sorted.begin(), sorted.end());
+            const std::size_t mid = sorted.size() / 2;
+            return sorted.size() % 2 == 1 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+        }
+        double minimum() const {
+            return seconds.empty() ? 0.0 : *std::min_element(seconds.begin(), seconds.end());
+        }
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point started) {
+        return std::chrono::duration<double>(Clock::now() - started).count();
+    }
+
+    /**
+     * @brief "10k" → 10 000, "1m" → 1 000 000, "2500" → 2 500
+     */
+    std::size_t parseCount(const std::string& text) {
+        std::size_t used = 0;
+        const double value = std::stod(text, &used);
+        double scale = 1.0;
+        if (used < text.size()) {
+            const char unit = static_cast<char>(std::tolower(static_cast<unsigned char>(text[used])));
+            scale = unit == 'k' ? 1e3 : unit == 'm' ? 1e6 : unit == 'g' ? 1e9 : 0.0;
+            if (scale == 0.0 || used + 1 != text.size()) {
+                throw std::invalid_argument("bad count: " + text);
+            }
+        }
+        return static_cast<std::size_t>(value * scale);
+    }
+
+    /**
+     * @brief "4:24" → {4, 24}; "8" → {8, 8}
+     */
+    std::pair<std::uint64_t, std::uint64_t> parseRange(const std::string& text) {
+        const std::size_t colon = text.find(':');
+        if (colon == std::string::npos) {
+            const auto v = static_cast<std::uint64_t>(parseCount(text));
+            return {v, v};
+        }
+        return {parseCount(text.substr(0, colon)), parseCount(text.substr(colon + 1))};
+    }
+
+    void printUsage() {
+        std::cerr <<
+            "Usage: SmartFileManagerBench [options]\n"
+            "  --entries N          Files in the tree: 10k (default), 1m, 10m or any count\n"
+            "  --root DIR           Where the tree lives (default: <temp>/sfm-bench-<entries>)\n"
+            "  --seed N             Generator seed (default 42)\n"
+            "  --depth N            Maximum directory depth (default 4)\n"
+            "  --files-per-dir N    Average files per directory (default 100)\n"
+            "  --name-length A:B    Random stem length range (default 4:24)\n"
+            "  --size A:B           File size range in bytes, log-uniform (default by --entries)\n"
+            "  --duplicates R       Fraction of files duplicating another (default 0.1)\n"
+            "  --iterations N       Timed runs per benchmark (default 3)\n"
+            "  --queries N          Name searches per search iteration (default 200)\n"
+            "  --only LIST          Comma list of scan,search,duplicates,category,organize\n"
+            "  --output FILE        Write the JSON there instead of stdout\n"
+            "  --clean              Delete the tree afterwards\n";
+    }
+
+    /**
+     * @brief Parses the command line; sizes default by scale
+     *
+     * 10 million files of a few KB each need tens of GB (every non-empty
+     * file takes at least one block), so the 10m preset writes empty files:
+     * scan, search, category and organize are metadata-bound anyway.
+     */
+    BenchOptions parseArguments(int argc, char* argv[]) {
+        BenchOptions options;
+        bool sizeGiven = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument(arg + " needs a value");
+                }
+                return argv[++i];
+            };
+            if (arg == "--entries") {
+                options.label = value();
+                options.spec.files = parseCount(options.label);
+            } else if (arg == "--root") {
+                options.root = value();
+            } else if (arg == "--seed") {
+                options.spec.seed = std::stoull(value());
+            } else if (arg == "--depth") {
+                options.spec.maxDepth = parseCount(value());
+            } else if (arg == "--files-per-dir") {
+                options.spec.filesPerDirectory = parseCount(value());
+            } else if (arg == "--name-length") {
+                const auto range = parseRange(value());
+                options.spec.nameLengthMin = static_cast<std::size_t>(range.first);
+                options.spec.nameLengthMax = static_cast<std::size_t>(range.second);
+            } else if (arg == "--size") {
+                const auto range = parseRange(value());
+                options.spec.sizeMin = range.first;
+                options.spec.sizeMax = range.second;
+                sizeGiven = true;
+            } else if (arg == "--duplicates") {
+                options.spec.duplicateRatio = std::stod(value());
+            } else if (arg == "--iterations") {
+                options.iterations = std::max<std::size_t>(1, parseCount(value()));
+            } else if (arg == "--queries") {
+                options.queries = std::max<std::size_t>(1, parseCount(value()));
+            } else if (arg == "--only") {
+                std::stringstream list(value());
+                for (std::string name; std::getline(list, name, ',');) {
+                    options.only.insert(name);
+                }
+            } else if (arg == "--output") {
+                options.output = value();
+            } else if (arg == "--clean") {
+                options.clean = true;
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                std::exit(0);
+            } else {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+        if (!sizeGiven) {
+            options.spec.sizeMin = 0;
+            options.spec.sizeMax = options.spec.files <= 100000 ? 64 * 1024
+                                 : options.spec.files <= 2000000 ? 4 * 1024 : 0;
+        }
+        if (options.root.empty()) {
+            options.root = (fs::temp_directory_path() / ("sfm-bench-" + options.label)).string();
+        }
+        return options;
+    }
+
+    // --------------------------------------------------------------------
+    // Benchmarks
+    // --------------------------------------------------------------------
+
+    Result benchScan(FileManager& manager, std::size_t iterations) {
+        Result result{"scan_directory"};
+        ScanOptions scan;
+        scan.recursive = true;
+        for (std::size_t it = 0; it < iterations; ++it) {
+            const auto started = Clock::now();
+            const int found = manager.scanDirectory(scan);
+            result.seconds.push_back(secondsSince(started));
+            result.items = static_cast<std::uint64_t>(std::max(found, 0));
+        }
+        result.extra.emplace_back("directories", static_cast<double>(manager.getFiles().directoryCount()));
+        return result;
+    }
+
+    /**
+     * @brief Query terms taken from the tree itself (and ~20% misses)
+     *
+     * Hits are 3-6 character pieces of existing lowercase names - long
+     * enough for the trigram index; misses contain '#', which no
+     * generated name does.
+     */
+    std::vector<std::string> makeTerms(const FileCatalog& files, std::size_t count) {
+        std::vector<std::string> terms;
+        terms.reserve(count);
+        for (std::size_t q = 0; q < count; ++q) {
+            const std::size_t length = 3 + q % 4;
+            if (q % 5 == 4 || files.empty()) {
+                terms.push_back("#" + std::to_string(q));
+                continue;
+            }
+            const auto i = static_cast<FileCatalog::Index>((q * 2654435761ULL) % files.size());
+            const std::string_view name = files.lowerName(i);
+            if (name.size() <= length) {
+                terms.emplace_back(name);
+            } else {
+                const std::size_t start = (q * 7) % (name.size() - length);
+                terms.emplace_back(name.substr(start, length));
+            }
+        }
+        return terms;
+    }
+
+    std::vector<Result> benchSearch(const FileCatalog& files, std::size_t iterations, std::size_t queries) {
+        FileSearcher searcher;
+        const std::vector<std::string> terms = makeTerms(files, queries);
+
+        // The first query builds the trigram index - reported on its own
+        Result build{"search_index_build"};
+        build.items = files.size();
+        auto started = Clock::now();
+        std::size_t matches = searcher.searchByName(files, terms.front()).size();
+        build.seconds.push_back(secondsSince(started));
+
+        Result search{"search_by_name"};
+        search.items = terms.size();
+        std::vector<double> latencies;
+        latencies.reserve(iterations * terms.size());
+        for (std::size_t it = 0; it < iterations; ++it) {
+            const auto round = Clock::now();
+            for (const std::string& term : terms) {
+                const auto one = Clock::now();
+                matches += searcher.searchByName(files, term).size();
+                latencies.push_back(secondsSince(one));
+            }
+            search.seconds.push_back(secondsSince(round));
+        }
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double q) {
+            const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(latencies.size())));
+            return latencies[std::min(latencies.size() - 1, rank == 0 ? 0 : rank - 1)];
+        };
+        search.extra.emplace_back("p50_query_us", percentile(0.50) * 1e6);
+        search.extra.emplace_back("p99_query_us", percentile(0.99) * 1e6);
+        search.extra.emplace_back("matches_per_round", static_cast<double>(matches) /
+                                                           static_cast<double>(iterations + 1));
+        return {build, search};
+    }
+
+    Result benchDuplicates(const FileCatalog& files, std::size_t iterations) {
+        FileSearcher searcher;   // No hash cache: every iteration reads
+        Result result{"find_duplicates"};
+        result.items = files.size();
+        DuplicateStats stats;
+        std::size_t groups = 0;
+        for (std::size_t it = 0; it < iterations; ++it) {
+            const auto started = Clock::now();
+            groups = searcher.findDuplicates(files, &stats).groups.size();
+            result.seconds.push_back(secondsSince(started));
+        }
+        result.extra.emplace_back("groups", static_cast<double>(groups));
+        result.extra.emplace_back("size_candidates", static_cast<double>(stats.sizeCandidates));
+        result.extra.emplace_back("bytes_read", static_cast<double>(stats.bytesRead));
+        result.extra.emplace_back("read_mb_per_second",
+                                  stats.seconds > 0 ? static_cast<double>(stats.bytesRead) / 1e6 / stats.seconds : 0.0);
+        return result;
+    }
+
+    /**
+     * @brief Category lookups for every file's extension, ≥ 10 M per iteration
+     */
+    Result benchCategory(const FileCatalog& files, std::size_t iterations) {
+        FileSorter sorter;
+        std::vector<std::string_view> extensions;
+        extensions.reserve(files.size());
+        for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+            extensions.push_back(files.extension(i));
+        }
+        if (extensions.empty()) {
+            extensions.push_back(".txt");
+        }
+        const std::size_t rounds = std::max<std::size_t>(1, 10000000 / extensions.size());
+
+        Result result{"category_for_extension"};
+        result.items = rounds * extensions.size();
+        volatile std::size_t sink = 0;   // Keeps the loop from being optimised away
+        for (std::size_t it = 0; it < iterations; ++it) {
+            std::size_t checksum = 0;
+            const auto started = Clock::now();
+            for (std::size_t r = 0; r < rounds; ++r) {
+                for (std::string_view extension : extensions) {
+                    checksum += sorter.getCategoryForExtension(extension).size();
+                }
+            }
+            result.seconds.push_back(secondsSince(started));
+            sink = sink + checksum;
+        }
+        result.extra.emplace_back("ns_per_lookup", result.median() * 1e9 / static_cast<double>(result.items));
+        return result;
+    }
+
+    /**
+     * @brief Plan, apply and undo - the undo restores the tree for the next round
+     * @return false (besides the results) if the tree could not be restored
+     */
+    bool benchOrganize(const FileCatalog& files, const std::string& root, std::size_t iterations,
+                       std::vector<Result>& results) {
+        FileSorter sorter;
+        OrganizeEngine engine;
+        Result plan{"organize_plan"};
+        Result apply{"organize_apply"};
+        Result undo{"organize_undo"};
+        bool restored = true;
+        for (std::size_t it = 0; it < iterations && restored; ++it) {
+            auto started = Clock::now();
+            const OrganizePlan organizePlan = sorter.planOrganize(files, root);
+            plan.seconds.push_back(secondsSince(started));
+            plan.items = organizePlan.moves.size();
+
+            started = Clock::now();
+            const OrganizeStats applied = sorter.applyPlan(organizePlan);
+            apply.seconds.push_back(secondsSince(started));
+            apply.items = applied.moved;
+
+            started = Clock::now();
+            const OrganizeStats reverted = OrganizeJournal::undo(root, engine);
+            undo.seconds.push_back(secondsSince(started));
+            undo.items = reverted.moved;
+
+            restored = reverted.moved == applied.moved && reverted.skipped == 0 && reverted.failed == 0 &&
+                       applied.failed == 0;
+            if (it == 0) {
+                apply.extra.emplace_back("skipped", static_cast<double>(applied.skipped));
+                apply.extra.emplace_back("failed", static_cast<double>(applied.failed));
+                apply.extra.emplace_back("batches", static_cast<double>(applied.tasks));
+            }
+        }
+        results.push_back(plan);
+        results.push_back(apply);
+        results.push_back(undo);
+        return restored;
+    }
+
+    // --------------------------------------------------------------------
+    // JSON output
+    // --------------------------------------------------------------------
+
+    std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (const char c : text) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        return out + "\"";
+    }
+
+    std::string jsonNumber(double value) {
+        if (!std::isfinite(value)) {
+            return "null";
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.9g", value);
+        return text;
+    }
+
+    std::string utcTimestamp() {
+        const std::time_t now = std::time(nullptr);
+        std::tm parts{};
+#ifdef _WIN32
+        gmtime_s(&parts, &now);
+#else
+        gmtime_r(&now, &parts);
+#endif
+        char text[32];
+        std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", &parts);
+        return text;
+    }
+
+    std::string compilerName() {
+#if defined(__clang__)
+        return std::string("Clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        return std::string("GCC ") + __VERSION__;
+#elif defined(_MSC_VER)
+        return "MSVC " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    void writeJson(std::ostream& out, const BenchOptions& options, const TreeSummary& tree,
+                   const std::vector<Result>& results) {
+#ifndef SFM_BENCH_BUILD_TYPE
+#define SFM_BENCH_BUILD_TYPE "unknown"
+#endif
+        out << "{\n"
+            << "  \"schema\": \"sfm-bench/1\",\n"
+            << "  \"started_at\": " << jsonString(utcTimestamp()) << ",\n"
+            << "  \"build\": {\"type\": " << jsonString(SFM_BENCH_BUILD_TYPE)
+            << ", \"compiler\": " << jsonString(compilerName())
+            << ", \"log_min_level\": " << SFM_LOG_MIN_LEVEL << "},\n"
+            << "  \"machine\": {\"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n"
+            << "  \"tree\": {\"label\": " << jsonString(options.label)
+            << ", \"root\": " << jsonString(options.root)
+            << ", \"spec\": " << jsonString(options.spec.describe())
+            << ", \"files\": " << tree.files << ", \"directories\": " << tree.directories
+            << ", \"duplicates\": " << tree.duplicates << ", \"bytes\": " << tree.bytes
+            << ", \"reused\": " << (tree.reused ? "true" : "false")
+            << ", \"generate_seconds\": " << jsonNumber(tree.seconds) << "},\n"
+            << "  \"results\": [";
+        for (std::size_t r = 0; r < results.size(); ++r) {
+            const Result& result = results[r];
+            out << (r == 0 ? "\n" : ",\n")
+                << "    {\"name\": " << jsonString(result.name)
+                << ", \"iterations\": " << result.seconds.size()
+                << ", \"items\": " << result.items << ", \"seconds\": [";
+            for (std::size_t i = 0; i < result.seconds.size(); ++i) {
+                out << (i == 0 ? "" : ", ") << jsonNumber(result.seconds[i]);
+            }
+            const double median = result.median();
+            out << "], \"median_seconds\": " << jsonNumber(median)
+                << ", \"min_seconds\": " << jsonNumber(result.minimum())
+                << ", \"items_per_second\": " << jsonNumber(median > 0 ? static_cast<double>(result.items) / median : 0.0);
+            if (!result.extra.empty()) {
+                out << ", \"extra\": {";
+                for (std::size_t e = 0; e < result.extra.size(); ++e) {
+                    out << (e == 0 ? "" : ", ") << jsonString(result.extra[e].first) << ": "
+                        << jsonNumber(result.extra[e].second);
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    bool wanted(const BenchOptions& options, const std::string& name) {
+        return options.only.empty() || options.only.count(name) > 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const BenchOptions options = parseArguments(argc, argv);
+        Logger::getInstance().setLevel(LogLevel::Warn);   // Measure the work, not the log file
+
+        std::cerr << "Tree: " << options.root << " (" << options.spec.describe() << ")\n";
+        const TreeSummary tree = TreeGenerator(options.spec).generate(options.root);
+        std::cerr << (tree.reused ? "  reused: " : "  generated: ") << tree.files << " files in "
+                  << tree.directories << " directories, " << tree.bytes << " bytes\n";
+
+        std::vector<Result> results;
+        FileManager manager(options.root);
+        auto report = [&results](std::size_t from) {
+            for (std::size_t r = from; r < results.size(); ++r) {
+                std::cerr << "  " << results[r].name << ": median " << results[r].median() << " s\n";
+            }
+        };
+
+        // Every other benchmark needs the catalog, so the tree is always scanned
+        Result scan = benchScan(manager, wanted(options, "scan") ? options.iterations : 1);
+        if (wanted(options, "scan")) {
+            results.push_back(std::move(scan));
+            report(0);
+        }
+        const FileCatalog& files = manager.getFiles();
+
+        if (wanted(options, "search")) {
+            const std::size_t from = results.size();
+            for (Result& r : benchSearch(files, options.iterations, options.queries)) {
+                results.push_back(std::move(r));
+            }
+            report(from);
+        }
+        if (wanted(options, "duplicates")) {
+            results.push_back(benchDuplicates(files, options.iterations));
+            report(results.size() - 1);
+        }
+        if (wanted(options, "category")) {
+            results.push_back(benchCategory(files, options.iterations));
+            report(results.size() - 1);
+        }
+        if (wanted(options, "organize")) {
+            const std::size_t from = results.size();
+            if (!benchOrganize(files, options.root, options.iterations, results)) {
+                // The tree no longer matches its spec - force a rebuild next time
+                std::cerr << "WARNING: organize undo did not restore the tree; it will be regenerated\n";
+                std::error_code ec;
+                fs::remove(options.root + ".spec", ec);
+            }
+            report(from);
+        }
+
+        if (options.output.empty()) {
+            writeJson(std::cout, options, tree, results);
+        } else {
+            std::ofstream out(options.output, std::ios::trunc);
+            writeJson(out, options, tree, results);
+            if (!out) {
+                throw std::runtime_error("cannot write " + options.output);
+            }
+            std::cerr << "Results written to " << options.output << "\n";
+        }
+
+        if (options.clean) {
+            std::error_code ec;
+            fs::remove_all(options.root, ec);
+            fs::remove(options.root + ".spec", ec);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        printUsage();
+        return 1;
+    }
+}
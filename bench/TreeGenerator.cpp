@@ -0,0 +1,357 @@
+#include "TreeGenerator.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * =============================================================================
+ * TREEGENERATOR IMPLEMENTATION - THE SAME MILLION FILES, EVERY TIME
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. A portable, seedable random number generator (SplitMix64)
+ * 2. Balanced tree layout from a single fan-out parameter
+ * 3. Content derived from a seed, so duplicates are exact copies
+ */
+
+namespace {
+
+    constexpr int kFormatVersion = 1;   // Bump when the same spec would produce a different tree
+
+    /**
+     * @brief SplitMix64 - tiny, fast, and identical on every platform
+     */
+    class SplitMix64 {
+    public:
+        explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+        std::uint64_t next() {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @brief Integer in [0, bound) (bound > 0; the modulo bias is irrelevant here)
+         */
+        std::uint64_t below(std::uint64_t bound) { return next() % bound; }
+
+        /**
+         * @brief true with probability p (53-bit resolution)
+         */
+        bool chance(double p) {
+            return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0) < p;
+        }
+
+    private:
+        std::uint64_t state;
+    };
+
+    /**
+     * @brief Extension mix, weighted roughly like a home directory
+     *
+     * Upper-case ".JPG" and unknown ".dat" / ".bin" are included on purpose:
+     * they exercise lower-casing and the "Others" / content-sniffing paths.
+     */
+    struct WeightedExtension {
+        std::string_view extension;
+        std::uint32_t weight;
+    };
+
+    constexpr WeightedExtension kExtensions[] = {
+        {".jpg", 14}, {".JPG", 2}, {".png", 8}, {".heic", 2}, {".gif", 1},
+        {".mp4", 4}, {".mkv", 1}, {".mov", 1},
+        {".mp3", 5}, {".flac", 1}, {".wav", 1},
+        {".pdf", 8}, {".txt", 10}, {".docx", 5}, {".xlsx", 3}, {".csv", 3}, {".md", 2},
+        {".zip", 4}, {".gz", 2}, {".7z", 1},
+        {".cpp", 6}, {".h", 5}, {".py", 4}, {".js", 3}, {".json", 4}, {".html", 2},
+        {".log", 3}, {".dat", 3}, {".bin", 2},
+    };
+
+    std::uint32_t totalWeight() {
+        std::uint32_t total = 0;
+        for (const auto& e : kExtensions) {
+            total += e.weight;
+        }
+        return total;
+    }
+
+    std::string_view pickExtension(SplitMix64& rng, std::uint32_t weights) {
+        auto ticket = static_cast<std::uint32_t>(rng.below(weights));
+        for (const auto& e : kExtensions) {
+            if (ticket < e.weight) {
+                return e.extension;
+            }
+            ticket -= e.weight;
+        }
+        return kExtensions[0].extension;
+    }
+
+    /**
+     * @brief Log-uniform integer in [low, high] without floating point
+     *
+     * Teaching Point: Real trees have many small files and a few huge ones.
+     * Drawing the bit length uniformly, then a value of that length,
+     * spreads sizes evenly over orders of magnitude - 1 KB..2 KB is as
+     * likely as 1 MB..2 MB. Integer-only, so it is bit-exact everywhere
+     * (std::exp/std::log may differ in the last ulp between libm versions).
+     */
+    std::uint64_t pickSize(SplitMix64& rng, std::uint64_t low, std::uint64_t high) {
+        if (high <= low) {
+            return low;
+        }
+        auto bitLength = [](std::uint64_t v) {
+            int bits = 0;
+            while (v != 0) {
+                ++bits;
+                v >>= 1;
+            }
+            return bits;
+        };
+        // Shift by one so 0 takes part: draw in [low + 1, high + 1], subtract 1
+        const int minBits = bitLength(low + 1);
+        const int maxBits = bitLength(high + 1);
+        const int bits = minBits + static_cast<int>(rng.below(static_cast<std::uint64_t>(maxBits - minBits + 1)));
+        const std::uint64_t from = std::max<std::uint64_t>(low + 1, 1ULL << (bits - 1));
+        const std::uint64_t to = std::min<std::uint64_t>(high + 1, bits >= 64 ? ~0ULL : (1ULL << bits) - 1);
+        return from + rng.below(to - from + 1) - 1;
+    }
+
+    /**
+     * @brief Base-36 digits - keeps names unique without making them long
+     */
+    void appendBase36(std::string& out, std::uint64_t value) {
+        char digits[16];
+        int n = 0;
+        do {
+            const auto d = static_cast<int>(value % 36);
+            digits[n++] = static_cast<char>(d < 10 ? '0' + d : 'a' + d - 10);
+            value /= 36;
+        } while (value != 0);
+        while (n > 0) {
+            out += digits[--n];
+        }
+    }
+
+    /**
+     * @brief Writes `size` bytes generated from contentSeed
+     *
+     * Two files with the same seed and size are identical - that is how
+     * duplicates are made without keeping the content of earlier files.
+     */
+    void writeContent(const std::string& path, std::uint64_t contentSeed, std::uint64_t size,
+                      std::vector<char>& buffer) {
+        std::FILE* out = std::fopen(path.c_str(), "wb");
+        if (out == nullptr) {
+            throw std::runtime_error("cannot create " + path);
+        }
+        SplitMix64 content(contentSeed);
+        std::uint64_t left = size;
+        while (left > 0) {
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(left, buffer.size()));
+            for (std::size_t i = 0; i < chunk; i += 8) {
+                const std::uint64_t word = content.next();
+                for (std::size_t byte = 0; byte < 8 && i + byte < chunk; ++byte) {
+                    buffer[i + byte] = static_cast<char>(word >> (8 * byte));   // Little-endian everywhere
+                }
+            }
+            if (std::fwrite(buffer.data(), 1, chunk, out) != chunk) {
+                std::fclose(out);
+                throw std::runtime_error("cannot write " + path);
+            }
+            left -= chunk;
+        }
+        if (std::fclose(out) != 0) {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+
+    /**
+     * @brief Smallest fan-out F with 1 + F + F² + ... + F^depth ≥ directories
+     */
+    std::size_t fanOutFor(std::size_t directories, std::size_t depth) {
+        if (directories <= 1 || depth == 0) {
+            return 1;
+        }
+        for (std::size_t fanOut = 2;; ++fanOut) {
+            std::size_t capacity = 1;
+            std::size_t level = 1;
+            for (std::size_t d = 0; d < depth && capacity < directories; ++d) {
+                level *= fanOut;
+                capacity += level;
+            }
+            if (capacity >= directories) {
+                return fanOut;
+            }
+        }
+    }
+}
+
+std::string TreeSpec::describe() const {
+    std::ostringstream out;
+    out << "v=" << kFormatVersion << " files=" << files << " files_per_dir=" << filesPerDirectory
+        << " depth=" << maxDepth << " name=" << nameLengthMin << ":" << nameLengthMax
+        << " size=" << sizeMin << ":" << sizeMax << " duplicates=" << duplicateRatio
+        << " no_extension=" << noExtensionRatio << " seed=" << seed;
+    return out.str();
+}
+
+TreeGenerator::TreeGenerator(TreeSpec treeSpec) : spec(treeSpec) {
+    spec.filesPerDirectory = std::max<std::size_t>(1, spec.filesPerDirectory);
+    spec.nameLengthMin = std::max<std::size_t>(1, spec.nameLengthMin);
+    spec.nameLengthMax = std::max(spec.nameLengthMin, spec.nameLengthMax);
+    spec.sizeMax = std::max(spec.sizeMin, spec.sizeMax);
+}
+
+/**
+ * @brief Creates the tree
+ *
+ * ALGORITHM:
+ * 1. "<root>.spec" equal to this spec → reuse, return the stored summary
+ * 2. Refuse to delete a non-empty root that is not ours (no .spec file)
+ * 3. Directories: D = files / filesPerDirectory, laid out as a complete
+ *    F-ary tree in breadth-first order (parent of i is (i - 1) / F)
+ * 4. Files: consecutive runs per directory; each draws a stem length,
+ *    extension, and either new content (seed + size) or - with
+ *    probability duplicateRatio - a recent earlier file's content
+ * 5. Write "<root>.spec" last: it only exists for complete trees
+ */
+TreeSummary TreeGenerator::generate(const std::string& root, bool progress) const {
+    const auto started = std::chrono::steady_clock::now();
+    const std::string specPath = root + ".spec";
+    const std::string description = spec.describe();
+    TreeSummary summary;
+
+    {
+        std::ifstream stored(specPath);
+        std::string line;
+        if (std::getline(stored, line) && line == description && fs::is_directory(root)) {
+            stored >> summary.files >> summary.directories >> summary.duplicates >> summary.bytes;
+            if (stored) {
+                summary.reused = true;
+                return summary;
+            }
+        }
+    }
+
+    std::error_code ec;
+    const bool ours = fs::exists(specPath, ec);
+    if (fs::exists(root, ec) && !fs::is_empty(root, ec) && !ours) {
+        throw std::runtime_error(root + " exists and was not made by the generator - refusing to delete it");
+    }
+    fs::remove_all(root, ec);
+    {
+        std::ofstream marker(specPath, std::ios::trunc);
+        marker << "incomplete\n";   // Claims the directory before anything is written
+    }
+
+    // Directories
+    const std::size_t directoryCount =
+        spec.maxDepth == 0 ? 1
+                           : std::max<std::size_t>(1, (spec.files + spec.filesPerDirectory - 1) /
+                                                          spec.filesPerDirectory);
+    const std::size_t fanOut = fanOutFor(directoryCount, spec.maxDepth);
+    std::vector<std::string> directories;
+    directories.reserve(directoryCount);
+    directories.push_back(root);
+    fs::create_directories(root);
+    for (std::size_t i = 1; i < directoryCount; ++i) {
+        const std::size_t parent = (i - 1) / fanOut;
+        std::string path = directories[parent] + "/dir_";
+        appendBase36(path, (i - 1) % fanOut);
+        fs::create_directory(path);
+        directories.push_back(std::move(path));
+    }
+    summary.directories = directoryCount;
+
+    // Files
+    struct Content {
+        std::uint64_t seed;
+        std::uint64_t size;
+    };
+    constexpr std::size_t kRecentOriginals = 4096;
+    std::vector<Content> recent;
+    recent.reserve(kRecentOriginals);
+    std::size_t recentNext = 0;
+
+    static constexpr char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_-";
+    const std::uint32_t weights = totalWeight();
+    SplitMix64 rng(spec.seed);
+    std::vector<char> buffer(64 * 1024);
+    std::string path;
+
+    for (std::size_t k = 0; k < spec.files; ++k) {
+        const std::size_t directory = k * directoryCount / std::max<std::size_t>(1, spec.files);
+        path = directories[directory];
+        path += '/';
+
+        const std::size_t stem = spec.nameLengthMin + rng.below(spec.nameLengthMax - spec.nameLengthMin + 1);
+        for (std::size_t c = 0; c < stem; ++c) {
+            path += kAlphabet[rng.below(sizeof(kAlphabet) - 1)];
+        }
+        path += '~';
+        appendBase36(path, k);   // Unique: two random stems may collide
+        if (!rng.chance(spec.noExtensionRatio)) {
+            path += pickExtension(rng, weights);
+        }
+
+        Content content{};
+        if (!recent.empty() && rng.chance(spec.duplicateRatio)) {
+            content = recent[rng.below(recent.size())];
+            ++summary.duplicates;
+        } else {
+            content = Content{rng.next(), pickSize(rng, spec.sizeMin, spec.sizeMax)};
+            if (recent.size() < kRecentOriginals) {
+                recent.push_back(content);
+            } else {
+                recent[recentNext] = content;
+                recentNext = (recentNext + 1) % kRecentOriginals;
+            }
+        }
+        writeContent(path, content.seed, content.size, buffer);
+        summary.bytes += content.size;
+        ++summary.files;
+
+        if (progress && (k + 1) % 100000 == 0) {
+            std::cerr << "  generated " << (k + 1) << " / " << spec.files << " files\n";
+        }
+    }
+
+    {
+        std::ofstream marker(specPath, std::ios::trunc);
+        marker << description << "\n"
+               << summary.files << " " << summary.directories << " " << summary.duplicates << " "
+               << summary.bytes << "\n";
+    }
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return summary;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM TREEGENERATOR IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. REPRODUCIBLE INPUT:
+ *    - Own RNG and integer-only distributions: same seed, same tree, everywhere
+ *    - Content is a function of (seed, size), so duplicates need no memory
+ *
+ * 2. REALISTIC SHAPE:
+ *    - Log-uniform sizes, weighted extensions, a few extensionless files
+ *    - Balanced depth from one fan-out parameter
+ *
+ * 3. SAFE REUSE:
+ *    - The .spec file is written last and checked first
+ *    - A directory the generator did not create is never deleted
+ */
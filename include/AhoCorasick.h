@@ -0,0 +1,84 @@
+#ifndef AHOCORASICK_H
+#define AHOCORASICK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief AhoCorasick Class - Find Many Patterns in One Pass
+ *
+ * RESPONSIBILITY: Report every pattern that occurs in a text, reading each
+ * text byte exactly once, no matter how many patterns there are
+ *
+ * IDEA: A trie of all patterns, plus a FAILURE link per node: "longest
+ * proper suffix of what I matched that is also a trie prefix". On a
+ * mismatch the automaton follows failure links instead of restarting, so
+ * it never moves backwards in the text.
+ *
+ *   patterns: "he", "she", "hers"
+ *   text:     "ushers"  →  "she" and "he" end at 's','h','e'; "hers" at the end
+ *
+ * Teaching Point: DETERMINISTIC TABLE
+ * After construction every (state, byte) pair has its final next state
+ * precomputed (failure links folded in), so matching is one table lookup
+ * per byte. Bytes that occur in no pattern all share ONE column (alphabet
+ * compression), so the table is states × (distinct pattern bytes + 1)
+ * instead of states × 256.
+ *
+ * THREAD SAFETY: immutable after construction - any number of threads
+ * may call forEachMatch() at once.
+ */
+class AhoCorasick {
+public:
+    using State = std::uint32_t;
+
+    /**
+     * @brief Builds the automaton
+     * @param patterns Byte strings to look for (pattern id = position)
+     *
+     * Matching is exact - lowercase patterns and text for a
+     * case-insensitive search. An empty pattern matches every text.
+     */
+    explicit AhoCorasick(const std::vector<std::string>& patterns);
+
+    std::size_t patternCount() const { return patterns; }
+    std::size_t stateCount() const { return outputStarts.size() - 1; }
+
+    /**
+     * @brief Calls found(patternId) for every occurrence in text
+     *
+     * A pattern occurring twice is reported twice; callers that only want
+     * "does it occur" deduplicate.
+     */
+    template <typename Found>
+    void forEachMatch(std::string_view text, Found found) const {
+        for (std::uint32_t k = outputStarts[0]; k < outputStarts[1]; ++k) {
+            found(outputs[k]);   // Empty patterns
+        }
+        State state = 0;
+        for (char c : text) {
+            state = next[static_cast<std::size_t>(state) * columns +
+                         byteClass[static_cast<unsigned char>(c)]];
+            for (std::uint32_t k = outputStarts[state]; k < outputStarts[state + 1]; ++k) {
+                found(outputs[k]);
+            }
+        }
+    }
+
+    /**
+     * @brief Approximate heap bytes used (for diagnostics)
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    std::size_t patterns = 0;
+    std::size_t columns = 1;                 // Distinct pattern bytes + 1 ("any other byte")
+    std::uint16_t byteClass[256] = {};       // Byte → column (0 = not in any pattern)
+    std::vector<State> next;                 // states × columns transition table
+    std::vector<std::uint32_t> outputStarts; // Per state: range in outputs (CSR)
+    std::vector<std::uint32_t> outputs;      // Pattern ids ending at each state
+};
+
+#endif // AHOCORASICK_H
@@ -0,0 +1,131 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include "FileManager.h"
+#include "FileSorter.h"
+#include "FileSearcher.h"
+
+class NdjsonWriter;
+class HashCache;
+
+/**
+ * @brief Parsed command line of one batch run
+ */
+struct BatchArguments {
+    std::string command;                // scan, search, dupes, similar, usage, organize, stats, daemon, client
+    std::string directory;
+    std::string request;                // client: ping, stats, search, dupes, rescan, add-root, drop-root
+    std::vector<std::string> roots;     // --root: more directories in the same catalog
+    std::vector<std::string> terms;     // search: the name fragment
+    ScanOptions scan;
+    std::string query;                  // search --query "size>1G ext:mkv"
+    bool fuzzy = false;                 // search --fuzzy: closest names, ranked
+    std::size_t limit = 0;              // search --fuzzy: results (0 = 50); client: results or groups,
+                                        // similar: pairs (0 = all); usage: directories and files (0 = 20)
+    NearDuplicateOptions nearDuplicates; // similar: --min-size, --min-similarity
+    bool nearDuplicateOptions = false;  // One of them was given (refused elsewhere)
+    bool dryRun = false;                // organize: print the plan, move nothing
+    bool renameConflicts = false;       // organize: "name (2).ext" instead of skipping
+    bool resume = false;                // organize: finish an interrupted run
+    bool undo = false;                  // organize: move the last run back
+    bool metrics = false;               // Append counter/histogram records at the end
+    std::string socketPath;             // daemon, client: --socket (empty = default path)
+    std::size_t maxClients = 64;        // daemon --max-clients
+};
+
+/**
+ * @brief BatchRunner Class - Headless Subcommands with NDJSON Output
+ *
+ * RESPONSIBILITY: Run one operation from the command line with no
+ * prompts and stream its results to stdout, one JSON object per line:
+ *
+ *   SmartFileManager scan ~/Downloads --recursive | jq -r 'select(.size > 1e9) | .path'
+ *
+ * DESIGN PATTERN: a second Controller next to Menu - same models
+ * (FileManager, FileSorter, FileSearcher), different view. Nothing in
+ * the engines knows which controller called it.
+ *
+ * Teaching Point: STREAM WHAT CAN BE STREAMED
+ * scan, search, dupes, similar and stats use FileManager::streamScan(): records
+ * of each batch are written (and flushed) while workers list the next
+ * directories, and memory stays bounded however large the tree is. Only
+ * what needs the whole catalog at once - ranked fuzzy search, attribute
+ * queries, disk usage and organize plans - does a full scan first.
+ *
+ * Every record has a "type" ("file", "duplicates", "similar", "directory", "move", "extension",
+ * "category", "counter", "histogram"); the last one is always a
+ * "summary". Diagnostics go to stderr and the log, never to stdout.
+ *
+ * daemon and client are the long-running variant: `daemon DIR` keeps the
+ * catalog resident (DaemonServer), and `client REQUEST` asks it - same
+ * record types, each with the "epoch" of the snapshot that answered.
+ *
+ * EXIT CODES: 0 = success, 1 = operation failed, 64 = usage error
+ */
+class BatchRunner {
+public:
+    BatchRunner(std::shared_ptr<FileSorter> sorter, std::shared_ptr<FileSearcher> searcher,
+                std::shared_ptr<HashCache> cache = nullptr);
+
+    /**
+     * @brief True if argv[1] names a subcommand (or asks for help)
+     */
+    static bool isCommand(std::string_view word);
+
+    /**
+     * @brief Parses and runs one command
+     * @param argc Arguments from the subcommand on (argv[0] = "scan", ...)
+     * @return Process exit code
+     */
+    int run(int argc, char* argv[]);
+
+    /**
+     * @brief Writes the usage text
+     */
+    static void printUsage(std::ostream& out);
+
+private:
+    std::shared_ptr<FileSorter> fileSorter;
+    std::shared_ptr<FileSearcher> fileSearcher;
+    std::shared_ptr<HashCache> hashCache;       // Handed to the daemon's snapshots
+
+    /**
+     * @brief Fills arguments from argv; prints the problem to stderr on failure
+     */
+    static bool parse(int argc, char* argv[], BatchArguments& arguments);
+
+    /**
+     * @brief Command handlers: write records, return the exit code
+     */
+    int runScan(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+    int runSearch(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+    int runDuplicates(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+    int runSimilar(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+    int runUsage(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+    int runOrganize(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+    int runStats(const BatchArguments& arguments, FileManager& manager, NdjsonWriter& out) const;
+
+    /**
+     * @brief daemon: serve until SIGINT/SIGTERM; client: one request, NDJSON answer
+     */
+    int runDaemon(const BatchArguments& arguments) const;
+    static int runClient(const BatchArguments& arguments, NdjsonWriter& out);
+
+    /**
+     * @brief {"type":"file",...} for one catalog entry (errors < 0 = omitted)
+     */
+    static void writeFile(NdjsonWriter& out, const FileCatalog& files, FileCatalog::Index i,
+                          int errors = -1);
+
+    /**
+     * @brief One record per counter and histogram of this process
+     */
+    static void writeMetrics(NdjsonWriter& out);
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,102 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief BoundedQueue - Blocking producer/consumer queue with a capacity
+ *
+ * RESPONSIBILITY: Hand items from producer threads to a consumer while
+ * never holding more than `capacity` items.
+ *
+ * Teaching Point: BACKPRESSURE
+ * An unbounded queue lets a fast producer run arbitrarily far ahead of a
+ * slow consumer - memory grows until the machine swaps. A bounded queue
+ * makes push() WAIT when full, so producers slow down to the consumer's
+ * pace and memory stays flat.
+ *
+ * SHUTDOWN:
+ * - close():  producers are done; pop() drains what is left, then returns false
+ * - cancel(): the consumer gave up; push() and pop() return false at once
+ *
+ * Teaching Point: Templates live entirely in the header - the compiler
+ * needs the full definition wherever BoundedQueue<T> is instantiated.
+ */
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    const std::size_t capacity;
+    bool closed = false;
+    bool cancelled = false;
+    mutable std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+public:
+    explicit BoundedQueue(std::size_t maxItems) : capacity(maxItems == 0 ? 1 : maxItems) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Adds an item, waiting while the queue is full
+     * @return false if the queue was cancelled (item is dropped)
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return items.size() < capacity || cancelled; });
+        if (cancelled) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item, waiting while the queue is empty
+     * @return false once the queue is closed and drained, or cancelled
+     */
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return !items.empty() || closed || cancelled; });
+        if (cancelled || items.empty()) {
+            return false;
+        }
+        out = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+    }
+
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+            items.clear();
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    bool isCancelled() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cancelled;
+    }
+};
+
+#endif // BOUNDEDQUEUE_H
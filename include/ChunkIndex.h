@@ -0,0 +1,139 @@
+#ifndef CHUNKINDEX_H
+#define CHUNKINDEX_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "ContentChunker.h"
+#include "FileReader.h"
+
+/**
+ * @brief ChunkIndex Class - Persistent Chunk Lists Keyed by File Identity
+ *
+ * RESPONSIBILITY: Remember the content-defined chunks of files that have
+ * not changed, so a repeat near-duplicate run reads (almost) nothing
+ *
+ * KEY: (device, inode) → the file's current identity and chunk list. A
+ * new version of a file REPLACES its old entry (unlike HashCache, there is
+ * nothing to gain from keeping a 10 GB image's previous chunk list).
+ *
+ * COMPACT LAYOUT: all chunk lists live in ONE arena; an entry is an
+ * offset + count into it. On disk a chunk is 12 bytes (fingerprint +
+ * length) - about 200 KB per GB of files at the default 64 KB chunks.
+ *
+ * FILE FORMAT:
+ *
+ *   Header  magic "SFMCHNK", version, endian marker, min/avg/max chunk size
+ *   File    device, inode, size, mtimeNs, chunk count, day last used
+ *   Chunk   fingerprint, length      (× chunk count)
+ *   File    ...
+ *
+ * The chunk sizes are part of the header: chunks cut with other sizes
+ * would never match, so an index written with other ChunkerOptions is
+ * ignored (and replaced on the next flush).
+ *
+ * EVICTION: a deleted file never says so. Every entry carries the day it
+ * was last stored or hit (days since 1970); a run re-dates the entries of
+ * the catalog it processes, and a rewrite drops entries nobody used for
+ * kKeepDays. Entries of OTHER roots sharing the file survive as long as
+ * those roots are still searched - pruning to one catalog would wipe them.
+ *
+ * SHARED BETWEEN PROCESSES: like HashCache, reads hold a shared FileLock
+ * and a rewrite an exclusive one; the rewrite first merges entries other
+ * processes wrote since we loaded (the newer version of a file wins).
+ *
+ * Teaching Point: LAZY LOADING
+ * Most sessions never look for near-duplicates. The file is read on the
+ * first lookup() or store(), not in the constructor, so having an index
+ * attached costs nothing until it is used.
+ *
+ * THREAD SAFETY: all methods lock an internal mutex.
+ */
+class ChunkIndex {
+public:
+    static constexpr std::uint32_t kVersion = 2;              // 2: day last used per file
+    static constexpr std::uint32_t kKeepDays = 60;            // Unused this long → dropped
+    static constexpr std::uint32_t kRefreshDays = 7;          // Hit on an older entry → re-dated
+
+    /**
+     * @brief Shared index file: "./.sfm_cache/chunks.sfmci" (next to the HashCache)
+     */
+    static std::string defaultPath();
+
+    /**
+     * @brief Names an index file (loaded on first use); a missing file is an empty index
+     * @param indexPath File to load from and flush to
+     * @param options Chunk sizes this index holds
+     */
+    explicit ChunkIndex(std::string indexPath, const ChunkerOptions& options = ChunkerOptions());
+
+    /**
+     * @brief Flushes changes (RAII)
+     */
+    ~ChunkIndex();
+
+    ChunkIndex(const ChunkIndex&) = delete;
+    ChunkIndex& operator=(const ChunkIndex&) = delete;
+
+    /**
+     * @brief Looks up the chunks of a file version
+     * @return true and fills chunks if exactly this identity was stored
+     *
+     * Not const: the first call loads the file.
+     */
+    bool lookup(const FileIdentity& identity, std::vector<Chunk>& chunks);
+
+    /**
+     * @brief Remembers the chunks of a file version (written by the next flush())
+     *
+     * Unknown identities (inode 0) are not stored.
+     */
+    void store(const FileIdentity& identity, const std::vector<Chunk>& chunks);
+
+    /**
+     * @brief Rewrites the file if anything changed (temp file + rename),
+     *        dropping entries unused for kKeepDays
+     * @return false if the file could not be written (index stays in memory)
+     */
+    bool flush();
+
+    /**
+     * @brief Number of files with a chunk list
+     */
+    std::size_t size() const;
+
+    const std::string& getPath() const { return path; }
+    const ChunkerOptions& chunking() const { return options; }
+
+private:
+    struct Entry {
+        FileIdentity identity;
+        std::uint64_t first = 0;       // Offset into arena
+        std::uint32_t count = 0;
+        std::uint32_t day = 0;         // Last stored or hit
+    };
+
+    struct InodeHasher {
+        std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& key) const;
+    };
+
+    std::string path;
+    ChunkerOptions options;
+    std::unordered_map<std::pair<std::uint64_t, std::uint64_t>, Entry, InodeHasher> entries;
+    std::vector<Chunk> arena;
+    std::uint64_t liveChunks = 0;      // Chunks referenced by an entry (the rest are replaced)
+    std::uint32_t today = 0;
+    bool dirty = false;
+    bool loaded = false;
+    mutable std::mutex mutex;
+
+    void ensureLoaded();               // mutex held
+    void load();
+    bool replay(bool merging);         // mutex held
+    void prune();                      // mutex held
+    bool rewrite();
+};
+
+#endif // CHUNKINDEX_H
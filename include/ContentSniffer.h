@@ -0,0 +1,107 @@
+#ifndef CONTENTSNIFFER_H
+#define CONTENTSNIFFER_H
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "FileCatalog.h"
+#include "FileReader.h"
+#include "HashCache.h"
+
+/**
+ * @brief File types recognised from their first bytes
+ *
+ * The numeric values are stored in the HashCache - only ever APPEND new
+ * types (and bump ContentSniffer::kTableVersion when the table changes).
+ */
+enum class ContentType : std::uint8_t {
+    Unknown = 0,
+    // Images
+    Png, Jpeg, Gif, Bmp, Tiff, Webp, Heic, Icon,
+    // Video
+    Mp4, QuickTime, Matroska, Avi, MpegStream,
+    // Audio
+    Mp3, Flac, Ogg, Wav, M4a, Midi,
+    // Archives
+    Zip, Gzip, Bzip2, Xz, SevenZip, Rar, Tar, Zstd,
+    // Documents
+    Pdf, OfficeOpenXml, OpenDocument, Epub, OleCompound, Rtf,
+    // Executables
+    Elf, WindowsExe, MachO,
+    // Code
+    Script,
+    Count
+};
+
+/**
+ * @brief Counters of one sniff() run
+ */
+struct SniffStats {
+    std::size_t files = 0;          // Rows asked about
+    std::size_t cacheHits = 0;      // Answered without reading
+    std::size_t headersRead = 0;    // Files whose first bytes were read
+    std::size_t recognised = 0;     // Rows with a type other than Unknown
+    double milliseconds = 0;
+};
+
+/**
+ * @brief ContentSniffer Class - Tells a File's Type from Its First Bytes
+ *
+ * RESPONSIBILITY: Classify files whose extension says nothing (none,
+ * ".dat", ".bin", a camera's ".001") by their "magic bytes"
+ *
+ * HOW:
+ * - Reads only the first kHeadBytes (512) of a file - through a
+ *   FileReader, so the read lands in a pooled buffer and respects the
+ *   per-device queue depth
+ * - Matches them against a constexpr signature table. A second constexpr
+ *   table, indexed by the FIRST byte, says which signatures can match at
+ *   all: for most unknown blobs that is one array load and zero compares
+ * - Runs on a ThreadPool; files of one call are read in parallel
+ * - Every verdict (Unknown included) is stored in the HashCache keyed by
+ *   the file identity, so the next run reads no header at all
+ *
+ * WITH A STREAMING SCAN: sniff() accepts any catalog, including the
+ * batches FileManager::streamScan() delivers - sniffing then overlaps the
+ * scan, and the later organize run is answered from the cache.
+ *
+ * THREAD SAFETY: sniff() may be called from several threads.
+ */
+class ContentSniffer {
+public:
+    static constexpr std::size_t kHeadBytes = 512;
+    static constexpr std::uint64_t kTableVersion = 1;   // Part of every cached value
+
+    /**
+     * @param cache Persistent verdicts (nullptr = always read)
+     */
+    explicit ContentSniffer(std::shared_ptr<HashCache> cache = nullptr);
+
+    /**
+     * @brief Classifies a file header (pure function, no I/O)
+     * @param head First bytes of the file
+     * @param length Bytes available (less than kHeadBytes for small files)
+     */
+    static ContentType classify(const unsigned char* head, std::size_t length);
+
+    /**
+     * @brief Short name of a type ("PNG image", ...)
+     */
+    static std::string_view typeName(ContentType type);
+
+    /**
+     * @brief Classifies catalog rows (cache first, then parallel reads)
+     * @param files Catalog the rows belong to
+     * @param rows Files to classify
+     * @param types Receives one type per row (same order)
+     * @return Counters; unreadable files come back as Unknown
+     */
+    SniffStats sniff(const FileCatalog& files, const std::vector<FileCatalog::Index>& rows,
+                     std::vector<ContentType>& types) const;
+
+private:
+    std::shared_ptr<HashCache> cache;
+};
+
+#endif // CONTENTSNIFFER_H
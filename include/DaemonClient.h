@@ -0,0 +1,52 @@
+#ifndef DAEMONCLIENT_H
+#define DAEMONCLIENT_H
+
+#include <string>
+#include "DaemonProtocol.h"
+
+/**
+ * @brief DaemonClient Class - One Connection to a Running Daemon
+ *
+ * RESPONSIBILITY: Send requests over the Unix socket and decode answers
+ *
+ *   DaemonClient client(DaemonServer::defaultSocketPath());
+ *   DaemonRequest request;
+ *   request.op = wire::Op::Search;
+ *   request.text = "report";
+ *   DaemonResponse response;
+ *   if (client.connect() && client.call(request, response)) { ... }
+ *
+ * One connection can carry any number of requests, one at a time.
+ */
+class DaemonClient {
+public:
+    explicit DaemonClient(std::string socketPath);
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    /**
+     * @brief Connects to the daemon's socket
+     * @return false if no daemon listens there (see error())
+     */
+    bool connect();
+
+    /**
+     * @brief Sends one request and waits for its answer
+     * @return false on a transport or decoding failure; a daemon-side
+     *         error is a successful call with response.status != Ok
+     */
+    bool call(const DaemonRequest& request, DaemonResponse& response);
+
+    void close();
+    const std::string& error() const { return lastError; }
+    const std::string& socketPath() const { return path; }
+
+private:
+    std::string path;
+    int fd = -1;
+    std::string lastError;
+};
+
+#endif // DAEMONCLIENT_H
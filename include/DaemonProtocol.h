@@ -0,0 +1,191 @@
+#ifndef DAEMONPROTOCOL_H
+#define DAEMONPROTOCOL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Wire format between the daemon and its clients
+ *
+ * FRAMING: every message is [u32 little-endian length][payload]
+ *
+ * REQUEST payload:  u8 version, u8 op, then per op
+ *   Search      u8 flags (1 = fuzzy), varint limit (0 = all), string term
+ *   Query       varint limit, string expression ("size>1G ext:mkv")
+ *   Duplicates  varint limit (groups, 0 = all)
+ *   AddRoot, DropRoot    string directory
+ *   Ping, Stats, Rescan  nothing
+ *
+ * RESPONSE payload: u8 version, u8 status, varint epoch, then
+ *   status != Ok    string message
+ *   Ping, Rescan    varint files
+ *   AddRoot, DropRoot    varint files, varint roots
+ *   Stats           varint files, directories, bytes, age ms, requests,
+ *                   clients, u8 watching
+ *   Search, Query   varint total, varint count, count × file
+ *                   (string path, varint size, zigzag mtime ns, varint errors + 1)
+ *   Duplicates      varint total groups, varint reclaimable bytes, varint count,
+ *                   count × (varint size, u64 hash, varint n, n × string path)
+ *
+ * Teaching Point: VARINTS (LEB128)
+ * Seven bits per byte, high bit = "more follows": sizes under 128 take
+ * one byte, under 16 384 two. Most numbers in a file listing are small,
+ * so a result row is its path plus a handful of bytes. Signed values
+ * (mtime) are zigzag-mapped first so small negatives stay short too.
+ */
+namespace wire {
+
+    constexpr std::uint8_t kVersion = 1;
+    constexpr std::size_t kMaxRequestBytes = 1 << 20;           // Requests are tiny
+    constexpr std::size_t kMaxResponseBytes = std::size_t(1) << 30;
+    constexpr std::uint8_t kSearchFuzzy = 1;
+
+    enum class Op : std::uint8_t {
+        Ping = 1,
+        Stats = 2,
+        Search = 3,
+        Query = 4,
+        Duplicates = 5,
+        Rescan = 6,         // Incremental rescan + new epoch now (no watch mode, or impatient cron)
+        AddRoot = 7,        // Scan one more directory into the catalog (only that one)
+        DropRoot = 8        // Forget one root and its files
+    };
+
+    enum class Status : std::uint8_t {
+        Ok = 0,
+        BadRequest = 1,     // Unknown op, malformed payload, invalid query
+        Failed = 2,         // Valid request the daemon could not serve
+        Busy = 3            // Connection limit reached
+    };
+
+    /**
+     * @brief Appends little-endian integers, varints and strings
+     */
+    class Writer {
+    public:
+        void u8(std::uint8_t value) { buffer.push_back(static_cast<char>(value)); }
+        void fixed64(std::uint64_t value);
+        void varint(std::uint64_t value);
+        void zigzag(std::int64_t value) {
+            varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+        }
+        void string(std::string_view text) {
+            varint(text.size());
+            buffer.append(text.data(), text.size());
+        }
+
+        const std::string& data() const { return buffer; }
+        std::string take() { return std::move(buffer); }
+
+    private:
+        std::string buffer;
+    };
+
+    /**
+     * @brief Reads what Writer wrote; any overrun turns ok() false (and reads 0)
+     *
+     * Teaching Point: A network peer can send anything. Every read checks
+     * the remaining length, so a truncated or hostile message fails cleanly
+     * instead of reading past the buffer.
+     */
+    class Reader {
+    public:
+        explicit Reader(std::string_view payload) : data(payload) {}
+
+        std::uint8_t u8();
+        std::uint64_t fixed64();
+        std::uint64_t varint();
+        std::int64_t zigzag() {
+            const std::uint64_t raw = varint();
+            return static_cast<std::int64_t>((raw >> 1) ^ (~(raw & 1) + 1));
+        }
+        std::string string();
+
+        bool ok() const { return good; }
+        bool atEnd() const { return position == data.size(); }
+
+    private:
+        std::string_view data;
+        std::size_t position = 0;
+        bool good = true;
+    };
+
+    /**
+     * @brief Sends one frame (handles partial writes, never raises SIGPIPE)
+     */
+    bool writeFrame(int fd, std::string_view payload);
+
+    /**
+     * @brief Receives one frame
+     * @return false on EOF, error, timeout or a frame larger than maxBytes
+     */
+    bool readFrame(int fd, std::string& payload, std::size_t maxBytes);
+
+}  // namespace wire
+
+/**
+ * @brief One request to the daemon
+ */
+struct DaemonRequest {
+    wire::Op op = wire::Op::Ping;
+    bool fuzzy = false;             // Search: ranked closest names
+    std::uint64_t limit = 0;        // Search / Query: files, Duplicates: groups (0 = all)
+    std::string text;               // Search term, query expression or root directory
+
+    std::string encode() const;
+    bool decode(std::string_view payload);
+};
+
+/**
+ * @brief One file of a search or query answer
+ */
+struct RemoteFile {
+    std::string path;
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    std::int64_t errors = -1;       // Fuzzy search: edits to the term; -1 = not fuzzy
+};
+
+/**
+ * @brief One group of identical files
+ */
+struct RemoteGroup {
+    std::uint64_t size = 0;
+    std::uint64_t hash = 0;
+    std::vector<std::string> paths;
+};
+
+/**
+ * @brief One answer from the daemon (fields used depend on the request op)
+ */
+struct DaemonResponse {
+    wire::Status status = wire::Status::Ok;
+    std::uint64_t epoch = 0;        // Snapshot the answer was computed on
+    std::string message;            // status != Ok
+
+    // Ping, Rescan, Stats, AddRoot, DropRoot
+    std::uint64_t files = 0;
+    std::uint64_t roots = 0;        // AddRoot, DropRoot: roots afterwards
+    std::uint64_t directories = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t ageMs = 0;        // Time since the snapshot was published
+    std::uint64_t requests = 0;     // Served since the daemon started
+    std::uint64_t clients = 0;      // Connected now
+    bool watching = false;
+
+    // Search, Query (total = matches before the limit)
+    std::uint64_t total = 0;
+    std::vector<RemoteFile> results;
+
+    // Duplicates (total = groups before the limit)
+    std::uint64_t reclaimable = 0;
+    std::vector<RemoteGroup> groups;
+
+    std::string encode(wire::Op op) const;
+    bool decode(wire::Op op, std::string_view payload);
+};
+
+#endif // DAEMONPROTOCOL_H
@@ -0,0 +1,171 @@
+#ifndef DAEMONSERVER_H
+#define DAEMONSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FileManager.h"
+#include "FileSearcher.h"
+#include "DaemonProtocol.h"
+#include "ThreadPool.h"
+
+class HashCache;
+
+/**
+ * @brief Settings of one daemon
+ */
+struct DaemonOptions {
+    std::string directory;
+    std::vector<std::string> extraRoots;                    // Scanned into the same catalog
+    std::string socketPath;                                 // Empty = DaemonServer::defaultSocketPath()
+    ScanOptions scan;
+    std::size_t maxClients = 64;                            // Connections served at once; more get Busy
+    std::chrono::milliseconds publishInterval{500};         // How often catalog changes are published
+    std::chrono::seconds rescanInterval{60};                // Without watch mode: periodic incremental rescan
+    std::chrono::seconds idleTimeout{300};                  // Silent connections are closed
+};
+
+/**
+ * @brief DaemonServer Class - Resident Catalog Served over a Unix Socket
+ *
+ * RESPONSIBILITY: Keep one FileManager catalog, its search indexes and
+ * the hash cache in memory, update them via watch mode, and answer
+ * search / query / duplicate / stats requests from many clients:
+ *
+ *   SmartFileManager daemon ~/Documents -r &
+ *   SmartFileManager client search report      # ~1 ms instead of a full scan
+ *   SmartFileManager client add-root /mnt/nas  # Scans only /mnt/nas
+ *
+ * THREADS:
+ *   watcher     (FileManager) applies inotify batches to the live catalog
+ *   publisher   turns a changed catalog into a new immutable snapshot
+ *   acceptor    run(): accepts connections, refuses them past maxClients
+ *   connection  one per client: read request → answer → write response
+ *   search pool one long-lived ThreadPool; every connection submits the
+ *               shards of its request and waits for them (TaskGroup)
+ *
+ * Teaching Point: READ-MOSTLY SNAPSHOTS (RCU-style epochs)
+ * Queries never touch the live catalog - the watcher may be rewriting it.
+ * Every published catalog is an immutable Snapshot with its own indexes:
+ *
+ *   publisher:  next = copy of live catalog, build indexes, then
+ *               atomic_store(current, next)          // epoch N+1
+ *   reader:     snap = atomic_load(current)          // never waits for publisher
+ *               ... search snap->files ...
+ *
+ * The shared_ptr reference count is the grace period: a reader still
+ * answering on epoch N keeps N alive, and N is freed when its last
+ * reader lets go. Searches never block on catalog updates, and every
+ * answer is consistent with exactly one epoch (sent with the response).
+ *
+ * POSIX only (Unix domain sockets); run() reports "not supported" elsewhere.
+ */
+class DaemonServer {
+public:
+    DaemonServer(DaemonOptions options, std::shared_ptr<HashCache> cache);
+    ~DaemonServer();
+
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+
+    /**
+     * @brief $SFM_SOCKET, else /tmp/sfm-<uid>.sock
+     */
+    static std::string defaultSocketPath();
+
+    /**
+     * @brief Scans, publishes epoch 1, then serves until requestStop() or SIGINT/SIGTERM
+     * @return Process exit code (0 = clean shutdown)
+     */
+    int run();
+
+    /**
+     * @brief Asks run() to return (any thread)
+     */
+    void requestStop() { stopping = true; }
+
+    /**
+     * @brief Makes SIGINT and SIGTERM stop every running daemon cleanly
+     */
+    static void installSignalHandlers();
+
+private:
+    /**
+     * @brief One published epoch: an immutable catalog plus its indexes
+     *
+     * Only the duplicate result is filled lazily - on the first dupes
+     * request of the epoch, once, under its own mutex.
+     */
+    struct Snapshot {
+        std::uint64_t epoch = 0;
+        FileCatalog files;
+        FileSearcher searcher;
+        std::uint64_t bytes = 0;
+        std::chrono::steady_clock::time_point published;
+
+        std::mutex duplicatesMutex;
+        bool duplicatesReady = false;
+        DuplicateResult duplicates;
+
+        const DuplicateResult& duplicateGroups();
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+    };
+
+    DaemonOptions options;
+    std::shared_ptr<HashCache> hashCache;
+    std::shared_ptr<ThreadPool> searchPool;        // Shared by every snapshot's searcher
+    FileManager manager;
+
+    std::shared_ptr<Snapshot> current;              // atomic_load / atomic_store only
+    std::mutex publishMutex;                        // One publisher at a time
+    std::mutex rescanMutex;                         // One rescan at a time
+
+    std::atomic<bool> stopping{false};
+    std::mutex wakeMutex;
+    std::condition_variable wake;                   // Publisher sleeps on it
+    std::thread publisherThread;
+
+    int listenFd = -1;
+    std::list<std::unique_ptr<Connection>> connections;     // Acceptor thread only (and stop)
+    std::atomic<std::size_t> activeClients{0};
+    std::atomic<std::uint64_t> requestsServed{0};
+
+    static volatile std::sig_atomic_t signalled;
+    static void onSignal(int);
+
+    bool shouldStop() const { return stopping || signalled != 0; }
+
+    /**
+     * @brief Copies the live catalog into a new epoch if it changed
+     * @return true if a snapshot was published
+     */
+    bool publish();
+
+    std::shared_ptr<Snapshot> snapshot() const { return std::atomic_load(&current); }
+
+    void publisherLoop();
+    bool openSocket();
+    void closeSocket();
+    void reapConnections(bool all);
+    void rejectBusy(int fd);
+    void serveConnection(Connection& connection);
+
+    /**
+     * @brief Answers one decoded request
+     */
+    DaemonResponse answer(const DaemonRequest& request);
+};
+
+#endif // DAEMONSERVER_H
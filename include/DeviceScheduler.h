@@ -0,0 +1,132 @@
+#ifndef DEVICESCHEDULER_H
+#define DEVICESCHEDULER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+class ThreadPool;
+
+/**
+ * @brief What kind of storage a device (st_dev) is
+ */
+enum class DeviceClass : std::uint8_t {
+    SolidState,     // SSD, NVMe, tmpfs - and anything unknown
+    Rotational,     // Spinning disk (sysfs queue/rotational = 1)
+    Network         // NFS, SMB/CIFS, Ceph, AFS, 9p
+};
+
+/**
+ * @brief Short lowercase name ("ssd", "hdd", "network") for logs and output
+ */
+const char* deviceClassName(DeviceClass kind);
+
+/**
+ * @brief Classifies a device
+ * @param device st_dev of `path`
+ * @param path Any path on that device (the filesystem type is asked via statfs)
+ *
+ * Linux only; elsewhere every device is SolidState.
+ */
+DeviceClass classifyDevice(std::uint64_t device, const std::string& path);
+
+/**
+ * @brief st_dev of a path (0 = unknown, or no POSIX stat on this platform)
+ */
+std::uint64_t deviceOf(const std::string& path);
+
+/**
+ * @brief Concurrent directory listings allowed per device, by device class
+ *
+ * Teaching Point: The right amount of parallelism is a property of the
+ * DEVICE, not of the machine. NVMe wants every worker; a spinning disk
+ * seeks itself to death beyond two; an NFS mount is latency-bound and
+ * may stall - capping it keeps the other workers free for local disks.
+ */
+struct DeviceLimits {
+    std::size_t solidState = 0;     // 0 = every worker of the pool
+    std::size_t rotational = 2;
+    std::size_t network = 4;
+
+    std::size_t forClass(DeviceClass kind) const;
+};
+
+/**
+ * @brief DeviceScheduler Class - Per-Device Concurrency Limits on a ThreadPool
+ *
+ * RESPONSIBILITY: Run scan tasks on a shared ThreadPool while keeping
+ * the number of tasks IN FLIGHT per device at or below its class limit
+ *
+ *   DeviceScheduler io(pool, options.devices);
+ *   io.submit(deviceOf(root), root, [&] { listDirectory(root); });
+ *   pool.waitIdle();     // Also waits for every deferred task
+ *
+ * HOW: Tasks of a throttled device are started through at most `limit`
+ * RUNNERS - pool tasks that run the submitted task, then take the next
+ * one waiting for the same device, and end when none is left. Excess
+ * tasks wait in the device's queue, not on a worker: a saturated NFS
+ * mount occupies `limit` workers, the rest keep listing local disks.
+ *
+ * Devices whose limit covers the whole pool skip the queue and go
+ * straight to the pool, so an all-NVMe scan behaves exactly as before.
+ *
+ * Teaching Point: No worker ever BLOCKS waiting for a device slot (as
+ * FileReader's semaphores do for single reads). A blocked worker would
+ * be lost to every other device for as long as it waits.
+ */
+class DeviceScheduler {
+public:
+    using Task = std::function<void()>;
+
+    DeviceScheduler(ThreadPool& pool, const DeviceLimits& limits);
+    ~DeviceScheduler();
+
+    DeviceScheduler(const DeviceScheduler&) = delete;
+    DeviceScheduler& operator=(const DeviceScheduler&) = delete;
+
+    /**
+     * @brief Runs `task` on the pool within the limit of `device`
+     * @param device st_dev the task reads from (0 = unknown, unthrottled)
+     * @param path A path on that device, used once to classify it
+     */
+    void submit(std::uint64_t device, const std::string& path, Task task);
+
+    /**
+     * @brief One line per device: class, limit, tasks run and deferred
+     */
+    std::string summary() const;
+
+    /**
+     * @brief Number of distinct devices seen so far
+     */
+    std::size_t deviceCount() const;
+
+private:
+    struct Device {
+        DeviceClass kind = DeviceClass::SolidState;
+        std::size_t limit = 0;          // 0 = unthrottled
+        std::atomic<std::uint64_t> tasks{0};    // Submitted
+
+        std::mutex mutex;               // Guards the fields below
+        std::size_t running = 0;        // Runners alive
+        std::deque<Task> pending;       // Waiting for a runner
+        std::uint64_t deferred = 0;     // Had to wait in `pending`
+    };
+
+    ThreadPool& pool;
+    DeviceLimits limits;
+    mutable std::shared_mutex devicesMutex;
+    std::unordered_map<std::uint64_t, std::unique_ptr<Device>> devices;
+
+    Device& deviceFor(std::uint64_t device, const std::string& path);
+    void runner(Device& device, Task first);
+};
+
+#endif // DEVICESCHEDULER_H
@@ -0,0 +1,115 @@
+#ifndef DISKUSAGE_H
+#define DISKUSAGE_H
+
+#include <cstdint>
+#include <vector>
+#include "FileCatalog.h"
+
+class ThreadPool;
+
+/**
+ * @brief Totals of a directory and everything below it
+ */
+struct DirectoryUsage {
+    std::uint64_t files = 0;
+    std::uint64_t bytes = 0;           // Apparent size (sum of file sizes)
+    std::uint64_t directories = 0;     // Subdirectories at any depth (not counting itself)
+};
+
+/**
+ * @brief One entry of DiskUsage::largestDirectories()
+ */
+struct DirectorySize {
+    FileCatalog::DirectoryId directory = FileCatalog::kNoDirectory;
+    DirectoryUsage usage;
+};
+
+/**
+ * @brief DiskUsage Class - Recursive Directory Totals ("du") From the Catalog
+ *
+ * RESPONSIBILITY: Know how many files and bytes every directory holds,
+ * INCLUDING its subdirectories, without touching the filesystem again
+ *
+ * WHERE THE NUMBERS COME FROM:
+ * 1. During the scan each worker adds a file's size to its directory's
+ *    own totals (FileCatalog::directoryTotals) - the per-directory sums
+ *    are built in parallel, in the same pass that lists the files
+ * 2. build() rolls the own totals up the directory tree: one pass over
+ *    DIRECTORIES, not files (a 10M-file tree has ~1M directories)
+ * 3. Watch mode applies each file change along the parent chain - a
+ *    depth-d change costs d additions, no rebuild
+ *
+ * Teaching Point: BOTTOM-UP REDUCTION BY LEVELS
+ * A directory's total needs its children's totals first. Grouping the
+ * directories by depth and processing the deepest level first gives that
+ * order; within one level no directory depends on another, so a level
+ * splits into independent pool tasks. Each task PULLS its children's
+ * totals and writes only its own slot - no atomics, no locks.
+ *
+ * Sizes are apparent sizes as stored by the scan (what `du -b` prints);
+ * a file with several hard links counts once per path.
+ *
+ * THREAD SAFETY: none - FileManager updates it under its exclusive lock.
+ */
+class DiskUsage {
+public:
+    /**
+     * @brief Recomputes every directory's recursive totals
+     * @param files Catalog with linked directories
+     * @param pool Runs large levels in parallel (nullptr = on this thread);
+     *        must be idle, build() waits for it
+     */
+    void build(const FileCatalog& files, ThreadPool* pool = nullptr);
+
+    void clear();
+
+    /**
+     * @brief True if built for a catalog with this many directories
+     */
+    bool covers(const FileCatalog& files) const { return usage.size() == files.directoryCount(); }
+
+    /**
+     * @brief Applies a file change to d and all its ancestors
+     * @param fileDelta +1 added, -1 removed, 0 resized
+     * @param byteDelta Size change in bytes
+     */
+    void apply(const FileCatalog& files, FileCatalog::DirectoryId d,
+               std::int64_t fileDelta, std::int64_t byteDelta);
+
+    /**
+     * @brief Recursive totals of d (requires covers())
+     */
+    const DirectoryUsage& subtree(FileCatalog::DirectoryId d) const { return usage[d]; }
+
+    /**
+     * @brief Totals of all roots together
+     */
+    DirectoryUsage total() const;
+
+    /**
+     * @brief The n directories with the most bytes below them, largest first
+     *
+     * Teaching Point: BOUNDED HEAP - a min-heap of at most n entries whose
+     * top is the smallest of the current best n. Each directory costs one
+     * compare with the top, and only a larger one replaces it: O(D log n)
+     * time and O(n) memory instead of sorting all D directories.
+     */
+    std::vector<DirectorySize> largestDirectories(std::size_t n) const;
+
+    /**
+     * @brief The n largest files of a catalog, largest first (bounded heap)
+     */
+    static std::vector<FileCatalog::Index> largestFiles(const FileCatalog& files, std::size_t n);
+
+    /**
+     * @brief Depth levels of the last build (for diagnostics)
+     */
+    std::size_t levels() const { return levelCount; }
+
+private:
+    std::vector<DirectoryUsage> usage;
+    std::vector<FileCatalog::DirectoryId> roots;   // Directories without a parent
+    std::size_t levelCount = 0;
+};
+
+#endif // DISKUSAGE_H
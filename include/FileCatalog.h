@@ -0,0 +1,439 @@
+#ifndef FILECATALOG_H
+#define FILECATALOG_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <functional>
+#include "FileInfo.h"
+
+/**
+ * @brief FileCatalog Class - Compact Column Storage for Scanned Files
+ *
+ * RESPONSIBILITY: Holds the results of a scan using as little memory as possible
+ *
+ * WHY NOT std::vector<FileInfo>?
+ * Every FileInfo owns three std::string objects and an fs::path. Each of
+ * those can allocate on the heap, and name/extension repeat bytes that are
+ * already inside path. At millions of files that overhead is gigabytes.
+ *
+ * LAYOUT: Structure-of-Arrays (SoA)
+ *
+ *   pathArena:   "/data/a.txt/data/b.JPG/data/sub/c.txt..."  (one big buffer)
+ *   records[i]:  { pathOffset, pathLength, nameLength, extensionId }
+ *   sizes[i]:    file size in bytes
+ *   hashes[i]:   content hash (0 = not computed yet)
+ *   mtimes[i]:   modification time (ns)
+ *   inodes[i]:   inode number (0 = unknown)
+ *   lowerNames:  "a.txt\0b.jpg\0c.txt\0..."  (lowercased names, second arena)
+ *
+ * - name is the LAST nameLength bytes of the path (no copy)
+ * - extension is interned: each distinct extension is stored once and files
+ *   refer to it with a 16-bit ID
+ *
+ *   directories: every scanned directory (path, parent, depth, mtime,
+ *                device); fileDirectories[i] says which one holds file i
+ *   ownTotals:   per directory, count and bytes of the files directly in it
+ *
+ * MEMORY PER FILE: 16 (record) + 8 (size) + 8 (hash) + 4 (directory)
+ *                  + 8 (mtime) + 8 (inode) + 8 (lowercase name offset)
+ *                  = 60 bytes + path bytes + name bytes + 1
+ *
+ * Teaching Point: Name search is case-insensitive. Lowercasing every name
+ * on every query costs a pass over all names plus an allocation each;
+ * lowercasing once at scan time into one contiguous buffer lets a SIMD
+ * kernel sweep all names in a single call (see SubstringSearch).
+ *
+ * Teaching Point: (device, inode, size, mtime) identifies file CONTENT
+ * across scans and renames - the key of the persistent HashCache. The
+ * device is per directory, not per file: all files listed from one
+ * directory live on that directory's device.
+ *
+ * Teaching Point: Array-of-Structures (vector<FileInfo>) keeps all fields of
+ * one file together. Structure-of-Arrays keeps one field of ALL files
+ * together. When a loop only needs sizes (duplicate detection) it then
+ * touches only the sizes column - far fewer cache misses.
+ *
+ * ACCESS: Index-based. Files are numbered 0..size()-1:
+ *
+ *   for (FileCatalog::Index i = 0; i < catalog.size(); ++i) {
+ *       std::string_view name = catalog.name(i);   // no allocation
+ *   }
+ */
+class FileCatalog {
+public:
+    using Index = std::uint32_t;         // Up to 4 billion files
+    using ExtensionId = std::uint16_t;   // Up to 65536 distinct extensions
+
+    using DirectoryId = std::uint32_t;
+
+    static constexpr ExtensionId kNoExtension = 0;   // ID of "" (file without extension)
+    static constexpr DirectoryId kNoDirectory = 0xFFFFFFFFu;  // "no parent" / "not found"
+    static constexpr Index kNoFile = 0xFFFFFFFFu;               // "not found"
+
+    /**
+     * @brief Files directly inside one directory (not in its subdirectories)
+     */
+    struct DirectoryTotals {
+        std::uint64_t files = 0;
+        std::uint64_t bytes = 0;   // Sum of file sizes (apparent size, not blocks)
+    };
+
+private:
+    /**
+     * @brief Fixed-size per-file record (16 bytes)
+     *
+     * Teaching Point: Field order matters. Largest member first avoids
+     * padding bytes the compiler would otherwise insert.
+     */
+    struct Record {
+        std::uint64_t pathOffset;    // Start of the path inside pathArena
+        std::uint32_t pathLength;    // Length of the full path
+        std::uint16_t nameLength;    // Filename = last nameLength bytes of the path
+        ExtensionId extensionId;     // Index into extensionNames
+    };
+
+    /**
+     * @brief Fixed-size per-directory record (40 bytes)
+     */
+    struct DirectoryRecord {
+        std::uint64_t pathOffset;    // Directory path inside pathArena
+        std::uint32_t pathLength;
+        DirectoryId parent;          // kNoDirectory for the scan root
+        std::int64_t mtimeNs;        // Directory mtime when it was listed
+        std::uint64_t device;        // st_dev (0 = unknown)
+        std::uint32_t depth;         // 0 = scan root
+        std::uint32_t reserved;      // Keeps the record 8-byte aligned on disk
+    };
+
+    std::vector<Record> records;
+    std::vector<std::uint64_t> sizes;
+    mutable std::vector<std::uint64_t> hashes;   // Lazily filled cache (see setHash)
+    std::vector<DirectoryId> fileDirectories;    // Directory holding each file
+    std::vector<std::int64_t> mtimes;
+    std::vector<std::uint64_t> inodes;
+    std::vector<DirectoryRecord> directories;
+    std::vector<DirectoryTotals> ownTotals;      // Per directory, kept up to date by add/remove/update
+    std::string pathArena;                       // File AND directory paths
+    std::string lowerNames;                      // Lowercased names, each followed by '\0'
+    std::vector<std::uint64_t> lowerOffsets;     // Start of each file's name in lowerNames
+    bool lowerInOrder = true;                    // lowerOffsets increase with the index
+
+    /**
+     * Teaching Point: std::deque never moves existing elements when it grows,
+     * so string_views into extensionNames stay valid (std::vector would
+     * invalidate them on reallocation - especially for short SSO strings).
+     */
+    std::deque<std::string> extensionNames;
+    std::unordered_map<std::string_view, ExtensionId> extensionIds;
+
+    /**
+     * Path → index lookups, built on first use by findFile()/findDirectory()
+     * and then kept up to date by add/remove. Keyed by path hash (not by
+     * string_view) because arena growth would leave views dangling.
+     */
+    std::unordered_multimap<std::size_t, Index> fileLookup;
+    std::unordered_multimap<std::size_t, DirectoryId> directoryLookup;
+    bool lookupsValid = false;
+    std::uint64_t garbageBytes = 0;   // Arena bytes of removed files
+    std::uint64_t revisionStamp;      // See revision()
+
+public:
+    /**
+     * @brief Creates an empty catalog ("" is pre-interned as kNoExtension)
+     */
+    FileCatalog();
+
+    FileCatalog(const FileCatalog& other);
+    FileCatalog& operator=(const FileCatalog& other);
+    FileCatalog(FileCatalog&&) = default;
+    FileCatalog& operator=(FileCatalog&&) = default;
+
+    std::size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+    /**
+     * @brief Stamp that changes whenever files are added, removed or updated
+     *
+     * Stamps come from one process-wide counter, so two catalogs only share
+     * a stamp if one is a copy of the other. Derived structures (search
+     * indexes) remember the stamp they were built for and rebuild when it
+     * no longer matches.
+     */
+    std::uint64_t revision() const { return revisionStamp; }
+
+    /**
+     * @brief Removes all files (interned extensions are kept)
+     */
+    void clear();
+
+    /**
+     * @brief Pre-allocates storage
+     * @param fileCount Expected number of files
+     * @param pathBytes Expected total bytes of all paths
+     */
+    void reserve(std::size_t fileCount, std::size_t pathBytes);
+
+    /**
+     * @brief Registers a scanned directory
+     * @param path Directory path (no trailing separator)
+     * @param depth Depth below the scan root (root = 0)
+     * @param mtimeNs Directory modification time when it was listed
+     * @param device Device the directory lives on (0 = unknown)
+     * @return ID used when adding the directory's files
+     *
+     * Parents are connected later by linkDirectories(), because during a
+     * parallel scan a directory and its parent may land in different
+     * per-worker catalogs.
+     */
+    DirectoryId addDirectory(std::string_view path, std::uint32_t depth, std::int64_t mtimeNs,
+                             std::uint64_t device = 0);
+
+    /**
+     * @brief Appends one file
+     * @param directory Directory containing the file (from addDirectory)
+     * @param name Filename (with extension)
+     * @param extension Lowercased extension with dot, or "" for none
+     * @param size Size in bytes
+     * @param mtimeNs Modification time (0 = unknown)
+     * @param inode Inode number (0 = unknown)
+     * @return Index of the new file
+     *
+     * The path is written straight into the arena as directory + '/' + name,
+     * so callers never have to build an fs::path per file.
+     */
+    Index add(DirectoryId directory, std::string_view name,
+              std::string_view extension, std::uint64_t size,
+              std::int64_t mtimeNs = 0, std::uint64_t inode = 0);
+
+    /**
+     * @brief Copies one file (including hash, mtime, inode) from another catalog
+     * @param source Catalog to copy from
+     * @param index File inside source
+     * @param directory Directory in THIS catalog that receives the file
+     */
+    Index addFrom(const FileCatalog& source, Index index, DirectoryId directory);
+
+    /**
+     * @brief Sets every directory's parent by matching path prefixes
+     *
+     * Call once after all per-worker catalogs have been appended.
+     */
+    void linkDirectories();
+
+    // ----- In-place updates (used by watch mode) -----
+
+    /**
+     * @brief Finds a file by its full path
+     * @return Its index, or kNoFile
+     *
+     * The first call builds a hash lookup in O(n); later calls are O(1).
+     * Not thread-safe - callers hold the catalog exclusively.
+     */
+    Index findFile(std::string_view filePath);
+
+    /**
+     * @brief Finds a directory by its path
+     * @return Its ID, or kNoDirectory
+     */
+    DirectoryId findDirectory(std::string_view dirPath);
+
+    /**
+     * @brief Stores new metadata for a file and forgets its cached hash
+     */
+    void updateFile(Index i, std::uint64_t size, std::int64_t mtimeNs, std::uint64_t inode);
+
+    /**
+     * @brief Removes one file
+     *
+     * Teaching Point: SWAP-AND-POP - the last file moves into slot i, so
+     * removal is O(1) instead of shifting every later element. The price:
+     * the former last file now has index i.
+     */
+    void removeFile(Index i);
+
+    /**
+     * @brief Removes a directory, everything below it and all their files
+     * @param dirPath Directory path as stored in the catalog
+     * @return Number of files removed
+     *
+     * O(n): the catalog is rebuilt without the subtree (which also
+     * reclaims arena space left behind by removeFile()).
+     */
+    std::size_t removeSubtree(std::string_view dirPath);
+
+    /**
+     * @brief Rebuilds the arena if removed files left too much garbage in it
+     */
+    void compactIfWasteful();
+
+    /**
+     * @brief Moves all files of another catalog to the end of this one
+     * @param other Catalog to merge (left empty afterwards)
+     *
+     * Extension IDs of other are re-mapped to this catalog's IDs.
+     * Used to merge the per-worker catalogs of a parallel scan.
+     */
+    void append(FileCatalog&& other);
+
+    // ----- Per-file accessors (no allocation) -----
+
+    std::string_view path(Index i) const {
+        const Record& r = records[i];
+        return std::string_view(pathArena.data() + r.pathOffset, r.pathLength);
+    }
+
+    std::string_view name(Index i) const {
+        const Record& r = records[i];
+        return std::string_view(pathArena.data() + r.pathOffset + r.pathLength - r.nameLength,
+                                r.nameLength);
+    }
+
+    std::string_view extension(Index i) const {
+        return extensionNames[records[i].extensionId];
+    }
+
+    /**
+     * @brief Filename lowercased (ASCII), stored at scan time
+     */
+    std::string_view lowerName(Index i) const {
+        return std::string_view(lowerNames.data() + lowerOffsets[i], records[i].nameLength);
+    }
+
+    ExtensionId extensionId(Index i) const { return records[i].extensionId; }
+    std::uint64_t fileSize(Index i) const { return sizes[i]; }
+    std::uint64_t hash(Index i) const { return hashes[i]; }
+    std::int64_t fileMtime(Index i) const { return mtimes[i]; }
+    std::uint64_t fileInode(Index i) const { return inodes[i]; }
+    std::uint64_t fileDevice(Index i) const { return directories[fileDirectories[i]].device; }
+
+    /**
+     * @brief Stores a computed content hash
+     *
+     * Teaching Point: Why const + mutable?
+     * The hash is a CACHE of something derived from the file - storing it
+     * does not change which files the catalog describes. Different threads
+     * may fill different indices at the same time; the same index must not
+     * be written by two threads at once.
+     */
+    void setHash(Index i, std::uint64_t value) const { hashes[i] = value; }
+
+    DirectoryId directoryOf(Index i) const { return fileDirectories[i]; }
+
+    // ----- Lowercase name arena (for whole-catalog scans) -----
+
+    /**
+     * @brief Every lowercased name, each followed by '\0'
+     *
+     * May contain the names of removed files; use fileAtLowerOffset() to
+     * map a position back to a file.
+     */
+    std::string_view lowerNameArena() const { return lowerNames; }
+
+    /**
+     * @brief True while the arena holds the names in index order
+     *
+     * Adding and appending keep the order; removeFile() (swap-and-pop)
+     * breaks it until the next rebuild. Only an ordered arena can be
+     * scanned as one block.
+     */
+    bool lowerNamesInOrder() const { return lowerInOrder; }
+
+    /**
+     * @brief File whose lowercased name contains arena position `offset`
+     * @return Its index, or kNoFile (separator, or removed file's bytes)
+     *
+     * Binary search - requires lowerNamesInOrder().
+     */
+    Index fileAtLowerOffset(std::uint64_t offset) const;
+
+    // ----- Directory accessors -----
+
+    std::size_t directoryCount() const { return directories.size(); }
+
+    std::string_view directoryPath(DirectoryId d) const {
+        const DirectoryRecord& r = directories[d];
+        return std::string_view(pathArena.data() + r.pathOffset, r.pathLength);
+    }
+
+    DirectoryId directoryParent(DirectoryId d) const { return directories[d].parent; }
+    std::uint32_t directoryDepth(DirectoryId d) const { return directories[d].depth; }
+    std::int64_t directoryMtime(DirectoryId d) const { return directories[d].mtimeNs; }
+    std::uint64_t directoryDevice(DirectoryId d) const { return directories[d].device; }
+
+    /**
+     * @brief Count and bytes of the files directly inside d
+     *
+     * Teaching Point: Maintained by add()/removeFile()/updateFile(), so a
+     * parallel scan fills them as each worker adds its files - every worker
+     * sums only the directories it listed, and append() concatenates the
+     * sums with the other columns. DiskUsage rolls them up the tree.
+     */
+    const DirectoryTotals& directoryTotals(DirectoryId d) const { return ownTotals[d]; }
+
+    /**
+     * @brief Groups file indices by directory (Compressed Sparse Row layout)
+     * @param starts Receives directoryCount()+1 offsets into order
+     * @param order Receives file indices; files of directory d are
+     *              order[starts[d]] .. order[starts[d+1]-1]
+     *
+     * Teaching Point: COUNTING SORT - two passes over an integer column
+     * group n files in O(n), with no per-directory vectors.
+     */
+    void filesByDirectory(std::vector<Index>& starts, std::vector<Index>& order) const;
+
+    /**
+     * @brief Builds a full FileInfo for one file (allocates - use sparingly)
+     *
+     * For display code and APIs that still speak FileInfo.
+     */
+    FileInfo at(Index i) const;
+
+    // ----- Extension intern table -----
+
+    std::size_t extensionCount() const { return extensionNames.size(); }
+    std::string_view extensionName(ExtensionId id) const { return extensionNames[id]; }
+
+    /**
+     * @brief Looks up an extension without adding it
+     * @return Its ID, or -1 if no scanned file has that extension
+     */
+    int findExtension(std::string_view extension) const;
+
+    /**
+     * @brief Approximate heap bytes used (for diagnostics)
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    ExtensionId internExtension(std::string_view extension);
+    void rebuildExtensionIndex();
+    void appendLowerName(std::string_view name);
+    void rebuildLowerNames();   // From the path arena (after ScanIndex::load)
+    void rebuildDirectoryTotals();   // From sizes + fileDirectories (after ScanIndex::load)
+    void touch();   // New revision stamp
+
+    /**
+     * @brief Appends a copy of arena bytes [offset, offset+length) to the arena
+     *
+     * Teaching Point: ALIASING - appending part of a string to ITSELF is
+     * only safe if the buffer does not move mid-copy, so capacity is
+     * secured first and the source pointer taken afterwards.
+     */
+    void appendFromArena(std::uint64_t offset, std::uint32_t length);
+
+    void buildLookups();
+
+    /**
+     * @brief Replaces *this with a copy that keeps only some directories
+     * @param keep keep[d] == true → directory d and its files survive
+     */
+    void rebuildKeeping(const std::vector<bool>& keep);
+
+    friend class ScanIndex;   // Reads/writes the columns as raw blocks
+};
+
+#endif // FILECATALOG_H
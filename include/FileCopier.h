@@ -0,0 +1,132 @@
+#ifndef FILECOPIER_H
+#define FILECOPIER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief When copied data is forced to disk
+ *
+ * Teaching Point: The source is deleted right after the copy. Without a
+ * sync, a power cut shortly afterwards can leave the deletion on disk but
+ * the copy's data still only in RAM - the file is gone.
+ */
+enum class SyncPolicy {
+    None,       // Trust the page cache (fastest, not crash-safe)
+    Data,       // fdatasync() the copy before deleting the source
+    Full        // fsync() the copy and its directory entry (default)
+};
+
+/**
+ * @brief How the bytes were copied (fastest first)
+ */
+enum class CopyMethod {
+    Reflink,        // ioctl(FICLONE): shares extents, copies no data (Btrfs, XFS, ...)
+    KernelCopy,     // copy_file_range() / sendfile(): in-kernel, no userspace buffer
+    Buffered        // pread()/pwrite() through a large aligned buffer
+};
+
+struct CopyOptions {
+    SyncPolicy sync = SyncPolicy::Full;
+    bool verifyContent = false;            // Also compare XXHash64 of source and copy
+    std::size_t bufferSize = 1 << 20;      // Buffered fallback (page aligned)
+};
+
+/**
+ * @brief Outcome of one cross-device move
+ */
+struct CopyReport {
+    enum class Result { Moved, Exists, Failed };
+    Result result = Result::Failed;
+    CopyMethod method = CopyMethod::Buffered;
+    std::uint64_t bytes = 0;
+    std::string error;                     // Set when result == Failed
+};
+
+/**
+ * @brief ByteThrottle Class - Caps the Bytes Being Copied at Once
+ *
+ * Four parallel 8 GB copies to one USB disk are slower than one after
+ * another and fill the page cache with dirty pages. acquire() waits while
+ * the running copies already add up to the budget; a single file larger
+ * than the whole budget still runs - alone.
+ */
+class ByteThrottle {
+public:
+    explicit ByteThrottle(std::uint64_t budgetBytes) : budget(budgetBytes) {}
+
+    void acquire(std::uint64_t bytes);
+    void release(std::uint64_t bytes);
+
+private:
+    std::uint64_t budget;
+    std::uint64_t inFlight = 0;
+    std::mutex mutex;
+    std::condition_variable freed;
+};
+
+/**
+ * @brief FileCopier Class - Moves a File to Another Filesystem
+ *
+ * RESPONSIBILITY: What rename() cannot do across mounts (EXDEV):
+ * copy → verify → publish → delete the source, never losing the file
+ *
+ * ORDER OF ATTEMPTS:
+ * 1. FICLONE reflink - works across mounts of the same Btrfs/XFS volume
+ * 2. copy_file_range(), then sendfile() - the kernel moves the pages
+ * 3. Buffered copy with a 1 MB page-aligned buffer
+ *
+ * SAFETY:
+ * - Data goes to a hidden temporary name and appears under its real name
+ *   only through a no-replace rename - never half a file, never an overwrite
+ * - Mode, owner (if permitted), timestamps and extended attributes -
+ *   including POSIX ACLs - are copied; xattrs the destination cannot
+ *   store, or that need privileges we lack (security.*, trusted.*), are
+ *   dropped silently, like an owner we may not set
+ * - The source is deleted only after the copy is synced (SyncPolicy) and
+ *   verified (size, source unchanged during the copy, optionally hashes)
+ *
+ * Linux only; other platforms use std::filesystem in OrganizeEngine.
+ * THREAD SAFETY: const methods, any number of threads.
+ */
+class FileCopier {
+public:
+    explicit FileCopier(CopyOptions options = CopyOptions());
+
+    /**
+     * @brief Moves fromDir/fromName to toDir/toName across filesystems
+     * @param fromDir, toDir Directory file descriptors (O_PATH is enough)
+     * @return Moved, Exists (toName taken - nothing changed) or Failed
+     *         (source untouched, temporary copy removed)
+     */
+    CopyReport move(int fromDir, const char* fromName, int toDir, const char* toName) const;
+
+    /**
+     * @brief renameat2(RENAME_NOREPLACE), with a check-then-rename fallback
+     *        where the filesystem does not support the flag
+     * @return 0, or -1 with errno (EEXIST = name taken)
+     */
+    static int renameNoReplace(int fromDir, const char* fromName, int toDir, const char* toName);
+
+    /**
+     * @brief True for move()'s temporary names (".sfm-<pid>-<n>.partial")
+     */
+    static bool isTemporaryName(std::string_view name);
+
+    /**
+     * @brief Deletes temporaries a crashed move() left in directory
+     *
+     * A crash between creating and publishing the copy leaves the partial
+     * file behind. Temporaries of processes that are still running are kept.
+     * @return Number of files removed
+     */
+    static std::size_t removeStaleTemporaries(const std::string& directory);
+
+private:
+    CopyOptions options;
+};
+
+#endif // FILECOPIER_H
@@ -0,0 +1,130 @@
+#ifndef FILELISTING_H
+#define FILELISTING_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "FileCatalog.h"
+
+/**
+ * @brief Order of a listing
+ */
+enum class ListingSort : std::uint8_t {
+    Original,       // Catalog order, or the order the rows were given in (search ranking)
+    Name,           // Case-insensitive
+    Size,
+    Extension,      // Then name
+    Count
+};
+
+/**
+ * @brief FileListing Class - Paged, Sorted View of a Catalog
+ *
+ * RESPONSIBILITY: Show N files one page at a time, in any sort order,
+ * without copying or re-sorting the catalog
+ *
+ * Teaching Point: VIRTUAL LISTING
+ * A terminal shows ~20 lines; formatting a million rows to display 20 is
+ * all waste. renderPage() formats ONLY the rows of the requested page -
+ * page 1 and page 50 000 cost the same - into one std::string that the
+ * caller writes with a single call (no std::setw per field).
+ *
+ * Teaching Point: PERMUTATIONS, NOT SORTED COPIES
+ * A sort order is a vector of row indices (4 bytes per file), built on
+ * first use and kept until the catalog's revision changes:
+ *
+ *   order[Size]  = [7, 2, 9, ...]   rows by size
+ *   rank[Size]   = inverse: rank[row] = position in order[Size]
+ *
+ * - Listing the whole catalog reads order[key] directly; descending
+ *   reads it backwards. Switching keys or directions sorts nothing twice.
+ * - A subset (search results) is sorted by rank[key] - integer compares
+ *   instead of string compares, O(k log k) for k results.
+ *
+ * The catalog must stay unchanged while the listing is used (hold
+ * FileManager::lockCatalog()); a later call with a newer revision
+ * rebuilds the permutations.
+ */
+class FileListing {
+public:
+    static constexpr std::size_t kDefaultPageRows = 20;
+
+    /**
+     * @brief Lists every file of the catalog
+     */
+    void showAll(const FileCatalog& files);
+
+    /**
+     * @brief Lists some files (e.g. search results) in the given order
+     *
+     * Starts in ListingSort::Original - the order of a ranked search is
+     * part of the result. showAll() keeps the previous key instead.
+     */
+    void showRows(const FileCatalog& files, std::vector<FileCatalog::Index> rows);
+
+    /**
+     * @brief Changes the order (builds that key's permutation on first use)
+     */
+    void sortBy(ListingSort key, bool descending = false);
+
+    ListingSort sortKey() const { return key; }
+    bool isDescending() const { return descending; }
+    static const char* sortName(ListingSort key);
+
+    std::size_t size() const { return allRows ? catalogRows() : rows.size(); }
+    std::size_t pageCount(std::size_t pageRows = kDefaultPageRows) const;
+
+    /**
+     * @brief Catalog index of the file at a position of the current order
+     */
+    FileCatalog::Index row(std::size_t position) const;
+
+    /**
+     * @brief Appends the column header and the rows of one page
+     * @param out Buffer to append to (write it in one call)
+     * @param page 0-based; clamped to the last page
+     */
+    void renderPage(std::string& out, std::size_t page, std::size_t pageRows = kDefaultPageRows) const;
+
+    /**
+     * @brief Appends rows [first, first + count) without a header
+     */
+    void renderRows(std::string& out, std::size_t first, std::size_t count) const;
+
+    /**
+     * @brief Column header line and separator
+     */
+    static void appendHeader(std::string& out);
+
+    /**
+     * @brief One formatted row: number, name, size, extension
+     */
+    static void appendRow(std::string& out, const FileCatalog& files, FileCatalog::Index i,
+                          std::size_t number);
+
+private:
+    static constexpr std::size_t kKeys = static_cast<std::size_t>(ListingSort::Count);
+
+    const FileCatalog* files = nullptr;
+    bool allRows = true;
+    std::vector<FileCatalog::Index> given;      // showRows(): original order
+    std::vector<FileCatalog::Index> rows;       // showRows(): arranged by key (ascending)
+    ListingSort key = ListingSort::Original;
+    bool descending = false;
+
+    // Permutations of the whole catalog, valid for one revision
+    std::uint64_t revision = 0;
+    std::size_t builtRows = 0;
+    std::array<std::vector<FileCatalog::Index>, kKeys> orders;
+    std::array<std::vector<std::uint32_t>, kKeys> ranks;
+
+    std::size_t catalogRows() const { return files == nullptr ? 0 : files->size(); }
+    void invalidateIfStale();
+    const std::vector<FileCatalog::Index>& order(ListingSort sortKey);
+    const std::vector<std::uint32_t>& rank(ListingSort sortKey);
+    void arrangeRows();
+};
+
+#endif // FILELISTING_H
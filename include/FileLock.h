@@ -0,0 +1,52 @@
+#ifndef FILELOCK_H
+#define FILELOCK_H
+
+#include <string>
+
+/**
+ * @brief FileLock Class - Advisory Lock Shared Between Processes (RAII)
+ *
+ * RESPONSIBILITY: Serialise the processes (menu, batch runs, daemon) that
+ * read and write the same cache file in .sfm_cache
+ *
+ * The lock lives on a separate "<file>.lock", never on the file itself:
+ * a rewrite replaces the file by rename(), and a lock held on the old
+ * inode would not stop anyone who opens the new one.
+ *
+ * Teaching Point: flock() locks belong to the open file description, so
+ * they are released when the descriptor closes - also when the process
+ * dies. A crashed writer never leaves the cache locked.
+ *
+ * POSIX only; elsewhere the lock is a no-op (held() is still true).
+ */
+class FileLock {
+public:
+    enum class Mode { Shared, Exclusive };
+
+    /**
+     * @brief Blocks until the lock is held (creates the lock file if needed)
+     * @param lockPath Lock file - its directory must exist
+     */
+    FileLock(const std::string& lockPath, Mode mode);
+
+    ~FileLock();
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    /**
+     * @brief False if the lock file could not be opened or locked
+     */
+    bool held() const { return locked; }
+
+    /**
+     * @brief "<path>.tmp.<pid>" - a temporary no other process writes to
+     */
+    static std::string temporaryPath(const std::string& path);
+
+private:
+    int fd = -1;
+    bool locked = false;
+};
+
+#endif // FILELOCK_H
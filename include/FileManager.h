@@ -4,10 +4,80 @@
 #include <vector>
 #include <filesystem>
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include "FileInfo.h"
+#include "FileCatalog.h"
+#include "DiskUsage.h"
+#include "ScanBackend.h"
+#include "WatchBackend.h"
+#include "DeviceScheduler.h"
 
 namespace fs = std::filesystem;
 
+/**
+ * @brief What to do with symbolic links met during a scan
+ *
+ * Teaching Point: enum class (C++11) is "scoped" - values must be written
+ * as SymlinkPolicy::Skip, and they never convert silently to int.
+ */
+enum class SymlinkPolicy {
+    Skip,           // Ignore every symlink
+    FollowFiles,    // Include symlinks to regular files, never enter linked directories
+    FollowAll       // Include linked files AND descend into linked directories (loop-safe)
+};
+
+/**
+ * @brief Scan configuration
+ *
+ * Teaching Point: Grouping related parameters in a struct keeps method
+ * signatures short and lets new options be added without breaking callers.
+ * Default member initializers (C++11) give every field a sensible value.
+ */
+struct ScanOptions {
+    bool recursive = false;                              // Descend into subdirectories
+    int maxDepth = -1;                                   // -1 = unlimited, 0 = target directory only
+    SymlinkPolicy symlinks = SymlinkPolicy::FollowFiles; // Matches the original non-recursive behaviour
+    std::size_t threadCount = 0;                         // 0 = one worker per hardware thread
+    DeviceLimits devices;                                // Listings at once per device class (not stored in the index)
+};
+
+/**
+ * @brief Settings of a streaming scan (see FileManager::streamScan)
+ */
+struct StreamOptions {
+    std::size_t batchSize = 4096;        // Files (+ directories) per delivered batch
+    std::size_t maxQueuedBatches = 4;    // Batches waiting for the consumer before workers pause
+};
+
+/**
+ * @brief Receives one batch of a streaming scan
+ * @return false to stop the scan early
+ * 
+ * Teaching Point: The batch is a small FileCatalog, so everything that
+ * works on a catalog (searchByName, organizeByExtension, ...) works on a
+ * batch unchanged. It is only valid during the call.
+ */
+using ScanBatchVisitor = std::function<bool(const FileCatalog& batch)>;
+
+/**
+ * @brief Counters of watch mode (see FileManager::startWatching)
+ */
+struct WatchStats {
+    std::uint64_t batches = 0;            // Coalesced batches applied
+    std::uint64_t events = 0;             // Raw events received
+    std::uint64_t filesAdded = 0;
+    std::uint64_t filesRemoved = 0;
+    std::uint64_t filesUpdated = 0;       // Size re-read after a write
+    std::uint64_t directoriesAdded = 0;   // New subtrees scanned
+    std::uint64_t directoriesRemoved = 0; // Subtrees dropped
+    std::uint64_t resyncs = 0;            // Event queue overflows → incremental rescan
+};
+
 /**
  * @brief FileManager Class - Core File Operations Engine
  * 
@@ -26,8 +96,118 @@ namespace fs = std::filesystem;
  */
 class FileManager {
 private:
-    std::vector<FileInfo> files;     // Container storing all scanned files
-    std::string targetDirectory;     // Directory being managed
+    FileCatalog files;               // Compact storage of all scanned files
+    DiskUsage usage;                 // Recursive directory totals of `files`
+    std::string targetDirectory;     // Directory being managed (the first root)
+    std::vector<std::string> roots;  // Every scanned root, normalised (roots[0] = targetDirectory)
+    ScanOptions scanOptions;         // Options used by scanDirectory()
+    std::shared_ptr<ScanBackend> scanBackend;  // Strategy that lists directories
+    ScanStats lastScanStats;         // Counters from the most recent scan
+    ScanOptions catalogOptions;      // Options that produced `files`
+    std::string catalogBackend;      // Backend that produced `files` (mtime clock)
+    std::string indexPath;           // On-disk scan index for this set of roots
+    
+    // Watch mode: a background thread applies change events to `files`
+    mutable std::shared_mutex catalogMutex;      // Readers shared, updates exclusive
+    std::unique_ptr<WatchBackend> watchBackend;
+    std::thread watchThread;
+    std::atomic<bool> watchStopRequested{false};
+    std::atomic<bool> watching{false};
+    std::chrono::milliseconds watchBatchWindow{200};
+    WatchStats watchStats;                       // Guarded by catalogMutex
+    
+    /**
+     * @brief Shared state of one parallel scan (defined in FileManager.cpp)
+     */
+    struct ScanContext;
+    
+    /**
+     * @brief Lists one directory; subdirectories become new pool tasks
+     * @param ctx Shared scan state
+     * @param dirPath Directory to list
+     * @param depth Depth of dirPath below the target directory (root = 0)
+     */
+    void scanDirectoryTask(ScanContext& ctx, const fs::path& dirPath, int depth) const;
+    
+    /**
+     * @brief Incremental rescan of one directory known from the previous catalog
+     * @param ctx Shared scan state (ctx.previous is set)
+     * @param dir Directory ID inside the previous catalog
+     * 
+     * Unchanged mtime → its files are copied from the previous catalog;
+     * changed mtime → it is listed again; gone → it is dropped.
+     */
+    void rescanDirectoryTask(ScanContext& ctx, FileCatalog::DirectoryId dir) const;
+    
+    /**
+     * @brief Shared driver of full and incremental scans
+     * @param options Scan configuration
+     * @param previous Catalog of the last scan, or nullptr for a full scan
+     * @return Number of files found
+     */
+    int runScan(const ScanOptions& options, const FileCatalog* previous);
+    
+    /**
+     * @brief Scans new subtrees and appends them to `files` (exclusive lock held)
+     * @param subtrees Directory paths with their depth below their root
+     * @param error Receives the failure of a depth-0 subtree (a root), if any
+     * @return Number of files added
+     * 
+     * Used by addRoot() and by watch mode for new directories: only the
+     * new subtrees are listed, the rest of the catalog is left alone.
+     */
+    std::size_t appendSubtrees(const ScanOptions& options,
+                               const std::vector<std::pair<std::string, int>>& subtrees,
+                               std::string* error = nullptr);
+    
+    /**
+     * @brief Body of rescanIncremental(); caller holds catalogMutex exclusively
+     */
+    int incrementalScan();
+    
+    /**
+     * @brief Directory without trailing separators ("/" stays "/")
+     * 
+     * Keeps stored directory paths identical between runs no matter
+     * whether the user typed "dir" or "dir/".
+     */
+    static std::string normaliseRoot(std::string directory);
+    
+    /**
+     * @brief The roots as one string, one per line (the index's root path)
+     */
+    std::string rootKey() const;
+    
+    /**
+     * @brief Points indexPath at the index of the current set of roots
+     */
+    void selectIndex();
+    
+    /**
+     * @brief Watcher thread body: wait, collect a batch, apply it
+     */
+    void watchLoop();
+    
+    /**
+     * @brief Applies one coalesced batch of events (takes the exclusive lock)
+     */
+    void applyWatchBatch(const std::vector<WatchEvent>& events);
+    
+    /**
+     * @brief Adds a watch for directories [first, directoryCount()) of `files`
+     */
+    void watchDirectories(FileCatalog::DirectoryId first);
+    
+    /**
+     * @brief Restores `files` from the on-disk index, if one matches
+     * @return true if a catalog was loaded
+     */
+    bool loadIndex();
+    
+    /**
+     * @brief Writes `files` to the on-disk index
+     */
+    void saveIndex() const;
     
     /**
      * @brief Helper method to extract file extension
@@ -50,23 +230,187 @@ public:
     explicit FileManager(const std::string& dirPath);
     
     /**
-     * @brief Scans directory and populates files vector
+     * @brief Manages several roots as one catalog (e.g. one per mount)
+     * @param rootPaths Directories to scan; the first is the primary one
+     *        (getDirectory(), organize target)
+     * 
+     * Nested or duplicate roots are dropped with a warning - a directory
+     * must belong to exactly one root. A root that does not exist (yet)
+     * is kept with a warning and scanned once it is back; the saved index
+     * is only loaded if at least one root exists.
+     */
+    explicit FileManager(const std::vector<std::string>& rootPaths);
+    
+    /**
+     * @brief Stops watch mode (if running) and saves the index
+     */
+    ~FileManager();
+    
+    // Owns a thread and a mutex - neither copyable nor movable
+    FileManager(const FileManager&) = delete;
+    FileManager& operator=(const FileManager&) = delete;
+    
+    /**
+     * @brief Scans every root with the current options (setScanOptions)
+     * @return Number of files found; 0 if no root could be listed
+     *         (reasons are logged, nothing is thrown)
+     * 
+     * Same as scanDirectory(getScanOptions()) - see there for the algorithm.
+     */
+    int scanDirectory();
+    
+    /**
+     * @brief Scans with explicit options (recursive, depth limit, symlinks)
+     * @param options Scan configuration
      * @return Number of files found
-     * @throws std::filesystem_error if directory doesn't exist or no permissions
      * 
-     * Teaching Point: This method demonstrates:
-     * - Exception handling (try-catch blocks)
-     * - STL algorithms (vector operations)
-     * - C++17 directory iteration
+     * ALGORITHM (parallel tree walk):
+     * 1. Submit every root as a first task of a ThreadPool
+     * 2. Each task lists ONE directory:
+     *    - regular files go into the calling worker's private FileCatalog
+     *    - subdirectories (within maxDepth) are submitted as new tasks
+     * 3. Idle workers steal pending directories from busy ones
+     * 4. After the pool drains, per-worker catalogs are appended to files
+     * 
+     * Every task goes through a DeviceScheduler: directories are grouped
+     * by st_dev, and options.devices caps how many of one device are
+     * listed at once (NFS, HDD) - the other workers keep scanning the
+     * remaining devices instead of queueing behind a slow one.
+     * 
+     * Teaching Point: No lock is taken per file - each worker owns its
+     * bucket, and buckets are merged once at the very end.
+     */
+    int scanDirectory(const ScanOptions& options);
+    
+    /**
+     * @brief Scans without keeping results: files are handed over in batches
+     * @param options Scan configuration
+     * @param visitor Called on THIS thread for every batch, in no particular order
+     * @param stream Batch size and queue depth
+     * @return Number of files delivered
+     * 
+     * ALGORITHM (producer/consumer):
+     * 1. Pool workers list directories exactly as in scanDirectory()
+     * 2. When a worker's bucket reaches batchSize it is pushed into a
+     *    BoundedQueue and the worker starts a new, empty bucket
+     * 3. The calling thread pops batches and runs the visitor
+     * 4. When maxQueuedBatches are waiting, pushing workers block until
+     *    the visitor catches up (backpressure)
+     * 
+     * MEMORY: about batchSize × (maxQueuedBatches + threads + 1) files,
+     * no matter how large the tree. getFiles() is not touched.
+     * 
+     * Example - search a huge archive without building a catalog:
+     * 
+     *   fm.streamScan(options, [&](const FileCatalog& batch) {
+     *       for (FileCatalog::Index i : searcher.searchByNameLinear(batch, "invoice")) {
+     *           results.push_back(batch.at(i));   // batch is gone after return
+     *       }
+     *       return true;
+     *   });
+     */
+    std::size_t streamScan(const ScanOptions& options, const ScanBatchVisitor& visitor,
+                           const StreamOptions& stream = StreamOptions()) const;
+    
+    /**
+     * @brief Re-lists only the directories that changed since the last scan
+     * @return Number of files found
      * 
      * ALGORITHM:
-     * 1. Clear existing files vector
-     * 2. Iterate through directory entries
-     * 3. Filter regular files (ignore directories/symlinks)
-     * 4. Extract metadata for each file
-     * 5. Store in files vector
+     * 1. Every directory of the current catalog becomes a pool task
+     * 2. Each task reads only that directory's mtime (one stat)
+     * 3. Same mtime → reuse the directory's files (and cached hashes)
+     *    Changed  → list it again; NEW subdirectories are scanned in full
+     *    Missing  → drop it
+     * 
+     * Teaching Point: Adding, removing or renaming an entry always updates
+     * the mtime of the directory holding it - so an unchanged mtime means
+     * an unchanged listing. Editing a file's CONTENT does not touch its
+     * directory, so a file whose size changed in place is only noticed by
+     * a full scan.
+     * 
+     * Falls back to a full scan when there is no previous catalog or it
+     * was built with different options or another backend.
      */
-    int scanDirectory();
+    int rescanIncremental();
+    
+    /**
+     * @brief Options used by the no-argument scanDirectory()
+     */
+    void setScanOptions(const ScanOptions& options) { scanOptions = options; }
+    const ScanOptions& getScanOptions() const { return scanOptions; }
+    
+    /**
+     * @brief Replaces the directory listing strategy
+     * @param backend New backend (nullptr restores the platform default)
+     * 
+     * Teaching Point: Strategy pattern - the scan algorithm stays the same,
+     * only the way entries are read from the OS changes.
+     */
+    void setScanBackend(std::shared_ptr<ScanBackend> backend);
+    const ScanBackend& getScanBackend() const { return *scanBackend; }
+    
+    /**
+     * @brief Counters of the most recent scan (directories, syscalls, ...)
+     */
+    const ScanStats& getLastScanStats() const { return lastScanStats; }
+    
+    /**
+     * @brief Keeps the catalog current from filesystem change events
+     * @param batchWindow How long to keep collecting after the first event
+     * @return false if unsupported on this platform or the watch could not start
+     * 
+     * ALGORITHM:
+     * 1. Watch every directory of the catalog (scan first if there is none)
+     * 2. Incremental rescan to catch changes made while we were not watching
+     * 3. Background thread: wait for an event, then collect events for
+     *    batchWindow so a burst (unzip, git checkout) becomes ONE update
+     * 4. Per batch, each distinct path is looked at once with a fresh stat:
+     *    - regular file → add it or refresh its size
+     *    - gone / no longer a file → remove it
+     *    - new directory → scan its subtree and watch it
+     *    - removed or renamed directory → drop its subtree
+     * 5. Queue overflow (events lost) → incremental rescan
+     * 
+     * Teaching Point: Directory mtimes in the catalog are NOT advanced by
+     * watch updates - the next quick rescan after a restart re-lists the
+     * directories that changed, which is extra work but never wrong.
+     * 
+     * While watching, hold lockCatalog() around every use of getFiles().
+     */
+    bool startWatching(std::chrono::milliseconds batchWindow = std::chrono::milliseconds(200));
+    
+    /**
+     * @brief Stops the watcher thread and saves the updated catalog
+     */
+    void stopWatching();
+    
+    bool isWatching() const { return watching.load(); }
+    
+    /**
+     * @brief Copy of the watch counters
+     */
+    WatchStats getWatchStats() const;
+    
+    /**
+     * @brief Shared (read) lock on the catalog
+     * @return Lock that is released when it goes out of scope
+     * 
+     * Teaching Point: READERS-WRITER LOCK
+     * Any number of searches can read the catalog at once; the watcher
+     * thread waits until they are done before it applies a batch.
+     * 
+     *   auto lock = fileManager->lockCatalog();
+     *   const auto& files = fileManager->getFiles();
+     */
+    std::shared_lock<std::shared_mutex> lockCatalog() const {
+        return std::shared_lock<std::shared_mutex>(catalogMutex);
+    }
+    
+    /**
+     * @brief Location of the persistent scan index for this directory
+     */
+    const std::string& getIndexPath() const { return indexPath; }
     
     /**
      * @brief Extracts metadata from a single file
@@ -82,13 +426,22 @@ public:
     
     /**
      * @brief Getter for files collection
-     * @return Const reference to files vector
+     * @return Const reference to the catalog
      * 
-     * Teaching Point: Returning const& prevents copying the entire vector
+     * Teaching Point: Returning const& prevents copying the entire catalog
      * (efficiency) while preventing external modification (safety).
      * This is a best practice for getter methods.
      */
-    const std::vector<FileInfo>& getFiles() const { return files; }
+    const FileCatalog& getFiles() const { return files; }
+    
+    /**
+     * @brief Recursive size and file count of every catalog directory
+     * 
+     * Rebuilt after every scan and kept current by watch mode - reading it
+     * costs no filesystem access. Index it with the catalog's directory
+     * IDs; while watching, hold lockCatalog() for both.
+     */
+    const DiskUsage& getDiskUsage() const { return usage; }
     
     /**
      * @brief Getter for target directory
@@ -96,13 +449,52 @@ public:
      */
     const std::string& getDirectory() const { return targetDirectory; }
     
+    /**
+     * @brief Every root of the catalog (normalised), the primary one first
+     */
+    const std::vector<std::string>& getRoots() const { return roots; }
+    
+    /**
+     * @brief Adds a root and scans ONLY that root into the catalog
+     * @param dirPath Directory to add
+     * @param error Receives the reason on failure
+     * @return false if it is not a directory, overlaps a root, or cannot be listed
+     * 
+     * ALGORITHM:
+     * 1. Validate: a directory, not inside / around an existing root
+     * 2. Nothing scanned yet → just remember it for the next scan
+     * 3. Otherwise list its subtree with the catalog's options (one
+     *    ThreadPool, per-device limits) and append it; watch it if watching
+     * 
+     * Teaching Point: The other roots are neither listed nor stat'ed -
+     * adding a USB disk next to a 10M-file NFS share costs the USB disk.
+     */
+    bool addRoot(const std::string& dirPath, std::string* error = nullptr);
+    
+    /**
+     * @brief Drops a root and its files; nothing else is rescanned
+     * @return false if it is not a root, or the last one
+     */
+    bool removeRoot(const std::string& dirPath, std::string* error = nullptr);
+    
     /**
      * @brief Checks if target directory exists
      * @return true if directory exists and is accessible
      * 
+     * Only the primary root is checked; an unreachable extra root is
+     * reported by the scan and skipped.
+     * 
      * Teaching Point: Defensive programming - always validate before operations.
      */
     bool directoryExists() const;
+    
+    /**
+     * @brief True if at least one root is an existing directory
+     * 
+     * The guard of every scan: with one root gone the others are still
+     * scanned, and only "all roots failed" empties the catalog.
+     */
+    bool anyRootExists() const;
 };
 
 #endif // FILEMANAGER_H
@@ -0,0 +1,145 @@
+#ifndef FILEQUERY_H
+#define FILEQUERY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <regex>
+#include <unordered_map>
+#include <cstdint>
+#include "FileCatalog.h"
+
+class TrigramIndex;
+
+/**
+ * @brief One condition of a query (all conditions must hold)
+ */
+struct QueryPredicate {
+    enum class Kind {
+        NameContains,   // name:raw   or just   raw
+        NameGlob,       // glob:*.tar.gz
+        NameRegex,      // regex:^img_[0-9]+
+        Extension,      // ext:mkv,mp4
+        Size,           // size>1G   size:10M..2G
+        Mtime           // mtime>=2024-01-01   mtime:2024-01-01..2024-03-31
+    };
+
+    Kind kind = Kind::NameContains;
+    std::string text;                        // Lowercased term / pattern
+    std::shared_ptr<const std::regex> regex; // NameRegex only
+    std::vector<std::string> extensions;     // Extension only (".mkv", "" = none)
+    std::int64_t min = 0;                    // Size / Mtime: inclusive bounds
+    std::int64_t max = 0;
+};
+
+/**
+ * @brief FileQuery Class - A Parsed Attribute Query
+ *
+ * LANGUAGE: whitespace-separated conditions, all of which must match
+ *
+ *   raw  name:raw         name contains "raw" (case-insensitive)
+ *   glob:img_*.jp?g       whole name matches the glob (* ? [a-z] [!x])
+ *   regex:^dsc[0-9]{4}    name matches the regular expression (ECMAScript)
+ *   ext:mkv,mp4           extension is one of these (ext:none = no extension)
+ *   size>1G  size<=500K   size:10M..2G     units B K M G T (powers of 1024)
+ *   mtime>=2024-01-01     mtime<2024-06-01  mtime:2024-01-01..2024-01-31
+ *                         dates are whole UTC days; ranges include both ends
+ *
+ * Double quotes keep spaces:  name:"holiday video"
+ *
+ * Example: "size>1G ext:mkv raw" - files over 1 GB with extension .mkv
+ * whose name contains "raw".
+ */
+class FileQuery {
+public:
+    /**
+     * @brief Parses a query string
+     * @param text Query in the language above
+     * @param query Receives the parsed query
+     * @param error Receives a message if parsing fails
+     * @return false on a syntax error (query left unchanged)
+     */
+    static bool parse(const std::string& text, FileQuery& query, std::string& error);
+
+    const std::vector<QueryPredicate>& predicates() const { return conditions; }
+    bool empty() const { return conditions.empty(); }
+
+private:
+    std::vector<QueryPredicate> conditions;
+};
+
+/**
+ * @brief What one query run did (how much the planner avoided)
+ */
+struct QueryStats {
+    std::size_t rows = 0;            // Files in the catalog
+    std::size_t candidates = 0;      // Rows produced by the driving index
+    std::size_t stringChecks = 0;    // Rows whose name was examined
+    std::size_t results = 0;
+    std::string plan;                // Order in which conditions ran
+};
+
+/**
+ * @brief QueryEngine Class - Index-Driven Query Evaluation
+ *
+ * RESPONSIBILITY: Run FileQuery objects against a catalog, touching as
+ * few rows (and as few strings) as possible
+ *
+ * INDEXES (built per catalog revision, on first use):
+ *   sizeOrder    row indices sorted by size   → range = 2 binary searches
+ *   mtimeOrder   row indices sorted by mtime  → same for time ranges
+ *   extension    one bitmap per extension ID (bit i = row i has it),
+ *                built when a query first asks for that extension
+ *   names        FileSearcher's TrigramIndex, if supplied
+ *
+ * PLANNER:
+ * 1. Every indexable condition reports an EXACT row count via its index
+ * 2. The smallest one DRIVES: its rows are the only candidates
+ * 3. Other index conditions filter next (fewest rows first - they
+ *    discard the most), reading one integer column or one bit per row
+ * 4. String conditions run last, cheapest first:
+ *    substring (SIMD) → glob → regex
+ *
+ * Teaching Point: "size>1G ext:mkv" on a home directory: maybe 40 files
+ * are over 1 GB. Those 40 rows are the candidates - the other millions
+ * are never looked at, and not a single name is read for them.
+ */
+class QueryEngine {
+public:
+    /**
+     * @brief Evaluates a query
+     * @param files Catalog to query
+     * @param query Parsed query
+     * @param names Optional trigram index of `files` (must be current)
+     * @param stats Optional: receives the plan and row counts
+     * @return Matching row indices in catalog order
+     *
+     * Not thread-safe (caches indexes) - FileSearcher serializes calls.
+     */
+    std::vector<FileCatalog::Index> run(const FileCatalog& files, const FileQuery& query,
+                                        const TrigramIndex* names = nullptr,
+                                        QueryStats* stats = nullptr);
+
+    /**
+     * @brief Builds the size/mtime orders for `files` now (run() does it on demand)
+     */
+    void prepare(const FileCatalog& files);
+
+private:
+    struct Bitmap {
+        std::vector<std::uint64_t> words;
+        bool test(FileCatalog::Index i) const { return (words[i >> 6] >> (i & 63)) & 1u; }
+    };
+
+    std::uint64_t revision = 0;
+    std::size_t rows = 0;
+    bool built = false;
+    std::vector<FileCatalog::Index> sizeOrder;
+    std::vector<FileCatalog::Index> mtimeOrder;
+    std::vector<std::size_t> extensionCounts;                           // Rows per extension ID
+    std::unordered_map<FileCatalog::ExtensionId, Bitmap> extensionBitmaps;
+
+    const Bitmap& extensionBitmap(const FileCatalog& files, FileCatalog::ExtensionId id);
+};
+
+#endif // FILEQUERY_H
@@ -3,20 +3,189 @@
 
 #include <vector>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include "FileInfo.h"
+#include "FileCatalog.h"
+#include "TrigramIndex.h"
+#include "FileQuery.h"
+#include "ContentChunker.h"
+#include "FileReader.h"
+
+class HashCache;
+class ChunkIndex;
+class ThreadPool;
+
+/**
+ * @brief Work done by one duplicate search
+ *
+ * Teaching Point: MEASURE THE FILTER
+ * The staged pipeline only pays off if most bytes are never read.
+ * bytesRead / totalBytes shows how well size and partial hashes filtered.
+ */
+struct DuplicateStats {
+    std::size_t files = 0;              // Files in the catalog
+    std::size_t sizeCandidates = 0;     // Files sharing their size with another file
+    std::size_t partialHashed = 0;      // Files whose head + tail were hashed
+    std::size_t fullHashed = 0;         // Files read completely
+    std::size_t unreadable = 0;         // Files that vanished or could not be read
+    std::size_t cacheHits = 0;          // Hashes taken from the HashCache instead of disk
+    std::uint64_t totalBytes = 0;       // Sum of all file sizes
+    std::uint64_t bytesRead = 0;        // Bytes actually read from disk
+    std::uint64_t mappedBytes = 0;      // ... of which were hashed straight from mmap
+    double seconds = 0.0;               // Time spent in stages 2-3 (bytesRead / seconds = MB/s)
+};
+
+/**
+ * @brief One set of files with identical content
+ * 
+ * The files themselves live in DuplicateResult::files[first, first + count).
+ */
+struct DuplicateGroup {
+    std::uint64_t size = 0;        // Bytes per file
+    std::uint64_t hash = 0;        // Full XXH64 content hash
+    std::size_t first = 0;         // Offset into DuplicateResult::files
+    std::size_t count = 0;         // Files in the group (always ≥ 2)
+    
+    /**
+     * @brief Bytes freed by keeping one copy and deleting the rest
+     */
+    std::uint64_t reclaimableBytes() const { return count < 2 ? 0 : size * (count - 1); }
+};
+
+/**
+ * @brief Duplicate groups as catalog indices, largest saving first
+ * 
+ * Teaching Point: INDICES, NOT COPIES
+ * A FileInfo copy costs a path, a name and an extension string per file.
+ * An index costs 4 bytes; name, size and path are read from the catalog
+ * when (and only if) they are displayed. All groups share ONE index
+ * array, so the whole result is two allocations.
+ * 
+ * The indices refer to the catalog passed to findDuplicates(): keep it
+ * unchanged (hold FileManager::lockCatalog()) while using the result.
+ */
+struct DuplicateResult {
+    std::vector<DuplicateGroup> groups;         // Sorted by reclaimableBytes(), descending
+    std::vector<FileCatalog::Index> files;      // Members of all groups, group after group
+    
+    bool empty() const { return groups.empty(); }
+    std::size_t size() const { return groups.size(); }
+    
+    /**
+     * @brief First member of a group (count members follow)
+     */
+    const FileCatalog::Index* members(const DuplicateGroup& group) const {
+        return files.data() + group.first;
+    }
+    
+    /**
+     * @brief Total bytes freed by reducing every group to one file
+     */
+    std::uint64_t reclaimableBytes() const {
+        std::uint64_t total = 0;
+        for (const DuplicateGroup& group : groups) {
+            total += group.reclaimableBytes();
+        }
+        return total;
+    }
+};
+
+/**
+ * @brief Tuning of a near-duplicate search
+ */
+struct NearDuplicateOptions {
+    std::uint64_t minSize = 1024 * 1024;   // Smaller files are skipped (findDuplicates covers them)
+    double minSimilarity = 0.5;            // Shared bytes / size of the smaller file, 0..1
+    ChunkerOptions chunking;               // Must match the ChunkIndex's to use it
+};
+
+/**
+ * @brief Work done by one near-duplicate search
+ */
+struct NearDuplicateStats {
+    std::size_t files = 0;              // Files in the catalog
+    std::size_t candidates = 0;         // Files of at least minSize
+    std::size_t chunked = 0;            // Files read and chunked
+    std::size_t cacheHits = 0;          // Chunk lists taken from the ChunkIndex
+    std::size_t unreadable = 0;         // Files that vanished or could not be read
+    std::uint64_t chunks = 0;           // Chunks over all candidates
+    std::uint64_t bytesRead = 0;
+    std::uint64_t mappedBytes = 0;      // ... of which were chunked straight from mmap
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Two files that share much of their content
+ */
+struct NearDuplicatePair {
+    FileCatalog::Index first = 0;       // Lower catalog index
+    FileCatalog::Index second = 0;
+    std::uint64_t sharedBytes = 0;      // Bytes of chunks found in both files
+    double similarity = 0.0;            // sharedBytes / size of the smaller file
+    bool identical = false;             // Same size and full hash (findDuplicates would group them)
+};
+
+/**
+ * @brief Near-duplicate pairs as catalog indices, most shared bytes first
+ *
+ * Like DuplicateResult, the indices refer to the catalog passed to
+ * findNearDuplicates() - keep it unchanged while using the result.
+ */
+struct NearDuplicateResult {
+    std::vector<NearDuplicatePair> pairs;
+    std::uint64_t candidateBytes = 0;       // Total size of the chunked files
+    std::uint64_t deduplicableBytes = 0;    // Bytes a chunk store would not need to keep twice
+    
+    bool empty() const { return pairs.empty(); }
+    std::size_t size() const { return pairs.size(); }
+};
+
+/**
+ * @brief One (file, term) hit of a batch name search
+ */
+struct NameMatch {
+    FileCatalog::Index file;     // File whose name contains the term
+    std::uint32_t term;          // Position of the term in the query list
+};
+
+/**
+ * @brief One ranked hit of a fuzzy name search
+ */
+struct FuzzyMatch {
+    FileCatalog::Index file;
+    std::uint32_t errors;        // Edits between the term and the closest part of the name
+};
+
+/**
+ * @brief Running state of duplicate detection over streamed batches
+ * 
+ * Teaching Point: Content hashing needs the complete set of files of a
+ * size, which a stream only has at the end. So batches are only filtered
+ * by SIZE: the first file of each size waits in `firstBySize`; once a
+ * second file of that size shows up, both move to `candidates`. After the
+ * stream, findDuplicates(collector.candidates) hashes just those.
+ */
+struct DuplicateCollector {
+    FileCatalog firstBySize;                                             // One file per size seen
+    std::unordered_map<std::uint64_t, FileCatalog::Index> indexBySize;   // size → file in firstBySize
+    FileCatalog candidates;                                              // Files whose size repeats
+};
 
 /**
  * @brief FileSearcher Class - Advanced Search & Duplicate Detection
  * 
  * RESPONSIBILITIES:
  * 1. Partial filename matching (case-insensitive fuzzy search)
- * 2. Duplicate file detection using multiple strategies
+ * 2. Content-based duplicate detection
+ * 3. Near-duplicate detection (files sharing most of their content)
  * 
  * ALGORITHMS IMPLEMENTED:
  * 1. Boyer-Moore-inspired substring search (for name matching)
- * 2. Hash-based duplicate detection (size + name hashing)
- * 3. Multi-criteria comparison (size, name, content hash)
+ * 2. Staged duplicate detection (size → partial hash → full XXH64)
+ * 3. Content-defined chunking (FastCDC) + shared-chunk counting
  * 
  * Teaching Point: This class showcases algorithm design and STL mastery.
  * Different problems require different algorithms - choosing wisely
@@ -36,19 +205,30 @@ private:
      */
     std::string toLowercase(const std::string& str) const;
     
+    std::shared_ptr<HashCache> hashCache;   // Optional (see setHashCache)
+    std::shared_ptr<ChunkIndex> chunkIndex; // Optional (see setChunkIndex)
+    ReaderOptions readerOptions;            // How duplicate searches read files
+    std::shared_ptr<ThreadPool> sharedPool; // Optional (see setThreadPool)
+    
     /**
-     * @brief Generates simple hash for duplicate detection
-     * @param file FileInfo object
-     * @return Hash string (combination of size and name)
-     * 
-     * Teaching Point: Simple hash = size + name
-     * For production: use MD5/SHA-256 with actual file content.
-     * Trade-off: speed vs accuracy
-     * 
-     * Simple hash: Fast, may have false positives (same size+name, different content)
-     * Content hash: Slower, no false positives
+     * @brief sharedPool, or a pool created in `own` for this one call
+     */
+    ThreadPool& workerPool(std::unique_ptr<ThreadPool>& own) const;
+    
+    /**
+     * Teaching Point: mutable for caches - building the name index does not
+     * change what searchByName() returns, so the method stays const. The
+     * mutex lets several readers search at once (shared catalog lock).
+     */
+    mutable TrigramIndex nameIndex;
+    mutable std::mutex nameIndexMutex;
+    mutable QueryEngine queryEngine;         // Size/mtime/extension indexes
+    mutable std::mutex queryMutex;
+    
+    /**
+     * @brief Rebuilds nameIndex if the catalog changed (nameIndexMutex held)
      */
-    std::string generateSimpleHash(const FileInfo& file) const;
+    void refreshNameIndex(const FileCatalog& files) const;
 
 public:
     /**
@@ -56,74 +236,239 @@ public:
      */
     FileSearcher() = default;
     
+    /**
+     * @brief Attaches a persistent hash cache used by findDuplicates()
+     * @param cache Cache to use (nullptr = always read files)
+     * 
+     * Teaching Point: Dependency injection - the searcher does not decide
+     * where the cache lives; main() (or a benchmark) hands one in.
+     */
+    void setHashCache(std::shared_ptr<HashCache> cache);
+    
+    /**
+     * @brief Attaches a persistent chunk index used by findNearDuplicates()
+     * @param index Index to use (nullptr = always chunk files)
+     */
+    void setChunkIndex(std::shared_ptr<ChunkIndex> index);
+    
+    /**
+     * @brief Options of the FileReader used by duplicate searches
+     * 
+     * The daemon, watch mode and batch mode clear mapFiles: a file
+     * truncated while it is mapped would raise SIGBUS (see FileReader).
+     */
+    void setReaderOptions(const ReaderOptions& options) { readerOptions = options; }
+    const ReaderOptions& getReaderOptions() const { return readerOptions; }
+    
+    /**
+     * @brief Runs the parallel searches on a long-lived pool
+     * @param pool Pool to share (nullptr = a new pool per call)
+     * 
+     * Several threads may search through the same pool at once: each
+     * call waits only for its own tasks (TaskGroup). Never call a search
+     * from a worker of that pool.
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> pool) { sharedPool = std::move(pool); }
+    
     /**
      * @brief Searches files by partial name match (case-insensitive)
-     * @param files Vector of all files
+     * @param files Catalog of all files
      * @param searchTerm Partial filename to search for
-     * @return Vector of matching files
+     * @return Indices of matching files, in catalog order
      * 
      * Teaching Point: This demonstrates:
-     * - STL algorithms (std::find_if with lambda)
-     * - String manipulation
-     * - Case-insensitive comparison
+     * - An inverted index (filter) followed by an exact check (verify)
+     * - Case-insensitive comparison against names lowercased at scan time
+     * - Returning indices instead of copies (files.at(i) if a FileInfo
+     *   is really needed)
      * 
      * ALGORITHM:
      * 1. Convert search term to lowercase
-     * 2. For each file:
-     *    a. Convert filename to lowercase
-     *    b. Check if search term is substring (str.find() != npos)
-     *    c. If match, add to results vector
-     * 3. Return results
+     * 2. Term of 3+ characters: ask the TrigramIndex for candidates (built
+     *    on the first query after each change of the catalog) and check
+     *    each candidate's lowercase name with SubstringSearch
+     * 3. Shorter term: searchByNameLinear()
      * 
-     * TIME COMPLEXITY: O(n * m) where n = number of files, m = string length
+     * TIME COMPLEXITY: O(candidates * m) with the index, O(n * m) without,
+     * where n = number of files, m = string length
      * 
      * Example:
      * Files: ["report.txt", "Report_2024.pdf", "summary.doc"]
      * Search: "report"
-     * Results: ["report.txt", "Report_2024.pdf"] (case-insensitive)
+     * Results: [0, 1] (case-insensitive)
      */
-    std::vector<FileInfo> searchByName(const std::vector<FileInfo>& files, 
-                                       const std::string& searchTerm) const;
+    std::vector<FileCatalog::Index> searchByName(const FileCatalog& files, 
+                                                 const std::string& searchTerm) const;
     
     /**
-     * @brief Finds duplicate files based on size and name
-     * @param files Vector of all files
-     * @return Map of hash to vector of duplicate files
+     * @brief Same result as searchByName(), without building an index
+     * @param files Catalog to search
+     * @param searchTerm Partial filename to search for
+     * @return Indices of matching files, in catalog order
      * 
-     * Teaching Point: This uses std::map to group duplicates.
-     * Key = hash (size + name)
-     * Value = vector of files with that hash
+     * One SIMD sweep over the catalog's lowercase name arena. Use it for
+     * catalogs searched only once - e.g. the batches of a streaming scan,
+     * where building a TrigramIndex would cost more than it saves.
+     */
+    std::vector<FileCatalog::Index> searchByNameLinear(const FileCatalog& files,
+                                                       const std::string& searchTerm) const;
+    
+    /**
+     * @brief Finds the names closest to a possibly mistyped term
+     * @param files Catalog to search
+     * @param searchTerm Term to look for (case-insensitive, ≤ 64 bytes used)
+     * @param limit Number of results to return
+     * @param maxErrors Edit budget (-1 = FuzzyMatcher::defaultMaxErrors)
+     * @return Best matches first: fewest errors, then shortest name,
+     *         then catalog order
      * 
-     * DATA STRUCTURE CHOICE:
-     * std::map<std::string, std::vector<FileInfo>>
+     * Teaching Point: TOP-K WITH A BOUNDED HEAP
+     * Sorting every scored name costs O(n log n) and memory for n entries.
+     * Each shard instead keeps a max-heap of its `limit` best so far: a new
+     * name either beats the worst kept (pop + push, O(log k)) or is dropped.
+     * Shards run in parallel on a ThreadPool; their heaps are merged at the end.
      * 
-     * WHY? We need to:
-     * 1. Group files by hash (key)
-     * 2. Store multiple files per hash (vector value)
-     * 3. Efficiently check if hash exists (map.find())
+     * Example:
+     * Files: ["annual_report.pdf", "rapport.doc", "notes.txt"]
+     * Search: "reprot" → [{0, 2}, {1, 2}]
+     */
+    std::vector<FuzzyMatch> searchByNameFuzzy(const FileCatalog& files,
+                                              const std::string& searchTerm,
+                                              std::size_t limit = 50,
+                                              int maxErrors = -1) const;
+    
+    /**
+     * @brief Searches for many terms at once (case-insensitive)
+     * @param files Catalog to search
+     * @param terms Partial filenames (hundreds are fine)
+     * @return Every (file, term) pair where the file's name contains the
+     *         term - sorted by file, then term, each pair once
+     * 
+     * Teaching Point: ONE PASS FOR ALL TERMS
+     * Calling searchByName() per term reads every name once PER TERM.
+     * An Aho-Corasick automaton over all terms reads every name ONCE and
+     * reports all terms it contains. The catalog is split into shards
+     * that are scanned in parallel on a ThreadPool.
+     * 
+     * Example:
+     * Files: ["ACME-1042 invoice.pdf", "notes.txt", "acme-7 report.doc"]
+     * Terms: ["acme-", "invoice", "report"]
+     * Result: {0, 0}, {0, 1}, {2, 0}, {2, 2}
+     */
+    std::vector<NameMatch> searchByNames(const FileCatalog& files,
+                                         const std::vector<std::string>& terms) const;
+    
+    /**
+     * @brief Finds files matching every condition of a query
+     * @param files Catalog to query
+     * @param query Parsed with FileQuery::parse(), e.g. "size>1G ext:mkv raw"
+     * @param stats Optional: receives the plan and how many rows it touched
+     * @return Indices of matching files, in catalog order
+     * 
+     * Teaching Point: The QueryEngine starts from the condition its
+     * indexes say is rarest (sorted size/mtime columns, extension bitmaps,
+     * the trigram index) and reads names only for the rows that survive.
+     */
+    std::vector<FileCatalog::Index> query(const FileCatalog& files, const FileQuery& query,
+                                          QueryStats* stats = nullptr) const;
+    
+    /**
+     * @brief Finds files with identical content
+     * @param files Catalog of all files (receives full hashes, see below)
+     * @param stats Optional: receives how much work each stage did
+     * @return Groups of catalog indices, largest reclaimable bytes first
+     * 
+     * Teaching Point: STAGED FILTERING - cheap tests first
+     * Two files can only be equal if every cheaper test already says so:
+     * 
+     *   Stage 1: SIZE          free (already in the catalog)
+     *   Stage 2: PARTIAL HASH  first + last 4 KB of each file
+     *   Stage 3: FULL HASH     whole file, XXH64
+     * 
+     * Each stage only sees files that still collide after the previous one,
+     * and singletons are dropped at every step. Stages 2 and 3 read files
+     * in parallel on a ThreadPool.
+     * 
+     * Every fully hashed file gets its hash stored with files.setHash(), so
+     * files.at(i).hash is filled for everything this returns. It writes the
+     * catalog's hash cache - callers must not run two searches at once on
+     * the same catalog.
+     * 
+     * TIME COMPLEXITY: O(n log n) to group + bytes read by stages 2-3
+     */
+    DuplicateResult findDuplicates(const FileCatalog& files,
+                                   DuplicateStats* stats = nullptr) const;
+    
+    /**
+     * @brief Adds one batch of a streaming scan to a duplicate search
+     * @param batch Files of this batch (see FileManager::streamScan)
+     * @param collector State carried from batch to batch
+     * 
+     * Filters by size only; call findDuplicates(collector.candidates)
+     * after the last batch to get the content-verified groups (their
+     * indices refer to collector.candidates).
+     */
+    void collectDuplicates(const FileCatalog& batch, DuplicateCollector& collector) const;
+    
+    /**
+     * @brief Finds files that share a large part of their content
+     * @param files Catalog of all files (receives full hashes of the files read)
+     * @param options Size threshold, similarity threshold, chunk sizes
+     * @param stats Optional: receives how much work was done
+     * @return Pairs above the similarity threshold, most shared bytes first
+     * 
+     * Teaching Point: EXACT HASHES MISS EDITED COPIES
+     * A re-exported video, a VM image after one boot, a log with a day
+     * appended: one changed byte gives a different full hash. Split into
+     * CONTENT-DEFINED chunks (ContentChunker), such copies still share
+     * most chunk fingerprints - and the count of shared chunk bytes says
+     * how similar they are.
      * 
      * ALGORITHM:
-     * 1. Create empty map
-     * 2. For each file:
-     *    a. Generate hash (size + name)
-     *    b. Add file to map[hash] vector
-     * 3. Filter map: only return entries with 2+ files (actual duplicates)
+     * 1. Candidates: files of at least options.minSize bytes
+     * 2. Chunk lists from the ChunkIndex when the file is unchanged,
+     *    otherwise read through FileReader (mmap for large files) and
+     *    chunked on a ThreadPool - the same pass also yields the partial
+     *    and full hashes, which go to the HashCache, so a later
+     *    findDuplicates() needs no reads for these files
+     * 3. One posting (fingerprint, file, count) per distinct chunk of a
+     *    file, sorted by fingerprint: equal chunks become adjacent runs
+     * 4. Every run adds its bytes to each pair of files in it (runs of
+     *    more than 64 files - zero pages, common headers - are skipped:
+     *    they say nothing about which files belong together)
      * 
-     * TIME COMPLEXITY: O(n log n) for map insertions
-     * SPACE COMPLEXITY: O(n) to store all files
+     * The deduplicable estimate counts every repeated chunk occurrence
+     * over all candidates - inside one file as well as across files.
+     * 
+     * TIME COMPLEXITY: bytes read + O(c log c) for c chunks
+     */
+    NearDuplicateResult findNearDuplicates(const FileCatalog& files,
+                                           const NearDuplicateOptions& options = NearDuplicateOptions(),
+                                           NearDuplicateStats* stats = nullptr) const;
+    
+    /**
+     * @brief Adds the large files of one streamed batch to a near-duplicate search
+     * @param batch Files of this batch (see FileManager::streamScan)
+     * @param options Files below options.minSize are left out
+     * @param candidates Receives copies of the files to chunk
      * 
-     * Example Output:
-     * {
-     *   "1024_file.txt" → [file1.txt, file_copy.txt],
-     *   "2048_image.jpg" → [pic1.jpg, pic2.jpg, pic3.jpg]
-     * }
+     * Call findNearDuplicates(candidates, options) after the last batch.
      */
-    std::map<std::string, std::vector<FileInfo>> findDuplicates(
-        const std::vector<FileInfo>& files) const;
+    void collectNearDuplicates(const FileCatalog& batch, const NearDuplicateOptions& options,
+                               FileCatalog& candidates) const;
+    
+    /**
+     * @brief Builds the name index and query indexes for `files` ahead of time
+     * 
+     * Searches build them on first use anyway; calling this when a catalog
+     * is published (see DaemonServer) moves that cost off the first query.
+     */
+    void prepareIndexes(const FileCatalog& files) const;
     
     /**
      * @brief Displays search results in formatted table
-     * @param results Vector of matching files
+     * @param files Catalog the indices refer to
+     * @param results Indices of matching files
      * 
      * Teaching Point: Separation of concerns - display logic separated
      * from search logic. This follows Single Responsibility Principle.
@@ -135,28 +480,36 @@ public:
      * | report.txt     | 1024 bytes  | .txt      | ...  |
      * +--------------------------------------------------+
      */
-    void displaySearchResults(const std::vector<FileInfo>& results) const;
+    void displaySearchResults(const FileCatalog& files,
+                              const std::vector<FileCatalog::Index>& results) const;
     
     /**
      * @brief Displays duplicate files in grouped format
-     * @param duplicates Map of duplicates
+     * @param files Catalog the result's indices refer to
+     * @param duplicates Result of findDuplicates(files)
      * 
-     * Teaching Point: Iterating through std::map
-     * - map.begin() to map.end()
-     * - Each element is std::pair<key, value>
-     * - Access: it->first (key), it->second (value)
+     * Teaching Point: The display reads names and paths straight from the
+     * catalog - nothing is copied to print it.
      * 
      * Format:
-     * Duplicate Group 1:
+     * Duplicate Group 1 (2 files, 1024 bytes reclaimable):
      *   - file1.txt (1024 bytes)
      *   - file_copy.txt (1024 bytes)
      * 
-     * Duplicate Group 2:
-     *   - image1.jpg (2048 bytes)
-     *   - image2.jpg (2048 bytes)
+     * Duplicate Group 2 (2 files, 512 bytes reclaimable):
+     *   - image1.jpg (512 bytes)
+     *   - image2.jpg (512 bytes)
+     */
+    void displayDuplicates(const FileCatalog& files, const DuplicateResult& duplicates) const;
+    
+    /**
+     * @brief Displays near-duplicate pairs with their similarity
+     * @param files Catalog the result's indices refer to
+     * @param nearDuplicates Result of findNearDuplicates(files)
+     * @param limit Pairs to show (the rest are counted)
      */
-    void displayDuplicates(
-        const std::map<std::string, std::vector<FileInfo>>& duplicates) const;
+    void displayNearDuplicates(const FileCatalog& files, const NearDuplicateResult& nearDuplicates,
+                               std::size_t limit = 20) const;
 };
 
 #endif // FILESEARCHER_H
@@ -2,9 +2,42 @@
 #define FILESORTER_H
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include "FileInfo.h"
+#include "FileCatalog.h"
+#include "OrganizeEngine.h"
+#include "OrganizeJournal.h"
+#include "ContentSniffer.h"
+
+/**
+ * @brief Category an extension belongs to
+ *
+ * The named values are built in. Categories added by a mapping file get
+ * the values after Others (FileSorter::categoryName() knows their names).
+ */
+enum class FileCategory : std::uint8_t {
+    Documents,
+    Images,
+    Videos,
+    Audio,
+    Archives,
+    Code,
+    Executables,
+    Others
+};
+
+/**
+ * @brief Which files the content sniffer looks at
+ */
+enum class SniffScope {
+    UnknownExtensions,   // Only files that would land in Others (cheap)
+    AllFiles             // Also catch mislabeled files (reads every header once)
+};
 
 /**
  * @brief FileSorter Class - Smart File Organization Engine
@@ -17,48 +50,43 @@
  * - Moves files to appropriate folders
  * - Logs all operations for audit trail
  * 
- * DATA STRUCTURE CHOICE: std::map
- * WHY? We need fast lookup: given extension → find category
- * std::map provides O(log n) lookup time with automatic sorting
+ * DATA STRUCTURE CHOICE: compile-time perfect hash
+ * The ~60 built-in extensions never change, so their table is computed
+ * by the COMPILER: each extension is packed into one 64-bit integer, and
+ * a multiplier is searched (constexpr) that sends every key to its own
+ * slot. A lookup is one multiply, one shift and one integer compare -
+ * no string comparison, no allocation.
  * 
  * Teaching Point: Choosing the right container is crucial for performance.
  * - std::vector: O(n) search, good for sequential access
  * - std::map: O(log n) search, good for key-based lookup
  * - std::unordered_map: O(1) average search, but no ordering
+ * - A perfect hash: O(1) WORST case - possible only when all keys are
+ *   known in advance
  */
 class FileSorter {
 private:
     /**
-     * @brief Extension-to-Category mapping
-     * 
-     * Teaching Point: std::map stores key-value pairs in sorted order.
-     * Key = extension (e.g., ".jpg")
-     * Value = category name (e.g., "Images")
+     * @brief Mappings merged from a mapping file (override the built-ins)
      * 
-     * Example structure:
-     * {
-     *   ".txt" → "Documents",
-     *   ".jpg" → "Images",
-     *   ".mp4" → "Videos"
-     * }
+     * Teaching Point: Extensions of up to 8 bytes are stored as the same
+     * packed integer the built-in table uses, so the override check is an
+     * integer hash lookup too. Longer ones go to a map with a transparent
+     * comparator (std::less<>), which can be searched with a string_view
+     * without building a std::string.
      */
-    std::map<std::string, std::string> extensionCategories;
+    std::unordered_map<std::uint64_t, FileCategory> packedOverrides;
+    std::map<std::string, FileCategory, std::less<>> longOverrides;
+    std::vector<std::string> customCategoryNames;   // Categories after Others
+    
+    std::shared_ptr<ContentSniffer> contentSniffer;  // Optional: classify by magic bytes
+    SniffScope sniffScope = SniffScope::UnknownExtensions;
     
     /**
-     * @brief Initializes the extension mapping
-     * 
-     * Teaching Point: Separation of concerns - initialization logic
-     * separate from constructor for clarity and maintainability.
-     * 
-     * Populates extensionCategories with predefined mappings:
-     * - Documents: .txt, .pdf, .doc, .docx, .xlsx, .ppt
-     * - Images: .jpg, .jpeg, .png, .gif, .bmp, .svg
-     * - Videos: .mp4, .avi, .mkv, .mov, .wmv
-     * - Audio: .mp3, .wav, .flac, .aac
-     * - Archives: .zip, .rar, .7z, .tar, .gz
-     * - Code: .cpp, .h, .py, .java, .js, .html, .css
+     * @brief Finds or creates a category by name
+     * @return false if the name is unusable (empty, path characters, too many)
      */
-    void initializeCategories();
+    bool resolveCategory(const std::string& name, FileCategory& category);
     
     /**
      * @brief Creates a directory if it doesn't exist
@@ -73,52 +101,116 @@ private:
 
 public:
     /**
-     * @brief Constructor - initializes category mappings
+     * @brief Constructor - the built-in table needs no setup
      * 
-     * Teaching Point: Constructor should set up invariants.
-     * Here, we ensure the extension map is ready before any operations.
+     * Teaching Point: Constructor should set up invariants. The built-in
+     * mapping is constexpr data - it exists before main() even starts.
      */
     FileSorter();
     
     /**
-     * @brief Organizes files into category-based subfolders
-     * @param files Vector of files to organize
+     * @brief Where main() looks for user mappings: "./.sfm_categories.conf"
+     */
+    static std::string defaultConfigPath();
+    
+    /**
+     * @brief Merges user mappings from a text file
+     * @param path File with lines like ".heic = Images" or "blend = 3D Models"
+     * @return false if the file is missing or unreadable
+     * 
+     * '#' starts a comment. A known category name (case-insensitive)
+     * reuses that category; any other name creates a new one (it becomes
+     * a folder name, so '/' and ".." are rejected). Later lines win.
+     * Bad lines are logged and skipped.
+     */
+    bool loadMappings(const std::string& path);
+    
+    /**
+     * @brief Lets planOrganize() look inside files the extension cannot place
+     * @param sniffer Content classifier (nullptr = extensions only)
+     * @param scope UnknownExtensions, or AllFiles to also fix mislabeled ones
+     * 
+     * A recognised content type decides the category; an unrecognised one
+     * keeps the extension's category.
+     */
+    void setContentSniffer(std::shared_ptr<ContentSniffer> sniffer,
+                           SniffScope scope = SniffScope::UnknownExtensions);
+    
+    /**
+     * @brief Built-in category of a sniffed content type (Others if Unknown)
+     */
+    static FileCategory categoryOfContent(ContentType type);
+    
+    /**
+     * @brief Decides where every file goes - without touching anything
+     * @param files Catalog of files to organize
      * @param baseDirectory Root directory for organization
-     * @return Number of files successfully moved
+     * @param policy Name already taken in the folder: skip or rename
+     * @return The complete plan (print it for a dry run)
      * 
-     * Teaching Point: This method demonstrates:
-     * - Iterating through STL containers
-     * - File system operations (create directories, move files)
-     * - Error handling (try-catch for each file)
-     * - Logging for audit trail
+     * Teaching Point: SEPARATE THE DECISION FROM THE ACTION
      * 
      * ALGORITHM:
-     * 1. For each file in vector:
-     *    a. Determine category from extension
-     *    b. Create category folder if needed
-     *    c. Construct destination path
-     *    d. Move file using std::filesystem::rename()
-     *    e. Log the operation
-     * 2. Return count of successful moves
+     * 1. Determine each file's category (once per distinct extension)
+     * 2. With a content sniffer: classify the files the extension cannot
+     *    place by their first bytes (parallel, cached across runs)
+     * 3. List each needed category folder ONCE to learn the names in it
+     * 4. Per file: already in its folder? → leave it. Name taken (on disk
+     *    or by an earlier file of this plan)? → skip or pick "name (2).ext"
      * 
-     * Teaching Point: Graceful degradation - if one file fails,
-     * continue with others rather than stopping entirely.
+     * Cost: one directory listing per category folder; header reads only
+     * for sniffed files not yet in the cache.
      */
-    int organizeByExtension(const std::vector<FileInfo>& files, 
-                           const std::string& baseDirectory);
+    OrganizePlan planOrganize(const FileCatalog& files, const std::string& baseDirectory,
+                              ConflictPolicy policy = ConflictPolicy::Skip) const;
     
     /**
-     * @brief Determines category for a given extension
-     * @param extension File extension (e.g., ".txt")
-     * @return Category name or "Others" if unknown
+     * @brief Creates the plan's folders, then applies it with a journal
+     * @return Engine counts (moves into a folder that cannot be created
+     *         count as failed)
+     * 
+     * Interrupted runs are finished or reverted with
+     * OrganizeJournal::resume() / undo() - no rescan needed.
+     */
+    OrganizeStats applyPlan(const OrganizePlan& plan);
+    
+    /**
+     * @brief Organizes files into category-based subfolders
+     * @param files Catalog of files to organize
+     * @param baseDirectory Root directory for organization
+     * @param stats Optional: receives moved / skipped / failed counts
+     * @return Number of files successfully moved
      * 
-     * Teaching Point: std::map::find() returns iterator.
-     * - If found: iterator points to key-value pair
-     * - If not found: iterator equals map.end()
+     * Shortcut for applyPlan(planOrganize(files, baseDirectory)).
+     * A file whose name already exists in its category folder is skipped.
+     */
+    int organizeByExtension(const FileCatalog& files, 
+                           const std::string& baseDirectory,
+                           OrganizeStats* stats = nullptr);
+    
+    /**
+     * @brief Determines the category of an extension
+     * @param extension Lowercased extension with dot (e.g. ".txt"), as
+     *        stored by FileCatalog
+     * @return Its category, or FileCategory::Others if unknown
      * 
-     * This is the standard STL pattern for safe lookups without exceptions.
+     * Costs a few nanoseconds and never allocates.
+     */
+    FileCategory categorize(std::string_view extension) const;
+    
+    /**
+     * @brief Display / folder name of a category ("Images", ...)
+     */
+    std::string_view categoryName(FileCategory category) const;
+    
+    /**
+     * @brief Category name for an extension - categoryName(categorize(ext))
+     * @param extension File extension (e.g., ".txt")
+     * @return Category name or "Others" if unknown
      */
-    std::string getCategoryForExtension(const std::string& extension) const;
+    std::string_view getCategoryForExtension(std::string_view extension) const {
+        return categoryName(categorize(extension));
+    }
     
     /**
      * @brief Displays all extension mappings (for user reference)
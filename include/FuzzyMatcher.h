@@ -0,0 +1,66 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <string_view>
+#include <cstdint>
+
+/**
+ * @brief FuzzyMatcher Class - Approximate Substring Matching, 64 Cells at a Time
+ *
+ * RESPONSIBILITY: Tell how many typos separate a search term from the
+ * closest substring of a name (edit distance: insert, delete, replace)
+ *
+ *   term "reprot"   name "annual_report.pdf"   → 2 (swap = 2 replacements)
+ *   term "raw"      name "IMG_0001.RAW"        → 0 (ordinary substring)
+ *
+ * IDEA (Myers 1999): The classic dynamic-programming table has one
+ * column per text byte and one row per term byte. Neighbouring cells
+ * differ by -1, 0 or +1 only, so a whole column can be stored as two
+ * bit vectors ("goes up" / "goes down") and advanced with a dozen
+ * word-wide operations - one step per text byte instead of one per cell.
+ *
+ * Teaching Point: NO ALLOCATION PER NAME
+ * Everything that depends on the term (one match mask per byte value) is
+ * computed once in the constructor; distance() keeps its whole state in
+ * four registers, so scoring a million names allocates nothing.
+ *
+ * LIMIT: terms longer than 64 bytes are cut to their first 64 bytes
+ * (one machine word per column).
+ *
+ * THREAD SAFETY: immutable after construction.
+ */
+class FuzzyMatcher {
+public:
+    static constexpr std::size_t kMaxTermLength = 64;
+
+    /**
+     * @brief Precomputes the match masks
+     * @param lowerTerm Search term, already lowercased
+     */
+    explicit FuzzyMatcher(std::string_view lowerTerm);
+
+    /**
+     * @brief Fewest edits turning the term into some substring of text
+     * @param lowerText Lowercased text (a file name)
+     * @param maxErrors Give up once the answer is certainly above this
+     * @return Edit distance, or maxErrors + 1 if it exceeds maxErrors
+     */
+    std::uint32_t distance(std::string_view lowerText, std::uint32_t maxErrors) const;
+
+    std::size_t termLength() const { return length; }
+
+    /**
+     * @brief A sensible error budget for a term of this length
+     *
+     * 1 typo for up to 4 characters, 2 up to 8, then one per 4 characters.
+     * More than that and everything matches everything.
+     */
+    static std::uint32_t defaultMaxErrors(std::size_t termLength);
+
+private:
+    std::uint64_t masks[256] = {};   // Bit j set: term[j] == byte
+    std::uint64_t lastRow = 0;       // Bit of the term's last byte
+    std::size_t length = 0;
+};
+
+#endif // FUZZYMATCHER_H
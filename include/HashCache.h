@@ -0,0 +1,161 @@
+#ifndef HASHCACHE_H
+#define HASHCACHE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "FileReader.h"
+
+/**
+ * @brief HashCache Class - Persistent Content Hashes Keyed by File Identity
+ *
+ * RESPONSIBILITY: Remember the hashes of files that have not changed, so
+ * repeat duplicate runs read (almost) nothing
+ *
+ * KEY: (device, inode, size, mtime_ns) - see FileIdentity
+ * VALUE: partial hash (head + tail) and full hash, stored SEPARATELY:
+ * most files only ever need the partial hash, and a full hash must not be
+ * invented for them. A third kind holds the ContentSniffer's verdict, so
+ * file headers are read once per file version, not once per run.
+ *
+ * FILE FORMAT: append-only log of fixed 48-byte records
+ *
+ *   Header  magic "SFMHASH", version, endian marker           (16 bytes)
+ *   Record  device, inode, size, mtimeNs, hash, kind, day      (48 bytes)
+ *   Record  ...
+ *
+ * Teaching Point: APPEND-ONLY LOG
+ * New hashes are appended at the end; nothing already written is ever
+ * modified. A crash can at worst leave a torn LAST record, which load()
+ * ignores. Later records override earlier ones for the same key. When
+ * dead records (overridden values) outnumber live ones, flush() rewrites
+ * the log compactly (write temp file + rename, like ScanIndex).
+ *
+ * Teaching Point: A CACHE NEEDS AN EVICTION RULE
+ * Every edit of a file is a new key, and deleted files never say so. Two
+ * rules keep the file bounded by what still exists:
+ * - Per (device, inode) only the NEWEST version (mtime) is kept - a
+ *   growing log file has one entry, not one per run
+ * - Each entry carries the day it was last stored or hit ("day", days
+ *   since 1970; 0 in old files = today). Entries unused for kKeepDays
+ *   are dropped - that is where deleted files go. A hit on an entry older
+ *   than kRefreshDays appends it again with today's date.
+ * Dropped entries count as dead records, so they trigger the compaction.
+ *
+ * SHARED BETWEEN PROCESSES: the menu, batch runs and the daemon all use
+ * .sfm_cache/hashes.sfmhc. Loading takes a shared FileLock, appending and
+ * rewriting an exclusive one; a rewrite first merges everything other
+ * processes appended since this one loaded the file.
+ *
+ * THREAD SAFETY: all methods lock an internal mutex.
+ */
+class HashCache {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kKeepDays = 60;      // Unused this long → dropped
+    static constexpr std::uint32_t kRefreshDays = 7;    // Hit on an older entry → re-dated
+
+    /**
+     * @brief Shared cache file: "./.sfm_cache/hashes.sfmhc"
+     *
+     * One file for every target directory - the key does not contain a
+     * path, so the same file reached from two roots is hashed once.
+     */
+    static std::string defaultPath();
+
+    /**
+     * @brief Opens (and loads) a cache file; a missing file is an empty cache
+     */
+    explicit HashCache(std::string cachePath);
+
+    /**
+     * @brief Flushes pending records (RAII)
+     */
+    ~HashCache();
+
+    HashCache(const HashCache&) = delete;
+    HashCache& operator=(const HashCache&) = delete;
+
+    /**
+     * @brief Looks up a stored hash
+     * @return true and sets hash if the identity has one of that kind
+     *
+     * Unknown identities (inode 0) never hit.
+     */
+    bool lookupPartial(const FileIdentity& identity, std::uint64_t& hash) const;
+    bool lookupFull(const FileIdentity& identity, std::uint64_t& hash) const;
+    bool lookupSniff(const FileIdentity& identity, std::uint64_t& value) const;
+
+    /**
+     * @brief Remembers a hash (written to disk by the next flush())
+     */
+    void storePartial(const FileIdentity& identity, std::uint64_t hash);
+    void storeFull(const FileIdentity& identity, std::uint64_t hash);
+    void storeSniff(const FileIdentity& identity, std::uint64_t value);
+
+    /**
+     * @brief Appends pending records to the file (compacting if wasteful)
+     * @return false if the file could not be written (cache stays in memory)
+     */
+    bool flush();
+
+    /**
+     * @brief Number of files with at least one stored value
+     */
+    std::size_t size() const;
+
+    const std::string& getPath() const { return path; }
+
+private:
+    enum class Kind : std::uint32_t { Partial = 1, Full = 2, Sniff = 3 };
+
+    /**
+     * @brief One on-disk record (48 bytes, no padding)
+     */
+    struct DiskRecord {
+        std::uint64_t device;
+        std::uint64_t inode;
+        std::uint64_t size;
+        std::int64_t mtimeNs;
+        std::uint64_t hash;
+        std::uint32_t kind;
+        std::uint32_t day;             // Last stored or hit (days since 1970)
+    };
+
+    struct Entry {
+        std::uint64_t partial = 0;
+        std::uint64_t full = 0;
+        std::uint64_t sniff = 0;
+        bool hasPartial = false;
+        bool hasFull = false;
+        bool hasSniff = false;
+        std::uint32_t day = 0;         // Newest day of its records
+    };
+
+    struct IdentityHasher {
+        std::size_t operator()(const FileIdentity& id) const;
+    };
+
+    std::string path;
+    std::unordered_map<FileIdentity, Entry, IdentityHasher> entries;
+    std::vector<DiskRecord> pending;     // Stored since the last flush
+    mutable std::vector<FileIdentity> refreshed;   // Hits on entries older than kRefreshDays
+    std::uint32_t today = 0;
+    std::uint64_t recordsOnDisk = 0;
+    bool rewriteNeeded = false;          // File missing, foreign or torn
+    mutable std::mutex mutex;
+
+    void load();
+    bool replay(std::uint64_t& records, bool& torn);
+    void apply(const DiskRecord& record);
+    void store(const FileIdentity& identity, std::uint64_t hash, Kind kind);
+    bool lookup(const FileIdentity& identity, Kind kind, std::uint64_t& value) const;
+    bool rewrite();
+    void prune();
+    static void recordsOf(const FileIdentity& identity, const Entry& entry, std::vector<DiskRecord>& out);
+    std::size_t liveRecords() const;
+};
+
+#endif // HASHCACHE_H
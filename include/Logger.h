@@ -5,92 +5,374 @@
 #include <fstream>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <charconv>
+#include <cstdio>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief Severity of a log record (ordered: a threshold passes itself and above)
+ */
+enum class LogLevel : std::uint8_t {
+    Trace = 0,      // Per file / per entry - hot loops
+    Debug = 1,      // Per group / per batch details
+    Info = 2,       // One line per operation (default threshold)
+    Warn = 3,
+    Error = 4,
+    Off = 5
+};
+
+/**
+ * @brief Lowest level that is compiled in at all
+ *
+ * Teaching Point: COMPILE-TIME ELISION
+ * SFM_LOG(Trace, ...) below a build's minimum becomes `if constexpr
+ * (false)`: the arguments are still type-checked, but no code is
+ * generated - not even the check of the runtime threshold. Release
+ * builds (NDEBUG) drop Trace and Debug; -DSFM_LOG_MIN_LEVEL=n overrides.
+ */
+#ifndef SFM_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SFM_LOG_MIN_LEVEL 2
+#else
+#define SFM_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+constexpr bool logLevelCompiledIn(LogLevel level) {
+    return static_cast<int>(level) + 1 > SFM_LOG_MIN_LEVEL;   // (">=" warns when the minimum is 0)
+}
+
+namespace logformat {
+
+    /**
+     * @brief Appends one argument of a format string
+     *
+     * Integers use std::to_chars (no locale, no allocation); strings are
+     * appended as they are.
+     */
+    inline void appendValue(std::string& out, std::string_view value) { out.append(value); }
+    inline void appendValue(std::string& out, const char* value) { out.append(value != nullptr ? value : "(null)"); }
+    inline void appendValue(std::string& out, char value) { out += value; }
+    inline void appendValue(std::string& out, bool value) { out.append(value ? "true" : "false"); }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    void appendValue(std::string& out, T value) {
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    void appendValue(std::string& out, T value) {
+        char digits[32];
+        const int length = std::snprintf(digits, sizeof(digits), "%.3f", static_cast<double>(value));
+        out.append(digits, static_cast<std::size_t>(length > 0 ? length : 0));
+    }
+
+    inline void formatInto(std::string& out, std::string_view format) { out.append(format); }
+
+    /**
+     * @brief Replaces each "{}" in format with the next argument
+     *
+     * formatInto(out, "Found {} ({} bytes)", name, size)
+     */
+    template <typename First, typename... Rest>
+    void formatInto(std::string& out, std::string_view format, const First& first, const Rest&... rest) {
+        const std::size_t slot = format.find("{}");
+        if (slot == std::string_view::npos) {
+            out.append(format);   // More arguments than slots: the extras are ignored
+            return;
+        }
+        out.append(format.substr(0, slot));
+        appendValue(out, first);
+        formatInto(out, format.substr(slot + 2), rest...);
+    }
+}
+
+/**
+ * @brief Lets at most N records per second through one call site
+ *
+ * Used by SFM_LOG_SAMPLED: a loop failing on 100 000 files writes a few
+ * lines per second plus "(N similar messages suppressed)", instead of
+ * burying everything else in the log. Lock-free: three atomics.
+ */
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(std::uint32_t perSecond) : limit(perSecond) {}
+
+    /**
+     * @return true if this record may be written; suppressed then receives
+     *         how many were held back since the last one that passed
+     */
+    bool allow(std::uint64_t& suppressed);
+
+private:
+    std::uint32_t limit;
+    std::atomic<std::int64_t> windowSecond{-1};
+    std::atomic<std::uint32_t> inWindow{0};
+    std::atomic<std::uint64_t> heldBack{0};
+};
+
+/**
+ * @brief What log() does when the async buffer is full
+ */
+enum class LogOverflow {
+    Block,      // Wait for the writer (no record is ever lost) - default
+    Drop        // Discard the record and count it (callers never wait)
+};
+
+/**
+ * @brief Settings of the asynchronous mode (see Logger::startAsync)
+ */
+struct LoggerOptions {
+    std::size_t capacity = 8192;                 // Records in the ring (rounded up to 2^k)
+    LogOverflow overflow = LogOverflow::Block;
+    std::size_t batchRecords = 1024;             // Records per write() of the writer thread
+};
 
 /**
  * @brief Logger Class - Singleton Pattern Implementation
- * 
+ *
  * DESIGN PATTERN: Singleton
  * WHY? We need exactly ONE log file throughout the application's lifetime.
  * Multiple Logger instances could lead to:
  * - File corruption from concurrent writes
  * - Inconsistent log ordering
  * - Resource wastage
- * 
+ *
  * KEY CONCEPTS:
  * 1. Private constructor - prevents external instantiation
  * 2. Static instance method - controlled access point
  * 3. Thread-safe implementation using mutex
  * 4. Delete copy/move constructors - prevent duplication
+ *
+ * TWO MODES:
+ * - Synchronous (default): log() writes and flushes under a mutex -
+ *   every line is on disk when log() returns
+ * - Asynchronous (startAsync()): log() formats the line and puts it into
+ *   a lock-free ring buffer; a background thread writes many lines per
+ *   write() call. Worker threads no longer queue up behind the file.
+ *   Lines starting with "ERROR" or "FATAL" are flushed before log()
+ *   returns, so a crash right after an error still leaves it in the file.
  */
 class Logger {
 private:
     std::ofstream logFile;              // Output file stream for writing logs
     std::mutex logMutex;                // Thread-safety mechanism (prevents race conditions)
-    
+
+    /**
+     * @brief One ring slot (see the MPSC queue in Logger.cpp)
+     */
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        std::string text;               // Complete line, timestamp and '\n' included
+    };
+
+    // Asynchronous mode
+    std::unique_ptr<Slot[]> ring;
+    std::size_t ringMask = 0;
+    LoggerOptions asyncOptions;
+    std::atomic<bool> asyncActive{false};
+    std::atomic<std::size_t> head{0};           // Next ticket for producers
+    std::size_t tail = 0;                       // Next slot to write (writer thread only)
+    std::atomic<std::size_t> written{0};        // Records written and flushed so far
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<bool> writerSleeping{false};
+    bool stopping = false;                      // Guarded by wakeMutex
+    std::mutex wakeMutex;
+    std::condition_variable wake;               // Producers / flush() → writer
+    std::condition_variable progress;           // Writer → flush() / blocked producers
+    std::thread writer;
+
     /**
      * @brief Private Constructor - Core of Singleton Pattern
-     * 
+     *
      * Teaching Point: By making constructor private, we prevent code like:
      * Logger myLogger;  // COMPILATION ERROR!
-     * 
+     *
      * Opens log file in append mode (std::ios::app) so previous logs aren't lost.
      */
     Logger();
-    
+
     /**
      * @brief Private Destructor - Ensures proper cleanup
-     * 
+     *
      * Automatically closes the log file when program exits.
      * Teaching Point: RAII (Resource Acquisition Is Initialization) principle -
      * resources are tied to object lifetime.
      */
     ~Logger();
 
+    std::atomic<std::uint8_t> threshold{static_cast<std::uint8_t>(LogLevel::Info)};
+
+    void write(LogLevel level, std::string_view prefix, const std::string& message);
+    bool tryPush(std::string& line, std::size_t& ticket);
+    void writerLoop();
+    void waitWritten(std::size_t count);
+    void wakeWriter();
+
 public:
     /**
      * @brief Delete copy constructor - Prevents copying
-     * 
+     *
      * Teaching Point: = delete is C++11 syntax that explicitly disables a function.
      * Prevents: Logger copy = Logger::getInstance(); // ERROR!
      */
     Logger(const Logger&) = delete;
-    
+
     /**
      * @brief Delete copy assignment - Prevents assignment
-     * 
+     *
      * Prevents: Logger log1 = Logger::getInstance(); // ERROR!
      */
     Logger& operator=(const Logger&) = delete;
-    
+
     /**
      * @brief Static method to get the single instance
      * @return Reference to the only Logger instance
-     * 
+     *
      * Teaching Point: This is the ONLY way to access the Logger.
      * Uses "lazy initialization" - instance created on first call.
      * Thread-safe in C++11+ (magic statics guarantee).
      */
     static Logger& getInstance();
-    
+
     /**
      * @brief Logs a message with timestamp
      * @param message The text to log
-     * 
+     *
      * Teaching Point: Mutex ensures thread-safety. If multiple threads call this,
      * they'll wait in line (serialized access) rather than corrupting the file.
-     * 
+     * In asynchronous mode there is no mutex: each thread claims a ring
+     * slot with one atomic compare-and-swap.
+     *
      * Format: [YYYY-MM-DD HH:MM:SS] Message
      */
     void log(const std::string& message);
-    
+
+    /**
+     * @brief Logs a message at a level ("WARNING: " / "ERROR: " etc. prefixed)
+     *
+     * The plain log(message) above infers the level from the text: a
+     * message starting with "ERROR"/"FATAL" is Error, "WARNING" is Warn,
+     * anything else Info - so existing calls keep working with levels.
+     */
+    void log(LogLevel level, const std::string& message);
+
+    /**
+     * @brief Lazy, format-string style logging
+     * @param format Text with "{}" slots, e.g. "Found {} ({} bytes)"
+     *
+     * Teaching Point: LAZY FORMATTING
+     * The arguments are passed as they are (references, integers); the
+     * string is only built when the level passes the threshold. Compare
+     * log("Found " + name + " (" + std::to_string(size) + ")"), which
+     * allocates and concatenates even when the line is thrown away.
+     */
+    template <typename... Args>
+    void logf(LogLevel level, std::string_view format, const Args&... args) {
+        if (!enabled(level)) {
+            return;
+        }
+        std::string message;
+        message.reserve(format.size() + 16 * sizeof...(Args));
+        logformat::formatInto(message, format, args...);
+        log(level, message);
+    }
+
+    /**
+     * @brief Runtime threshold: records below it are discarded
+     */
+    void setLevel(LogLevel level) { threshold.store(static_cast<std::uint8_t>(level), std::memory_order_relaxed); }
+    LogLevel getLevel() const { return static_cast<LogLevel>(threshold.load(std::memory_order_relaxed)); }
+    bool enabled(LogLevel level) const {
+        return static_cast<std::uint8_t>(level) >= threshold.load(std::memory_order_relaxed) &&
+               level != LogLevel::Off;
+    }
+
+    /**
+     * @brief Parses "trace", "debug", "info", "warn", "error" or "off"
+     * @return false (level unchanged) for anything else
+     */
+    static bool parseLevel(std::string_view text, LogLevel& level);
+
+    /**
+     * @brief Switches to asynchronous mode and starts the writer thread
+     * @return false if already asynchronous or the log file is not open
+     */
+    bool startAsync(const LoggerOptions& options = LoggerOptions());
+
+    /**
+     * @brief Writes everything queued, stops the writer, back to synchronous
+     *
+     * Called by the destructor; call it earlier if other threads may
+     * still log during static destruction.
+     */
+    void stopAsync();
+
+    /**
+     * @brief Returns once every record logged before the call is in the file
+     */
+    void flush();
+
+    bool isAsync() const { return asyncActive.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Records discarded under LogOverflow::Drop
+     */
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
     /**
      * @brief Helper to get current timestamp
      * @return Formatted timestamp string
-     * 
+     *
      * Teaching Point: Private helper methods improve code organization.
      * This follows the Single Responsibility Principle - each method does one thing.
+     * The text is formatted once per second per thread and then reused.
      */
     std::string getCurrentTimestamp() const;
 };
 
+/**
+ * @brief Level-filtered, lazily formatted logging with compile-time elision
+ *
+ *   SFM_LOG(Trace, "Found file: {} ({} bytes)", name, size);
+ *   SFM_LOG_SAMPLED(Error, 10, "ERROR moving {}: {}", path, reason);
+ *
+ * Nothing after the level is evaluated unless the level is compiled in
+ * (SFM_LOG_MIN_LEVEL) AND passes the runtime threshold. SFM_LOG_SAMPLED
+ * additionally lets at most `perSecond` records through from that line.
+ */
+#define SFM_LOG(level, ...)                                                            \
+    do {                                                                               \
+        if constexpr (logLevelCompiledIn(LogLevel::level)) {                          \
+            Logger& sfmLogger = Logger::getInstance();                                 \
+            if (sfmLogger.enabled(LogLevel::level)) {                                  \
+                sfmLogger.logf(LogLevel::level, __VA_ARGS__);                          \
+            }                                                                          \
+        }                                                                              \
+    } while (0)
+
+#define SFM_LOG_SAMPLED(level, perSecond, ...)                                         \
+    do {                                                                               \
+        if constexpr (logLevelCompiledIn(LogLevel::level)) {                          \
+            static LogRateLimiter sfmLimiter(perSecond);                               \
+            Logger& sfmLogger = Logger::getInstance();                                 \
+            std::uint64_t sfmSuppressed = 0;                                           \
+            if (sfmLogger.enabled(LogLevel::level) && sfmLimiter.allow(sfmSuppressed)) { \
+                sfmLogger.logf(LogLevel::level, __VA_ARGS__);                          \
+                if (sfmSuppressed > 0) {                                               \
+                    sfmLogger.logf(LogLevel::level, "({} similar messages suppressed)", \
+                                   sfmSuppressed);                                     \
+                }                                                                      \
+            }                                                                          \
+        }                                                                              \
+    } while (0)
+
 #endif // LOGGER_H
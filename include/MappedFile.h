@@ -0,0 +1,59 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief MappedFile Class - Read-Only Memory Mapping (RAII)
+ *
+ * RESPONSIBILITY: Makes a whole file readable as one block of memory
+ *
+ * WHY mmap INSTEAD OF read()?
+ * read() copies file bytes from the kernel's page cache into our buffer.
+ * mmap() maps the page cache pages straight into our address space, so
+ * the bytes are used where they already are. Pages are loaded lazily the
+ * first time they are touched.
+ *
+ * Teaching Point: RAII for OS resources
+ * The constructor acquires the mapping, the destructor releases it. The
+ * object is move-only: two owners would unmap the same region twice.
+ *
+ * PORTABILITY: On systems without POSIX mmap the file is read into a
+ * heap buffer instead - same interface, one extra copy.
+ */
+class MappedFile {
+private:
+    const char* mappedData = nullptr;   // Start of the mapping (or of fallbackBuffer)
+    std::size_t mappedSize = 0;
+    bool usingMmap = false;             // Release with munmap() vs. let the vector free it
+    std::vector<char> fallbackBuffer;
+
+    void release();
+
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Maps a file read-only
+     * @param path File to map
+     *
+     * Check isOpen() afterwards - a missing file is not an exception here,
+     * callers usually just fall back to doing the work from scratch.
+     */
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool isOpen() const { return mappedData != nullptr; }
+    const char* data() const { return mappedData; }
+    std::size_t size() const { return mappedSize; }
+};
+
+#endif // MAPPEDFILE_H
@@ -5,6 +5,7 @@
 #include "FileManager.h"
 #include "FileSorter.h"
 #include "FileSearcher.h"
+#include "FileListing.h"
 
 /**
  * @brief Menu Class - Console User Interface Controller
@@ -57,6 +58,7 @@ private:
     
     std::string currentDirectory;   // Working directory path
     bool isRunning;                 // Application state flag
+    FileListing listing;            // Paged view; its sort orders survive between listings
     
     /**
      * @brief Displays main menu options
@@ -86,11 +88,28 @@ private:
      * - Easier to understand (each method has clear purpose)
      */
     void handleScanDirectory();
+    void handleQuickRescan();
+    void handleToggleWatch();
     void handleOrganizeFiles();
+    void handleUndoOrganize();
+    bool handleInterruptedOrganize();   // true if one was found (and dealt with)
+    void refreshAfterMoves();           // Rescan unless watch mode keeps up
     void handleSearchFiles();
+    void handleQueryFiles();
     void handleFindDuplicates();
     void handleDisplayFiles();
     void handleChangeDirectory();
+    void handleShowMetrics();
+    void handleDiskUsage();
+    
+    /**
+     * @brief Pages through `listing` until the user quits
+     * @param title Shown above every page
+     * 
+     * Teaching Point: Only the visible page is formatted, so paging a
+     * million files is as fast as paging twenty; sort keys switch in place.
+     */
+    void pageListing(const std::string& title);
     
     /**
      * @brief Utility methods for user interaction
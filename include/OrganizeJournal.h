@@ -0,0 +1,158 @@
+#ifndef ORGANIZEJOURNAL_H
+#define ORGANIZEJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include "OrganizeEngine.h"
+
+/**
+ * @brief What to do when a file's name is already taken in its folder
+ */
+enum class ConflictPolicy {
+    Skip,       // Leave the file where it is (default, never overwrites)
+    Rename      // Move it as "name (2).ext", "name (3).ext", ...
+};
+
+/**
+ * @brief One file of a plan: where it is and where it goes
+ */
+struct PlannedMove {
+    std::uint32_t sourceDirectory;   // Index into OrganizePlan::sourceDirectories
+    std::uint16_t folder;            // Index into OrganizePlan::folders
+    std::uint64_t size;
+    std::string name;                // Current filename
+    std::string newName;             // Name inside the folder; "" = unchanged
+
+    const std::string& targetName() const { return newName.empty() ? name : newName; }
+};
+
+/**
+ * @brief A complete organize run, decided before anything moves
+ *
+ * Teaching Point: PLAN, THEN ACT
+ * Computing every source, destination and conflict up front makes a
+ * dry run free (print the plan), and it gives a crash something to
+ * recover FROM: the plan is written to a journal before the first move.
+ */
+struct OrganizePlan {
+    std::string baseDirectory;
+    std::vector<std::string> sourceDirectories;
+    std::vector<std::string> folders;         // Destination folders
+    std::vector<PlannedMove> moves;
+    std::size_t conflicts = 0;                // Names already taken (skipped or renamed)
+    std::size_t alreadyPlaced = 0;            // Files already in their folder
+
+    std::string sourcePath(const PlannedMove& move) const {
+        return sourceDirectories[move.sourceDirectory] + "/" + move.name;
+    }
+    std::string destinationPath(const PlannedMove& move) const {
+        return folders[move.folder] + "/" + move.targetName();
+    }
+};
+
+/**
+ * @brief OrganizeJournal Class - Crash-Safe, Undoable Organize Runs
+ *
+ * RESPONSIBILITY: Apply a plan so that an interruption at ANY point can
+ * be finished or reverted later, without rescanning the tree
+ *
+ * JOURNAL FILE (<base>/.sfm_journal, text, one record per line):
+ *   SFMJ 1                    header / version
+ *   B <base>                  base directory (absolute, like S and F)
+ *   S <dir>                   source directory  (id = order of S lines)
+ *   F <folder>                destination folder (id = order of F lines)
+ *   M <size> <S id> <F id> <name> <new name or empty>
+ *   P                         plan complete and fsync'ed - moving starts
+ *   D <id> <id> ...           moves finished, one line per engine batch
+ *   C                         run complete
+ * Fields are tab-separated; tab, newline and backslash in names are
+ * escaped. A torn last line (crash mid-write) is ignored.
+ *
+ * RECOVERY NEEDS NO "D" LINE TO BE ON DISK: D lines are written without
+ * fsync. A move missing its D line is recognised by looking at the two
+ * paths (source gone, destination present) - one lstat per unfinished
+ * move instead of a full rescan.
+ *
+ * THREAD SAFETY: apply()/resume()/undo() are meant to run one at a time
+ * per base directory; inside, the engine's workers append D lines
+ * concurrently (serialized by a mutex).
+ */
+class OrganizeJournal {
+public:
+    enum class State {
+        None,           // No journal (or one not worth keeping)
+        Incomplete,     // A run was interrupted: resume() or undo()
+        Complete,       // Last run finished: undo() can revert it
+        Unreadable      // Exists but damaged / unknown version
+    };
+
+    /**
+     * @brief Journal location for a base directory: "<base>/.sfm_journal"
+     */
+    static std::string pathFor(const std::string& baseDirectory);
+
+    /**
+     * @brief Reports the state of the journal in a base directory
+     * @param finished Optional: moves recorded as done
+     * @param total Optional: moves in the plan
+     */
+    static State inspect(const std::string& baseDirectory, std::size_t* finished = nullptr,
+                         std::size_t* total = nullptr);
+
+    /**
+     * @brief Journals the plan, then runs it in parallel
+     * @return Engine counts; nothing happens if an incomplete journal exists
+     *
+     * Destination folders must already exist (FileSorter creates them).
+     * Replaces a previous COMPLETE journal - undo goes back one run.
+     */
+    static OrganizeStats apply(const OrganizePlan& plan, const OrganizeEngine& engine);
+
+    /**
+     * @brief Finishes an interrupted run (moves what is still pending)
+     */
+    static OrganizeStats resume(const std::string& baseDirectory, const OrganizeEngine& engine);
+
+    /**
+     * @brief Moves every file of the last run back (rollback or undo)
+     * @return Counts of the reverse moves; the journal is removed once
+     *         nothing is left to revert
+     *
+     * A file whose original name has been taken since is skipped and the
+     * journal kept, so undo can be retried after the clash is resolved.
+     */
+    static OrganizeStats undo(const std::string& baseDirectory, const OrganizeEngine& engine);
+
+private:
+    std::FILE* file = nullptr;
+    std::mutex writeMutex;
+
+    explicit OrganizeJournal(std::FILE* openFile) : file(openFile) {}
+    ~OrganizeJournal();
+    OrganizeJournal(const OrganizeJournal&) = delete;
+    OrganizeJournal& operator=(const OrganizeJournal&) = delete;
+
+    void recordDone(const std::vector<std::uint32_t>& planIds);
+    bool commit();
+
+    /**
+     * @brief Parses a journal
+     * @param done Per move: recorded as finished
+     * @param complete Receives whether the C record was found
+     */
+    static bool load(const std::string& path, OrganizePlan& plan, std::vector<bool>& done,
+                     bool& complete);
+
+    /**
+     * @brief Runs the given plan moves through the engine
+     * @param reverse true = from destination back to source
+     * @param journal Receives D records (forward runs only)
+     */
+    static OrganizeStats execute(const OrganizePlan& plan, const std::vector<std::uint32_t>& ids,
+                                 bool reverse, const OrganizeEngine& engine, OrganizeJournal* journal);
+};
+
+#endif // ORGANIZEJOURNAL_H
@@ -0,0 +1,206 @@
+#ifndef SCANBACKEND_H
+#define SCANBACKEND_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <system_error>
+#include <cstdint>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Kind of a directory entry as reported by a ScanBackend
+ */
+enum class EntryType {
+    Regular,
+    Directory,
+    Symlink,
+    Other       // Sockets, FIFOs, devices, ...
+};
+
+/**
+ * @brief One entry of a directory listing
+ *
+ * Teaching Point: The backend fills in only what the scanner needs:
+ * - name: the entry name (NOT a full path - the caller already knows the directory)
+ * - type: the entry itself (a symlink is reported as Symlink)
+ * - targetType: for symlinks, the type of what the link points to
+ * - size: only meaningful for regular files (or links to regular files)
+ * - mtimeNs / inode: identity of the file contents for the hash cache
+ *   (same stat call as the size, so they cost nothing extra)
+ */
+struct ScanEntry {
+    std::string name;
+    EntryType type = EntryType::Other;
+    EntryType targetType = EntryType::Other;
+    std::uintmax_t size = 0;
+    std::int64_t mtimeNs = 0;   // Modification time (regular files / link targets)
+    std::uint64_t inode = 0;    // 0 = backend cannot report inodes
+};
+
+/**
+ * @brief Result of listing one directory
+ */
+struct DirectoryListing {
+    std::vector<ScanEntry> entries;
+    std::int64_t mtimeNs = 0;   // Modification time of the directory itself
+    std::uint64_t device = 0;   // st_dev of the directory (0 = unknown)
+
+    void clear() {
+        entries.clear();
+        mtimeNs = 0;
+        device = 0;
+    }
+};
+
+/**
+ * @brief Per-scan counters used for the scan summary
+ *
+ * Teaching Point: Plain integers, not atomics - every worker owns its own
+ * ScanStats and they are summed once at the end (see operator+=).
+ */
+struct ScanStats {
+    std::uint64_t directories = 0;   // Directories listed
+    std::uint64_t entries = 0;       // Entries returned by the backend
+    std::uint64_t syscalls = 0;      // System calls issued (estimated for portable backend)
+    std::uint64_t statCalls = 0;     // Subset of syscalls: stat/statx
+    std::uint64_t readdirCalls = 0;  // Subset of syscalls: getdents64 batches
+    std::uint64_t reusedDirectories = 0;  // Incremental rescan: unchanged, not re-listed
+
+    ScanStats& operator+=(const ScanStats& other) {
+        directories += other.directories;
+        entries += other.entries;
+        syscalls += other.syscalls;
+        statCalls += other.statCalls;
+        readdirCalls += other.readdirCalls;
+        reusedDirectories += other.reusedDirectories;
+        return *this;
+    }
+};
+
+/**
+ * @brief ScanBackend Interface - How a directory gets listed
+ *
+ * DESIGN PATTERN: Strategy
+ * FileManager knows WHAT to scan; the backend knows HOW to talk to the OS.
+ * Backends can be swapped at runtime with FileManager::setScanBackend().
+ *
+ * Teaching Point: A pure virtual class (= 0 methods) is C++'s "interface".
+ * The virtual destructor makes deleting through a base pointer safe.
+ *
+ * THREAD SAFETY: listDirectory() is called from many pool workers at
+ * once, so implementations must not keep per-call state in members.
+ */
+class ScanBackend {
+public:
+    virtual ~ScanBackend() = default;
+
+    /**
+     * @brief Short identifier shown in the scan summary
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Lists one directory
+     * @param dir Directory to list
+     * @param resolveLinks Fill ScanEntry::targetType/size for symlinks
+     * @param out Receives the entries ("." and ".." excluded) and the
+     *            directory's own mtime, read BEFORE the entries
+     * @param stats Counters to update
+     * @param ec Set on failure (std::filesystem style error reporting)
+     * @return true on success
+     */
+    virtual bool listDirectory(const fs::path& dir, bool resolveLinks,
+                               DirectoryListing& out, ScanStats& stats,
+                               std::error_code& ec) const = 0;
+
+    /**
+     * @brief Reads only a directory's modification time
+     * @param dir Directory to check
+     * @param mtimeNs Receives the mtime (same clock as DirectoryListing::mtimeNs)
+     * @param stats Counters to update
+     * @param ec Set on failure (e.g. the directory was removed)
+     * @return true on success
+     *
+     * Used by incremental rescans: a directory whose mtime did not change
+     * still has exactly the same entries, so it need not be listed again.
+     */
+    virtual bool directoryMtime(const fs::path& dir, std::int64_t& mtimeNs,
+                                ScanStats& stats, std::error_code& ec) const = 0;
+
+    /**
+     * @brief Reads one file's metadata, following symlinks
+     * @param file File to check
+     * @param out Receives type, size, mtimeNs and inode (name is untouched)
+     * @param device Receives the file's st_dev (0 = unknown)
+     * @param stats Counters to update
+     * @param ec Set on failure
+     * @return true on success
+     *
+     * Used by watch mode, which learns about single paths rather than
+     * whole directories.
+     */
+    virtual bool fileMetadata(const fs::path& file, ScanEntry& out, std::uint64_t& device,
+                              ScanStats& stats, std::error_code& ec) const = 0;
+};
+
+/**
+ * @brief Portable backend built on std::filesystem::directory_iterator
+ *
+ * Works everywhere std::filesystem does. Its syscall count is an
+ * estimate: std::filesystem does not tell us how many calls it makes,
+ * so we count one per metadata query plus open/read/close per directory.
+ * std::filesystem has no notion of devices or inodes, so files scanned
+ * with it report inode 0 and are never looked up in the hash cache.
+ */
+class FilesystemScanBackend : public ScanBackend {
+public:
+    const char* name() const override { return "std::filesystem"; }
+    bool listDirectory(const fs::path& dir, bool resolveLinks,
+                       DirectoryListing& out, ScanStats& stats,
+                       std::error_code& ec) const override;
+    bool directoryMtime(const fs::path& dir, std::int64_t& mtimeNs,
+                        ScanStats& stats, std::error_code& ec) const override;
+    bool fileMetadata(const fs::path& file, ScanEntry& out, std::uint64_t& device,
+                      ScanStats& stats, std::error_code& ec) const override;
+};
+
+#ifdef __linux__
+/**
+ * @brief Linux backend: getdents64 batches + statx relative to a dir fd
+ *
+ * SYSCALL BUDGET PER DIRECTORY:
+ * - 1 open(O_DIRECTORY) + 1 fstat (directory mtime) + 1 close
+ * - 1 getdents64 per 128 KiB of directory entries (thousands of names)
+ *
+ * SYSCALL BUDGET PER ENTRY (using d_type from getdents64):
+ * - Directory:    0 (d_type already says DT_DIR)
+ * - Regular file: 1 statx(dirfd, name, SIZE|MTIME|INO) - no path building
+ * - Symlink:      1 statx following the link (only if resolveLinks)
+ * - DT_UNKNOWN:   1 statx(STATX_TYPE | STATX_SIZE) as a fallback
+ */
+class LinuxScanBackend : public ScanBackend {
+public:
+    const char* name() const override { return "linux getdents64+statx"; }
+    bool listDirectory(const fs::path& dir, bool resolveLinks,
+                       DirectoryListing& out, ScanStats& stats,
+                       std::error_code& ec) const override;
+    bool directoryMtime(const fs::path& dir, std::int64_t& mtimeNs,
+                        ScanStats& stats, std::error_code& ec) const override;
+    bool fileMetadata(const fs::path& file, ScanEntry& out, std::uint64_t& device,
+                      ScanStats& stats, std::error_code& ec) const override;
+};
+#endif
+
+/**
+ * @brief Factory for the fastest backend available on this platform
+ * @return LinuxScanBackend on Linux, FilesystemScanBackend elsewhere
+ *
+ * Teaching Point: Factory function - callers never name a concrete class,
+ * so adding a backend for another OS changes only this function.
+ */
+std::shared_ptr<ScanBackend> createDefaultScanBackend();
+
+#endif // SCANBACKEND_H
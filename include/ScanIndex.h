@@ -0,0 +1,91 @@
+#ifndef SCANINDEX_H
+#define SCANINDEX_H
+
+#include <string>
+#include <vector>
+#include "FileCatalog.h"
+#include "FileManager.h"
+
+/**
+ * @brief What a saved index says about the scan that produced it
+ *
+ * A stored catalog is only reusable if it was built the same way we
+ * would build it now: same root, same options, same backend (the two
+ * backends use different clocks for directory mtimes).
+ */
+struct ScanIndexInfo {
+    std::string rootPath;       // Target directory as given to FileManager (several: one per line)
+    std::string backendName;    // ScanBackend::name() at save time
+    ScanOptions options;        // recursive / maxDepth / symlinks (threadCount is not stored)
+};
+
+/**
+ * @brief ScanIndex Class - Versioned On-Disk Snapshot of a FileCatalog
+ *
+ * RESPONSIBILITY: Save a scan so the next launch starts with results
+ *
+ * FILE LAYOUT (all sections 8-byte aligned, native byte order):
+ *
+ *   Header          magic "SFMIDX", version, endian marker, counts,
+ *                   section offsets, scan options, backend name
+ *   root path       bytes
+ *   records         FileCatalog::Record[fileCount]        (raw block)
+ *   sizes           uint64[fileCount]                      (raw block)
+ *   hashes          uint64[fileCount]                      (raw block)
+ *   fileDirectories uint32[fileCount]                      (raw block)
+ *   mtimes          int64[fileCount]                       (raw block)
+ *   inodes          uint64[fileCount]                      (raw block)
+ *   directories     FileCatalog::DirectoryRecord[dirCount] (raw block)
+ *   path arena      bytes
+ *   extensions      { uint16 length, bytes }[extensionCount]
+ *
+ * Teaching Point: The columns of FileCatalog are already flat arrays of
+ * plain structs with offsets instead of pointers. Writing them is one
+ * write() per column; loading is one memcpy per column out of an mmap'ed
+ * file - there is nothing to parse per file.
+ *
+ * SAFETY: Loading checks the magic, version, endian marker and that every
+ * section lies inside the file. Any mismatch means "no index" and the
+ * caller simply scans from scratch. Saving writes a temporary file and
+ * renames it, so a crash never leaves a half-written index behind.
+ */
+class ScanIndex {
+public:
+    static constexpr std::uint32_t kVersion = 2;   // 2: per-file mtime/inode, per-directory device
+
+    /**
+     * @brief Index file used for a target directory
+     * @param targetDirectory Directory being managed
+     * @return "./.sfm_cache/index-<hash of absolute path>.sfmidx"
+     *
+     * The cache directory sits next to file_manager.log (the working
+     * directory), one index file per target directory.
+     */
+    static std::string defaultPath(const std::string& targetDirectory);
+
+    /**
+     * @brief Index file used for a set of roots (one root = the path above)
+     */
+    static std::string defaultPath(const std::vector<std::string>& roots);
+
+    /**
+     * @brief Writes a catalog to disk
+     * @param indexPath Destination file (its directory is created if needed)
+     * @param files Catalog to save
+     * @param info How the catalog was produced
+     * @return true on success (failures are logged)
+     */
+    static bool save(const std::string& indexPath, const FileCatalog& files,
+                     const ScanIndexInfo& info);
+
+    /**
+     * @brief Reads a catalog back
+     * @param indexPath File written by save()
+     * @param files Receives the catalog (left untouched on failure)
+     * @param info Receives the stored scan description
+     * @return false if the file is missing, from another version or damaged
+     */
+    static bool load(const std::string& indexPath, FileCatalog& files, ScanIndexInfo& info);
+};
+
+#endif // SCANINDEX_H
@@ -0,0 +1,46 @@
+#ifndef SUBSTRINGSEARCH_H
+#define SUBSTRINGSEARCH_H
+
+#include <cstddef>
+
+/**
+ * @brief SubstringSearch Class - SIMD Substring Kernel with CPU Dispatch
+ *
+ * RESPONSIBILITY: Find a needle in a (long) haystack as fast as the CPU
+ * allows, without allocating
+ *
+ * ALGORITHM: "first and last byte" filter
+ *   For 16 (SSE2, NEON) or 32 (AVX2) positions at once, compare
+ *     block at position i           with the needle's FIRST byte
+ *     block at position i + m - 1   with the needle's LAST byte
+ *   AND the two masks: only positions where both bytes match are checked
+ *   with memcmp. In real text that is almost never, so the kernel runs at
+ *   close to memory bandwidth.
+ *
+ * Teaching Point: RUNTIME DISPATCH
+ * A binary built for "any x86-64" may only assume SSE2. The AVX2 kernel is
+ * compiled with a per-function target attribute and chosen on the first
+ * call if the CPU reports AVX2 - one binary, best kernel on every machine.
+ * ARM64 always has NEON; other CPUs get the portable scalar kernel.
+ */
+class SubstringSearch {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief First position of needle in text
+     * @return Offset of the match, or npos (an empty needle matches at 0)
+     *
+     * Bytes are compared exactly - lowercase both sides for a
+     * case-insensitive search.
+     */
+    static std::size_t find(const char* text, std::size_t length,
+                            const char* needle, std::size_t needleLength);
+
+    /**
+     * @brief Name of the kernel in use ("avx2", "sse2", "neon" or "scalar")
+     */
+    static const char* implementation();
+};
+
+#endif // SUBSTRINGSEARCH_H
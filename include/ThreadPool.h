@@ -0,0 +1,160 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief ThreadPool Class - Work-Stealing Task Executor
+ *
+ * RESPONSIBILITY: Runs many small, independent tasks on a fixed set of threads
+ *
+ * WORK-STEALING DESIGN:
+ * - Every worker owns a double-ended queue (deque) of tasks
+ * - A worker pushes AND pops new tasks at the BACK of its own deque (LIFO)
+ * - An idle worker steals from the FRONT of another worker's deque (FIFO)
+ *
+ * WHY? Recursive jobs (like walking a directory tree) create their own
+ * sub-tasks. LIFO keeps a worker on the subtree it just discovered (hot caches),
+ * while FIFO stealing hands out the OLDEST tasks - usually the biggest subtrees -
+ * so idle threads pick up large chunks of work instead of crumbs.
+ *
+ * Teaching Point: A single shared queue works too, but every push/pop then
+ * fights for one mutex. Per-worker queues spread that contention out, which is
+ * what keeps throughput growing with the core count.
+ */
+class ThreadPool {
+private:
+    /**
+     * @brief One task queue per worker
+     *
+     * Teaching Point: Each queue has its own mutex. The owner and thieves
+     * only collide when they touch the SAME queue at the SAME time.
+     */
+    struct WorkerQueue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  // queues[i] belongs to workers[i]
+    std::vector<std::thread> workers;                  // Worker threads
+
+    std::atomic<std::size_t> pendingTasks;   // Submitted but not yet finished
+    std::atomic<std::size_t> queuedTasks;    // Sitting in a queue, not yet picked up
+    std::atomic<std::size_t> nextQueue;     // Round-robin target for external submits
+    std::atomic<bool> stopping;              // Set by destructor
+
+    std::mutex stateMutex;                   // Guards the two condition variables below
+    std::condition_variable workAvailable;   // Wakes sleeping workers
+    std::condition_variable allDone;         // Wakes waitIdle() callers
+
+    /**
+     * @brief Main loop executed by every worker thread
+     * @param index Worker index (also its queue index)
+     */
+    void workerLoop(std::size_t index);
+
+    /**
+     * @brief Pops from own queue, otherwise steals from a sibling
+     * @param index Calling worker's index
+     * @param task Receives the task on success
+     * @return true if a task was found
+     */
+    bool findTask(std::size_t index, std::function<void()>& task);
+
+    /**
+     * @brief Runs one task and updates the pending counter
+     *
+     * Exceptions are caught and logged so one failing task cannot
+     * terminate the worker thread (graceful degradation).
+     */
+    void runTask(std::function<void()>& task);
+
+public:
+    /**
+     * @brief Creates the pool and starts the workers
+     * @param threadCount Number of workers (0 = std::thread::hardware_concurrency())
+     */
+    explicit ThreadPool(std::size_t threadCount = 0);
+
+    /**
+     * @brief Finishes queued work, then joins all workers (RAII)
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Schedules a task
+     * @param task Callable to run on some worker
+     *
+     * Called from a worker: task goes to the back of that worker's own queue.
+     * Called from outside: task is spread round-robin across the queues.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until every submitted task (including tasks submitted
+     *        BY tasks) has finished
+     *
+     * Teaching Point: Must not be called from a worker thread - the worker
+     * would wait for itself forever (deadlock).
+     */
+    void waitIdle();
+
+    /**
+     * @brief Number of worker threads
+     */
+    std::size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Index of the calling worker inside its pool
+     * @return 0..size()-1 on a worker thread, -1 on any other thread
+     *
+     * Teaching Point: Lets tasks write into per-thread result buckets
+     * without locking - each worker only ever touches its own bucket.
+     */
+    static int currentWorkerIndex();
+};
+
+/**
+ * @brief TaskGroup Class - One Caller's Tasks on a Shared Pool
+ *
+ * waitIdle() waits for EVERY task of the pool. When several callers share
+ * one long-lived pool (the daemon's concurrent clients), each must wait
+ * only for its own tasks - a group counts them and wait() returns when
+ * they are done, whatever the other callers submitted.
+ *
+ *   TaskGroup group(pool);
+ *   for (...) group.submit([...] { ... });
+ *   group.wait();
+ *
+ * Like waitIdle(), wait() must not be called from a worker of the same
+ * pool. The destructor waits too, so no task outlives the locals it uses.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& target) : pool(target) {}
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t pending = 0;
+};
+
+#endif // THREADPOOL_H
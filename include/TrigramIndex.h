@@ -0,0 +1,86 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "FileCatalog.h"
+
+/**
+ * @brief TrigramIndex Class - Inverted Index over Lowercased File Names
+ *
+ * RESPONSIBILITY: Answer "which files COULD contain this substring?"
+ * without looking at every name
+ *
+ * IDEA: Every substring of length ≥ 3 contains the trigrams of the
+ * search term. "report" → {"rep", "epo", "por", "ort"}. A file can only
+ * match if its name contains ALL of them, so intersecting the four
+ * posting lists (files per trigram) leaves a handful of candidates; only
+ * those get the exact substring check.
+ *
+ *   "rep" → [3, 17, 42, 1001, ...]
+ *   "epo" → [3, 42, 77, ...]            intersection → [3, 42, ...]
+ *
+ * Teaching Point: COMPRESSED POSTING LISTS
+ * File indices in a list are increasing, so the list stores GAPS between
+ * them as variable-length integers (7 bits per byte, high bit = "more").
+ * Gaps in popular trigrams are tiny - usually one byte per file instead
+ * of four. All lists share one byte array.
+ *
+ * It indexes FileCatalog::lowerName() - names lowercased (ASCII) at scan time.
+ */
+class TrigramIndex {
+public:
+    static constexpr std::size_t kGramLength = 3;
+
+    /**
+     * @brief Indexes every name in the catalog (replaces previous contents)
+     *
+     * O(total name bytes). Remembers files.revision().
+     */
+    void build(const FileCatalog& files);
+
+    /**
+     * @brief True if build() ran on exactly this state of the catalog
+     */
+    bool isCurrent(const FileCatalog& files) const {
+        return built && revision == files.revision() && fileCount == files.size();
+    }
+
+    /**
+     * @brief Files whose name contains every trigram of a lowercased term
+     * @param lowerTerm Search term, already lowercased (≥ kGramLength bytes)
+     * @param out Receives candidate indices in increasing order
+     *
+     * Candidates still need the exact check: "abcab" contains the trigrams
+     * of "abcabc" but not the term itself.
+     */
+    void candidates(std::string_view lowerTerm, std::vector<FileCatalog::Index>& out) const;
+
+    std::size_t trigramCount() const { return lists.size(); }
+
+    /**
+     * @brief Approximate heap bytes used (for diagnostics)
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    /**
+     * @brief Where one trigram's list lives in `postings`
+     */
+    struct PostingList {
+        std::uint64_t offset;      // First byte in postings
+        std::uint32_t bytes;       // Encoded length
+        std::uint32_t count;       // Number of files
+    };
+
+    std::unordered_map<std::uint32_t, std::uint32_t> listByTrigram;   // trigram → lists[]
+    std::vector<PostingList> lists;
+    std::vector<std::uint8_t> postings;    // All lists, gap + varint encoded
+    std::uint64_t revision = 0;
+    std::size_t fileCount = 0;
+    bool built = false;
+};
+
+#endif // TRIGRAMINDEX_H
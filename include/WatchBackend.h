@@ -0,0 +1,122 @@
+#ifndef WATCHBACKEND_H
+#define WATCHBACKEND_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <system_error>
+
+/**
+ * @brief What happened to a watched path
+ *
+ * Teaching Point: The catalog never trusts the event kind alone - by the
+ * time a batch is applied the path may have changed again. Kinds only say
+ * WHICH paths to look at; a fresh stat says what they are now.
+ */
+enum class WatchEventKind {
+    Created,        // New entry (file or directory)
+    Removed,        // Entry deleted
+    Modified,       // File content written (size may have changed)
+    MovedFrom,      // Renamed away from this path
+    MovedTo,        // Renamed onto this path
+    Overflow        // Kernel queue overflowed - events were lost
+};
+
+/**
+ * @brief One change notification
+ */
+struct WatchEvent {
+    WatchEventKind kind = WatchEventKind::Modified;
+    std::string path;            // Full path of the entry (empty for Overflow)
+    bool isDirectory = false;    // The entry itself is a directory
+};
+
+/**
+ * @brief WatchBackend Interface - How filesystem changes are reported
+ *
+ * DESIGN PATTERN: Strategy (same idea as ScanBackend)
+ * FileManager decides what to do with a change; the backend only knows
+ * how the operating system announces changes. inotify is the Linux
+ * implementation; FSEvents or ReadDirectoryChangesW would slot in here.
+ *
+ * THREAD SAFETY: One watcher thread calls waitForEvents(); addWatch() and
+ * removeWatchesUnder() may be called from any thread at the same time
+ * (after a manual rescan, for example).
+ */
+class WatchBackend {
+public:
+    virtual ~WatchBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Acquires the OS resources (e.g. the inotify descriptor)
+     */
+    virtual bool open(std::error_code& ec) = 0;
+
+    /**
+     * @brief Starts watching ONE directory (not recursive)
+     * @return false on failure (e.g. the per-user watch limit is reached)
+     *
+     * Watching a directory twice is harmless.
+     */
+    virtual bool addWatch(const std::string& directory, std::error_code& ec) = 0;
+
+    /**
+     * @brief Stops watching a directory and every watched directory below it
+     */
+    virtual void removeWatchesUnder(const std::string& directory) = 0;
+
+    /**
+     * @brief Waits for events and appends them to out
+     * @param out Receives events (appended, not cleared)
+     * @param timeout Maximum time to wait if nothing is pending
+     * @return false on a fatal error (watching should stop)
+     */
+    virtual bool waitForEvents(std::vector<WatchEvent>& out, std::chrono::milliseconds timeout) = 0;
+
+    /**
+     * @brief Number of directories currently watched
+     */
+    virtual std::size_t watchCount() const = 0;
+};
+
+#ifdef __linux__
+/**
+ * @brief Linux backend built on inotify
+ *
+ * One inotify descriptor, one watch per directory. Each watch descriptor
+ * (wd) maps back to its directory path so events can be turned into full
+ * paths. inotify is not recursive - FileManager adds a watch for every
+ * directory in the catalog and for each new directory as it appears.
+ */
+class InotifyWatchBackend : public WatchBackend {
+public:
+    InotifyWatchBackend() = default;
+    ~InotifyWatchBackend() override;
+
+    InotifyWatchBackend(const InotifyWatchBackend&) = delete;
+    InotifyWatchBackend& operator=(const InotifyWatchBackend&) = delete;
+
+    const char* name() const override { return "inotify"; }
+    bool open(std::error_code& ec) override;
+    bool addWatch(const std::string& directory, std::error_code& ec) override;
+    void removeWatchesUnder(const std::string& directory) override;
+    bool waitForEvents(std::vector<WatchEvent>& out, std::chrono::milliseconds timeout) override;
+    std::size_t watchCount() const override;
+
+private:
+    struct State;                       // wd ↔ path maps (defined in the .cpp)
+    int inotifyFd = -1;
+    std::unique_ptr<State> state;
+};
+#endif
+
+/**
+ * @brief Factory for the platform's watch backend
+ * @return InotifyWatchBackend on Linux, nullptr where watching is unsupported
+ */
+std::unique_ptr<WatchBackend> createDefaultWatchBackend();
+
+#endif // WATCHBACKEND_H
@@ -0,0 +1,130 @@
+#include "../include/AhoCorasick.h"
+#include <limits>
+
+/**
+ * =============================================================================
+ * AHOCORASICK IMPLEMENTATION - TRIE + FAILURE LINKS → DFA
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Building a trie in a flat table (no node pointers)
+ * 2. Breadth-first computation of failure links
+ * 3. Compressed Sparse Row storage for per-state output lists
+ */
+
+namespace {
+    constexpr AhoCorasick::State kMissing = std::numeric_limits<AhoCorasick::State>::max();
+}
+
+/**
+ * @brief Builds the matching automaton
+ *
+ * ALGORITHM:
+ * 1. Alphabet: give every byte used by some pattern its own column;
+ *    all other bytes share column 0
+ * 2. Trie: insert each pattern; its last node records the pattern id
+ * 3. BFS from the root, level by level:
+ *    - existing edge s --c--> t: fail(t) = next(fail(s), c)
+ *    - missing edge:             next(s, c) = next(fail(s), c)
+ *    (fail(s) is on a shallower level, so its row is already final)
+ * 4. Outputs(s) = own patterns of s + outputs(fail(s)) - so a single
+ *    lookup reports "she" AND its suffix "he"
+ *
+ * TIME: O(total pattern bytes × columns)
+ */
+AhoCorasick::AhoCorasick(const std::vector<std::string>& patternList)
+    : patterns(patternList.size()) {
+    // Step 1: alphabet compression
+    for (const std::string& pattern : patternList) {
+        for (char c : pattern) {
+            auto byte = static_cast<unsigned char>(c);
+            if (byteClass[byte] == 0) {
+                byteClass[byte] = static_cast<std::uint16_t>(columns++);
+            }
+        }
+    }
+
+    // Step 2: trie (state 0 = root)
+    next.assign(columns, kMissing);
+    std::vector<std::vector<std::uint32_t>> own(1);
+    for (std::size_t id = 0; id < patternList.size(); ++id) {
+        State state = 0;
+        for (char c : patternList[id]) {
+            std::size_t slot = static_cast<std::size_t>(state) * columns +
+                               byteClass[static_cast<unsigned char>(c)];
+            if (next[slot] == kMissing) {
+                auto created = static_cast<State>(own.size());
+                own.emplace_back();
+                next.resize(next.size() + columns, kMissing);
+                next[slot] = created;
+            }
+            state = next[slot];
+        }
+        own[state].push_back(static_cast<std::uint32_t>(id));
+    }
+    const std::size_t states = own.size();
+
+    // Step 3: failure links, breadth-first
+    std::vector<State> fail(states, 0);
+    std::vector<State> order;
+    order.reserve(states);
+    for (std::size_t c = 0; c < columns; ++c) {
+        State child = next[c];
+        if (child == kMissing) {
+            next[c] = 0;   // Root: unknown byte → stay at the root
+        } else {
+            fail[child] = 0;
+            order.push_back(child);
+        }
+    }
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        State state = order[k];
+        const std::size_t row = static_cast<std::size_t>(state) * columns;
+        const std::size_t failRow = static_cast<std::size_t>(fail[state]) * columns;
+        for (std::size_t c = 0; c < columns; ++c) {
+            State child = next[row + c];
+            if (child == kMissing) {
+                next[row + c] = next[failRow + c];
+            } else {
+                fail[child] = next[failRow + c];
+                order.push_back(child);
+            }
+        }
+    }
+
+    // Step 4: merged outputs (BFS order: a failure target is always done first)
+    std::vector<std::vector<std::uint32_t>> merged(states);
+    merged[0] = own[0];
+    for (State state : order) {
+        merged[state] = own[state];
+        const auto& inherited = merged[fail[state]];
+        merged[state].insert(merged[state].end(), inherited.begin(), inherited.end());
+    }
+    outputStarts.resize(states + 1);
+    outputStarts[0] = 0;
+    for (std::size_t s = 0; s < states; ++s) {
+        outputStarts[s + 1] = outputStarts[s] + static_cast<std::uint32_t>(merged[s].size());
+        outputs.insert(outputs.end(), merged[s].begin(), merged[s].end());
+    }
+}
+
+std::size_t AhoCorasick::memoryUsage() const {
+    return next.capacity() * sizeof(State) +
+           outputStarts.capacity() * sizeof(std::uint32_t) +
+           outputs.capacity() * sizeof(std::uint32_t);
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM AHOCORASICK IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. ONE PASS, ANY NUMBER OF PATTERNS:
+ *    - The cost is per text byte, not per pattern
+ *
+ * 2. PRECOMPUTE THE HARD PART:
+ *    - Failure links are folded into the table once, at build time
+ *
+ * 3. FLAT TABLES:
+ *    - Indices into vectors instead of node pointers: compact, cache-friendly
+ */
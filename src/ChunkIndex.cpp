@@ -0,0 +1,382 @@
+#include "../include/ChunkIndex.h"
+#include "../include/FileLock.h"
+#include "../include/Logger.h"
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+/**
+ * =============================================================================
+ * CHUNKINDEX IMPLEMENTATION - CHUNK LISTS IN ONE ARENA
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Variable-length records in a flat file (header + count + payload)
+ * 2. Offset/count "spans" into one shared vector instead of a vector per file
+ * 3. Bounds-checked parsing of a file that may be torn or foreign
+ * 4. Last-used days as the eviction rule of a file shared by many runs
+ */
+
+namespace {
+
+    constexpr char kMagic[8] = {'S', 'F', 'M', 'C', 'H', 'N', 'K', '\0'};
+    constexpr std::uint32_t kEndianMarker = 0x01020304u;
+    constexpr std::size_t kDiskChunkBytes = 12;       // fingerprint (8) + length (4), unpadded
+
+    struct IndexHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t endianMarker;
+        std::uint32_t minSize;
+        std::uint32_t averageSize;
+        std::uint32_t maxSize;
+        std::uint32_t reserved;
+    };
+
+    struct FileRecord {
+        std::uint64_t device;
+        std::uint64_t inode;
+        std::uint64_t size;
+        std::int64_t mtimeNs;
+        std::uint32_t chunkCount;
+        std::uint32_t day;             // Days since 1970 the file was last stored or hit
+    };
+
+    static_assert(sizeof(IndexHeader) == 32, "header layout is part of the file format");
+    static_assert(sizeof(FileRecord) == 40, "record layout is part of the file format");
+    static_assert(std::is_trivially_copyable<FileRecord>::value, "raw record block");
+}
+
+std::string ChunkIndex::defaultPath() {
+    return (fs::path(".sfm_cache") / "chunks.sfmci").string();
+}
+
+std::size_t ChunkIndex::InodeHasher::operator()(const std::pair<std::uint64_t, std::uint64_t>& key) const {
+    std::uint64_t h = key.second * 0x9E3779B97F4A7C15ULL;
+    h ^= (h >> 29) + key.first;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+ChunkIndex::ChunkIndex(std::string indexPath, const ChunkerOptions& chunkerOptions)
+    : path(std::move(indexPath)), options(chunkerOptions) {
+    using Days = std::chrono::duration<std::int64_t, std::ratio<86400>>;
+    today = static_cast<std::uint32_t>(
+        std::chrono::duration_cast<Days>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+ChunkIndex::~ChunkIndex() {
+    flush();
+}
+
+void ChunkIndex::ensureLoaded() {
+    if (!loaded) {
+        loaded = true;
+        load();
+    }
+}
+
+/**
+ * @brief Reads the index under a shared lock
+ *
+ * A missing index starts empty; a foreign or torn one is rewritten on flush.
+ */
+void ChunkIndex::load() {
+    FileLock lock(path + ".lock", FileLock::Mode::Shared);
+    if (!replay(false)) {
+        return;
+    }
+    Logger::getInstance().log("Chunk index loaded: " + std::to_string(entries.size()) + " files, " +
+                              std::to_string(liveChunks) + " chunks from " + path);
+}
+
+/**
+ * @brief Adds every complete file record to the arena
+ *
+ * ALGORITHM:
+ * 1. mmap the file; missing, foreign or other chunk sizes → nothing added
+ * 2. Per record: check the claimed chunk count against the bytes left
+ *    BEFORE reserving anything
+ * 3. An entry we already hold for the same (device, inode) wins if it is
+ *    the newer version; only otherwise are the chunks copied in
+ * 4. A torn last record is dropped and the file rewritten on flush
+ *
+ * With merging set (called from rewrite()), entries other processes
+ * wrote since our load() are picked up; the file is replaced anyway, so
+ * damage does not mark the index dirty.
+ *
+ * @return false if the file was missing or unusable
+ */
+bool ChunkIndex::replay(bool merging) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        return false;
+    }
+    IndexHeader header;
+    if (file.size() < sizeof(header)) {
+        dirty = dirty || !merging;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.endianMarker != kEndianMarker) {
+        Logger::getInstance().log("Chunk index ignored (incompatible or damaged): " + path);
+        dirty = dirty || !merging;
+        return false;
+    }
+    if (header.minSize != options.minSize || header.averageSize != options.averageSize ||
+        header.maxSize != options.maxSize) {
+        Logger::getInstance().log("Chunk index ignored (written with other chunk sizes): " + path);
+        dirty = dirty || !merging;
+        return false;
+    }
+
+    const char* cursor = file.data() + sizeof(header);
+    const char* end = file.data() + file.size();
+    while (cursor != end) {
+        FileRecord record;
+        if (static_cast<std::size_t>(end - cursor) < sizeof(record)) {
+            break;
+        }
+        std::memcpy(&record, cursor, sizeof(record));
+        const std::size_t left = static_cast<std::size_t>(end - cursor) - sizeof(record);
+        if (record.chunkCount > left / kDiskChunkBytes) {
+            break;
+        }
+        cursor += sizeof(record);
+        const char* chunkBytes = cursor;
+        cursor += static_cast<std::size_t>(record.chunkCount) * kDiskChunkBytes;
+
+        auto inserted = entries.try_emplace({record.device, record.inode});
+        Entry& entry = inserted.first->second;
+        if (!inserted.second) {
+            if (entry.identity.mtimeNs == record.mtimeNs && entry.identity.size == record.size) {
+                entry.day = std::max(entry.day, record.day);   // Same version - keep the later use
+                continue;
+            }
+            if (entry.identity.mtimeNs > record.mtimeNs) {
+                continue;                                      // Ours is newer
+            }
+            liveChunks -= entry.count;
+        }
+        entry.identity.device = record.device;
+        entry.identity.inode = record.inode;
+        entry.identity.size = record.size;
+        entry.identity.mtimeNs = record.mtimeNs;
+        entry.first = arena.size();
+        entry.count = record.chunkCount;
+        entry.day = record.day;
+        arena.reserve(arena.size() + entry.count);
+        for (std::uint32_t k = 0; k < entry.count; ++k, chunkBytes += kDiskChunkBytes) {
+            Chunk chunk;
+            std::memcpy(&chunk.fingerprint, chunkBytes, sizeof(chunk.fingerprint));
+            std::memcpy(&chunk.length, chunkBytes + sizeof(chunk.fingerprint), sizeof(chunk.length));
+            arena.push_back(chunk);
+        }
+        liveChunks += entry.count;
+    }
+    if (cursor != end) {
+        Logger::getInstance().log("Chunk index: ignoring torn record at the end of " + path);
+        dirty = dirty || !merging;
+    }
+    return true;
+}
+
+bool ChunkIndex::lookup(const FileIdentity& identity, std::vector<Chunk>& chunks) {
+    if (!identity.known()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    ensureLoaded();
+    auto it = entries.find({identity.device, identity.inode});
+    if (it == entries.end() || it->second.identity != identity) {
+        return false;
+    }
+    if (it->second.day + kRefreshDays < today) {
+        it->second.day = today;   // Still in use - persist that at most weekly
+        dirty = true;
+    }
+    const Chunk* first = arena.data() + it->second.first;
+    chunks.assign(first, first + it->second.count);
+    return true;
+}
+
+/**
+ * Teaching Point: A replaced list stays in the arena as dead space until
+ * the next rewrite() - moving every later list to close the gap would
+ * cost far more than the few MB it frees.
+ */
+void ChunkIndex::store(const FileIdentity& identity, const std::vector<Chunk>& chunks) {
+    if (!identity.known()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    ensureLoaded();
+    Entry& entry = entries[{identity.device, identity.inode}];
+    if (entry.identity == identity && entry.count == chunks.size()) {
+        return;   // Same version - nothing new (lookup() dates it)
+    }
+    liveChunks -= entry.count;
+    entry.identity = identity;
+    entry.first = arena.size();
+    entry.count = static_cast<std::uint32_t>(chunks.size());
+    entry.day = today;
+    arena.insert(arena.end(), chunks.begin(), chunks.end());
+    liveChunks += entry.count;
+    dirty = true;
+}
+
+std::size_t ChunkIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+bool ChunkIndex::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty || entries.empty()) {
+        return true;   // Never create an empty index file
+    }
+    std::error_code ec;
+    const fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+    FileLock fileLock(path + ".lock", FileLock::Mode::Exclusive);
+    if (!fileLock.held()) {
+        Logger::getInstance().log("ERROR: Cannot lock chunk index: " + path);
+        return false;
+    }
+    return rewrite();
+}
+
+/**
+ * @brief Erases entries no run has used for kKeepDays (mutex held)
+ *
+ * Every file of the catalog being searched is looked up or stored in the
+ * run, so its entry is current; what expires are deleted files and roots
+ * nobody searches any more. Their chunks become dead arena space that
+ * rewrite() compacts away.
+ */
+void ChunkIndex::prune() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.day + kKeepDays < today) {
+            liveChunks -= it->second.count;
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Writes every live entry to a temp file, renames it over the index
+ *
+ * Called with the exclusive file lock held. The file is replayed first,
+ * so entries other processes wrote since our load() survive the rename;
+ * then expired entries are pruned. The arena is compacted on the way:
+ * live lists are copied into a fresh arena in the order they are written.
+ */
+bool ChunkIndex::rewrite() {
+    replay(true);
+    prune();
+    std::error_code ec;
+    if (entries.empty()) {
+        fs::remove(path, ec);   // Everything expired - no empty index file
+        dirty = false;
+        return true;
+    }
+
+    const std::string tempPath = FileLock::temporaryPath(path);
+    std::vector<Chunk> compacted;
+    compacted.reserve(static_cast<std::size_t>(liveChunks));
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Logger::getInstance().log("ERROR: Cannot write chunk index: " + tempPath);
+            return false;
+        }
+        IndexHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.endianMarker = kEndianMarker;
+        header.minSize = options.minSize;
+        header.averageSize = options.averageSize;
+        header.maxSize = options.maxSize;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<char> block;
+        for (auto& item : entries) {
+            Entry& entry = item.second;
+            FileRecord record{};
+            record.device = entry.identity.device;
+            record.inode = entry.identity.inode;
+            record.size = entry.identity.size;
+            record.mtimeNs = entry.identity.mtimeNs;
+            record.chunkCount = entry.count;
+            record.day = entry.day;
+            out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+            block.resize(static_cast<std::size_t>(entry.count) * kDiskChunkBytes);
+            char* cursor = block.data();
+            const std::uint64_t first = compacted.size();
+            for (std::uint32_t k = 0; k < entry.count; ++k, cursor += kDiskChunkBytes) {
+                const Chunk& chunk = arena[entry.first + k];
+                std::memcpy(cursor, &chunk.fingerprint, sizeof(chunk.fingerprint));
+                std::memcpy(cursor + sizeof(chunk.fingerprint), &chunk.length, sizeof(chunk.length));
+                compacted.push_back(chunk);
+            }
+            entry.first = first;
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        }
+        if (!out) {
+            Logger::getInstance().log("ERROR: Writing chunk index failed: " + tempPath);
+            fs::remove(tempPath, ec);
+            arena.swap(compacted);   // Entries already point into the compacted arena
+            return false;
+        }
+    }
+    arena.swap(compacted);
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        Logger::getInstance().log("ERROR: Cannot replace chunk index: " + ec.message());
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    dirty = false;
+    Logger::getInstance().log("Chunk index written: " + std::to_string(entries.size()) + " files, " +
+                              std::to_string(liveChunks) + " chunks to " + path);
+    return true;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM CHUNKINDEX IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. SPANS, NOT NESTED VECTORS:
+ *    - One arena + (offset, count) per file: one allocation for millions
+ *      of chunks, and lists copy out with a single assign()
+ *
+ * 2. THE FORMAT PARAMETERS ARE PART OF THE KEY:
+ *    - Chunks cut with other sizes can never match; the header says which
+ *      sizes the file holds
+ *
+ * 3. FAIL SOFT (like HashCache):
+ *    - A missing, foreign or torn index only costs re-reading files
+ *
+ * 4. EVICT BY LAST USE, NOT BY ONE CATALOG:
+ *    - The file is shared by every root searched from this directory;
+ *      entries age out when no run has touched them for kKeepDays
+ *
+ * 5. MERGE BEFORE REPLACING:
+ *    - A rewrite under the exclusive lock re-reads the file first, so
+ *      concurrent runs add to the index instead of overwriting each other
+ *
+ * =============================================================================
+ */
@@ -0,0 +1,160 @@
+#include "../include/ContentChunker.h"
+#include <algorithm>
+#include <array>
+
+/**
+ * =============================================================================
+ * CONTENTCHUNKER IMPLEMENTATION
+ * =============================================================================
+ */
+
+namespace {
+
+    /**
+     * @brief SplitMix64 step - fills the Gear table at compile time
+     */
+    constexpr std::uint64_t splitMix(std::uint64_t& state) {
+        state += 0x9E3779B97F4A7C15ULL;
+        std::uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * Teaching Point: The table is part of the chunk format - a different
+     * table gives different boundaries, and every ChunkIndex entry would
+     * stop matching. A fixed seed keeps it identical across builds.
+     */
+    constexpr std::array<std::uint64_t, 256> makeGearTable() {
+        std::array<std::uint64_t, 256> table{};
+        std::uint64_t state = 0x5346'4D43'4443'0001ULL;     // "SFMCDC" + 1
+        for (std::size_t b = 0; b < table.size(); ++b) {
+            table[b] = splitMix(state);
+        }
+        return table;
+    }
+
+    constexpr std::array<std::uint64_t, 256> kGear = makeGearTable();
+
+    /**
+     * @brief Mask of the top `bits` bits (the ones with a 64-byte window)
+     */
+    constexpr std::uint64_t topBits(unsigned bits) {
+        return bits == 0 ? 0 : ~0ULL << (64 - bits);
+    }
+
+    unsigned log2Floor(std::uint32_t value) {
+        unsigned bits = 0;
+        while (value > 1) {
+            value >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+}
+
+/**
+ * Teaching Point: A 1-in-2^n boundary test gives chunks of 2^n bytes on
+ * average, so averageSize picks the mask width. Normalization level 2:
+ * n + 2 bits before the average, n - 2 after.
+ */
+ContentChunker::ContentChunker(const ChunkerOptions& options) : limits(options) {
+    const unsigned bits = log2Floor(std::max<std::uint32_t>(limits.averageSize, 256));
+    limits.averageSize = 1u << bits;
+    limits.minSize = std::min(limits.minSize, limits.averageSize);
+    limits.maxSize = std::max(limits.maxSize, limits.averageSize);
+    maskSmall = topBits(bits + 2);
+    maskLarge = topBits(bits - 2);
+}
+
+/**
+ * @brief Chunks one piece of the stream
+ *
+ * ALGORITHM per step:
+ * 1. Below minSize: skip ahead - these bytes are only fingerprinted
+ * 2. Otherwise roll the Gear hash up to the next size limit (average or
+ *    maximum) with that section's mask, stopping at the first zero test
+ * 3. A hit, or reaching maxSize, ends the chunk
+ *
+ * The fingerprint hasher is fed once per contiguous run of bytes, not
+ * per byte.
+ */
+void ContentChunker::update(const void* data, std::size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    std::size_t runStart = 0;          // First byte not yet fed to the hasher
+    while (i < length) {
+        if (position < limits.minSize) {
+            const std::size_t skip = std::min<std::size_t>(length - i, limits.minSize - position);
+            i += skip;
+            position += static_cast<std::uint32_t>(skip);
+            continue;
+        }
+
+        const bool early = position < limits.averageSize;
+        const std::uint64_t mask = early ? maskSmall : maskLarge;
+        const std::uint32_t limit = early ? limits.averageSize : limits.maxSize;
+        const std::size_t stop = i + std::min<std::size_t>(length - i, limit - position);
+        std::uint64_t h = gear;
+        std::size_t j = i;
+        bool hit = false;
+        while (j < stop) {
+            h = (h << 1) + kGear[bytes[j++]];
+            if ((h & mask) == 0) {
+                hit = true;
+                break;
+            }
+        }
+        gear = h;
+        position += static_cast<std::uint32_t>(j - i);
+        i = j;
+
+        if (hit || position >= limits.maxSize) {
+            hasher.update(bytes + runStart, i - runStart);
+            runStart = i;
+            cut();
+        }
+    }
+    hasher.update(bytes + runStart, length - runStart);
+}
+
+void ContentChunker::finish() {
+    if (position > 0) {
+        cut();
+    }
+}
+
+void ContentChunker::cut() {
+    done.push_back(Chunk{hasher.digest(), position});
+    hasher = XXHash64();
+    gear = 0;
+    position = 0;
+}
+
+std::vector<Chunk> ContentChunker::take() {
+    std::vector<Chunk> result;
+    result.swap(done);
+    hasher = XXHash64();
+    gear = 0;
+    position = 0;
+    return result;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM CONTENTCHUNKER
+ * =============================================================================
+ *
+ * 1. BOUNDARIES FROM CONTENT: an insert or append disturbs only the chunks
+ *    around it, so edited copies still share most fingerprints.
+ *
+ * 2. THE CHEAPEST BYTE IS THE ONE NOT HASHED: cut-point skipping leaves
+ *    the first minSize bytes of every chunk to the fingerprint alone.
+ *
+ * 3. NORMALIZE THE DISTRIBUTION: two masks keep chunks near the average -
+ *    fewer tiny chunks (index bloat) and fewer forced cuts at maxSize
+ *    (which are offset-dependent again).
+ *
+ * =============================================================================
+ */
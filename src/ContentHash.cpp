@@ -0,0 +1,177 @@
+#include "../include/ContentHash.h"
+#include <cstring>
+
+/**
+ * =============================================================================
+ * XXHASH64 IMPLEMENTATION
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Bit manipulation (rotations, multiplications modulo 2^64)
+ * 2. A streaming hash with a small carry-over buffer
+ * 3. Endian-independent reads via memcpy
+ */
+
+namespace {
+
+    constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+    inline std::uint64_t rotl(std::uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    /**
+     * Teaching Point: memcpy instead of *(uint64_t*)p
+     * Casting a char pointer to uint64_t* breaks alignment and aliasing
+     * rules (undefined behaviour). memcpy of 8 bytes compiles to a single
+     * load on every modern compiler.
+     */
+    inline std::uint64_t read64(const unsigned char* p) {
+        std::uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = __builtin_bswap64(value);
+#endif
+        return value;
+    }
+
+    inline std::uint32_t read32(const unsigned char* p) {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = __builtin_bswap32(value);
+#endif
+        return value;
+    }
+
+    inline std::uint64_t round(std::uint64_t accumulator, std::uint64_t input) {
+        accumulator += input * kPrime2;
+        accumulator = rotl(accumulator, 31);
+        return accumulator * kPrime1;
+    }
+
+    inline std::uint64_t mergeRound(std::uint64_t hash, std::uint64_t accumulator) {
+        hash ^= round(0, accumulator);
+        return hash * kPrime1 + kPrime4;
+    }
+}
+
+XXHash64::XXHash64(std::uint64_t seedValue) : seed(seedValue) {
+    accumulators[0] = seedValue + kPrime1 + kPrime2;
+    accumulators[1] = seedValue + kPrime2;
+    accumulators[2] = seedValue;
+    accumulators[3] = seedValue - kPrime1;
+}
+
+/**
+ * @brief Consumes input in 32-byte stripes
+ *
+ * ALGORITHM:
+ * 1. Top up the pending buffer; if it fills, process it as one stripe
+ * 2. Process full stripes straight from the caller's memory (no copy)
+ * 3. Keep the remaining < 32 bytes for next time
+ */
+void XXHash64::update(const void* data, std::size_t length) {
+    const auto* input = static_cast<const unsigned char*>(data);
+    totalLength += length;
+
+    if (pendingSize + length < 32) {
+        std::memcpy(pending + pendingSize, input, length);
+        pendingSize += length;
+        return;
+    }
+
+    if (pendingSize > 0) {
+        std::size_t fill = 32 - pendingSize;
+        std::memcpy(pending + pendingSize, input, fill);
+        for (int lane = 0; lane < 4; ++lane) {
+            accumulators[lane] = round(accumulators[lane], read64(pending + lane * 8));
+        }
+        input += fill;
+        length -= fill;
+        pendingSize = 0;
+    }
+
+    while (length >= 32) {
+        accumulators[0] = round(accumulators[0], read64(input));
+        accumulators[1] = round(accumulators[1], read64(input + 8));
+        accumulators[2] = round(accumulators[2], read64(input + 16));
+        accumulators[3] = round(accumulators[3], read64(input + 24));
+        input += 32;
+        length -= 32;
+    }
+
+    if (length > 0) {
+        std::memcpy(pending, input, length);
+        pendingSize = length;
+    }
+}
+
+std::uint64_t XXHash64::digest() const {
+    std::uint64_t hash;
+    if (totalLength >= 32) {
+        hash = rotl(accumulators[0], 1) + rotl(accumulators[1], 7) +
+               rotl(accumulators[2], 12) + rotl(accumulators[3], 18);
+        for (int lane = 0; lane < 4; ++lane) {
+            hash = mergeRound(hash, accumulators[lane]);
+        }
+    } else {
+        hash = seed + kPrime5;
+    }
+    hash += totalLength;
+
+    // Tail: 8, then 4, then 1 byte at a time
+    const unsigned char* p = pending;
+    std::size_t remaining = pendingSize;
+    while (remaining >= 8) {
+        hash ^= round(0, read64(p));
+        hash = rotl(hash, 27) * kPrime1 + kPrime4;
+        p += 8;
+        remaining -= 8;
+    }
+    if (remaining >= 4) {
+        hash ^= static_cast<std::uint64_t>(read32(p)) * kPrime1;
+        hash = rotl(hash, 23) * kPrime2 + kPrime3;
+        p += 4;
+        remaining -= 4;
+    }
+    while (remaining > 0) {
+        hash ^= static_cast<std::uint64_t>(*p) * kPrime5;
+        hash = rotl(hash, 11) * kPrime1;
+        ++p;
+        --remaining;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::uint64_t XXHash64::hash(const void* data, std::size_t length, std::uint64_t seedValue) {
+    XXHash64 hasher(seedValue);
+    hasher.update(data, length);
+    return hasher.digest();
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM XXHASH64 IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. INSTRUCTION-LEVEL PARALLELISM:
+ *    - Four independent accumulators keep the CPU's multipliers busy
+ *
+ * 2. SAFE MEMORY ACCESS:
+ *    - memcpy-based loads avoid alignment and aliasing bugs
+ *
+ * 3. STREAMING:
+ *    - A 32-byte carry buffer makes piecewise hashing equal to one-shot
+ */
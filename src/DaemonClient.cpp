@@ -0,0 +1,111 @@
+#include "../include/DaemonClient.h"
+#include <cerrno>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+/**
+ * =============================================================================
+ * DAEMONCLIENT IMPLEMENTATION
+ * =============================================================================
+ */
+
+DaemonClient::DaemonClient(std::string socketPath) : path(std::move(socketPath)) {
+}
+
+DaemonClient::~DaemonClient() {
+    close();
+}
+
+#ifndef _WIN32
+
+bool DaemonClient::connect() {
+    close();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        lastError = "socket path too long: " + path;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        lastError = std::string("socket(): ") + std::strerror(errno);
+        return false;
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        lastError = "no daemon on " + path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Teaching Point: A daemon at its client limit answers Busy and hangs up
+ * without reading the request - so a failed send is not the end: the
+ * answer may already be waiting. Only if nothing can be read is the
+ * send error reported.
+ */
+bool DaemonClient::call(const DaemonRequest& request, DaemonResponse& response) {
+    if (fd < 0 && !connect()) {
+        return false;
+    }
+    const bool sent = wire::writeFrame(fd, request.encode());
+    const int sendError = errno;
+    std::string payload;
+    if (!wire::readFrame(fd, payload, wire::kMaxResponseBytes)) {
+        lastError = !sent ? std::string("sending the request failed: ") + std::strerror(sendError)
+                          : std::string("the daemon closed the connection");
+        close();
+        return false;
+    }
+    if (!response.decode(request.op, payload)) {
+        lastError = "malformed response (protocol version mismatch?)";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void DaemonClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+#else
+
+bool DaemonClient::connect() {
+    lastError = "daemon mode needs Unix domain sockets (not supported on this platform)";
+    return false;
+}
+
+bool DaemonClient::call(const DaemonRequest&, DaemonResponse&) {
+    return connect();
+}
+
+void DaemonClient::close() {}
+
+#endif
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM DAEMONCLIENT
+ * =============================================================================
+ *
+ * 1. TRANSPORT ERRORS VS ANSWERS: call() fails only when no answer arrived;
+ *    "bad query" or "busy" are answers, carried in response.status.
+ *
+ * 2. CONNECTIONS ARE REUSABLE: the framing lets one socket carry many
+ *    request/response pairs, saving a connect() per query.
+ *
+ * =============================================================================
+ */
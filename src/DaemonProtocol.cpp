@@ -0,0 +1,381 @@
+#include "../include/DaemonProtocol.h"
+#include <cerrno>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
+
+/**
+ * =============================================================================
+ * DAEMONPROTOCOL IMPLEMENTATION
+ * =============================================================================
+ */
+
+namespace wire {
+
+    void Writer::fixed64(std::uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            buffer.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    /**
+     * @brief LEB128: low 7 bits first, high bit set on every byte but the last
+     */
+    void Writer::varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    std::uint8_t Reader::u8() {
+        if (!good || position >= data.size()) {
+            good = false;
+            return 0;
+        }
+        return static_cast<std::uint8_t>(data[position++]);
+    }
+
+    std::uint64_t Reader::fixed64() {
+        if (!good || data.size() - position < 8) {
+            good = false;
+            return 0;
+        }
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 8) {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[position++])) << shift;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Decodes LEB128; more than 10 bytes is malformed, not a bigger number
+     */
+    std::uint64_t Reader::varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t byte = u8();
+            if (!good) {
+                return 0;
+            }
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        good = false;
+        return 0;
+    }
+
+    std::string Reader::string() {
+        const std::uint64_t length = varint();
+        if (!good || length > data.size() - position) {
+            good = false;
+            return std::string();
+        }
+        std::string text(data.substr(position, static_cast<std::size_t>(length)));
+        position += static_cast<std::size_t>(length);
+        return text;
+    }
+
+#ifndef _WIN32
+    namespace {
+
+        bool sendAll(int fd, const char* bytes, std::size_t length) {
+#ifdef MSG_NOSIGNAL
+            constexpr int kFlags = MSG_NOSIGNAL;    // EPIPE instead of a process-killing SIGPIPE
+#else
+            constexpr int kFlags = 0;               // Callers ignore SIGPIPE on these systems
+#endif
+            while (length > 0) {
+                const ssize_t sent = ::send(fd, bytes, length, kFlags);
+                if (sent < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                bytes += sent;
+                length -= static_cast<std::size_t>(sent);
+            }
+            return true;
+        }
+
+        bool receiveAll(int fd, char* bytes, std::size_t length) {
+            while (length > 0) {
+                const ssize_t received = ::recv(fd, bytes, length, 0);
+                if (received == 0) {
+                    return false;                   // Peer closed the connection
+                }
+                if (received < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;                   // Includes EAGAIN from SO_RCVTIMEO
+                }
+                bytes += received;
+                length -= static_cast<std::size_t>(received);
+            }
+            return true;
+        }
+
+    }  // namespace
+
+    /**
+     * Teaching Point: A stream socket has no message boundaries - one send()
+     * may arrive as three recv()s. The length prefix restores them, and
+     * header + payload go out in ONE send for small frames so the peer never
+     * waits on a 4-byte packet.
+     */
+    bool writeFrame(int fd, std::string_view payload) {
+        if (payload.size() > 0xFFFFFFFFu) {
+            return false;
+        }
+        const std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+        char header[4] = {
+            static_cast<char>(length & 0xFF), static_cast<char>((length >> 8) & 0xFF),
+            static_cast<char>((length >> 16) & 0xFF), static_cast<char>((length >> 24) & 0xFF)
+        };
+        if (payload.size() <= 4096) {
+            std::string frame(header, sizeof(header));
+            frame.append(payload.data(), payload.size());
+            return sendAll(fd, frame.data(), frame.size());
+        }
+        return sendAll(fd, header, sizeof(header)) && sendAll(fd, payload.data(), payload.size());
+    }
+
+    bool readFrame(int fd, std::string& payload, std::size_t maxBytes) {
+        unsigned char header[4];
+        if (!receiveAll(fd, reinterpret_cast<char*>(header), sizeof(header))) {
+            return false;
+        }
+        const std::size_t length = static_cast<std::size_t>(header[0]) |
+                                   static_cast<std::size_t>(header[1]) << 8 |
+                                   static_cast<std::size_t>(header[2]) << 16 |
+                                   static_cast<std::size_t>(header[3]) << 24;
+        if (length > maxBytes) {
+            return false;                           // Never allocate what a peer merely claims
+        }
+        payload.resize(length);
+        return length == 0 || receiveAll(fd, &payload[0], length);
+    }
+#else
+    bool writeFrame(int, std::string_view) { return false; }
+    bool readFrame(int, std::string&, std::size_t) { return false; }
+#endif
+
+}  // namespace wire
+
+std::string DaemonRequest::encode() const {
+    wire::Writer out;
+    out.u8(wire::kVersion);
+    out.u8(static_cast<std::uint8_t>(op));
+    switch (op) {
+        case wire::Op::Search:
+            out.u8(fuzzy ? wire::kSearchFuzzy : 0);
+            out.varint(limit);
+            out.string(text);
+            break;
+        case wire::Op::Query:
+            out.varint(limit);
+            out.string(text);
+            break;
+        case wire::Op::Duplicates:
+            out.varint(limit);
+            break;
+        case wire::Op::AddRoot:
+        case wire::Op::DropRoot:
+            out.string(text);
+            break;
+        default:
+            break;
+    }
+    return out.take();
+}
+
+bool DaemonRequest::decode(std::string_view payload) {
+    wire::Reader in(payload);
+    if (in.u8() != wire::kVersion) {
+        return false;
+    }
+    op = static_cast<wire::Op>(in.u8());
+    fuzzy = false;
+    limit = 0;
+    text.clear();
+    switch (op) {
+        case wire::Op::Search:
+            fuzzy = (in.u8() & wire::kSearchFuzzy) != 0;
+            limit = in.varint();
+            text = in.string();
+            break;
+        case wire::Op::Query:
+            limit = in.varint();
+            text = in.string();
+            break;
+        case wire::Op::Duplicates:
+            limit = in.varint();
+            break;
+        case wire::Op::AddRoot:
+        case wire::Op::DropRoot:
+            text = in.string();
+            break;
+        case wire::Op::Ping:
+        case wire::Op::Stats:
+        case wire::Op::Rescan:
+            break;
+        default:
+            return false;                           // Unknown op
+    }
+    return in.ok() && in.atEnd();
+}
+
+std::string DaemonResponse::encode(wire::Op op) const {
+    wire::Writer out;
+    out.u8(wire::kVersion);
+    out.u8(static_cast<std::uint8_t>(status));
+    out.varint(epoch);
+    if (status != wire::Status::Ok) {
+        out.string(message);
+        return out.take();
+    }
+    switch (op) {
+        case wire::Op::Ping:
+        case wire::Op::Rescan:
+            out.varint(files);
+            break;
+        case wire::Op::AddRoot:
+        case wire::Op::DropRoot:
+            out.varint(files);
+            out.varint(roots);
+            break;
+        case wire::Op::Stats:
+            out.varint(files);
+            out.varint(directories);
+            out.varint(bytes);
+            out.varint(ageMs);
+            out.varint(requests);
+            out.varint(clients);
+            out.u8(watching ? 1 : 0);
+            break;
+        case wire::Op::Search:
+        case wire::Op::Query:
+            out.varint(total);
+            out.varint(results.size());
+            for (const RemoteFile& file : results) {
+                out.string(file.path);
+                out.varint(file.size);
+                out.zigzag(file.mtimeNs);
+                out.varint(static_cast<std::uint64_t>(file.errors + 1));   // 0 = not fuzzy
+            }
+            break;
+        case wire::Op::Duplicates:
+            out.varint(total);
+            out.varint(reclaimable);
+            out.varint(groups.size());
+            for (const RemoteGroup& group : groups) {
+                out.varint(group.size);
+                out.fixed64(group.hash);
+                out.varint(group.paths.size());
+                for (const std::string& path : group.paths) {
+                    out.string(path);
+                }
+            }
+            break;
+    }
+    return out.take();
+}
+
+/**
+ * Teaching Point: Counts come off the wire, so they bound nothing - a
+ * claimed count is only trusted as far as the bytes actually present
+ * (every entry needs at least one byte), never as a reserve() size.
+ */
+bool DaemonResponse::decode(wire::Op op, std::string_view payload) {
+    wire::Reader in(payload);
+    if (in.u8() != wire::kVersion) {
+        return false;
+    }
+    status = static_cast<wire::Status>(in.u8());
+    epoch = in.varint();
+    results.clear();
+    groups.clear();
+    if (status != wire::Status::Ok) {
+        message = in.string();
+        return in.ok();
+    }
+    switch (op) {
+        case wire::Op::Ping:
+        case wire::Op::Rescan:
+            files = in.varint();
+            break;
+        case wire::Op::AddRoot:
+        case wire::Op::DropRoot:
+            files = in.varint();
+            roots = in.varint();
+            break;
+        case wire::Op::Stats:
+            files = in.varint();
+            directories = in.varint();
+            bytes = in.varint();
+            ageMs = in.varint();
+            requests = in.varint();
+            clients = in.varint();
+            watching = in.u8() != 0;
+            break;
+        case wire::Op::Search:
+        case wire::Op::Query: {
+            total = in.varint();
+            const std::uint64_t count = in.varint();
+            for (std::uint64_t k = 0; k < count && in.ok(); ++k) {
+                RemoteFile file;
+                file.path = in.string();
+                file.size = in.varint();
+                file.mtimeNs = in.zigzag();
+                file.errors = static_cast<std::int64_t>(in.varint()) - 1;
+                results.push_back(std::move(file));
+            }
+            break;
+        }
+        case wire::Op::Duplicates: {
+            total = in.varint();
+            reclaimable = in.varint();
+            const std::uint64_t count = in.varint();
+            for (std::uint64_t k = 0; k < count && in.ok(); ++k) {
+                RemoteGroup group;
+                group.size = in.varint();
+                group.hash = in.fixed64();
+                const std::uint64_t members = in.varint();
+                for (std::uint64_t m = 0; m < members && in.ok(); ++m) {
+                    group.paths.push_back(in.string());
+                }
+                groups.push_back(std::move(group));
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+    return in.ok() && in.atEnd();
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM DAEMONPROTOCOL
+ * =============================================================================
+ *
+ * 1. FRAME EVERYTHING: a length prefix turns a byte stream into messages,
+ *    and a maximum length keeps one bad peer from allocating gigabytes.
+ *
+ * 2. VARINTS MAKE A BINARY PROTOCOL COMPACT WITHOUT COMPRESSION: a search
+ *    result costs its path plus ~6 bytes, JSON would add ~60.
+ *
+ * 3. VERSION BYTE FIRST: a future v2 daemon can still answer (or reject
+ *    cleanly) a v1 client.
+ *
+ * 4. DECODE DEFENSIVELY: bounds-checked reads, bounded varints, counts
+ *    trusted no further than the bytes present, atEnd() for trailing junk.
+ *
+ * =============================================================================
+ */
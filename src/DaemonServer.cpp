@@ -0,0 +1,583 @@
+#include "../include/DaemonServer.h"
+#include "../include/HashCache.h"
+#include "../include/Logger.h"
+#include "../include/Metrics.h"
+#include "../include/FileQuery.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
+
+/**
+ * =============================================================================
+ * DAEMONSERVER IMPLEMENTATION
+ * =============================================================================
+ *
+ * Teaching Point: WHY A DAEMON?
+ * A batch search scans the tree every time - seconds on a large home
+ * directory. The daemon pays for the scan once, keeps the catalog current
+ * from watch events, and answers each later request from memory with
+ * warm indexes: the cost of a search becomes the search itself.
+ */
+
+volatile std::sig_atomic_t DaemonServer::signalled = 0;
+
+namespace {
+
+    constexpr std::size_t kDefaultFuzzyLimit = 50;
+    constexpr int kAcceptPollMs = 200;       // How quickly the acceptor notices a stop
+
+    std::size_t clampLimit(std::uint64_t limit, std::size_t available) {
+        return limit == 0 || limit > available ? available : static_cast<std::size_t>(limit);
+    }
+
+    RemoteFile remoteFile(const FileCatalog& files, FileCatalog::Index i, std::int64_t errors = -1) {
+        RemoteFile file;
+        file.path = std::string(files.path(i));
+        file.size = files.fileSize(i);
+        file.mtimeNs = files.fileMtime(i);
+        file.errors = errors;
+        return file;
+    }
+
+    std::vector<std::string> allRoots(const DaemonOptions& options) {
+        std::vector<std::string> roots{options.directory};
+        roots.insert(roots.end(), options.extraRoots.begin(), options.extraRoots.end());
+        return roots;
+    }
+
+    DaemonResponse failure(wire::Status status, std::string message) {
+        DaemonResponse response;
+        response.status = status;
+        response.message = std::move(message);
+        return response;
+    }
+
+}  // namespace
+
+/**
+ * @brief Content-verified groups of this epoch, computed by the first caller
+ *
+ * Teaching Point: findDuplicates() writes the catalog's hash column, so
+ * two runs must not overlap on one catalog - the mutex serializes them,
+ * and everyone after the first gets the stored result. Searches on the
+ * same snapshot never take this mutex.
+ */
+const DuplicateResult& DaemonServer::Snapshot::duplicateGroups() {
+    std::lock_guard<std::mutex> lock(duplicatesMutex);
+    if (!duplicatesReady) {
+        duplicates = searcher.findDuplicates(files);
+        duplicatesReady = true;
+    }
+    return duplicates;
+}
+
+DaemonServer::DaemonServer(DaemonOptions daemonOptions, std::shared_ptr<HashCache> cache)
+    : options(std::move(daemonOptions)),
+      hashCache(std::move(cache)),
+      searchPool(std::make_shared<ThreadPool>(options.scan.threadCount)),
+      manager(allRoots(options)) {
+    if (options.socketPath.empty()) {
+        options.socketPath = defaultSocketPath();
+    }
+    if (options.maxClients == 0) {
+        options.maxClients = 1;
+    }
+}
+
+DaemonServer::~DaemonServer() {
+    stopping = true;
+    wake.notify_all();
+    if (publisherThread.joinable()) {
+        publisherThread.join();
+    }
+    reapConnections(true);
+    closeSocket();
+}
+
+std::string DaemonServer::defaultSocketPath() {
+    if (const char* path = std::getenv("SFM_SOCKET"); path != nullptr && *path != '\0') {
+        return path;
+    }
+#ifndef _WIN32
+    return "/tmp/sfm-" + std::to_string(::getuid()) + ".sock";
+#else
+    return "sfm.sock";
+#endif
+}
+
+void DaemonServer::onSignal(int) {
+    signalled = 1;      // Only async-signal-safe work here; the loops poll the flag
+}
+
+void DaemonServer::installSignalHandlers() {
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+#ifndef _WIN32
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+}
+
+/**
+ * @brief Publishes the live catalog as a new epoch if it changed
+ *
+ * ALGORITHM:
+ * 1. Shared lock on the live catalog; same revision as the current
+ *    snapshot → nothing to do
+ * 2. Copy it (the watcher waits for the copy, readers of older epochs don't)
+ * 3. Without any lock: build the name and query indexes of the copy
+ * 4. atomic_store - new requests see the new epoch from here on
+ *
+ * Teaching Point: The expensive part (index building) happens on the
+ * private copy BEFORE it is visible, so no request ever waits for it.
+ */
+bool DaemonServer::publish() {
+    std::lock_guard<std::mutex> guard(publishMutex);
+    const auto started = std::chrono::steady_clock::now();
+    const std::shared_ptr<Snapshot> previous = snapshot();
+
+    std::shared_ptr<Snapshot> next;
+    {
+        auto lock = manager.lockCatalog();
+        const FileCatalog& live = manager.getFiles();
+        if (previous && previous->files.revision() == live.revision() &&
+            previous->files.size() == live.size()) {
+            return false;
+        }
+        next = std::make_shared<Snapshot>();
+        next->files = live;
+    }
+
+    next->epoch = previous ? previous->epoch + 1 : 1;
+    for (FileCatalog::Index i = 0; i < next->files.size(); ++i) {
+        next->bytes += next->files.fileSize(i);
+    }
+    next->searcher.setHashCache(hashCache);
+    ReaderOptions reader;
+    reader.mapFiles = false;   // Files change under a resident daemon - pread cannot SIGBUS
+    next->searcher.setReaderOptions(reader);
+    next->searcher.setThreadPool(searchPool);   // Requests share one pool - no threads per request
+    next->searcher.prepareIndexes(next->files);
+    next->published = std::chrono::steady_clock::now();
+    std::atomic_store(&current, next);
+
+    const double ms = std::chrono::duration<double, std::milli>(next->published - started).count();
+    Logger::getInstance().log("Daemon: published epoch " + std::to_string(next->epoch) + " (" +
+                              std::to_string(next->files.size()) + " files, " +
+                              std::to_string(ms) + " ms)");
+    return true;
+}
+
+/**
+ * @brief Publishes changes every publishInterval; rescans if nothing watches
+ *
+ * Teaching Point: Publishing on a timer instead of per watch batch
+ * bounds the copy cost - a burst of 10 000 events becomes one snapshot,
+ * not 10 000. Answers are at most one interval (+ batch window) stale.
+ */
+void DaemonServer::publisherLoop() {
+    auto lastRescan = std::chrono::steady_clock::now();
+    while (!shouldStop()) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, options.publishInterval, [this]() { return shouldStop(); });
+        }
+        if (shouldStop()) {
+            break;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (!manager.isWatching() && now - lastRescan >= options.rescanInterval) {
+            std::lock_guard<std::mutex> lock(rescanMutex);
+            manager.rescanIncremental();
+            lastRescan = now;
+        }
+        publish();
+    }
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief Creates, binds and listens on the Unix socket
+ *
+ * Teaching Point: A leftover socket file from a crashed daemon would make
+ * bind() fail forever. If nobody answers on it, it is stale and removed;
+ * if somebody does, another daemon owns it and we refuse to start. The
+ * socket is created under umask 077: only this user may connect.
+ */
+bool DaemonServer::openSocket() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: socket path too long: " << options.socketPath << "\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+
+    struct stat existing {};
+    if (::lstat(options.socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "Error: " << options.socketPath << " exists and is not a socket\n";
+            return false;
+        }
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool alive = probe >= 0 &&
+            ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (alive) {
+            std::cerr << "Error: a daemon is already listening on " << options.socketPath << "\n";
+            return false;
+        }
+        ::unlink(options.socketPath.c_str());
+    }
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Error: socket(): " << std::strerror(errno) << "\n";
+        return false;
+    }
+    ::fcntl(listenFd, F_SETFD, FD_CLOEXEC);
+    const mode_t previousMask = ::umask(077);
+    const int bound = ::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    ::umask(previousMask);
+    if (bound != 0 || ::listen(listenFd, 128) != 0) {
+        std::cerr << "Error: cannot listen on " << options.socketPath << ": " << std::strerror(errno) << "\n";
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void DaemonServer::closeSocket() {
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(options.socketPath.c_str());
+    }
+}
+
+/**
+ * @brief Joins finished connection threads (all of them when stopping)
+ *
+ * The descriptor is closed HERE, after the join, not by the connection
+ * thread: while the thread runs, the fd number stays ours, so a stop can
+ * shutdown() it without hitting a recycled descriptor.
+ */
+void DaemonServer::reapConnections(bool all) {
+    for (auto it = connections.begin(); it != connections.end();) {
+        Connection& connection = **it;
+        if (all && !connection.finished) {
+            ::shutdown(connection.fd, SHUT_RDWR);   // Wakes a blocked recv()
+        }
+        if (all || connection.finished) {
+            if (connection.thread.joinable()) {
+                connection.thread.join();
+            }
+            ::close(connection.fd);
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DaemonServer::rejectBusy(int fd) {
+    Metrics::getInstance().add(Counter::DaemonRejected);
+    DaemonResponse response = failure(wire::Status::Busy, "too many clients (limit " +
+                                      std::to_string(options.maxClients) + ")");
+    if (const auto snap = snapshot()) {
+        response.epoch = snap->epoch;
+    }
+    wire::writeFrame(fd, response.encode(wire::Op::Ping));
+    ::close(fd);
+}
+
+/**
+ * @brief Request loop of one client (own thread)
+ */
+void DaemonServer::serveConnection(Connection& connection) {
+    timeval idle{};
+    idle.tv_sec = static_cast<time_t>(options.idleTimeout.count());
+    ::setsockopt(connection.fd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof(idle));
+
+    std::string payload;
+    while (!shouldStop() && wire::readFrame(connection.fd, payload, wire::kMaxRequestBytes)) {
+        MetricTimer timer(Histogram::DaemonRequest);
+        DaemonRequest request;
+        DaemonResponse response;
+        wire::Op op = wire::Op::Ping;
+        if (request.decode(payload)) {
+            op = request.op;
+            response = answer(request);
+        } else {
+            response = failure(wire::Status::BadRequest, "malformed request (protocol version " +
+                               std::to_string(wire::kVersion) + ")");
+        }
+        if (!wire::writeFrame(connection.fd, response.encode(op))) {
+            break;
+        }
+        ++requestsServed;
+        Metrics::getInstance().add(Counter::DaemonRequests);
+    }
+    --activeClients;
+    connection.finished = true;
+}
+
+/**
+ * @brief Serves until a stop is requested
+ *
+ * ALGORITHM:
+ * 1. Claim the socket first - a second daemon fails before it scans
+ * 2. Incremental rescan (fast after the first launch: the scan index
+ *    on disk is reused), publish epoch 1, start watch mode
+ * 3. Publisher thread; acceptor loop with a short poll() timeout so
+ *    SIGINT/SIGTERM are noticed without signal-unsafe work in the handler
+ * 4. Stop: close the socket, wake and join every connection, the
+ *    publisher and the watcher (which saves the catalog for next time)
+ */
+int DaemonServer::run() {
+    if (!manager.anyRootExists()) {   // One unmounted root must not block a restart
+        std::cerr << "Error: no root directory exists\n";
+        return 1;
+    }
+    if (!openSocket()) {
+        Logger::getInstance().log("ERROR: Daemon could not listen on " + options.socketPath);
+        return 1;
+    }
+
+    manager.setScanOptions(options.scan);
+    manager.rescanIncremental();
+    publish();
+    if (!manager.startWatching()) {
+        std::cerr << "Warning: watch mode unavailable, rescanning every "
+                  << options.rescanInterval.count() << " s\n";
+        Logger::getInstance().log("WARNING: Daemon without watch mode - periodic rescans");
+    }
+    const auto first = snapshot();
+    std::cerr << "Serving " << first->files.size() << " files of " << options.directory
+              << (manager.getRoots().size() > 1 ? " and " + std::to_string(manager.getRoots().size() - 1) +
+                                                  " more root(s)" : std::string())
+              << " on " << options.socketPath << " (Ctrl+C to stop)\n";
+    Logger::getInstance().log("Daemon started on " + options.socketPath + " for " + options.directory);
+
+    publisherThread = std::thread(&DaemonServer::publisherLoop, this);
+
+    while (!shouldStop()) {
+        pollfd ready{listenFd, POLLIN, 0};
+        const int events = ::poll(&ready, 1, kAcceptPollMs);
+        reapConnections(false);
+        if (events <= 0 || (ready.revents & POLLIN) == 0) {
+            continue;
+        }
+        const int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        if (activeClients >= options.maxClients) {
+            rejectBusy(fd);
+            continue;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        Connection& accepted = *connection;
+        ++activeClients;
+        try {
+            accepted.thread = std::thread(&DaemonServer::serveConnection, this, std::ref(accepted));
+        } catch (const std::system_error& e) {
+            --activeClients;
+            Logger::getInstance().log("ERROR: Daemon could not start a connection thread: " +
+                                      std::string(e.what()));
+            rejectBusy(fd);
+            continue;
+        }
+        connections.push_back(std::move(connection));
+    }
+
+    std::cerr << "Stopping daemon...\n";
+    stopping = true;
+    wake.notify_all();
+    closeSocket();
+    reapConnections(true);
+    publisherThread.join();
+    manager.stopWatching();
+    if (hashCache) {
+        hashCache->flush();
+    }
+    Logger::getInstance().log("Daemon stopped after " + std::to_string(requestsServed.load()) + " requests");
+    return 0;
+}
+
+#else
+
+bool DaemonServer::openSocket() { return false; }
+void DaemonServer::closeSocket() {}
+void DaemonServer::reapConnections(bool) {}
+void DaemonServer::rejectBusy(int) {}
+void DaemonServer::serveConnection(Connection&) {}
+
+int DaemonServer::run() {
+    std::cerr << "Error: daemon mode needs Unix domain sockets (not supported on this platform)\n";
+    return 1;
+}
+
+#endif
+
+/**
+ * @brief Answers one request from the current snapshot
+ *
+ * Teaching Point: The snapshot is loaded ONCE per request. Even if the
+ * publisher swaps epochs mid-search, this request keeps reading the
+ * catalog it started on - and reports that epoch.
+ */
+DaemonResponse DaemonServer::answer(const DaemonRequest& request) {
+    std::size_t roots = 0;
+    if (request.op == wire::Op::Rescan) {
+        std::lock_guard<std::mutex> lock(rescanMutex);
+        manager.rescanIncremental();
+        publish();
+    } else if (request.op == wire::Op::AddRoot || request.op == wire::Op::DropRoot) {
+        // Only the named root is listed (or dropped); the other roots'
+        // files are carried over into the next epoch untouched
+        std::lock_guard<std::mutex> lock(rescanMutex);
+        std::string error;
+        const bool changed = request.op == wire::Op::AddRoot ? manager.addRoot(request.text, &error)
+                                                             : manager.removeRoot(request.text, &error);
+        if (!changed) {
+            return failure(wire::Status::BadRequest, error);
+        }
+        roots = manager.getRoots().size();
+        publish();
+    }
+
+    const std::shared_ptr<Snapshot> snap = snapshot();
+    DaemonResponse response;
+    response.epoch = snap->epoch;
+    const FileCatalog& files = snap->files;
+
+    try {
+        switch (request.op) {
+            case wire::Op::Ping:
+            case wire::Op::Rescan:
+                response.files = files.size();
+                break;
+            case wire::Op::AddRoot:
+            case wire::Op::DropRoot:
+                response.files = files.size();
+                response.roots = roots;
+                break;
+            case wire::Op::Stats:
+                response.files = files.size();
+                response.directories = files.directoryCount();
+                response.bytes = snap->bytes;
+                response.ageMs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - snap->published).count());
+                response.requests = requestsServed.load();
+                response.clients = activeClients.load();
+                response.watching = manager.isWatching();
+                break;
+            case wire::Op::Search: {
+                if (request.text.empty()) {
+                    return failure(wire::Status::BadRequest, "empty search term");
+                }
+                if (request.fuzzy) {
+                    const std::size_t limit = request.limit == 0 ? kDefaultFuzzyLimit
+                                                                 : clampLimit(request.limit, files.size());
+                    const auto matches = snap->searcher.searchByNameFuzzy(files, request.text, limit);
+                    response.total = matches.size();
+                    for (const FuzzyMatch& match : matches) {
+                        response.results.push_back(remoteFile(files, match.file, match.errors));
+                    }
+                } else {
+                    const auto matches = snap->searcher.searchByName(files, request.text);
+                    response.total = matches.size();
+                    const std::size_t count = clampLimit(request.limit, matches.size());
+                    response.results.reserve(count);
+                    for (std::size_t k = 0; k < count; ++k) {
+                        response.results.push_back(remoteFile(files, matches[k]));
+                    }
+                }
+                break;
+            }
+            case wire::Op::Query: {
+                FileQuery query;
+                std::string error;
+                if (!FileQuery::parse(request.text, query, error) || query.empty()) {
+                    return failure(wire::Status::BadRequest,
+                                   "invalid query: " + (error.empty() ? std::string("no conditions") : error));
+                }
+                const auto matches = snap->searcher.query(files, query);
+                response.total = matches.size();
+                const std::size_t count = clampLimit(request.limit, matches.size());
+                response.results.reserve(count);
+                for (std::size_t k = 0; k < count; ++k) {
+                    response.results.push_back(remoteFile(files, matches[k]));
+                }
+                break;
+            }
+            case wire::Op::Duplicates: {
+                const DuplicateResult& duplicates = snap->duplicateGroups();
+                if (hashCache) {
+                    hashCache->flush();
+                }
+                response.total = duplicates.size();
+                response.reclaimable = duplicates.reclaimableBytes();
+                const std::size_t count = clampLimit(request.limit, duplicates.size());
+                for (std::size_t g = 0; g < count; ++g) {
+                    const DuplicateGroup& group = duplicates.groups[g];
+                    RemoteGroup remote;
+                    remote.size = group.size;
+                    remote.hash = group.hash;
+                    const FileCatalog::Index* members = duplicates.members(group);
+                    for (std::size_t m = 0; m < group.count; ++m) {
+                        remote.paths.emplace_back(files.path(members[m]));
+                    }
+                    response.groups.push_back(std::move(remote));
+                }
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        Logger::getInstance().log("ERROR: Daemon request failed: " + std::string(e.what()));
+        return failure(wire::Status::Failed, e.what());
+    }
+    return response;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM DAEMONSERVER
+ * =============================================================================
+ *
+ * 1. READERS NEVER WAIT FOR WRITERS: requests read an immutable snapshot;
+ *    the live catalog is only locked by the watcher and by the publisher's
+ *    copy.
+ *
+ * 2. REFERENCE COUNTS AS THE GRACE PERIOD: atomic_load/atomic_store on a
+ *    shared_ptr give RCU semantics without an RCU library - an epoch lives
+ *    exactly as long as someone reads it.
+ *
+ * 3. PUBLISH ON A TIMER, BUILD BEFORE PUBLISHING: one copy per interval,
+ *    indexes warm before the first request sees them.
+ *
+ * 4. BOUNDED CONCURRENCY: one thread per client up to maxClients, an
+ *    explicit Busy answer beyond it, idle connections timed out.
+ *
+ * 5. SIGNAL HANDLERS ONLY SET A FLAG: loops with short timeouts notice it
+ *    and shut down through the normal, lock-using code paths.
+ *
+ * =============================================================================
+ */
@@ -0,0 +1,68 @@
+#include "../include/FileLock.h"
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SFM_HAVE_FLOCK 1
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * =============================================================================
+ * FILELOCK IMPLEMENTATION - flock() AROUND SHARED CACHE FILES
+ * =============================================================================
+ */
+
+FileLock::FileLock(const std::string& lockPath, Mode mode) {
+#ifdef SFM_HAVE_FLOCK
+    fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    const int operation = mode == Mode::Exclusive ? LOCK_EX : LOCK_SH;
+    int result;
+    do {
+        result = ::flock(fd, operation);
+    } while (result != 0 && errno == EINTR);
+    locked = result == 0;
+#else
+    (void)lockPath;
+    (void)mode;
+    locked = true;
+#endif
+}
+
+FileLock::~FileLock() {
+#ifdef SFM_HAVE_FLOCK
+    if (fd >= 0) {
+        ::close(fd);   // Releases the lock
+    }
+#endif
+}
+
+std::string FileLock::temporaryPath(const std::string& path) {
+#ifdef SFM_HAVE_FLOCK
+    return path + ".tmp." + std::to_string(::getpid());
+#else
+    return path + ".tmp." + std::to_string(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM FILELOCK IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. LOCK A NAME THAT NEVER MOVES:
+ *    - Files replaced by rename() get a new inode; the lock file keeps its own
+ *
+ * 2. THE KERNEL CLEANS UP:
+ *    - flock() ends with the descriptor, so a crash cannot leave a stale lock
+ *
+ * 3. ONE WRITER, UNIQUE TEMPORARIES:
+ *    - Even without the lock, two processes never share a temp file name
+ */
@@ -1,7 +1,19 @@
 #include "../include/FileManager.h"
 #include "../include/Logger.h"
+#include "../include/ThreadPool.h"
+#include "../include/ScanIndex.h"
+#include "../include/BoundedQueue.h"
+#include "../include/Metrics.h"
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <iomanip>
 
 /**
  * =============================================================================
@@ -35,17 +47,125 @@
  * Why? Prevents accidental conversions that can hide bugs.
  */
 FileManager::FileManager(const std::string& dirPath) 
-    : targetDirectory(dirPath) {
+    : FileManager(std::vector<std::string>{dirPath}) {
+}
+
+FileManager::FileManager(const std::vector<std::string>& rootPaths)
+    : targetDirectory(rootPaths.empty() ? std::string() : rootPaths.front()),
+      scanBackend(createDefaultScanBackend()) {
     
     // Log initialization
-    Logger::getInstance().log("FileManager initialized for directory: " + dirPath);
-    
-    // Teaching Point: Validation in constructor
-    // Ensures object starts in valid state (class invariant)
+    Logger::getInstance().log("FileManager initialized for directory: " + targetDirectory);
+    roots.push_back(normaliseRoot(targetDirectory));
     if (!directoryExists()) {
-        Logger::getInstance().log("WARNING: Directory does not exist: " + dirPath);
-        std::cerr << "Warning: Directory '" << dirPath << "' does not exist!\n";
+        Logger::getInstance().log("WARNING: Directory does not exist: " + targetDirectory);
+        std::cerr << "Warning: Directory '" << targetDirectory << "' does not exist!\n";
+    }
+    
+    // Extra roots: while the catalog is empty, addRoot() only registers
+    // them - the index (or the first scan) fills them in. A root that is
+    // missing right now (unmounted) is kept too: scans skip it until it
+    // is back, like a root that disappears while we run.
+    for (std::size_t r = 1; r < rootPaths.size(); ++r) {
+        std::error_code ec;
+        std::string error;
+        if (!fs::is_directory(rootPaths[r], ec)) {
+            Logger::getInstance().log("WARNING: Directory does not exist: " + rootPaths[r]);
+            std::cerr << "Warning: Directory '" << rootPaths[r] << "' does not exist!\n";
+            roots.push_back(normaliseRoot(rootPaths[r]));
+        } else if (!addRoot(rootPaths[r], &error)) {
+            Logger::getInstance().log("WARNING: Root ignored: " + error);
+            std::cerr << "Warning: " << error << "\n";
+        }
+    }
+    
+    // Teaching Point: Validation in constructor - with no root at all
+    // there is nothing to load or scan
+    if (!anyRootExists()) {
+        return;
+    }
+    
+    // Start with the results of the previous session, if they were saved
+    selectIndex();
+    loadIndex();
+}
+
+FileManager::~FileManager() {
+    stopWatching();
+}
+
+/**
+ * @brief Normalised root path used for every stored directory path
+ */
+std::string FileManager::normaliseRoot(std::string directory) {
+    while (directory.size() > 1 && (directory.back() == '/' ||
+                                    directory.back() == static_cast<char>(fs::path::preferred_separator))) {
+        directory.pop_back();
+    }
+    return directory;
+}
+
+std::string FileManager::rootKey() const {
+    std::string key;
+    for (const std::string& root : roots) {
+        key += (key.empty() ? "" : "\n") + root;
+    }
+    return key;
+}
+
+/**
+ * @brief One index per SET of roots
+ * 
+ * Teaching Point: A single root keeps its old index file, so existing
+ * caches stay valid; a multi-root catalog is saved under a key made of
+ * all its roots, and reloaded when the same set is opened again.
+ */
+void FileManager::selectIndex() {
+    indexPath = ScanIndex::defaultPath(roots);
+}
+
+/**
+ * @brief Loads the saved catalog for this directory
+ * 
+ * Teaching Point: The index is only a starting point. Its scan options
+ * become our options so that a quick rescan continues where it left off.
+ */
+bool FileManager::loadIndex() {
+    if (indexPath.empty()) {
+        return false;
+    }
+    FileCatalog loaded;
+    ScanIndexInfo info;
+    if (!ScanIndex::load(indexPath, loaded, info)) {
+        return false;
+    }
+    if (info.rootPath != rootKey()) {
+        Logger::getInstance().log("Scan index ignored (different root): " + info.rootPath);
+        return false;
     }
+    
+    files = std::move(loaded);
+    usage.build(files);
+    catalogOptions = info.options;
+    catalogBackend = info.backendName;
+    scanOptions.recursive = info.options.recursive;
+    scanOptions.maxDepth = info.options.maxDepth;
+    scanOptions.symlinks = info.options.symlinks;
+    Logger::getInstance().log("Loaded scan index: " + std::to_string(files.size()) +
+                              " files in " + std::to_string(files.directoryCount()) +
+                              " directories from " + indexPath);
+    return true;
+}
+
+void FileManager::saveIndex() const {
+    if (indexPath.empty()) {
+        return;
+    }
+    ScanIndexInfo info;
+    info.rootPath = rootKey();
+    info.backendName = catalogBackend;
+    info.options = catalogOptions;
+    ScanIndex::save(indexPath, files, info);
 }
 
 /**
@@ -73,6 +193,74 @@ bool FileManager::directoryExists() const {
     }
 }
 
+bool FileManager::anyRootExists() const {
+    return std::any_of(roots.begin(), roots.end(), [](const std::string& root) {
+        std::error_code ec;
+        return fs::is_directory(root, ec);
+    });
+}
+
+/**
+ * @brief Swaps the scan backend
+ * @param backend New strategy, or nullptr for the platform default
+ */
+void FileManager::setScanBackend(std::shared_ptr<ScanBackend> backend) {
+    scanBackend = backend ? std::move(backend) : createDefaultScanBackend();
+    Logger::getInstance().log(std::string("Scan backend set to: ") + scanBackend->name());
+}
+
+/**
+ * @brief Shared state of one parallel scan
+ * 
+ * Teaching Point: Everything the worker tasks share lives in ONE struct
+ * that outlives the pool. Tasks capture a reference to it, never copies.
+ */
+struct FileManager::ScanContext {
+    const ScanOptions& options;
+    ThreadPool& pool;
+    DeviceScheduler io;                             // Every directory task goes through it
+    std::vector<FileCatalog> perWorker;             // One result catalog per worker
+    std::vector<ScanStats> perWorkerStats;          // One counter set per worker
+    
+    // Loop detection, only used with SymlinkPolicy::FollowAll
+    std::mutex visitedMutex;
+    std::set<fs::path> visitedDirectories;
+    
+    // A root itself failing is reported to the caller; failures deeper
+    // in the tree are logged and skipped.
+    std::mutex rootErrorMutex;
+    std::vector<std::string> rootErrors;
+    
+    // Incremental rescans only: the previous catalog, its files grouped by
+    // directory, and the set of directories that already have their own task
+    const FileCatalog* previous = nullptr;
+    std::vector<FileCatalog::Index> previousStarts;
+    std::vector<FileCatalog::Index> previousOrder;
+    std::unordered_set<std::string_view> knownDirectories;
+    
+    // Streaming scans only: full buckets are pushed here instead of kept
+    BoundedQueue<FileCatalog>* stream = nullptr;
+    std::size_t batchSize = 0;
+    
+    ScanContext(const ScanOptions& opts, ThreadPool& p)
+        : options(opts), pool(p), io(p, opts.devices), perWorker(p.size()), perWorkerStats(p.size()) {}
+
+    
+    /**
+     * @brief Records a directory as visited
+     * @return false if it was seen before (symlink loop)
+     */
+    bool markVisited(const fs::path& dir) {
+        std::error_code ec;
+        fs::path canonical = fs::canonical(dir, ec);
+        if (ec) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(visitedMutex);
+        return visitedDirectories.insert(canonical).second;
+    }
+};
+
 /**
  * @brief Main scanning algorithm
  * @return Number of files found
@@ -80,50 +268,113 @@ bool FileManager::directoryExists() const {
  * Teaching Point: DIRECTORY ITERATION PATTERN
  * 
  * std::filesystem provides THREE iterators:
- * 1. directory_iterator - Current directory only (used here)
+ * 1. directory_iterator - Current directory only (used here, once per directory)
  * 2. recursive_directory_iterator - Includes subdirectories
  * 3. Both have range-based for loop support!
  * 
- * ALGORITHM BREAKDOWN:
- * 1. Clear previous scan results
- * 2. Iterate through directory entries
- * 3. Filter regular files (skip directories, symlinks)
- * 4. Extract metadata for each file
- * 5. Store in vector
- * 6. Return count
+ * Why not recursive_directory_iterator for recursive scans?
+ * It walks the tree on ONE thread. We instead list each directory on its
+ * own (through the ScanBackend) and hand subdirectories to a ThreadPool,
+ * so many directories are listed at the same time.
  */
 int FileManager::scanDirectory() {
+    return scanDirectory(scanOptions);
+}
+
+int FileManager::scanDirectory(const ScanOptions& options) {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    int count = runScan(options, nullptr);
+    if (watching) {
+        watchDirectories(0);   // New directories need watches too
+    }
+    return count;
+}
+
+/**
+ * @brief Quick rescan: only directories whose mtime changed are listed
+ */
+int FileManager::rescanIncremental() {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    int count = incrementalScan();
+    if (watching) {
+        watchDirectories(0);
+    }
+    return count;
+}
+
+int FileManager::incrementalScan() {
+    bool sameSetup = catalogOptions.recursive == scanOptions.recursive &&
+                     catalogOptions.maxDepth == scanOptions.maxDepth &&
+                     catalogOptions.symlinks == scanOptions.symlinks &&
+                     catalogBackend == scanBackend->name();
+    if (files.directoryCount() == 0 || !sameSetup) {
+        Logger::getInstance().log("Incremental rescan not possible - running a full scan");
+        return runScan(scanOptions, nullptr);
+    }
+    
+    // runScan() clears `files`, so the old catalog moves out first
+    FileCatalog previous = std::move(files);
+    return runScan(scanOptions, &previous);
+}
+
+int FileManager::runScan(const ScanOptions& options, const FileCatalog* previous) {
     files.clear();  // Clear previous scan (if any)
+    usage.clear();
+    lastScanStats = ScanStats();
     
-    if (!directoryExists()) {
-        Logger::getInstance().log("ERROR: Cannot scan non-existent directory");
+    if (!anyRootExists()) {
+        Logger::getInstance().log("ERROR: Cannot scan - no root directory exists");
         return 0;
     }
     
-    try {
-        // Teaching Point: Range-based for loop with filesystem
-        // Each entry is a directory_entry object containing:
-        // - path (full path to file/directory)
-        // - status (file type, permissions, etc.)
-        // - Methods to query attributes
+    ThreadPool pool(options.threadCount);
+    ScanContext ctx(options, pool);
+    
+    if (options.symlinks == SymlinkPolicy::FollowAll) {
+        for (const std::string& root : roots) {
+            ctx.markVisited(root);
+        }
+    }
+    
+    if (previous == nullptr) {
+        for (const std::string& root : roots) {
+            ctx.io.submit(deviceOf(root), root, [this, &ctx, root] { scanDirectoryTask(ctx, root, 0); });
+        }
+    } else {
+        ctx.previous = previous;
+        previous->filesByDirectory(ctx.previousStarts, ctx.previousOrder);
+        ctx.knownDirectories.reserve(previous->directoryCount());
+        for (FileCatalog::DirectoryId d = 0; d < previous->directoryCount(); ++d) {
+            ctx.knownDirectories.insert(previous->directoryPath(d));
+        }
         
-        for (const auto& entry : fs::directory_iterator(targetDirectory)) {
-            // Filter: Only regular files (not directories or special files)
-            if (entry.is_regular_file()) {
-                FileInfo info = getFileInfo(entry.path());
-                files.push_back(info);
-                
-                // Log each file found (verbose, but good for debugging)
-                Logger::getInstance().log("Found file: " + info.name + 
-                                        " (" + std::to_string(info.size) + " bytes)");
+        // With FollowAll a NEW link could point at a known directory; mark
+        // them all first so it is recognised instead of scanned twice
+        if (options.symlinks == SymlinkPolicy::FollowAll) {
+            for (FileCatalog::DirectoryId d = 0; d < previous->directoryCount(); ++d) {
+                pool.submit([&ctx, previous, d] {
+                    ctx.markVisited(fs::path(previous->directoryPath(d)));
+                });
             }
+            pool.waitIdle();
         }
         
-        Logger::getInstance().log("Scan complete: " + 
-                                std::to_string(files.size()) + " files found");
-        return static_cast<int>(files.size());
-        
-    } catch (const fs::filesystem_error& e) {
+        for (FileCatalog::DirectoryId d = 0; d < previous->directoryCount(); ++d) {
+            ctx.io.submit(previous->directoryDevice(d), std::string(previous->directoryPath(d)),
+                          [this, &ctx, d] { rescanDirectoryTask(ctx, d); });
+        }
+    }
+    pool.waitIdle();
+    
+    // One unreachable mount must not cost the others their results: the
+    // scan only fails when no root at all could be listed
+    for (const std::string& error : ctx.rootErrors) {
+        if (ctx.rootErrors.size() < roots.size()) {
+            Logger::getInstance().log("WARNING: Root skipped: " + error);
+            std::cerr << "Warning: root skipped: " << error << std::endl;
+        }
+    }
+    if (!ctx.rootErrors.empty() && ctx.rootErrors.size() >= roots.size()) {
         /**
          * Teaching Point: Exception Handling Strategy
          * 
@@ -138,12 +389,692 @@ int FileManager::scanDirectory() {
          * - Path not found
          * - Too many open files
          * - Disk I/O error
+         * 
+         * Exceptions cannot cross thread boundaries on their own, so the
+         * worker stores the message and the calling thread reports it.
          */
-        std::string errorMsg = "ERROR scanning directory: " + std::string(e.what());
+        std::string errorMsg = "ERROR scanning directory: " + ctx.rootErrors.front();
         Logger::getInstance().log(errorMsg);
         std::cerr << errorMsg << std::endl;
         return 0;
     }
+    
+    // Merge: reserve once, then append each worker's catalog
+    // (extension IDs are re-mapped, arenas copied in one block each)
+    std::size_t totalFiles = 0;
+    for (const auto& bucket : ctx.perWorker) {
+        totalFiles += bucket.size();
+    }
+    files.reserve(totalFiles, 0);
+    for (auto& bucket : ctx.perWorker) {
+        files.append(std::move(bucket));
+    }
+    files.linkDirectories();
+    usage.build(files, &pool);   // Directories only - the file sums came with the buckets
+    for (const auto& stats : ctx.perWorkerStats) {
+        lastScanStats += stats;
+    }
+    catalogOptions = options;
+    catalogBackend = scanBackend->name();
+    
+    double perFile = files.empty() ? 0.0
+                   : static_cast<double>(lastScanStats.syscalls) / static_cast<double>(files.size());
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2)
+            << "Scan complete: " << files.size() << " files found in "
+            << lastScanStats.directories << " directories (" << pool.size() << " threads, "
+            << scanBackend->name() << " backend, " << lastScanStats.syscalls << " syscalls, "
+            << perFile << " per file)";
+    if (roots.size() > 1) {
+        summary << " across " << roots.size() << " roots";
+    }
+    if (previous != nullptr) {
+        summary << " - incremental, " << lastScanStats.reusedDirectories
+                << " unchanged directories reused";
+    }
+    Logger::getInstance().log(summary.str());
+    if (ctx.io.deviceCount() > 1) {
+        Logger::getInstance().log("Scan devices: " + ctx.io.summary());
+    }
+    const DirectoryUsage total = usage.total();
+    Logger::getInstance().log("Disk usage: " + std::to_string(total.bytes) + " bytes in " +
+                              std::to_string(total.files) + " files, " +
+                              std::to_string(usage.levels()) + " directory levels");
+    
+    saveIndex();
+    return static_cast<int>(files.size());
+}
+
+/**
+ * @brief One directory of an incremental rescan
+ * 
+ * ALGORITHM:
+ * 1. stat the directory (mtime only - no listing)
+ * 2. Failed           → directory is gone; its files are dropped
+ * 3. Same mtime       → copy its files over from the previous catalog
+ * 4. Different mtime  → full listing via scanDirectoryTask(); known
+ *                       subdirectories are skipped there (they have
+ *                       their own task), new ones are scanned recursively
+ */
+void FileManager::rescanDirectoryTask(ScanContext& ctx, FileCatalog::DirectoryId dir) const {
+    const FileCatalog& previous = *ctx.previous;
+    const std::string_view path = previous.directoryPath(dir);
+    const auto depth = static_cast<int>(previous.directoryDepth(dir));
+    
+    const auto worker = static_cast<std::size_t>(ThreadPool::currentWorkerIndex());
+    FileCatalog& bucket = ctx.perWorker[worker];
+    ScanStats& stats = ctx.perWorkerStats[worker];
+    
+    fs::path dirPath(path);
+    std::error_code ec;
+    std::int64_t mtime = 0;
+    MetricTimer statTimer(Histogram::ScanStat);
+    const bool statted = scanBackend->directoryMtime(dirPath, mtime, stats, ec);
+    statTimer.stop();
+    if (!statted) {
+        Metrics::getInstance().add(Counter::ScanErrors);
+        std::string reason = fs::filesystem_error("cannot stat directory", dirPath, ec).what();
+        if (depth == 0) {
+            std::lock_guard<std::mutex> lock(ctx.rootErrorMutex);
+            ctx.rootErrors.push_back(reason);
+        } else {
+            SFM_LOG_SAMPLED(Warn, 20, "Directory gone since last scan: {}", reason);
+        }
+        return;
+    }
+    
+    if (mtime != previous.directoryMtime(dir)) {
+        scanDirectoryTask(ctx, dirPath, depth);
+        return;
+    }
+    
+    FileCatalog::DirectoryId copy = bucket.addDirectory(path, static_cast<std::uint32_t>(depth), mtime,
+                                                        previous.directoryDevice(dir));
+    for (FileCatalog::Index k = ctx.previousStarts[dir]; k < ctx.previousStarts[dir + 1]; ++k) {
+        bucket.addFrom(previous, ctx.previousOrder[k], copy);
+    }
+    stats.reusedDirectories += 1;
+}
+
+/**
+ * @brief Lists a single directory as one pool task
+ * 
+ * ALGORITHM:
+ * 1. Ask the ScanBackend for the directory's entries
+ * 2. Apply the symlink policy to links
+ * 3. Regular files → metadata → this worker's bucket
+ * 4. Subdirectories within the depth limit → new task
+ * 
+ * Teaching Point: Graceful degradation - an unreadable subdirectory is
+ * logged and skipped; the rest of the tree is still scanned.
+ */
+void FileManager::scanDirectoryTask(ScanContext& ctx, const fs::path& dirPath, int depth) const {
+    const ScanOptions& options = ctx.options;
+    const bool descend = options.recursive &&
+                         (options.maxDepth < 0 || depth < options.maxDepth);
+    
+    if (ctx.stream != nullptr && ctx.stream->isCancelled()) {
+        return;  // Consumer stopped the streaming scan
+    }
+    
+    const auto worker = static_cast<std::size_t>(ThreadPool::currentWorkerIndex());
+    FileCatalog& bucket = ctx.perWorker[worker];
+    ScanStats& stats = ctx.perWorkerStats[worker];
+    
+    // Reused listing buffer: one allocation per worker, not per directory
+    thread_local DirectoryListing listing;
+    listing.clear();
+    
+    std::error_code ec;
+    MetricTimer listTimer(Histogram::ScanReaddir);
+    const bool listed = scanBackend->listDirectory(dirPath, options.symlinks != SymlinkPolicy::Skip,
+                                                   listing, stats, ec);
+    listTimer.stop();
+    if (!listed) {
+        Metrics::getInstance().add(Counter::ScanErrors);
+        std::string reason = fs::filesystem_error("cannot list directory", dirPath, ec).what();
+        if (depth == 0) {
+            std::lock_guard<std::mutex> lock(ctx.rootErrorMutex);
+            ctx.rootErrors.push_back(reason);
+        } else {
+            SFM_LOG_SAMPLED(Error, 20, "cannot scan subdirectory: {}", reason);
+        }
+        return;
+    }
+    
+    // Stored once per directory; every file path is built from it
+    const FileCatalog::DirectoryId directory =
+        bucket.addDirectory(dirPath.string(), static_cast<std::uint32_t>(depth), listing.mtimeNs,
+                            listing.device);
+    
+    std::uint64_t regularFiles = 0;
+    for (ScanEntry& entry : listing.entries) {
+        bool isLink = entry.type == EntryType::Symlink;
+        if (isLink && options.symlinks == SymlinkPolicy::Skip) {
+            continue;
+        }
+        
+        // For links, decide by the type of the TARGET
+        EntryType effective = isLink ? entry.targetType : entry.type;
+        
+        if (effective == EntryType::Regular) {
+            std::string extension = extractExtension(entry.name);
+            bucket.add(directory, entry.name, extension, entry.size, entry.mtimeNs, entry.inode);
+            ++regularFiles;
+            
+            // One record per file: Trace level, compiled out of release builds
+            SFM_LOG(Trace, "Found file: {} ({} bytes)", entry.name, entry.size);
+            
+        } else if (descend && effective == EntryType::Directory) {
+            fs::path child = dirPath / entry.name;
+            
+            if (ctx.previous != nullptr && ctx.knownDirectories.count(child.string()) > 0) {
+                continue;  // Incremental rescan: this directory has its own task
+            }
+            if (isLink && options.symlinks != SymlinkPolicy::FollowAll) {
+                continue;  // Linked directories are only entered with FollowAll
+            }
+            if (options.symlinks == SymlinkPolicy::FollowAll && !ctx.markVisited(child)) {
+                continue;  // Already visited (symlink loop or second path)
+            }
+            
+            // Scheduled on this directory's device; a mount point below it
+            // is only recognised once listed (its children then use its own)
+            ctx.io.submit(listing.device, child.string(), [this, &ctx, child, depth] {
+                scanDirectoryTask(ctx, child, depth + 1);
+            });
+        }
+    }
+    Metrics::getInstance().add(Counter::ScanDirectories);
+    Metrics::getInstance().add(Counter::ScanFiles, regularFiles);
+    
+    // Streaming: hand a full bucket to the consumer (may block = backpressure)
+    if (ctx.stream != nullptr && bucket.size() + bucket.directoryCount() >= ctx.batchSize) {
+        ctx.stream->push(std::move(bucket));
+        bucket = FileCatalog();
+    }
+}
+
+/**
+ * @brief Streaming scan: batches flow to the visitor while the walk runs
+ * 
+ * Teaching Point: WHO WAITS FOR WHOM
+ * - Pool workers produce batches
+ * - A small "closer" thread waits for the pool to go idle, pushes the
+ *   last partial buckets and closes the queue
+ * - The calling thread consumes, so the visitor never needs to be
+ *   thread-safe
+ */
+std::size_t FileManager::streamScan(const ScanOptions& options, const ScanBatchVisitor& visitor,
+                                    const StreamOptions& stream) const {
+    if (!anyRootExists()) {
+        Logger::getInstance().log("ERROR: Cannot scan - no root directory exists");
+        return 0;
+    }
+    
+    BoundedQueue<FileCatalog> queue(stream.maxQueuedBatches);
+    ThreadPool pool(options.threadCount);
+    ScanContext ctx(options, pool);
+    ctx.stream = &queue;
+    ctx.batchSize = stream.batchSize == 0 ? 1 : stream.batchSize;
+    
+    for (const std::string& root : roots) {
+        if (options.symlinks == SymlinkPolicy::FollowAll) {
+            ctx.markVisited(root);
+        }
+        ctx.io.submit(deviceOf(root), root, [this, &ctx, root] { scanDirectoryTask(ctx, root, 0); });
+    }
+    
+    std::thread closer([&ctx, &pool, &queue] {
+        pool.waitIdle();
+        for (auto& bucket : ctx.perWorker) {
+            if (bucket.size() > 0 && !queue.push(std::move(bucket))) {
+                break;
+            }
+        }
+        queue.close();
+    });
+    
+    std::size_t delivered = 0;
+    try {
+        FileCatalog batch;
+        while (queue.pop(batch)) {
+            delivered += batch.size();
+            if (!visitor(batch)) {
+                Logger::getInstance().log("Streaming scan stopped by consumer");
+                queue.cancel();
+                break;
+            }
+        }
+    } catch (...) {
+        // Workers may be blocked in push(): release them before unwinding
+        queue.cancel();
+        closer.join();
+        throw;
+    }
+    closer.join();
+    
+    // As in runScan(): a skipped root is a warning while others delivered
+    const bool allFailed = !ctx.rootErrors.empty() && ctx.rootErrors.size() >= roots.size();
+    for (const std::string& error : ctx.rootErrors) {
+        std::string message = (allFailed ? "ERROR scanning directory: " : "Warning: root skipped: ") + error;
+        Logger::getInstance().log(allFailed ? message : "WARNING: Root skipped: " + error);
+        std::cerr << message << std::endl;
+    }
+    if (allFailed) {
+        return 0;
+    }
+    
+    ScanStats total;
+    for (const auto& stats : ctx.perWorkerStats) {
+        total += stats;
+    }
+    Logger::getInstance().log("Streaming scan complete: " + std::to_string(delivered) +
+                              " files delivered from " + std::to_string(total.directories) +
+                              " directories (" + std::to_string(total.syscalls) + " syscalls)");
+    return delivered;
+}
+
+/**
+ * =============================================================================
+ * WATCH MODE
+ * =============================================================================
+ */
+
+bool FileManager::startWatching(std::chrono::milliseconds batchWindow) {
+    if (watching) {
+        return true;
+    }
+    if (!anyRootExists()) {
+        Logger::getInstance().log("ERROR: Cannot watch - no root directory exists");
+        return false;
+    }
+    
+    std::unique_ptr<WatchBackend> backend = createDefaultWatchBackend();
+    if (!backend) {
+        Logger::getInstance().log("Watch mode is not supported on this platform");
+        return false;
+    }
+    std::error_code ec;
+    if (!backend->open(ec)) {
+        Logger::getInstance().log("ERROR starting watch mode: " + ec.message());
+        return false;
+    }
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        watchBackend = std::move(backend);
+        watchBatchWindow = batchWindow;
+        watchStats = WatchStats();
+        
+        // Watch first, then resynchronise: a change made between the two
+        // steps shows up as an event AND in the rescan - applying it twice
+        // is harmless, missing it would not be
+        watchDirectories(0);
+        incrementalScan();
+        watchDirectories(0);
+    }
+    
+    watchStopRequested = false;
+    watching = true;
+    watchThread = std::thread(&FileManager::watchLoop, this);
+    
+    Logger::getInstance().log("Watch mode started: " + std::to_string(watchBackend->watchCount()) +
+                              " directories (" + watchBackend->name() + ", " +
+                              std::to_string(batchWindow.count()) + " ms batches)");
+    return true;
+}
+
+void FileManager::stopWatching() {
+    if (!watching) {
+        return;
+    }
+    watchStopRequested = true;
+    if (watchThread.joinable()) {
+        watchThread.join();
+    }
+    watching = false;
+    
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    watchBackend.reset();
+    saveIndex();   // Keep what watch mode learned for the next launch
+    Logger::getInstance().log("Watch mode stopped after " + std::to_string(watchStats.batches) +
+                              " batches");
+}
+
+WatchStats FileManager::getWatchStats() const {
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    return watchStats;
+}
+
+void FileManager::watchDirectories(FileCatalog::DirectoryId first) {
+    bool limitLogged = false;
+    for (FileCatalog::DirectoryId d = first; d < files.directoryCount(); ++d) {
+        std::error_code ec;
+        if (!watchBackend->addWatch(std::string(files.directoryPath(d)), ec) && !limitLogged) {
+            // Typically ENOSPC: fs.inotify.max_user_watches is too low
+            Logger::getInstance().log("WARNING: Cannot watch " + std::string(files.directoryPath(d)) +
+                                      ": " + ec.message());
+            limitLogged = true;
+        }
+    }
+}
+
+/**
+ * @brief Watcher thread
+ * 
+ * Teaching Point: BATCHING WITH A TIME WINDOW
+ * The first event opens a window of watchBatchWindow; everything arriving
+ * inside it is applied together. The poll timeout stays short so that
+ * stopWatching() is noticed within ~100 ms.
+ */
+void FileManager::watchLoop() {
+    const std::chrono::milliseconds pollInterval(100);
+    std::vector<WatchEvent> events;
+    
+    while (!watchStopRequested) {
+        if (!watchBackend->waitForEvents(events, pollInterval)) {
+            Logger::getInstance().log("ERROR: Watch backend failed - watch mode stops");
+            break;
+        }
+        if (events.empty()) {
+            continue;
+        }
+        
+        auto deadline = std::chrono::steady_clock::now() + watchBatchWindow;
+        while (!watchStopRequested) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                break;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+            if (!watchBackend->waitForEvents(events, std::min(remaining, pollInterval))) {
+                break;
+            }
+        }
+        
+        applyWatchBatch(events);
+        events.clear();
+    }
+}
+
+/**
+ * @brief Applies one batch of change events to the catalog
+ * 
+ * ALGORITHM:
+ * 1. Coalesce: each distinct path once, in order of first appearance
+ *    ("structural" = it was created, removed or renamed at least once)
+ * 2. Reconcile each path against a fresh stat (see startWatching)
+ * 3. Scan all new directories together on one ThreadPool
+ * 4. Merge the new subtrees, relink parents, watch the new directories
+ * 
+ * Teaching Point: RECONCILE, DON'T REPLAY
+ * Replaying "create, write, write, rename, delete" in order is fragile.
+ * Asking "what is at this path NOW?" gives the same answer with less
+ * work, and a burst of writes to one file costs a single stat.
+ */
+void FileManager::applyWatchBatch(const std::vector<WatchEvent>& events) {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    watchStats.batches += 1;
+    watchStats.events += events.size();
+    
+    for (const WatchEvent& event : events) {
+        if (event.kind == WatchEventKind::Overflow) {
+            Logger::getInstance().log("Watch event queue overflowed - resynchronising");
+            watchStats.resyncs += 1;
+            incrementalScan();
+            watchDirectories(0);
+            return;
+        }
+    }
+    
+    std::vector<const std::string*> order;
+    std::unordered_map<std::string_view, bool> structural;
+    for (const WatchEvent& event : events) {
+        auto inserted = structural.emplace(event.path, false);
+        if (inserted.second) {
+            order.push_back(&event.path);
+        }
+        if (event.kind != WatchEventKind::Modified) {
+            inserted.first->second = true;
+        }
+    }
+    
+    const ScanOptions& options = catalogOptions;
+    std::vector<std::pair<std::string, int>> newDirectories;
+    WatchStats before = watchStats;
+    
+    // File changes walk their ancestor chain; removeSubtree() renumbers
+    // directories, after which only a rebuild is correct
+    bool usageStale = false;
+    auto trackUsage = [&](FileCatalog::DirectoryId dir, std::int64_t fileDelta, std::int64_t byteDelta) {
+        if (!usageStale) {
+            usage.apply(files, dir, fileDelta, byteDelta);
+        }
+    };
+    
+    for (const std::string* pathPtr : order) {
+        const std::string& path = *pathPtr;
+        const bool changedShape = structural[path];
+        
+        std::error_code ec;
+        fs::file_status linkStatus = fs::symlink_status(path, ec);
+        bool exists = !ec && linkStatus.type() != fs::file_type::not_found;
+        bool isLink = exists && fs::is_symlink(linkStatus);
+        fs::file_status status = linkStatus;
+        if (isLink) {
+            status = fs::status(path, ec);
+            exists = !ec;
+        }
+        bool nowFile = exists && fs::is_regular_file(status) &&
+                       !(isLink && options.symlinks == SymlinkPolicy::Skip);
+        bool nowDirectory = exists && fs::is_directory(status) &&
+                            !(isLink && options.symlinks != SymlinkPolicy::FollowAll);
+        
+        FileCatalog::Index fileIndex = files.findFile(path);
+        if (fileIndex != FileCatalog::kNoFile && !nowFile) {
+            trackUsage(files.directoryOf(fileIndex), -1,
+                       -static_cast<std::int64_t>(files.fileSize(fileIndex)));
+            files.removeFile(fileIndex);
+            fileIndex = FileCatalog::kNoFile;
+            watchStats.filesRemoved += 1;
+        }
+        
+        FileCatalog::DirectoryId dirId = files.findDirectory(path);
+        if (dirId != FileCatalog::kNoDirectory && (!nowDirectory || changedShape)) {
+            watchStats.filesRemoved += files.removeSubtree(path);
+            usageStale = true;
+            watchStats.directoriesRemoved += 1;
+            watchBackend->removeWatchesUnder(path);
+            dirId = FileCatalog::kNoDirectory;
+        }
+        
+        std::size_t cut = path.find_last_of('/');
+        if (cut == std::string::npos) {
+            continue;
+        }
+        FileCatalog::DirectoryId parent = files.findDirectory(std::string_view(path).substr(0, cut));
+        if (parent == FileCatalog::kNoDirectory) {
+            continue;   // Outside the catalog (depth limit, not yet scanned, ...)
+        }
+        
+        if (nowFile) {
+            ScanEntry metadata;
+            std::uint64_t device = 0;
+            ScanStats ignored;
+            if (!scanBackend->fileMetadata(path, metadata, device, ignored, ec)) {
+                continue;   // Gone again already - the next event will say so
+            }
+            if (device != files.directoryDevice(parent)) {
+                metadata.inode = 0;   // Lives elsewhere - identity unknown (see FileCatalog)
+            }
+            if (fileIndex != FileCatalog::kNoFile) {
+                trackUsage(files.directoryOf(fileIndex), 0,
+                           static_cast<std::int64_t>(metadata.size) -
+                           static_cast<std::int64_t>(files.fileSize(fileIndex)));
+                files.updateFile(fileIndex, metadata.size, metadata.mtimeNs, metadata.inode);
+                watchStats.filesUpdated += 1;
+            } else {
+                std::string name = path.substr(cut + 1);
+                files.add(parent, name, extractExtension(name), metadata.size,
+                          metadata.mtimeNs, metadata.inode);
+                trackUsage(parent, 1, static_cast<std::int64_t>(metadata.size));
+                watchStats.filesAdded += 1;
+            }
+        } else if (nowDirectory && dirId == FileCatalog::kNoDirectory) {
+            int depth = static_cast<int>(files.directoryDepth(parent)) + 1;
+            if (options.recursive && (options.maxDepth < 0 || depth <= options.maxDepth)) {
+                newDirectories.emplace_back(path, depth);
+            }
+        }
+    }
+    
+    if (!newDirectories.empty()) {
+        watchStats.filesAdded += appendSubtrees(options, newDirectories);
+        watchStats.directoriesAdded += newDirectories.size();
+        usageStale = false;   // appendSubtrees() rebuilt it
+    }
+    
+    files.compactIfWasteful();   // Keeps every directory, so IDs stay valid
+    if (usageStale) {
+        usage.build(files);
+    }
+    
+    std::ostringstream summary;
+    summary << "Watch batch: " << events.size() << " events, "
+            << order.size() << " paths → +" << (watchStats.filesAdded - before.filesAdded)
+            << " -" << (watchStats.filesRemoved - before.filesRemoved)
+            << " ~" << (watchStats.filesUpdated - before.filesUpdated)
+            << " files (" << files.size() << " total)";
+    Logger::getInstance().log(summary.str());
+}
+
+/**
+ * @brief Lists new subtrees on one ThreadPool and appends them
+ * 
+ * Teaching Point: The subtrees go through the same DeviceScheduler as a
+ * full scan, so a new root on a slow mount is listed within its limit.
+ */
+std::size_t FileManager::appendSubtrees(const ScanOptions& options,
+                                        const std::vector<std::pair<std::string, int>>& subtrees,
+                                        std::string* error) {
+    ThreadPool pool(options.threadCount);
+    ScanContext ctx(options, pool);
+    for (const auto& dir : subtrees) {
+        if (options.symlinks == SymlinkPolicy::FollowAll && !ctx.markVisited(dir.first)) {
+            continue;
+        }
+        fs::path dirPath(dir.first);
+        int depth = dir.second;
+        ctx.io.submit(deviceOf(dir.first), dir.first,
+                      [this, &ctx, dirPath, depth] { scanDirectoryTask(ctx, dirPath, depth); });
+    }
+    pool.waitIdle();
+    if (error != nullptr && !ctx.rootErrors.empty()) {
+        *error = ctx.rootErrors.front();
+    }
+    
+    auto firstNew = static_cast<FileCatalog::DirectoryId>(files.directoryCount());
+    std::size_t filesBefore = files.size();
+    for (auto& bucket : ctx.perWorker) {
+        files.append(std::move(bucket));
+    }
+    files.linkDirectories();
+    usage.build(files, &pool);
+    if (watching) {
+        watchDirectories(firstNew);
+    }
+    return files.size() - filesBefore;
+}
+
+/**
+ * @brief Adds one root; only its subtree is listed
+ */
+bool FileManager::addRoot(const std::string& dirPath, std::string* error) {
+    const auto fail = [&](const std::string& reason) {
+        if (error != nullptr) {
+            *error = reason;
+        }
+        return false;
+    };
+    const std::string root = normaliseRoot(dirPath);
+    std::error_code ec;
+    if (root.empty() || !fs::is_directory(root, ec)) {
+        return fail("not a directory: " + dirPath);
+    }
+    
+    // Overlap is decided on canonical paths: "/data" and "/data/../data/x"
+    // nest even though the strings do not say so
+    const fs::path canonical = fs::weakly_canonical(root, ec);
+    for (const std::string& existing : roots) {
+        std::error_code existingEc;
+        const fs::path other = fs::weakly_canonical(existing, existingEc);
+        const auto inside = [](const fs::path& inner, const fs::path& outer) {
+            auto mismatch = std::mismatch(outer.begin(), outer.end(), inner.begin(), inner.end());
+            return mismatch.first == outer.end();
+        };
+        if (!ec && !existingEc && (inside(canonical, other) || inside(other, canonical))) {
+            return fail(dirPath + " overlaps the root " + existing);
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    roots.push_back(root);
+    if (files.directoryCount() == 0) {
+        selectIndex();      // Nothing scanned yet - the next scan includes it
+        return true;
+    }
+    
+    std::string rootError;
+    const auto started = std::chrono::steady_clock::now();
+    const std::size_t added = appendSubtrees(catalogOptions, {{root, 0}}, &rootError);
+    if (!rootError.empty()) {
+        roots.pop_back();
+        return fail(rootError);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    Logger::getInstance().log("Root added: " + root + " (" + std::to_string(added) + " files in " +
+                              std::to_string(ms) + " ms, " + std::to_string(roots.size()) + " roots)");
+    selectIndex();
+    saveIndex();
+    return true;
+}
+
+/**
+ * @brief Drops one root's subtree from the catalog
+ */
+bool FileManager::removeRoot(const std::string& dirPath, std::string* error) {
+    const std::string root = normaliseRoot(dirPath);
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    // "data" and "/home/me/data" name the same root
+    std::error_code ec;
+    const fs::path canonical = fs::weakly_canonical(root, ec);
+    auto found = std::find_if(roots.begin(), roots.end(), [&](const std::string& existing) {
+        std::error_code existingEc;
+        return existing == root || (!ec && fs::weakly_canonical(existing, existingEc) == canonical && !existingEc);
+    });
+    if (found == roots.end() || roots.size() == 1) {
+        if (error != nullptr) {
+            *error = found == roots.end() ? "not a root: " + dirPath : "cannot remove the only root";
+        }
+        return false;
+    }
+    const std::string stored = *found;
+    roots.erase(found);
+    targetDirectory = roots.front();
+    
+    const std::size_t removed = files.removeSubtree(stored);
+    usage.build(files);
+    if (watching) {
+        watchBackend->removeWatchesUnder(stored);
+    }
+    Logger::getInstance().log("Root removed: " + stored + " (" + std::to_string(removed) + " files, " +
+                              std::to_string(roots.size()) + " roots left)");
+    selectIndex();
+    if (files.directoryCount() > 0) {
+        saveIndex();
+    }
+    return true;
 }
 
 /**
@@ -246,7 +1177,9 @@ std::string FileManager::extractExtension(const std::string& filename) const {
  * =============================================================================
  * 
  * 1. STD::FILESYSTEM USAGE:
- *    - directory_iterator for scanning
+ *    - ScanBackend strategy for listing (one directory per pool task)
+ *    - Directory mtimes decide what an incremental rescan re-lists
+ *    - Change events (inotify) keep the catalog current in watch mode
  *    - path methods for file information
  *    - is_regular_file(), exists(), is_directory() for filtering
  *    - file_size() for metadata
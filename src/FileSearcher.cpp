@@ -1,6 +1,20 @@
 #include "../include/FileSearcher.h"
 #include "../include/Logger.h"
+#include "../include/ContentHash.h"
+#include "../include/ThreadPool.h"
+#include "../include/FileReader.h"
+#include "../include/HashCache.h"
+#include "../include/ChunkIndex.h"
+#include "../include/ContentChunker.h"
+#include "../include/TrigramIndex.h"
+#include "../include/SubstringSearch.h"
+#include "../include/AhoCorasick.h"
+#include "../include/FuzzyMatcher.h"
+#include "../include/Metrics.h"
+#include "../include/FileListing.h"
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -12,12 +26,25 @@
  * 
  * This class demonstrates:
  * 1. String manipulation algorithms
- * 2. Hash-based duplicate detection
+ * 2. Staged content-hash duplicate detection on a thread pool
+ *    (and content-defined chunking for near-duplicates)
  * 3. STL algorithms (find_if, transform, etc.)
- * 4. Map-based grouping techniques
+ * 4. Hash-table grouping on integer keys
  * 5. Custom comparison logic
  */
 
+namespace {
+
+    /**
+     * @brief Counts one finished query (its latency comes from a MetricTimer)
+     */
+    void countQuery(std::size_t results) {
+        Metrics& metrics = Metrics::getInstance();
+        metrics.add(Counter::SearchQueries);
+        metrics.add(Counter::SearchResults, results);
+    }
+}
+
 /**
  * @brief Converts string to lowercase
  * @param str Input string
@@ -62,217 +89,1181 @@ std::string FileSearcher::toLowercase(const std::string& str) const {
     return result;
 }
 
-/**
- * @brief Generates simple hash for duplicate detection
- * @param file FileInfo object
- * @return Hash string
- * 
- * Teaching Point: HASHING STRATEGIES
- * 
- * SIMPLE HASH (used here):
- * - Combines size + name
- * - Fast (no file reading)
- * - May have false positives (same size+name, different content)
- * 
- * PRODUCTION HASH (recommended):
- * - Read file content
- * - Compute MD5/SHA-256
- * - Slower but accurate
- * - No false positives
- * 
- * TRADE-OFF:
- * Speed vs Accuracy
- * 
- * For this educational project, simple hash is sufficient.
- * In production file deduplication (like Dropbox), use content hash.
- * 
- * IMPLEMENTATION NOTE:
- * std::to_string() converts numbers to strings
- * + operator concatenates strings
- */
-std::string FileSearcher::generateSimpleHash(const FileInfo& file) const {
-    return std::to_string(file.size) + "_" + file.name;
-}
-
 /**
  * @brief Searches files by partial name match
  * @param files All files to search
  * @param searchTerm Partial name to find
- * @return Vector of matching files
+ * @return Indices of matching files
  * 
  * Teaching Point: SUBSTRING SEARCH ALGORITHM
  * 
  * ALGORITHM:
  * 1. Convert search term to lowercase
- * 2. For each file:
- *    a. Convert filename to lowercase
- *    b. Check if search term is substring
- *    c. If yes, add to results
- * 3. Return results
- * 
- * TIME COMPLEXITY: O(n * m)
- * n = number of files
- * m = average string length
+ * 2. 3+ characters: the TrigramIndex names the candidates, each is
+ *    checked against its stored lowercase name
+ * 3. Shorter: searchByNameLinear() sweeps all lowercase names at once
+ * 4. Return results (in catalog order either way)
  * 
- * STRING::FIND() METHOD:
- * - Returns position of first occurrence
- * - Returns std::string::npos if not found
- * - Case-sensitive (that's why we convert to lowercase first)
+ * TIME COMPLEXITY: O(candidates * m) with the index
+ * m = average string length
  * 
  * EXAMPLE:
  * Files: ["report.txt", "Report_2024.pdf", "summary.doc"]
  * Search: "report"
  * 
- * After lowercase:
+ * Lowercase names (stored at scan time):
  * ["report.txt", "report_2024.pdf", "summary.doc"]
  * 
  * Matches: "report" found in first two
- * Results: ["report.txt", "Report_2024.pdf"]
+ * Results: [0, 1]
  */
-std::vector<FileInfo> FileSearcher::searchByName(
-    const std::vector<FileInfo>& files, 
+std::vector<FileCatalog::Index> FileSearcher::searchByName(
+    const FileCatalog& files, 
     const std::string& searchTerm) const {
     
-    std::vector<FileInfo> results;
     std::string lowerSearchTerm = toLowercase(searchTerm);
+    if (lowerSearchTerm.size() < TrigramIndex::kGramLength) {
+        return searchByNameLinear(files, searchTerm);
+    }
+    MetricTimer timer(Histogram::SearchQuery);
     
-    Logger::getInstance().log("Searching for files containing: " + searchTerm);
+    std::vector<FileCatalog::Index> candidates;
+    {
+        std::lock_guard<std::mutex> lock(nameIndexMutex);
+        refreshNameIndex(files);
+        nameIndex.candidates(lowerSearchTerm, candidates);
+    }
+    
+    // Exact check in place: keep candidates whose name really contains the term
+    std::size_t kept = 0;
+    for (FileCatalog::Index i : candidates) {
+        std::string_view name = files.lowerName(i);
+        if (SubstringSearch::find(name.data(), name.size(), lowerSearchTerm.data(),
+                                  lowerSearchTerm.size()) != SubstringSearch::npos) {
+            candidates[kept++] = i;
+        }
+    }
+    candidates.resize(kept);
+    timer.stop();
+    countQuery(candidates.size());
     
     /**
-     * Teaching Point: ALTERNATIVE IMPLEMENTATION with STL ALGORITHM
-     * 
-     * Could use std::copy_if for functional programming style:
-     * 
-     * std::copy_if(files.begin(), files.end(), 
-     *              std::back_inserter(results),
-     *              [&](const FileInfo& file) {
-     *                  std::string lowerName = toLowercase(file.name);
-     *                  return lowerName.find(lowerSearchTerm) != std::string::npos;
-     *              });
-     * 
-     * This is more concise but potentially less readable for beginners.
-     * Explicit loop below is clearer for learning purposes.
+     * Teaching Point: Log once per query, not once per match - every
+     * Logger call takes a mutex and writes to disk.
      */
+    Logger::getInstance().log("Search for \"" + searchTerm + "\" complete: " +
+                            std::to_string(candidates.size()) + " matches found");
+    return candidates;
+}
+
+/**
+ * @brief Builds the trigram index on the first query after a change
+ */
+void FileSearcher::refreshNameIndex(const FileCatalog& files) const {
+    if (nameIndex.isCurrent(files)) {
+        return;
+    }
+    auto started = std::chrono::steady_clock::now();
+    nameIndex.build(files);
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    Logger::getInstance().log("Name index built: " + std::to_string(files.size()) +
+                              " files, " + std::to_string(nameIndex.trigramCount()) +
+                              " trigrams, " + std::to_string(nameIndex.memoryUsage()) +
+                              " bytes in " + std::to_string(ms) + " ms");
+}
+
+/**
+ * @brief Warms both index families (same lock order as query())
+ */
+void FileSearcher::prepareIndexes(const FileCatalog& files) const {
+    std::lock_guard<std::mutex> lock(queryMutex);
+    std::lock_guard<std::mutex> namesLock(nameIndexMutex);
+    refreshNameIndex(files);
+    queryEngine.prepare(files);
+}
+
+/**
+ * @brief Runs an attribute query through the QueryEngine
+ * 
+ * The trigram index is only built (or refreshed) when the query has a
+ * name term long enough to use it. Lock order: queryMutex, then
+ * nameIndexMutex - searchByName() takes only the latter.
+ */
+std::vector<FileCatalog::Index> FileSearcher::query(const FileCatalog& files,
+                                                    const FileQuery& query,
+                                                    QueryStats* stats) const {
+    MetricTimer timer(Histogram::SearchQuery);
+    bool wantsNames = false;
+    for (const QueryPredicate& condition : query.predicates()) {
+        wantsNames |= condition.kind == QueryPredicate::Kind::NameContains &&
+                      condition.text.size() >= TrigramIndex::kGramLength;
+    }
     
-    for (const auto& file : files) {
-        std::string lowerFileName = toLowercase(file.name);
-        
-        // Check if search term is substring of filename
-        if (lowerFileName.find(lowerSearchTerm) != std::string::npos) {
-            results.push_back(file);
-            Logger::getInstance().log("Match found: " + file.name);
+    QueryStats local;
+    std::vector<FileCatalog::Index> results;
+    {
+        std::lock_guard<std::mutex> lock(queryMutex);
+        if (wantsNames) {
+            std::lock_guard<std::mutex> namesLock(nameIndexMutex);
+            refreshNameIndex(files);
+            results = queryEngine.run(files, query, &nameIndex, &local);
+        } else {
+            results = queryEngine.run(files, query, nullptr, &local);
         }
     }
+    timer.stop();
+    countQuery(results.size());
     
-    Logger::getInstance().log("Search complete: " + 
-                            std::to_string(results.size()) + " matches found");
+    Logger::getInstance().log("Query plan: " + local.plan + " - " +
+                              std::to_string(local.candidates) + " of " +
+                              std::to_string(local.rows) + " rows were candidates, " +
+                              std::to_string(local.results) + " matches");
+    if (stats != nullptr) {
+        *stats = local;
+    }
     return results;
 }
 
 /**
- * @brief Finds duplicate files
- * @param files All files to check
- * @return Map of hash → vector of duplicate files
+ * @brief Searches by sweeping every lowercase name (no index)
+ * 
+ * ALGORITHM (arena in index order - the normal case):
+ * 1. SubstringSearch::find() over the WHOLE lowercase arena from `from`
+ * 2. Hit → fileAtLowerOffset() names the file (binary search)
+ * 3. Record it and continue after the end of its name
+ *    (each file is reported once, even if the term occurs twice)
  * 
- * Teaching Point: HASH-BASED GROUPING ALGORITHM
+ * After swap-and-pop removals the arena is out of order; then each name
+ * is searched on its own (same kernel, shorter haystacks).
  * 
- * PROBLEM: Find all files that are duplicates of each other
+ * Teaching Point: ONE CALL, MANY NAMES
+ * The '\0' between names can never be part of a match, so scanning the
+ * whole arena in one call gives the same answer as one call per name -
+ * but the SIMD kernel runs over long stretches instead of 20-byte bits.
+ */
+std::vector<FileCatalog::Index> FileSearcher::searchByNameLinear(
+    const FileCatalog& files, 
+    const std::string& searchTerm) const {
+    
+    MetricTimer timer(Histogram::SearchQuery);
+    std::vector<FileCatalog::Index> results;
+    std::string lowerSearchTerm = toLowercase(searchTerm);
+    const char* term = lowerSearchTerm.data();
+    const std::size_t termLength = lowerSearchTerm.size();
+    
+    if (termLength == 0) {
+        results.resize(files.size());
+        for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+            results[i] = i;
+        }
+    } else if (files.lowerNamesInOrder()) {
+        std::string_view arena = files.lowerNameArena();
+        std::size_t from = 0;
+        while (from < arena.size()) {
+            std::size_t hit = SubstringSearch::find(arena.data() + from, arena.size() - from,
+                                                    term, termLength);
+            if (hit == SubstringSearch::npos) {
+                break;
+            }
+            hit += from;
+            FileCatalog::Index i = files.fileAtLowerOffset(hit);
+            if (i == FileCatalog::kNoFile) {
+                from = hit + 1;
+                continue;
+            }
+            std::string_view name = files.lowerName(i);
+            std::size_t nameEnd = static_cast<std::size_t>(name.data() - arena.data()) + name.size();
+            if (hit + termLength <= nameEnd) {
+                results.push_back(i);
+                from = nameEnd + 1;
+            } else {
+                from = hit + 1;
+            }
+        }
+    } else {
+        for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+            std::string_view name = files.lowerName(i);
+            if (SubstringSearch::find(name.data(), name.size(), term, termLength) !=
+                SubstringSearch::npos) {
+                results.push_back(i);
+            }
+        }
+    }
+    timer.stop();
+    countQuery(results.size());
+    
+    Logger::getInstance().log("Linear search for \"" + searchTerm + "\" (" +
+                            SubstringSearch::implementation() + "): " +
+                            std::to_string(results.size()) + " matches found");
+    return results;
+}
+
+/**
+ * @brief Batch search: one automaton, one pass, parallel shards
  * 
- * NAIVE APPROACH: Compare every file with every other file
- * - Time complexity: O(n²)
- * - For 1000 files: 1,000,000 comparisons!
+ * ALGORITHM:
+ * 1. Lowercase the terms and build an AhoCorasick automaton over them
+ * 2. Split the catalog into shards of kFilesPerShard files; one pool
+ *    task per shard runs the automaton over each lowercase name
+ * 3. Per name, a term seen twice is kept once (lastHit[term] = file + 1)
+ * 4. Shards are concatenated in order, so the result is sorted by file
  * 
- * HASH-BASED APPROACH: Group by hash
- * - Time complexity: O(n)
- * - For 1000 files: 1,000 comparisons!
+ * Teaching Point: NO SHARED WRITES
+ * Each task writes only its own shard's vector - no locks, no atomics.
+ * The automaton is read-only and shared by all tasks.
+ */
+std::vector<NameMatch> FileSearcher::searchByNames(const FileCatalog& files,
+                                                   const std::vector<std::string>& terms) const {
+    constexpr FileCatalog::Index kFilesPerShard = 16384;
+    
+    std::vector<std::string> lowerTerms;
+    lowerTerms.reserve(terms.size());
+    for (const std::string& term : terms) {
+        lowerTerms.push_back(toLowercase(term));
+    }
+    const AhoCorasick automaton(lowerTerms);
+    
+    MetricTimer timer(Histogram::SearchQuery);
+    auto started = std::chrono::steady_clock::now();
+    const auto fileCount = static_cast<FileCatalog::Index>(files.size());
+    const std::size_t shardCount = (fileCount + kFilesPerShard - 1) / kFilesPerShard;
+    std::vector<std::vector<NameMatch>> shards(shardCount);
+    {
+        std::unique_ptr<ThreadPool> ownPool;
+        TaskGroup group(workerPool(ownPool));
+        for (std::size_t shard = 0; shard < shardCount; ++shard) {
+            group.submit([&files, &automaton, &shards, &terms, shard, fileCount] {
+                const auto begin = static_cast<FileCatalog::Index>(shard * kFilesPerShard);
+                const FileCatalog::Index end = std::min<FileCatalog::Index>(fileCount, begin + kFilesPerShard);
+                std::vector<FileCatalog::Index> lastHit(terms.size(), 0);
+                std::vector<std::uint32_t> hits;
+                std::vector<NameMatch>& out = shards[shard];
+                for (FileCatalog::Index i = begin; i < end; ++i) {
+                    hits.clear();
+                    automaton.forEachMatch(files.lowerName(i), [&](std::uint32_t term) {
+                        if (lastHit[term] != i + 1) {
+                            lastHit[term] = i + 1;
+                            hits.push_back(term);
+                        }
+                    });
+                    std::sort(hits.begin(), hits.end());
+                    for (std::uint32_t term : hits) {
+                        out.push_back(NameMatch{i, term});
+                    }
+                }
+            });
+        }
+        group.wait();
+    }
+    
+    std::size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.size();
+    }
+    std::vector<NameMatch> matches;
+    matches.reserve(total);
+    for (const auto& shard : shards) {
+        matches.insert(matches.end(), shard.begin(), shard.end());
+    }
+    timer.stop();
+    countQuery(matches.size());
+    
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    Logger::getInstance().log("Batch search for " + std::to_string(terms.size()) + " terms (" +
+                            std::to_string(automaton.stateCount()) + " states): " +
+                            std::to_string(matches.size()) + " matches in " +
+                            std::to_string(ms) + " ms");
+    return matches;
+}
+
+/**
+ * @brief Scores every name with FuzzyMatcher, keeping the best `limit`
  * 
  * ALGORITHM:
- * 1. Create empty map<hash, vector<files>>
- * 2. For each file:
- *    a. Generate hash
- *    b. Add file to map[hash] vector
- * 3. Filter: Only keep groups with 2+ files
- * 4. Return duplicate groups
+ * 1. One matcher for the lowercased term (shared, read-only)
+ * 2. Per shard: score each lowercase name; keep a max-heap of at most
+ *    `limit` entries ordered by (errors, name length, index). Once the
+ *    heap is full, its worst entry's error count becomes the budget for
+ *    the next names - the matcher then gives up on them sooner.
+ * 3. Concatenate all shard heaps, sort, cut to `limit`
+ * 
+ * Ties break on the shorter name: "report" matches "report.txt" and
+ * "old_reports_backup_2019.zip" equally well, but the first is more
+ * likely what was meant.
+ */
+std::vector<FuzzyMatch> FileSearcher::searchByNameFuzzy(const FileCatalog& files,
+                                                        const std::string& searchTerm,
+                                                        std::size_t limit,
+                                                        int maxErrors) const {
+    constexpr FileCatalog::Index kFilesPerShard = 16384;
+    
+    const std::string lowerTerm = toLowercase(searchTerm);
+    const FuzzyMatcher matcher(lowerTerm);
+    const std::uint32_t budget = maxErrors >= 0 ? static_cast<std::uint32_t>(maxErrors)
+                                                : FuzzyMatcher::defaultMaxErrors(matcher.termLength());
+    if (limit == 0 || files.empty()) {
+        return {};
+    }
+    
+    struct Ranked {
+        std::uint32_t errors;
+        std::uint32_t length;
+        FileCatalog::Index file;
+        bool operator<(const Ranked& other) const {
+            if (errors != other.errors) return errors < other.errors;
+            if (length != other.length) return length < other.length;
+            return file < other.file;
+        }
+    };
+    
+    MetricTimer timer(Histogram::SearchQuery);
+    auto started = std::chrono::steady_clock::now();
+    const auto fileCount = static_cast<FileCatalog::Index>(files.size());
+    const std::size_t shardCount = (fileCount + kFilesPerShard - 1) / kFilesPerShard;
+    std::vector<std::vector<Ranked>> shards(shardCount);
+    {
+        std::unique_ptr<ThreadPool> ownPool;
+        TaskGroup group(workerPool(ownPool));
+        for (std::size_t shard = 0; shard < shardCount; ++shard) {
+            group.submit([&files, &matcher, &shards, shard, fileCount, budget, limit] {
+                const auto begin = static_cast<FileCatalog::Index>(shard * kFilesPerShard);
+                const FileCatalog::Index end = std::min<FileCatalog::Index>(fileCount, begin + kFilesPerShard);
+                std::vector<Ranked>& heap = shards[shard];
+                heap.reserve(std::min<std::size_t>(limit, end - begin));   // Never more than the shard can fill
+                std::uint32_t allowed = budget;
+                for (FileCatalog::Index i = begin; i < end; ++i) {
+                    std::string_view name = files.lowerName(i);
+                    std::uint32_t errors = matcher.distance(name, allowed);
+                    if (errors > allowed) {
+                        continue;
+                    }
+                    Ranked entry{errors, static_cast<std::uint32_t>(name.size()), i};
+                    if (heap.size() < limit) {
+                        heap.push_back(entry);
+                        std::push_heap(heap.begin(), heap.end());
+                    } else if (entry < heap.front()) {
+                        std::pop_heap(heap.begin(), heap.end());
+                        heap.back() = entry;
+                        std::push_heap(heap.begin(), heap.end());
+                    } else {
+                        continue;
+                    }
+                    if (heap.size() == limit) {
+                        allowed = heap.front().errors;   // Worse than the worst kept: useless
+                    }
+                }
+            });
+        }
+        group.wait();
+    }
+    
+    std::vector<Ranked> merged;
+    for (const auto& shard : shards) {
+        merged.insert(merged.end(), shard.begin(), shard.end());
+    }
+    std::sort(merged.begin(), merged.end());
+    if (merged.size() > limit) {
+        merged.resize(limit);
+    }
+    std::vector<FuzzyMatch> matches;
+    matches.reserve(merged.size());
+    for (const Ranked& entry : merged) {
+        matches.push_back(FuzzyMatch{entry.file, entry.errors});
+    }
+    timer.stop();
+    countQuery(matches.size());
+    
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    Logger::getInstance().log("Fuzzy search for \"" + searchTerm + "\" (up to " +
+                            std::to_string(budget) + " errors): " +
+                            std::to_string(matches.size()) + " results in " +
+                            std::to_string(ms) + " ms");
+    return matches;
+}
+
+namespace {
+
+    /**
+     * Teaching Point: HOW MUCH IS "A FEW KB"?
+     * 4 KB is one page / one disk block: reading it costs about as much as
+     * reading 1 byte, and headers + trailers catch nearly every difference
+     * between same-sized files (different images, archives, documents).
+     */
+    constexpr std::uint64_t kEdgeBytes = 4096;
+    constexpr std::size_t kFilesPerTask = 16;
+
+    /**
+     * @brief One file that survived the size filter
+     */
+    struct Candidate {
+        FileCatalog::Index index = 0;
+        std::uint64_t size = 0;
+        std::uint64_t partial = 0;     // Hash of head + tail (stage 2)
+        std::uint64_t full = 0;        // Hash of everything (stage 3)
+        std::uint64_t bytesRead = 0;
+        FileIdentity identity;         // From the catalog (key of the hash cache)
+        FileIdentity seen;             // From fstat when the file was read
+        bool complete = false;         // Stage 2 already saw the whole file
+        bool readable = true;
+    };
+
+    /**
+     * @brief Feeds ranges of a candidate's file into a hasher via the reader
+     */
+    bool hashRanges(FileReader& reader, const std::string& path, const ReadRange* ranges,
+                    std::size_t count, Candidate& c, XXHash64& hasher) {
+        MetricTimer timer(Histogram::HashFile);
+        const std::uint64_t before = c.bytesRead;
+        const bool readable = reader.readRanges(path, ranges, count,
+                                                [&hasher](const char* data, std::size_t length) {
+                                                    hasher.update(data, length);
+                                                },
+                                                c.bytesRead, &c.seen);
+        timer.stop();
+        Metrics& metrics = Metrics::getInstance();
+        metrics.add(Counter::HashFiles);
+        metrics.add(Counter::HashBytes, c.bytesRead - before);
+        return readable;
+    }
+
+    /**
+     * @brief Stage 2: hash the first and last kEdgeBytes
+     *
+     * Small files (≤ 2 × kEdgeBytes) are read whole - their "partial" hash
+     * is already the full hash and stage 3 skips them.
+     * The size seeds the hash so equal edges of different sizes never match.
+     */
+    void hashEdges(FileReader& reader, const std::string& path, Candidate& c) {
+        XXHash64 hasher(c.size);
+        if (c.size <= 2 * kEdgeBytes) {
+            ReadRange whole{0, c.size};
+            c.readable = hashRanges(reader, path, &whole, 1, c, hasher);
+            c.complete = true;
+        } else {
+            ReadRange edges[2] = {{0, kEdgeBytes}, {c.size - kEdgeBytes, kEdgeBytes}};
+            c.readable = hashRanges(reader, path, edges, 2, c, hasher);
+        }
+        c.partial = hasher.digest();
+        if (c.complete) {
+            c.full = c.partial;
+        }
+    }
+
+    /**
+     * @brief Stage 3: hash the whole file
+     */
+    void hashWhole(FileReader& reader, const std::string& path, Candidate& c) {
+        XXHash64 hasher(c.size);
+        ReadRange whole{0, c.size};
+        c.readable = hashRanges(reader, path, &whole, 1, c, hasher);
+        c.full = hasher.digest();
+    }
+
+    /**
+     * @brief Runs work(candidate) for the listed candidates on a pool
+     *
+     * Teaching Point: Each task owns a slice of candidates and writes only
+     * into its own structs - no locks. Read buffers come from the reader's
+     * fixed pool, so nothing is allocated per file. Any Item with an
+     * `index` into the catalog works (Candidate, Sketch).
+     */
+    template <typename Item, typename Work>
+    void runParallel(ThreadPool& pool, FileReader& reader, const FileCatalog& files,
+                     std::vector<Item>& candidates, const std::vector<std::size_t>& selected,
+                     Work work) {
+        TaskGroup group(pool);
+        for (std::size_t begin = 0; begin < selected.size(); begin += kFilesPerTask) {
+            std::size_t end = std::min(selected.size(), begin + kFilesPerTask);
+            group.submit([&reader, &files, &candidates, &selected, work, begin, end] {
+                std::string path;
+                for (std::size_t k = begin; k < end; ++k) {
+                    Item& c = candidates[selected[k]];
+                    std::string_view p = files.path(c.index);
+                    path.assign(p.data(), p.size());
+                    work(reader, path, c);
+                }
+            });
+        }
+        group.wait();
+    }
+
+    /**
+     * @brief Calls visit(first, last) for every run of 2+ equal keys
+     * @param order Candidate positions, sorted so equal keys are adjacent
+     */
+    template <typename Key, typename Visit>
+    void forEachCollision(const std::vector<std::size_t>& order, Key key, Visit visit) {
+        for (std::size_t first = 0; first < order.size();) {
+            std::size_t last = first + 1;
+            while (last < order.size() && key(order[last]) == key(order[first])) {
+                ++last;
+            }
+            if (last - first >= 2) {
+                visit(first, last);
+            }
+            first = last;
+        }
+    }
+    
+    /**
+     * @brief Integer key of a final duplicate group
+     */
+    struct GroupKey {
+        std::uint64_t size;
+        std::uint64_t hash;
+        bool operator==(const GroupKey& other) const {
+            return size == other.size && hash == other.hash;
+        }
+    };
+    
+    /**
+     * Teaching Point: The full hash is already XXH64 output - uniformly
+     * distributed - so mixing in the size is all the hashing left to do.
+     */
+    struct GroupKeyHasher {
+        std::size_t operator()(const GroupKey& key) const {
+            return static_cast<std::size_t>(key.hash ^ (key.size * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+}
+
+/**
+ * @brief Finds duplicate files by content
+ * @param files All files to check
+ * @return Groups of catalog indices with identical content
+ * 
+ * Teaching Point: A FUNNEL OF EVER MORE EXPENSIVE TESTS
+ * 
+ * NAIVE APPROACH: hash every file completely
+ * - Reads every byte in the tree (hundreds of GB → hours)
  * 
- * DATA STRUCTURE: std::map<std::string, std::vector<FileInfo>>
+ * STAGED APPROACH:
+ * 1. SIZE:    sort by size; a file with a unique size has no duplicate.
+ *             Typically > 90% of files are eliminated without any I/O.
+ * 2. PARTIAL: hash first + last 4 KB of the rest (≤ 8 KB per file,
+ *             two pread() calls through FileReader).
+ *             Same-sized but different files almost always differ here.
+ * 3. FULL:    hash the files that STILL collide - these are nearly
+ *             always real duplicates, so the expensive read is rarely wasted.
  * 
- * Key = hash (identifies duplicate group)
- * Value = vector of files with that hash
+ * With a HashCache attached, stages 2 and 3 first ask the cache: a file
+ * whose (device, inode, size, mtime) is unchanged is not read at all.
+ * 
+ * Teaching Point: INTEGER KEYS instead of map<string, vector<FileInfo>>
+ * Stage 2 sorts candidates by (size, partial) so equal keys sit next to
+ * each other; one linear pass finds every collision. The final groups are
+ * counted in an unordered_map keyed by (size, full) - two integers, no
+ * string is ever built - and laid out in one shared index array, like a
+ * counting sort.
  * 
  * EXAMPLE:
- * Files:
- * - file1.txt (1024 bytes)
- * - file2.txt (2048 bytes)
- * - file1_copy.txt (1024 bytes, same name)
- * - file3.txt (1024 bytes, different name)
- * 
- * After grouping:
- * {
- *   "1024_file1.txt" → [file1.txt, file1_copy.txt],
- *   "2048_file2.txt" → [file2.txt],
- *   "1024_file3.txt" → [file3.txt]
- * }
- * 
- * After filtering (2+ files only):
- * {
- *   "1024_file1.txt" → [file1.txt, file1_copy.txt]
- * }
+ * a.jpg (2 MB), b.jpg (2 MB, copy of a), c.jpg (2 MB, other photo), d.txt (1 KB)
+ * 
+ * Stage 1: d.txt unique size → dropped           (0 bytes read)
+ * Stage 2: c.jpg edges differ → dropped          (3 × 8 KB read)
+ * Stage 3: a.jpg, b.jpg hashed fully → one group (2 × 2 MB read)
  */
-std::map<std::string, std::vector<FileInfo>> FileSearcher::findDuplicates(
-    const std::vector<FileInfo>& files) const {
+DuplicateResult FileSearcher::findDuplicates(const FileCatalog& files,
+                                             DuplicateStats* stats) const {
     
-    // Step 1: Group by hash
-    std::map<std::string, std::vector<FileInfo>> hashGroups;
+    DuplicateStats local;
+    local.files = files.size();
+    DuplicateResult duplicates;
     
     Logger::getInstance().log("Starting duplicate detection on " + 
                             std::to_string(files.size()) + " files");
     
-    /**
-     * Teaching Point: MAP INSERTION AND VECTOR PUSH_BACK
-     * 
-     * map[key] - If key doesn't exist, creates empty vector
-     * .push_back(value) - Adds to that vector
-     * 
-     * This is idempotent - works whether key exists or not
-     * 
-     * FIRST INSERT:
-     * hashGroups["hash1"] → creates empty vector
-     * .push_back(file) → vector now has 1 element
-     * 
-     * SUBSEQUENT INSERTS:
-     * hashGroups["hash1"] → returns existing vector
-     * .push_back(file) → vector now has 2+ elements
-     */
-    for (const auto& file : files) {
-        std::string hash = generateSimpleHash(file);
-        hashGroups[hash].push_back(file);
+    // Stage 1: group by size (empty files are all "equal" but reclaim nothing)
+    std::vector<FileCatalog::Index> bySize;
+    bySize.reserve(files.size());
+    for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+        local.totalBytes += files.fileSize(i);
+        if (files.fileSize(i) > 0) {
+            bySize.push_back(i);
+        }
+    }
+    std::sort(bySize.begin(), bySize.end(), [&files](FileCatalog::Index a, FileCatalog::Index b) {
+        return files.fileSize(a) < files.fileSize(b);
+    });
+    
+    std::vector<Candidate> candidates;
+    for (std::size_t first = 0; first < bySize.size();) {
+        std::size_t last = first + 1;
+        std::uint64_t size = files.fileSize(bySize[first]);
+        while (last < bySize.size() && files.fileSize(bySize[last]) == size) {
+            ++last;
+        }
+        if (last - first >= 2) {
+            for (std::size_t k = first; k < last; ++k) {
+                Candidate c;
+                c.index = bySize[k];
+                c.size = size;
+                c.identity.device = files.fileDevice(c.index);
+                c.identity.inode = files.fileInode(c.index);
+                c.identity.size = size;
+                c.identity.mtimeNs = files.fileMtime(c.index);
+                candidates.push_back(c);
+            }
+        }
+        first = last;
+    }
+    local.sizeCandidates = candidates.size();
+    
+    std::unique_ptr<ThreadPool> ownPool;
+    ThreadPool& pool = workerPool(ownPool);
+    FileReader reader(readerOptions);
+    auto started = std::chrono::steady_clock::now();
+    
+    // A hash read from a file that changed since the scan must not be
+    // cached under the scan's (now stale) identity
+    auto cacheable = [](const Candidate& c) {
+        return c.readable && c.identity.known() && c.seen == c.identity;
+    };
+    
+    // Stage 2: partial hashes for every size candidate (cache first). The
+    // lookup key is the scan's identity - trustworthy because the scan asks
+    // network filesystems for fresh attributes (LinuxScanBackend)
+    std::vector<std::size_t> selected;
+    for (std::size_t k = 0; k < candidates.size(); ++k) {
+        Candidate& c = candidates[k];
+        if (hashCache && hashCache->lookupPartial(c.identity, c.partial)) {
+            c.complete = c.size <= 2 * kEdgeBytes;
+            c.full = c.complete ? c.partial : 0;
+            ++local.cacheHits;
+        } else {
+            selected.push_back(k);
+        }
+    }
+    runParallel(pool, reader, files, candidates, selected, hashEdges);
+    local.partialHashed = selected.size();
+    if (hashCache) {
+        for (std::size_t k : selected) {
+            if (cacheable(candidates[k])) {
+                hashCache->storePartial(candidates[k].identity, candidates[k].partial);
+            }
+        }
+    }
+    
+    auto partialKey = [&candidates](std::size_t k) {
+        return std::make_pair(candidates[k].size, candidates[k].partial);
+    };
+    std::vector<std::size_t> order;
+    for (std::size_t k = 0; k < candidates.size(); ++k) {
+        if (candidates[k].readable) {
+            order.push_back(k);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&partialKey](std::size_t a, std::size_t b) {
+        return partialKey(a) < partialKey(b);
+    });
+    
+    // Stage 3: full hashes for files still colliding (small files are done)
+    selected.clear();
+    std::vector<std::size_t> survivors;
+    forEachCollision(order, partialKey, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            Candidate& c = candidates[order[k]];
+            survivors.push_back(order[k]);
+            if (c.complete) {
+                continue;
+            }
+            if (hashCache && hashCache->lookupFull(c.identity, c.full)) {
+                ++local.cacheHits;
+            } else {
+                selected.push_back(order[k]);
+            }
+        }
+    });
+    runParallel(pool, reader, files, candidates, selected, hashWhole);
+    local.fullHashed = selected.size();
+    if (hashCache) {
+        for (std::size_t k : selected) {
+            if (cacheable(candidates[k])) {
+                hashCache->storeFull(candidates[k].identity, candidates[k].full);
+            }
+        }
+        hashCache->flush();
+    }
+    
+    order.clear();
+    for (std::size_t k : survivors) {
+        if (candidates[k].readable) {
+            order.push_back(k);
+            // 0 means "not computed" in the catalog - nudge the 1-in-2^64 case
+            files.setHash(candidates[k].index, candidates[k].full == 0 ? 1 : candidates[k].full);
+        }
+    }
+    
+    // Final grouping: count each (size, full) key...
+    std::unordered_map<GroupKey, std::size_t, GroupKeyHasher> slotByKey;
+    slotByKey.reserve(order.size());
+    std::vector<DuplicateGroup> slots;
+    std::vector<std::size_t> slotOf(order.size());
+    for (std::size_t j = 0; j < order.size(); ++j) {
+        const Candidate& c = candidates[order[j]];
+        auto inserted = slotByKey.try_emplace(GroupKey{c.size, c.full}, slots.size());
+        if (inserted.second) {
+            DuplicateGroup group;
+            group.size = c.size;
+            group.hash = c.full;
+            slots.push_back(group);
+        }
+        slotOf[j] = inserted.first->second;
+        slots[slotOf[j]].count += 1;
+    }
+    
+    // ...keep keys seen twice or more, biggest saving first...
+    std::vector<std::size_t> groupOfSlot(slots.size(), slots.size());
+    std::vector<std::size_t> kept;
+    for (std::size_t slot = 0; slot < slots.size(); ++slot) {
+        if (slots[slot].count >= 2) {
+            kept.push_back(slot);
+        }
+    }
+    std::sort(kept.begin(), kept.end(), [&slots](std::size_t a, std::size_t b) {
+        const DuplicateGroup& x = slots[a];
+        const DuplicateGroup& y = slots[b];
+        if (x.reclaimableBytes() != y.reclaimableBytes()) {
+            return x.reclaimableBytes() > y.reclaimableBytes();
+        }
+        return x.size != y.size ? x.size > y.size : x.hash < y.hash;
+    });
+    std::size_t members = 0;
+    duplicates.groups.reserve(kept.size());
+    for (std::size_t slot : kept) {
+        groupOfSlot[slot] = duplicates.groups.size();
+        DuplicateGroup group = slots[slot];
+        group.first = members;
+        members += group.count;
+        group.count = 0;   // Refilled below as the write cursor
+        duplicates.groups.push_back(group);
     }
     
-    // Step 2: Filter groups (only keep those with 2+ files)
-    std::map<std::string, std::vector<FileInfo>> duplicates;
+    // ...and drop every member into its group's slice of one array
+    duplicates.files.resize(members);
+    for (std::size_t j = 0; j < order.size(); ++j) {
+        std::size_t g = groupOfSlot[slotOf[j]];
+        if (g == slots.size()) {
+            continue;   // Unique content
+        }
+        DuplicateGroup& group = duplicates.groups[g];
+        duplicates.files[group.first + group.count] = candidates[order[j]].index;
+        group.count += 1;
+    }
+    for (DuplicateGroup& group : duplicates.groups) {
+        std::sort(duplicates.files.begin() + static_cast<std::ptrdiff_t>(group.first),
+                  duplicates.files.begin() + static_cast<std::ptrdiff_t>(group.first + group.count));
+        SFM_LOG(Debug, "Duplicate group found: {} files", group.count);
+    }
     
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    local.mappedBytes = reader.stats().mappedBytes;
+    for (const Candidate& c : candidates) {
+        local.bytesRead += c.bytesRead;
+        if (!c.readable) {
+            ++local.unreadable;
+        }
+    }
+    
+    double percent = local.totalBytes == 0 ? 0.0 :
+        100.0 * static_cast<double>(local.bytesRead) / static_cast<double>(local.totalBytes);
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2)
+            << "Duplicate detection complete: " << duplicates.size() << " groups ("
+            << duplicates.reclaimableBytes() << " bytes reclaimable), "
+            << local.sizeCandidates << " size candidates, "
+            << local.fullHashed << " fully hashed, " << local.cacheHits << " cache hits, read "
+            << local.bytesRead << " of " << local.totalBytes << " bytes (" << percent << "%)";
+    if (local.seconds > 0 && local.bytesRead > 0) {
+        summary << " at " << static_cast<double>(local.bytesRead) / (1024.0 * 1024.0) / local.seconds
+                << " MB/s";
+    }
+    if (local.unreadable > 0) {
+        summary << ", " << local.unreadable << " unreadable";
+    }
+    Logger::getInstance().log(summary.str());
+    
+    if (stats) {
+        *stats = local;
+    }
+    return duplicates;
+}
+
+/**
+ * Teaching Point: A pool of its own per call costs one thread start and
+ * join per hardware thread - fine for one menu action, far too much per
+ * request when many daemon clients search at once.
+ */
+ThreadPool& FileSearcher::workerPool(std::unique_ptr<ThreadPool>& own) const {
+    if (sharedPool) {
+        return *sharedPool;
+    }
+    own = std::make_unique<ThreadPool>();
+    return *own;
+}
+
+void FileSearcher::setHashCache(std::shared_ptr<HashCache> cache) {
+    hashCache = std::move(cache);
+}
+
+void FileSearcher::setChunkIndex(std::shared_ptr<ChunkIndex> index) {
+    chunkIndex = std::move(index);
+}
+
+namespace {
+
     /**
-     * Teaching Point: FILTERING WITH CONDITIONAL INSERTION
+     * @brief Copies one file of a streamed batch into a collecting catalog
      * 
-     * We iterate through hashGroups and only copy groups with size >= 2
-     * 
-     * This is a filter operation - keeping only elements that meet criteria
-     * 
-     * ALTERNATIVE with STL:
-     * Could use std::copy_if, but map filtering is less straightforward
-     * Explicit loop is clearer here
+     * Teaching Point: Directories are registered per catalog on demand
+     * (findDirectory builds its lookup once, add keeps it current).
+     */
+    void copyFileInto(FileCatalog& target, const FileCatalog& source, FileCatalog::Index i) {
+        FileCatalog::DirectoryId sourceDir = source.directoryOf(i);
+        std::string_view dirPath = source.directoryPath(sourceDir);
+        FileCatalog::DirectoryId dir = target.findDirectory(dirPath);
+        if (dir == FileCatalog::kNoDirectory) {
+            dir = target.addDirectory(dirPath, source.directoryDepth(sourceDir),
+                                      source.directoryMtime(sourceDir),
+                                      source.directoryDevice(sourceDir));
+        }
+        target.addFrom(source, i, dir);
+    }
+}
+
+/**
+ * @brief Streaming duplicate detection, one batch at a time
+ * 
+ * ALGORITHM per file:
+ * 1. Size never seen → copy the file into firstBySize, nothing else
+ * 2. Size seen once  → move the remembered file + this one to candidates
+ * 3. Size repeated   → append this one to candidates
+ */
+void FileSearcher::collectDuplicates(const FileCatalog& batch,
+                                     DuplicateCollector& collector) const {
+    for (FileCatalog::Index i = 0; i < batch.size(); ++i) {
+        std::uint64_t size = batch.fileSize(i);
+        if (size == 0) {
+            continue;
+        }
+        
+        auto first = collector.indexBySize.try_emplace(size, FileCatalog::kNoFile);
+        if (first.second) {
+            first.first->second = static_cast<FileCatalog::Index>(collector.firstBySize.size());
+            copyFileInto(collector.firstBySize, batch, i);
+            continue;
+        }
+        if (first.first->second != FileCatalog::kNoFile) {
+            // Second file of this size: the remembered one becomes a candidate too
+            copyFileInto(collector.candidates, collector.firstBySize, first.first->second);
+            first.first->second = FileCatalog::kNoFile;
+        }
+        copyFileInto(collector.candidates, batch, i);
+    }
+}
+
+namespace {
+
+    /**
+     * Teaching Point: A chunk found in more than this many files (zero
+     * pages, a common container header) says nothing about which files
+     * belong together - and n files would add n²/2 pair updates.
+     */
+    constexpr std::size_t kMaxFilesPerChunk = 64;
+
+    /**
+     * @brief One file of a near-duplicate search
+     */
+    struct Sketch {
+        FileCatalog::Index index = 0;
+        std::uint64_t size = 0;
+        std::uint64_t partial = 0;     // Same value hashEdges() computes
+        std::uint64_t full = 0;        // Same value hashWhole() computes
+        std::uint64_t bytesRead = 0;
+        FileIdentity identity;         // From the catalog (key of both caches)
+        FileIdentity seen;             // From fstat when the file was read
+        std::vector<Chunk> chunks;
+        bool hasFull = false;
+        bool readable = true;
+    };
+
+    /**
+     * @brief One distinct chunk of one file
+     */
+    struct Posting {
+        std::uint64_t fingerprint;
+        std::uint32_t sketch;          // Position in the sketch list
+        std::uint32_t length;
+        std::uint32_t count;           // Occurrences in that file
+    };
+
+    /**
+     * @brief Reads a file once: chunks, full hash and edge hash together
+     *
+     * Teaching Point: ONE PASS, THREE RESULTS
+     * The bytes are in cache anyway - feeding them to the chunker, the
+     * full XXH64 and a copy of the first/last kEdgeBytes costs little
+     * more than chunking alone, and saves findDuplicates() a second read.
+     * The edge hasher gets exactly the bytes hashEdges() would read.
      */
-    for (const auto& [hash, group] : hashGroups) {
-        if (group.size() >= 2) {
-            duplicates[hash] = group;
-            Logger::getInstance().log("Duplicate group found: " + 
-                                    std::to_string(group.size()) + " files");
+    void chunkWhole(FileReader& reader, const std::string& path, Sketch& s,
+                    const ChunkerOptions& options) {
+        constexpr std::size_t kEdge = static_cast<std::size_t>(kEdgeBytes);
+        MetricTimer timer(Histogram::HashFile);
+        ContentChunker chunker(options);
+        XXHash64 full(s.size);
+        char head[kEdge];
+        char tail[kEdge];
+        std::size_t headBytes = 0;
+        std::size_t tailBytes = 0;
+        auto sink = [&](const char* data, std::size_t length) {
+            chunker.update(data, length);
+            full.update(data, length);
+            if (headBytes < kEdge) {
+                const std::size_t n = std::min(kEdge - headBytes, length);
+                std::memcpy(head + headBytes, data, n);
+                headBytes += n;
+            }
+            if (length >= kEdge) {
+                std::memcpy(tail, data + length - kEdge, kEdge);
+                tailBytes = kEdge;
+            } else {
+                const std::size_t keep = std::min(tailBytes, kEdge - length);
+                std::memmove(tail, tail + tailBytes - keep, keep);
+                std::memcpy(tail + keep, data, length);
+                tailBytes = keep + length;
+            }
+        };
+        ReadRange whole{0, s.size};
+        s.readable = reader.readRanges(path, &whole, 1, sink, s.bytesRead, &s.seen);
+        timer.stop();
+        Metrics& metrics = Metrics::getInstance();
+        metrics.add(Counter::HashFiles);
+        metrics.add(Counter::HashBytes, s.bytesRead);
+
+        chunker.finish();
+        s.chunks = chunker.take();
+        s.full = full.digest();
+        s.hasFull = s.readable;
+        if (s.size <= 2 * kEdgeBytes) {
+            s.partial = s.full;
+        } else {
+            XXHash64 edges(s.size);
+            edges.update(head, kEdge);
+            edges.update(tail, kEdge);
+            s.partial = edges.digest();
         }
     }
+}
+
+/**
+ * @brief Finds near-duplicates by counting shared content-defined chunks
+ * 
+ * Teaching Point: INVERT, THEN COUNT
+ * Comparing every pair of files is O(n²) chunk-list merges. Inverting the
+ * lists - "which files contain chunk f?" - by sorting one array of
+ * postings makes every file pair that shares a chunk meet in one run, so
+ * the work grows with the number of SHARED chunks, not with n².
+ * 
+ * Similarity is measured against the SMALLER file: a log and the same log
+ * with a week appended are 100% similar, because the smaller one could be
+ * stored entirely as references into the larger.
+ * 
+ * EXAMPLE (64 KB chunks):
+ * disk.img (10 GB) and disk-after-update.img (10 GB, 300 MB rewritten)
+ * → ~9.7 GB shared, similarity 97%, ~9.7 GB deduplicable
+ */
+NearDuplicateResult FileSearcher::findNearDuplicates(const FileCatalog& files,
+                                                     const NearDuplicateOptions& options,
+                                                     NearDuplicateStats* stats) const {
+    NearDuplicateStats local;
+    local.files = files.size();
+    NearDuplicateResult result;
     
-    Logger::getInstance().log("Duplicate detection complete: " + 
-                            std::to_string(duplicates.size()) + " groups found");
-    return duplicates;
+    Logger::getInstance().log("Starting near-duplicate detection on " +
+                              std::to_string(files.size()) + " files");
+    
+    const std::uint64_t minSize = std::max<std::uint64_t>(options.minSize, 1);
+    std::vector<Sketch> sketches;
+    for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+        if (files.fileSize(i) < minSize) {
+            continue;
+        }
+        Sketch s;
+        s.index = i;
+        s.size = files.fileSize(i);
+        s.identity.device = files.fileDevice(i);
+        s.identity.inode = files.fileInode(i);
+        s.identity.size = s.size;
+        s.identity.mtimeNs = files.fileMtime(i);
+        sketches.push_back(std::move(s));
+    }
+    local.candidates = sketches.size();
+    
+    const bool useIndex = chunkIndex && chunkIndex->chunking() == options.chunking;
+    if (chunkIndex && !useIndex) {
+        Logger::getInstance().log("Chunk index not used: it holds other chunk sizes (" +
+                                  chunkIndex->getPath() + ")");
+    }
+    
+    // Unchanged files: chunk list from the index, full hash from the cache
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::size_t> selected;
+    for (std::size_t k = 0; k < sketches.size(); ++k) {
+        Sketch& s = sketches[k];
+        if (useIndex && chunkIndex->lookup(s.identity, s.chunks)) {
+            s.hasFull = hashCache && hashCache->lookupFull(s.identity, s.full);
+            ++local.cacheHits;
+        } else {
+            selected.push_back(k);
+        }
+    }
+    
+    std::unique_ptr<ThreadPool> ownPool;
+    ThreadPool& pool = workerPool(ownPool);
+    FileReader reader(readerOptions);
+    const ChunkerOptions chunking = options.chunking;
+    runParallel(pool, reader, files, sketches, selected,
+                [chunking](FileReader& r, const std::string& path, Sketch& s) {
+                    chunkWhole(r, path, s, chunking);
+                });
+    local.chunked = selected.size();
+    for (std::size_t k : selected) {
+        const Sketch& s = sketches[k];
+        if (!s.readable) {
+            continue;
+        }
+        files.setHash(s.index, s.full == 0 ? 1 : s.full);
+        if (!s.identity.known() || s.seen != s.identity) {
+            continue;   // Changed since the scan - not cacheable under its identity
+        }
+        if (hashCache) {
+            hashCache->storePartial(s.identity, s.partial);
+            hashCache->storeFull(s.identity, s.full);
+        }
+        if (useIndex) {
+            chunkIndex->store(s.identity, s.chunks);
+        }
+    }
+    if (hashCache) {
+        hashCache->flush();
+    }
+    if (useIndex) {
+        chunkIndex->flush();
+    }
+    
+    // One posting per distinct chunk of each file (the chunk lists go away)
+    std::vector<Posting> postings;
+    for (std::size_t k = 0; k < sketches.size(); ++k) {
+        Sketch& s = sketches[k];
+        local.bytesRead += s.bytesRead;
+        if (!s.readable) {
+            ++local.unreadable;
+            continue;
+        }
+        result.candidateBytes += s.size;
+        local.chunks += s.chunks.size();
+        std::sort(s.chunks.begin(), s.chunks.end(), [](const Chunk& a, const Chunk& b) {
+            return a.fingerprint < b.fingerprint;
+        });
+        for (std::size_t first = 0; first < s.chunks.size();) {
+            std::size_t last = first + 1;
+            while (last < s.chunks.size() && s.chunks[last].fingerprint == s.chunks[first].fingerprint) {
+                ++last;
+            }
+            postings.push_back(Posting{s.chunks[first].fingerprint, static_cast<std::uint32_t>(k),
+                                       s.chunks[first].length, static_cast<std::uint32_t>(last - first)});
+            first = last;
+        }
+        std::vector<Chunk>().swap(s.chunks);
+    }
+    std::sort(postings.begin(), postings.end(), [](const Posting& a, const Posting& b) {
+        return a.fingerprint != b.fingerprint ? a.fingerprint < b.fingerprint : a.sketch < b.sketch;
+    });
+    
+    // Each run of one fingerprint credits every pair of files in it
+    std::unordered_map<std::uint64_t, std::uint64_t> sharedByPair;
+    for (std::size_t first = 0; first < postings.size();) {
+        std::size_t last = first + 1;
+        std::uint64_t occurrences = postings[first].count;
+        while (last < postings.size() && postings[last].fingerprint == postings[first].fingerprint) {
+            occurrences += postings[last].count;
+            ++last;
+        }
+        const std::uint64_t length = postings[first].length;
+        result.deduplicableBytes += length * (occurrences - 1);
+        if (last - first >= 2 && last - first <= kMaxFilesPerChunk) {
+            for (std::size_t a = first; a < last; ++a) {
+                for (std::size_t b = a + 1; b < last; ++b) {
+                    const std::uint64_t key = static_cast<std::uint64_t>(postings[a].sketch) << 32 |
+                                              postings[b].sketch;
+                    sharedByPair[key] += length * std::min(postings[a].count, postings[b].count);
+                }
+            }
+        }
+        first = last;
+    }
+    
+    for (const auto& entry : sharedByPair) {
+        const Sketch& a = sketches[static_cast<std::size_t>(entry.first >> 32)];
+        const Sketch& b = sketches[static_cast<std::size_t>(entry.first & 0xFFFFFFFFu)];
+        const std::uint64_t smaller = std::min(a.size, b.size);
+        const double similarity = std::min(1.0, static_cast<double>(entry.second) /
+                                                static_cast<double>(smaller));
+        if (similarity < options.minSimilarity) {
+            continue;
+        }
+        NearDuplicatePair pair;
+        pair.first = std::min(a.index, b.index);
+        pair.second = std::max(a.index, b.index);
+        pair.sharedBytes = entry.second;
+        pair.similarity = similarity;
+        pair.identical = a.size == b.size && a.hasFull && b.hasFull && a.full == b.full;
+        result.pairs.push_back(pair);
+    }
+    std::sort(result.pairs.begin(), result.pairs.end(),
+              [](const NearDuplicatePair& x, const NearDuplicatePair& y) {
+                  if (x.sharedBytes != y.sharedBytes) {
+                      return x.sharedBytes > y.sharedBytes;
+                  }
+                  return x.first != y.first ? x.first < y.first : x.second < y.second;
+              });
+    
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    local.mappedBytes = reader.stats().mappedBytes;
+    
+    std::ostringstream summary;
+    summary << "Near-duplicate detection complete: " << result.size() << " pairs, "
+            << result.deduplicableBytes << " of " << result.candidateBytes
+            << " bytes deduplicable, " << local.candidates << " candidates, " << local.chunked
+            << " chunked, " << local.cacheHits << " from the chunk index, " << local.chunks
+            << " chunks, read " << local.bytesRead << " bytes";
+    if (local.seconds > 0 && local.bytesRead > 0) {
+        summary << std::fixed << std::setprecision(2) << " at "
+                << static_cast<double>(local.bytesRead) / (1024.0 * 1024.0) / local.seconds << " MB/s";
+    }
+    if (local.unreadable > 0) {
+        summary << ", " << local.unreadable << " unreadable";
+    }
+    Logger::getInstance().log(summary.str());
+    
+    if (stats) {
+        *stats = local;
+    }
+    return result;
+}
+
+void FileSearcher::collectNearDuplicates(const FileCatalog& batch, const NearDuplicateOptions& options,
+                                         FileCatalog& candidates) const {
+    const std::uint64_t minSize = std::max<std::uint64_t>(options.minSize, 1);
+    for (FileCatalog::Index i = 0; i < batch.size(); ++i) {
+        if (batch.fileSize(i) >= minSize) {
+            copyFileInto(candidates, batch, i);
+        }
+    }
 }
 
 /**
@@ -295,7 +1286,8 @@ std::map<std::string, std::vector<FileInfo>> FileSearcher::findDuplicates(
  * Sets width to 20, left-aligned, then prints "Name"
  * If "Name" is 4 chars, adds 16 spaces after
  */
-void FileSearcher::displaySearchResults(const std::vector<FileInfo>& results) const {
+void FileSearcher::displaySearchResults(const FileCatalog& files,
+                                        const std::vector<FileCatalog::Index>& results) const {
     if (results.empty()) {
         std::cout << "\n❌ No files found matching your search.\n\n";
         return;
@@ -308,63 +1300,39 @@ void FileSearcher::displaySearchResults(const std::vector<FileInfo>& results) co
     std::cout << std::string(padding, ' ') << "║\n";
     std::cout << "╚════════════════════════════════════════════════════════════╝\n\n";
     
-    // Table header
-    std::cout << std::left 
-              << std::setw(40) << "Filename" 
-              << std::setw(15) << "Size"
-              << std::setw(10) << "Extension" << "\n";
-    std::cout << std::string(65, '-') << "\n";
-    
     /**
-     * Teaching Point: NUMBER FORMATTING
-     * 
-     * For file sizes, we want human-readable format:
-     * - 1024 bytes → "1.0 KB"
-     * - 1048576 bytes → "1.0 MB"
+     * Teaching Point: ONE BUFFER, ONE WRITE
      * 
-     * ALGORITHM:
-     * if (size < 1024) → bytes
-     * else if (size < 1024*1024) → KB
-     * else if (size < 1024*1024*1024) → MB
-     * else → GB
+     * Rows are preformatted into a std::string (FileListing::appendRow:
+     * to_chars, plain appends, human-readable sizes such as "14 KB") and
+     * written with a single call - no std::setw per field, no flush per
+     * row. The Menu pages large results instead of printing them all.
      */
-    for (const auto& file : results) {
-        std::string sizeStr;
-        double size = static_cast<double>(file.size);
-        
-        if (size < 1024) {
-            sizeStr = std::to_string(static_cast<int>(size)) + " B";
-        } else if (size < 1024 * 1024) {
-            sizeStr = std::to_string(static_cast<int>(size / 1024)) + " KB";
-        } else if (size < 1024 * 1024 * 1024) {
-            sizeStr = std::to_string(static_cast<int>(size / (1024 * 1024))) + " MB";
-        } else {
-            sizeStr = std::to_string(static_cast<int>(size / (1024 * 1024 * 1024))) + " GB";
-        }
-        
-        std::cout << std::left
-                  << std::setw(40) << file.name
-                  << std::setw(15) << sizeStr
-                  << std::setw(10) << file.extension << "\n";
+    std::string table;
+    table.reserve((results.size() + 2) * 80);
+    FileListing::appendHeader(table);
+    std::size_t number = 0;
+    for (FileCatalog::Index i : results) {
+        FileListing::appendRow(table, files, i, ++number);
     }
+    std::cout.write(table.data(), static_cast<std::streamsize>(table.size()));
     std::cout << "\n";
 }
 
 /**
  * @brief Displays duplicate groups
- * @param duplicates Map of duplicate groups
+ * @param files Catalog the indices refer to
+ * @param duplicates Groups of catalog indices
  * 
  * Teaching Point: NESTED ITERATION
  * 
- * We have map<string, vector<FileInfo>>
- * 
- * Outer loop: Iterate through map (each group)
- * Inner loop: Iterate through vector (files in group)
+ * Outer loop: each group (already sorted by reclaimable bytes)
+ * Inner loop: the group's slice of the shared index array
  * 
  * This is a common pattern for hierarchical data
  */
-void FileSearcher::displayDuplicates(
-    const std::map<std::string, std::vector<FileInfo>>& duplicates) const {
+void FileSearcher::displayDuplicates(const FileCatalog& files,
+                                     const DuplicateResult& duplicates) const {
     
     if (duplicates.empty()) {
         std::cout << "\n✅ No duplicate files found!\n\n";
@@ -375,39 +1343,62 @@ void FileSearcher::displayDuplicates(
     std::cout << "║         DUPLICATE FILES (" << duplicates.size() << " groups)";
     int padding = 58 - std::to_string(duplicates.size()).length() - 25;
     std::cout << std::string(padding, ' ') << "║\n";
-    std::cout << "╚════════════════════════════════════════════════════════════╝\n\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+    std::cout << "💾 Reclaimable: " << duplicates.reclaimableBytes() << " bytes\n\n";
     
     int groupNum = 1;
     
-    /**
-     * Teaching Point: STRUCTURED BINDINGS (C++17)
-     * 
-     * for (const auto& [hash, files] : duplicates)
-     * 
-     * Unpacks std::pair<const string, vector> into:
-     * - hash (first element)
-     * - files (second element)
-     * 
-     * BEFORE C++17:
-     * for (const auto& pair : duplicates) {
-     *     const auto& hash = pair.first;
-     *     const auto& files = pair.second;
-     * }
-     * 
-     * C++17 version is much cleaner!
-     */
-    for (const auto& [hash, files] : duplicates) {
+    for (const DuplicateGroup& group : duplicates.groups) {
         std::cout << "📦 Duplicate Group #" << groupNum++ << " (" 
-                  << files.size() << " files):\n";
+                  << group.count << " files, " << group.reclaimableBytes()
+                  << " bytes reclaimable):\n";
         std::cout << std::string(60, '-') << "\n";
         
-        for (const auto& file : files) {
-            std::cout << "  📄 " << file.name << " (" << file.size << " bytes)\n";
-            std::cout << "     Path: " << file.path.string() << "\n\n";
+        const FileCatalog::Index* member = duplicates.members(group);
+        for (std::size_t k = 0; k < group.count; ++k) {
+            FileCatalog::Index i = member[k];
+            std::cout << "  📄 " << files.name(i) << " (" << files.fileSize(i) << " bytes)\n";
+            std::cout << "     Path: " << files.path(i) << "\n\n";
         }
     }
 }
 
+/**
+ * @brief Displays near-duplicate pairs, most shared bytes first
+ */
+void FileSearcher::displayNearDuplicates(const FileCatalog& files,
+                                         const NearDuplicateResult& nearDuplicates,
+                                         std::size_t limit) const {
+    if (nearDuplicates.empty()) {
+        std::cout << "\n✅ No near-duplicate files found!\n\n";
+        return;
+    }
+    
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         NEAR-DUPLICATE FILES (" << nearDuplicates.size() << " pairs)";
+    int padding = 58 - std::to_string(nearDuplicates.size()).length() - 29;
+    std::cout << std::string(std::max(padding, 0), ' ') << "║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+    std::cout << "💾 Deduplicable (shared chunks): " << nearDuplicates.deduplicableBytes << " of "
+              << nearDuplicates.candidateBytes << " bytes\n\n";
+    
+    std::size_t shown = std::min(limit, nearDuplicates.size());
+    for (std::size_t p = 0; p < shown; ++p) {
+        const NearDuplicatePair& pair = nearDuplicates.pairs[p];
+        std::cout << "🧩 Pair #" << p + 1 << " (" << std::fixed << std::setprecision(1)
+                  << pair.similarity * 100.0 << "% similar, " << pair.sharedBytes << " bytes shared"
+                  << (pair.identical ? ", identical" : "") << "):\n";
+        std::cout << std::string(60, '-') << "\n";
+        for (FileCatalog::Index i : {pair.first, pair.second}) {
+            std::cout << "  📄 " << files.name(i) << " (" << files.fileSize(i) << " bytes)\n";
+            std::cout << "     Path: " << files.path(i) << "\n\n";
+        }
+    }
+    if (shown < nearDuplicates.size()) {
+        std::cout << "... and " << nearDuplicates.size() - shown << " more pairs\n\n";
+    }
+}
+
 /**
  * =============================================================================
  * KEY TAKEAWAYS FROM FILESEARCHER IMPLEMENTATION
@@ -424,14 +1415,16 @@ void FileSearcher::displayDuplicates(
  *    - tolower() for case-insensitive comparison
  * 
  * 3. HASH-BASED ALGORITHMS:
- *    - O(n) duplicate detection vs O(n²) naive approach
- *    - Map-based grouping
- *    - Trade-off: speed vs accuracy
+ *    - Cheap filters first (size, partial hash), full hash last
+ *    - Content-defined chunks + an inverted posting list for near-duplicates
+ *    - Sort + linear scan to find collisions
+ *    - Integer-keyed hash table for the final groups
+ *    - Parallel file reads on a ThreadPool
  * 
  * 4. DATA STRUCTURES:
- *    - std::map for key-value storage
+ *    - std::unordered_map with a custom key and hasher
  *    - std::vector for dynamic arrays
- *    - Nested containers (map of vectors)
+ *    - Results as indices into one shared array (no copies)
  * 
  * 5. FORMATTED OUTPUT:
  *    - <iomanip> manipulators
@@ -439,7 +1432,6 @@ void FileSearcher::displayDuplicates(
  *    - Human-readable file sizes
  * 
  * 6. MODERN C++ FEATURES:
- *    - Structured bindings (C++17)
  *    - Lambda expressions
  *    - auto keyword
  *    - Range-based for loops
@@ -1,178 +1,332 @@
 #include "../include/FileSorter.h"
 #include "../include/Logger.h"
+#include <array>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <unordered_set>
 
 namespace fs = std::filesystem;
 
 /**
  * =============================================================================
- * FILESORTER IMPLEMENTATION - MASTERING std::map AND FILE OPERATIONS
+ * FILESORTER IMPLEMENTATION - CONSTEXPR TABLES AND FILE OPERATIONS
  * =============================================================================
  * 
  * This class demonstrates:
- * 1. std::map usage for key-value lookups
+ * 1. A perfect hash table computed entirely at compile time
  * 2. File moving operations with std::filesystem
  * 3. Directory creation with error handling
  * 4. Batch processing patterns
  */
 
+namespace {
+
+    struct BuiltinMapping {
+        std::string_view extension;
+        FileCategory category;
+    };
+
+    /**
+     * Teaching Point: constexpr DATA
+     * This array is baked into the executable's read-only section - no
+     * code runs to fill it, and it cannot be modified by accident.
+     */
+    constexpr BuiltinMapping kBuiltinMappings[] = {
+        // Documents
+        {".txt", FileCategory::Documents}, {".pdf", FileCategory::Documents},
+        {".doc", FileCategory::Documents}, {".docx", FileCategory::Documents},
+        {".xlsx", FileCategory::Documents}, {".xls", FileCategory::Documents},
+        {".ppt", FileCategory::Documents}, {".pptx", FileCategory::Documents},
+        {".odt", FileCategory::Documents}, {".rtf", FileCategory::Documents},
+        // Images
+        {".jpg", FileCategory::Images}, {".jpeg", FileCategory::Images},
+        {".png", FileCategory::Images}, {".gif", FileCategory::Images},
+        {".bmp", FileCategory::Images}, {".svg", FileCategory::Images},
+        {".ico", FileCategory::Images}, {".tiff", FileCategory::Images},
+        {".webp", FileCategory::Images},
+        // Videos
+        {".mp4", FileCategory::Videos}, {".avi", FileCategory::Videos},
+        {".mkv", FileCategory::Videos}, {".mov", FileCategory::Videos},
+        {".wmv", FileCategory::Videos}, {".flv", FileCategory::Videos},
+        {".webm", FileCategory::Videos}, {".m4v", FileCategory::Videos},
+        // Audio
+        {".mp3", FileCategory::Audio}, {".wav", FileCategory::Audio},
+        {".flac", FileCategory::Audio}, {".aac", FileCategory::Audio},
+        {".ogg", FileCategory::Audio}, {".wma", FileCategory::Audio},
+        {".m4a", FileCategory::Audio},
+        // Archives
+        {".zip", FileCategory::Archives}, {".rar", FileCategory::Archives},
+        {".7z", FileCategory::Archives}, {".tar", FileCategory::Archives},
+        {".gz", FileCategory::Archives}, {".bz2", FileCategory::Archives},
+        {".xz", FileCategory::Archives},
+        // Code files
+        {".cpp", FileCategory::Code}, {".h", FileCategory::Code},
+        {".hpp", FileCategory::Code}, {".c", FileCategory::Code},
+        {".py", FileCategory::Code}, {".java", FileCategory::Code},
+        {".js", FileCategory::Code}, {".ts", FileCategory::Code},
+        {".html", FileCategory::Code}, {".css", FileCategory::Code},
+        {".php", FileCategory::Code}, {".rb", FileCategory::Code},
+        {".go", FileCategory::Code}, {".rs", FileCategory::Code},
+        // Executables
+        {".exe", FileCategory::Executables}, {".dll", FileCategory::Executables},
+        {".so", FileCategory::Executables}, {".app", FileCategory::Executables},
+        {".deb", FileCategory::Executables}, {".rpm", FileCategory::Executables},
+    };
+
+    constexpr std::string_view kBuiltinNames[] = {
+        "Documents", "Images", "Videos", "Audio", "Archives", "Code", "Executables", "Others"
+    };
+    constexpr std::size_t kBuiltinCategories = sizeof(kBuiltinNames) / sizeof(kBuiltinNames[0]);
+    static_assert(kBuiltinCategories == static_cast<std::size_t>(FileCategory::Others) + 1,
+                  "kBuiltinNames must list every FileCategory");
+
+    /**
+     * @brief ".jpeg" → the bytes "jpeg" as one little-endian integer
+     * @return 0 if the extension has no dot or more than 8 bytes after it
+     */
+    constexpr std::uint64_t packExtension(std::string_view extension) {
+        if (extension.size() < 2 || extension.size() > 9 || extension[0] != '.') {
+            return 0;
+        }
+        std::uint64_t key = 0;
+        for (std::size_t i = 1; i < extension.size(); ++i) {
+            key |= static_cast<std::uint64_t>(static_cast<unsigned char>(extension[i])) << (8 * (i - 1));
+        }
+        return key;
+    }
+
+    std::string unpackExtension(std::uint64_t key) {
+        std::string extension = ".";
+        for (; key != 0; key >>= 8) {
+            extension += static_cast<char>(key & 0xFF);
+        }
+        return extension;
+    }
+
+    constexpr unsigned kSlotBits = 8;
+    constexpr std::size_t kSlots = std::size_t(1) << kSlotBits;   // 256 slots for ~60 keys
+
+    struct PerfectTable {
+        std::uint64_t multiplier = 0;
+        std::array<std::uint64_t, kSlots> keys{};          // 0 = empty slot
+        std::array<FileCategory, kSlots> categories{};
+        bool found = false;
+    };
+
+    constexpr std::size_t slotOf(std::uint64_t key, std::uint64_t multiplier) {
+        return static_cast<std::size_t>((key * multiplier) >> (64 - kSlotBits));
+    }
+
+    /**
+     * @brief Searches a multiplier that gives every built-in key its own slot
+     * 
+     * Teaching Point: The COMPILER runs this loop (constexpr). Candidate
+     * multipliers come from a fixed pseudo-random sequence (splitmix64);
+     * each is tried until none of the keys collide. With 60 keys in 256
+     * slots that takes some thousand tries - milliseconds of compile time,
+     * zero run time. Adding an extension that makes the search fail is a
+     * compile error (static_assert below), never a runtime surprise.
+     */
+    constexpr PerfectTable buildPerfectTable() {
+        PerfectTable table;
+        std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (int attempt = 0; attempt < 1000000; ++attempt) {
+            state += 0x9E3779B97F4A7C15ull;
+            std::uint64_t mixed = state;
+            mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+            const std::uint64_t multiplier = (mixed ^ (mixed >> 31)) | 1;
+
+            for (std::size_t s = 0; s < kSlots; ++s) {
+                table.keys[s] = 0;
+                table.categories[s] = FileCategory::Others;
+            }
+            bool collision = false;
+            for (const BuiltinMapping& mapping : kBuiltinMappings) {
+                const std::size_t slot = slotOf(packExtension(mapping.extension), multiplier);
+                if (table.keys[slot] != 0) {
+                    collision = true;
+                    break;
+                }
+                table.keys[slot] = packExtension(mapping.extension);
+                table.categories[slot] = mapping.category;
+            }
+            if (!collision) {
+                table.multiplier = multiplier;
+                table.found = true;
+                return table;
+            }
+        }
+        return table;
+    }
+
+    constexpr bool allPackable() {
+        for (const BuiltinMapping& mapping : kBuiltinMappings) {
+            if (packExtension(mapping.extension) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(allPackable(), "built-in extensions need a dot and at most 8 bytes");
+    constexpr PerfectTable kTable = buildPerfectTable();
+    static_assert(kTable.found, "no perfect hash multiplier found - enlarge kSlotBits");
+
+    std::string toLower(std::string text) {
+        for (char& c : text) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c + ('a' - 'A'));
+            }
+        }
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        const auto first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            return "";
+        }
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+}
+
 /**
- * @brief Constructor - Initializes extension categories
+ * @brief Constructor
  * 
  * Teaching Point: Initialization in constructor ensures object
  * is ready to use immediately after creation (class invariant).
+ * The built-in table already is - only user mappings are loaded later.
  */
 FileSorter::FileSorter() {
-    initializeCategories();
-    Logger::getInstance().log("FileSorter initialized with category mappings");
+    Logger::getInstance().log("FileSorter initialized: " +
+                              std::to_string(sizeof(kBuiltinMappings) / sizeof(kBuiltinMappings[0])) +
+                              " built-in mappings (perfect hash, " + std::to_string(kSlots) + " slots)");
+}
+
+std::string FileSorter::defaultConfigPath() {
+    return ".sfm_categories.conf";
 }
 
 /**
- * @brief Populates the extension-to-category mapping
- * 
- * Teaching Point: std::map INSERTION METHODS
- * 
- * THREE WAYS TO INSERT:
- * 1. map[key] = value;           // Easiest, but overwrites if exists
- * 2. map.insert({key, value});   // Returns pair<iterator, bool>
- * 3. map.emplace(key, value);    // Constructs in-place (most efficient)
- * 
- * We use method 1 here for clarity (teaching context).
- * In production, emplace() is preferred for efficiency.
+ * @brief Looks up category for given extension
+ * @param extension Lowercased extension with dot (e.g., ".txt")
+ * @return Its category, FileCategory::Others if not found
  * 
- * DESIGN DECISION: Predefined categories
- * Alternative: Could load from config file (more flexible but complex)
- * Current approach: Hardcoded (simple, fast, sufficient for most cases)
+ * ALGORITHM:
+ * 1. Pack the extension into a 64-bit key (0 = cannot be a table key)
+ * 2. User overrides first - skipped entirely when none were loaded
+ * 3. slot = (key × multiplier) >> 56; the slot's key either equals ours
+ *    (hit) or the extension is unknown. No probing: the hash is perfect.
  */
-void FileSorter::initializeCategories() {
-    // Documents
-    extensionCategories[".txt"] = "Documents";
-    extensionCategories[".pdf"] = "Documents";
-    extensionCategories[".doc"] = "Documents";
-    extensionCategories[".docx"] = "Documents";
-    extensionCategories[".xlsx"] = "Documents";
-    extensionCategories[".xls"] = "Documents";
-    extensionCategories[".ppt"] = "Documents";
-    extensionCategories[".pptx"] = "Documents";
-    extensionCategories[".odt"] = "Documents";
-    extensionCategories[".rtf"] = "Documents";
-    
-    // Images
-    extensionCategories[".jpg"] = "Images";
-    extensionCategories[".jpeg"] = "Images";
-    extensionCategories[".png"] = "Images";
-    extensionCategories[".gif"] = "Images";
-    extensionCategories[".bmp"] = "Images";
-    extensionCategories[".svg"] = "Images";
-    extensionCategories[".ico"] = "Images";
-    extensionCategories[".tiff"] = "Images";
-    extensionCategories[".webp"] = "Images";
-    
-    // Videos
-    extensionCategories[".mp4"] = "Videos";
-    extensionCategories[".avi"] = "Videos";
-    extensionCategories[".mkv"] = "Videos";
-    extensionCategories[".mov"] = "Videos";
-    extensionCategories[".wmv"] = "Videos";
-    extensionCategories[".flv"] = "Videos";
-    extensionCategories[".webm"] = "Videos";
-    extensionCategories[".m4v"] = "Videos";
-    
-    // Audio
-    extensionCategories[".mp3"] = "Audio";
-    extensionCategories[".wav"] = "Audio";
-    extensionCategories[".flac"] = "Audio";
-    extensionCategories[".aac"] = "Audio";
-    extensionCategories[".ogg"] = "Audio";
-    extensionCategories[".wma"] = "Audio";
-    extensionCategories[".m4a"] = "Audio";
-    
-    // Archives
-    extensionCategories[".zip"] = "Archives";
-    extensionCategories[".rar"] = "Archives";
-    extensionCategories[".7z"] = "Archives";
-    extensionCategories[".tar"] = "Archives";
-    extensionCategories[".gz"] = "Archives";
-    extensionCategories[".bz2"] = "Archives";
-    extensionCategories[".xz"] = "Archives";
-    
-    // Code files
-    extensionCategories[".cpp"] = "Code";
-    extensionCategories[".h"] = "Code";
-    extensionCategories[".hpp"] = "Code";
-    extensionCategories[".c"] = "Code";
-    extensionCategories[".py"] = "Code";
-    extensionCategories[".java"] = "Code";
-    extensionCategories[".js"] = "Code";
-    extensionCategories[".ts"] = "Code";
-    extensionCategories[".html"] = "Code";
-    extensionCategories[".css"] = "Code";
-    extensionCategories[".php"] = "Code";
-    extensionCategories[".rb"] = "Code";
-    extensionCategories[".go"] = "Code";
-    extensionCategories[".rs"] = "Code";
-    
-    // Executables
-    extensionCategories[".exe"] = "Executables";
-    extensionCategories[".dll"] = "Executables";
-    extensionCategories[".so"] = "Executables";
-    extensionCategories[".app"] = "Executables";
-    extensionCategories[".deb"] = "Executables";
-    extensionCategories[".rpm"] = "Executables";
+FileCategory FileSorter::categorize(std::string_view extension) const {
+    const std::uint64_t key = packExtension(extension);
+    if (!packedOverrides.empty() && key != 0) {
+        auto it = packedOverrides.find(key);
+        if (it != packedOverrides.end()) {
+            return it->second;
+        }
+    }
+    if (!longOverrides.empty() && key == 0) {
+        auto it = longOverrides.find(extension);
+        if (it != longOverrides.end()) {
+            return it->second;
+        }
+    }
+    if (key == 0) {
+        return FileCategory::Others;
+    }
+    const std::size_t slot = slotOf(key, kTable.multiplier);
+    return kTable.keys[slot] == key ? kTable.categories[slot] : FileCategory::Others;
+}
+
+std::string_view FileSorter::categoryName(FileCategory category) const {
+    auto id = static_cast<std::size_t>(category);
+    if (id < kBuiltinCategories) {
+        return kBuiltinNames[id];
+    }
+    return customCategoryNames[id - kBuiltinCategories];
 }
 
 /**
- * @brief Looks up category for given extension
- * @param extension File extension (e.g., ".txt")
- * @return Category name or "Others" if not found
- * 
- * Teaching Point: SAFE MAP LOOKUP PATTERN
- * 
- * WRONG WAY:
- * return extensionCategories[extension];  // Creates entry if not found!
- * 
- * RIGHT WAY: Use find()
- * 
- * std::map::find() returns iterator:
- * - If found: iterator points to key-value pair
- * - If not found: iterator equals map.end()
+ * @brief Maps a category name from the mapping file to a FileCategory
  * 
- * This is the standard STL pattern for safe lookups.
+ * Teaching Point: A category name becomes a FOLDER name during organize,
+ * so anything that could escape the base directory is refused here.
+ */
+bool FileSorter::resolveCategory(const std::string& name, FileCategory& category) {
+    const std::string lower = toLower(name);
+    for (std::size_t id = 0; id < kBuiltinCategories; ++id) {
+        if (toLower(std::string(kBuiltinNames[id])) == lower) {
+            category = static_cast<FileCategory>(id);
+            return true;
+        }
+    }
+    for (std::size_t k = 0; k < customCategoryNames.size(); ++k) {
+        if (toLower(customCategoryNames[k]) == lower) {
+            category = static_cast<FileCategory>(kBuiltinCategories + k);
+            return true;
+        }
+    }
+    if (name.empty() || name == "." || name == ".." || name.find('/') != std::string::npos ||
+        name.find('\0') != std::string::npos ||
+        kBuiltinCategories + customCategoryNames.size() > 0xFF) {
+        return false;
+    }
+    category = static_cast<FileCategory>(kBuiltinCategories + customCategoryNames.size());
+    customCategoryNames.push_back(name);
+    return true;
+}
+
+/**
+ * @brief Reads "extension = Category" lines and merges them
  * 
- * ALTERNATIVE: C++20 contains()
- * if (extensionCategories.contains(extension)) { ... }
- * But find() works in C++17 and earlier.
+ * ALGORITHM:
+ * 1. Strip comments and blanks; split at '='
+ * 2. Normalize the extension like the scanner does (lowercase, with dot)
+ * 3. Resolve the category name (existing or new)
+ * 4. Store by packed key (≤ 8 bytes) or in the long-extension map
  */
-std::string FileSorter::getCategoryForExtension(const std::string& extension) const {
-    auto it = extensionCategories.find(extension);
-    
-    /**
-     * Teaching Point: AUTO KEYWORD
-     * 
-     * auto it = ...
-     * 
-     * Compiler deduces type automatically:
-     * std::map<std::string, std::string>::const_iterator
-     * 
-     * Benefits:
-     * - Less typing
-     * - Easier to refactor (change map type, auto adapts)
-     * - Cleaner code
-     * 
-     * When to use auto:
-     * - Complex types (iterators, lambda functions)
-     * - Obvious types from right-hand side
-     * 
-     * When NOT to use auto:
-     * - When type clarity is important
-     * - When implicit conversions matter
-     */
+bool FileSorter::loadMappings(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
     
-    if (it != extensionCategories.end()) {
-        return it->second;  // Return the value (category)
+    std::string line;
+    int lineNumber = 0;
+    int merged = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        const auto equals = line.find('=');
+        std::string extension = equals == std::string::npos ? "" : toLower(trim(line.substr(0, equals)));
+        const std::string name = equals == std::string::npos ? "" : trim(line.substr(equals + 1));
+        if (!extension.empty() && extension[0] != '.') {
+            extension = "." + extension;
+        }
+        FileCategory category;
+        if (extension.size() < 2 || extension.find('/') != std::string::npos ||
+            !resolveCategory(name, category)) {
+            Logger::getInstance().log("WARNING: " + path + ":" + std::to_string(lineNumber) +
+                                      ": expected \"extension = Category\", skipped");
+            continue;
+        }
+        const std::uint64_t key = packExtension(extension);
+        if (key != 0) {
+            packedOverrides[key] = category;
+        } else {
+            longOverrides[extension] = category;
+        }
+        ++merged;
     }
-    return "Others";  // Default category for unknown extensions
+    
+    Logger::getInstance().log("Loaded " + std::to_string(merged) + " category mappings from " + path);
+    return true;
 }
 
 /**
@@ -219,133 +373,228 @@ bool FileSorter::createDirectoryIfNotExists(const std::string& path) {
     }
 }
 
+void FileSorter::setContentSniffer(std::shared_ptr<ContentSniffer> sniffer, SniffScope scope) {
+    contentSniffer = std::move(sniffer);
+    sniffScope = scope;
+}
+
 /**
- * @brief Main organization algorithm
- * @param files Vector of files to organize
- * @param baseDirectory Root directory for organization
- * @return Number of files successfully moved
- * 
- * Teaching Point: BATCH PROCESSING PATTERN
- * 
- * ALGORITHM:
- * 1. For each file:
- *    a. Determine category from extension
- *    b. Create category folder (if needed)
- *    c. Construct destination path
- *    d. Move file
- *    e. Log operation
- * 2. Count successes
- * 3. Return count
+ * @brief Maps a sniffed type to its built-in category
  * 
- * ERROR HANDLING STRATEGY:
- * - Try-catch inside loop (graceful degradation)
- * - If one file fails, continue with others
- * - Log each failure for debugging
- * - Return count of successes
- * 
- * ALTERNATIVE STRATEGY (fail-fast):
- * - Try-catch outside loop
- * - First error stops entire operation
- * - All-or-nothing approach
+ * Teaching Point: ContentType is grouped by category in its declaration,
+ * but a switch states the mapping explicitly - reordering the enum can
+ * never silently move PDFs into Videos.
+ */
+FileCategory FileSorter::categoryOfContent(ContentType type) {
+    switch (type) {
+        case ContentType::Png: case ContentType::Jpeg: case ContentType::Gif:
+        case ContentType::Bmp: case ContentType::Tiff: case ContentType::Webp:
+        case ContentType::Heic: case ContentType::Icon:
+            return FileCategory::Images;
+        case ContentType::Mp4: case ContentType::QuickTime: case ContentType::Matroska:
+        case ContentType::Avi: case ContentType::MpegStream:
+            return FileCategory::Videos;
+        case ContentType::Mp3: case ContentType::Flac: case ContentType::Ogg:
+        case ContentType::Wav: case ContentType::M4a: case ContentType::Midi:
+            return FileCategory::Audio;
+        case ContentType::Zip: case ContentType::Gzip: case ContentType::Bzip2:
+        case ContentType::Xz: case ContentType::SevenZip: case ContentType::Rar:
+        case ContentType::Tar: case ContentType::Zstd:
+            return FileCategory::Archives;
+        case ContentType::Pdf: case ContentType::OfficeOpenXml: case ContentType::OpenDocument:
+        case ContentType::Epub: case ContentType::OleCompound: case ContentType::Rtf:
+            return FileCategory::Documents;
+        case ContentType::Elf: case ContentType::WindowsExe: case ContentType::MachO:
+            return FileCategory::Executables;
+        case ContentType::Script:
+            return FileCategory::Code;
+        case ContentType::Unknown: case ContentType::Count:
+            break;
+    }
+    return FileCategory::Others;
+}
+
+/**
+ * @brief Builds the move plan
  * 
- * Choice depends on use case. Here, partial success is acceptable.
+ * Teaching Point: DECIDE FIRST, THEN ACT IN BULK
+ * The plan is plain data - a dry run prints it, applyPlan() journals
+ * and executes it. Nothing here creates, renames or deletes anything.
  */
-int FileSorter::organizeByExtension(const std::vector<FileInfo>& files, 
-                                    const std::string& baseDirectory) {
-    int movedCount = 0;
+OrganizePlan FileSorter::planOrganize(const FileCatalog& files, const std::string& baseDirectory,
+                                      ConflictPolicy policy) const {
+    OrganizePlan plan;
+    plan.baseDirectory = baseDirectory;
     
-    Logger::getInstance().log("Starting file organization in: " + baseDirectory);
+    /**
+     * Teaching Point: CLASSIFY EXTENSIONS, NOT FILES
+     * The catalog interns extensions, so a million files share a few
+     * hundred extension IDs. Each ID is categorized once; per file the
+     * category is a plain array read.
+     */
+    std::vector<FileCategory> byExtension(files.extensionCount());
+    for (std::size_t id = 0; id < byExtension.size(); ++id) {
+        byExtension[id] = categorize(files.extensionName(static_cast<FileCatalog::ExtensionId>(id)));
+    }
     
+    // Plan folder per category (only categories that occur), with the
+    // names already taken in it - one directory listing per folder
     /**
-     * Teaching Point: RANGE-BASED FOR LOOP with const reference
-     * 
-     * for (const auto& file : files)
-     * 
-     * Breakdown:
-     * - auto: Compiler deduces type (FileInfo)
-     * - const: We're not modifying the file object
-     * - &: Pass by reference (avoid copying)
-     * 
-     * WHY const&?
-     * - FileInfo might be large (path, strings)
-     * - Copying is expensive (time + memory)
-     * - We only read data, no modifications
-     * 
-     * ALTERNATIVES:
-     * for (FileInfo file : files)         // Copies each file! Slow!
-     * for (auto& file : files)            // Non-const ref (for modifying)
-     * for (const FileInfo& file : files)  // Explicit type (no auto)
+     * Teaching Point: LOOK INSIDE ONLY WHEN THE NAME SAYS NOTHING
+     * Reading 512 bytes is cheap, but not free on a million files. By
+     * default only files headed for Others are sniffed; the verdicts are
+     * cached, so a second run reads no header at all.
      */
-    for (const auto& file : files) {
-        try {
-            // Step 1: Determine category
-            std::string category = getCategoryForExtension(file.extension);
-            
-            // Step 2: Create category folder
-            std::string categoryPath = baseDirectory + "/" + category;
-            if (!createDirectoryIfNotExists(categoryPath)) {
-                Logger::getInstance().log("ERROR: Failed to create directory: " + categoryPath);
-                continue;  // Skip this file, move to next
+    std::vector<FileCategory> sniffedCategory;   // Per file, only when sniffing
+    if (contentSniffer) {
+        std::vector<FileCatalog::Index> rows;
+        for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+            if (sniffScope == SniffScope::AllFiles || byExtension[files.extensionId(i)] == FileCategory::Others) {
+                rows.push_back(i);
+            }
+        }
+        std::vector<ContentType> types;
+        contentSniffer->sniff(files, rows, types);
+        sniffedCategory.resize(files.size());
+        for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+            sniffedCategory[i] = byExtension[files.extensionId(i)];
+        }
+        for (std::size_t k = 0; k < rows.size(); ++k) {
+            if (types[k] != ContentType::Unknown) {
+                sniffedCategory[rows[k]] = categoryOfContent(types[k]);
+            }
+        }
+    }
+    
+    const std::size_t categoryCount = kBuiltinCategories + customCategoryNames.size();
+    constexpr std::uint16_t kNoFolder = 0xFFFF;
+    std::vector<std::uint16_t> folderOf(categoryCount, kNoFolder);
+    std::vector<std::unordered_set<std::string>> taken;
+    std::vector<std::uint32_t> sourceOf(files.directoryCount(), UINT32_MAX);
+    const std::string journalPath = OrganizeJournal::pathFor(baseDirectory);
+    
+    for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+        if (files.path(i) == journalPath || files.path(i) == journalPath + ".tmp") {
+            continue;   // Never organize our own journal
+        }
+        if (FileCopier::isTemporaryName(files.name(i))) {
+            continue;   // Nor a cross-device copy that is still being written
+        }
+        const auto category = static_cast<std::size_t>(
+            sniffedCategory.empty() ? byExtension[files.extensionId(i)] : sniffedCategory[i]);
+        if (folderOf[category] == kNoFolder) {
+            folderOf[category] = static_cast<std::uint16_t>(plan.folders.size());
+            plan.folders.push_back(baseDirectory + "/" +
+                                   std::string(categoryName(static_cast<FileCategory>(category))));
+            taken.emplace_back();
+            std::error_code error;
+            for (fs::directory_iterator it(plan.folders.back(), error), end; !error && it != end;
+                 it.increment(error)) {
+                taken.back().insert(it->path().filename().string());
             }
-            
-            // Step 3: Construct destination path
-            std::string destPath = categoryPath + "/" + file.name;
-            
-            /**
-             * Teaching Point: HANDLING FILE NAME CONFLICTS
-             * 
-             * What if file already exists at destination?
-             * 
-             * OPTIONS:
-             * 1. Overwrite (dangerous - data loss!)
-             * 2. Skip (safe but incomplete)
-             * 3. Rename (add suffix like _1, _2)
-             * 4. Ask user (interactive)
-             * 
-             * Here we skip for safety. Production code might rename.
-             */
-            if (fs::exists(destPath)) {
-                Logger::getInstance().log("SKIPPED: File already exists: " + destPath);
+        }
+        const std::uint16_t folder = folderOf[category];
+        
+        const FileCatalog::DirectoryId directory = files.directoryOf(i);
+        if (files.directoryPath(directory) == plan.folders[folder]) {
+            plan.alreadyPlaced += 1;
+            continue;
+        }
+        if (sourceOf[directory] == UINT32_MAX) {
+            sourceOf[directory] = static_cast<std::uint32_t>(plan.sourceDirectories.size());
+            plan.sourceDirectories.emplace_back(files.directoryPath(directory));
+        }
+        
+        PlannedMove move{sourceOf[directory], folder, files.fileSize(i), std::string(files.name(i)), ""};
+        if (taken[folder].count(move.name) != 0) {
+            plan.conflicts += 1;
+            if (policy == ConflictPolicy::Skip) {
+                SFM_LOG(Trace, "Plan: {} skipped - name taken in {}", files.path(i), plan.folders[folder]);
                 continue;
             }
-            
-            // Step 4: Move file
-            /**
-             * Teaching Point: fs::rename() for moving files
-             * 
-             * Despite the name, rename() MOVES files:
-             * - Same filesystem: Instant (just updates directory entry)
-             * - Different filesystem: Copies then deletes (slower)
-             * 
-             * ALTERNATIVE: fs::copy() + fs::remove()
-             * - More explicit
-             * - Allows copy without removing original
-             * - But rename() is atomic (safer)
-             */
-            fs::rename(file.path, destPath);
-            
-            // Step 5: Log success
-            Logger::getInstance().log("Moved: " + file.name + " → " + category + "/");
-            movedCount++;
-            
-        } catch (const fs::filesystem_error& e) {
-            /**
-             * Teaching Point: PER-FILE ERROR HANDLING
-             * 
-             * Catch inside loop = graceful degradation
-             * One file failure doesn't stop the entire operation
-             * 
-             * Log error for debugging, then continue
-             */
-            std::string errorMsg = "ERROR moving " + file.name + ": " + e.what();
-            Logger::getInstance().log(errorMsg);
-            std::cerr << errorMsg << std::endl;
+            // "report.pdf" → "report (2).pdf", "report (3).pdf", ...
+            const std::size_t dot = move.name.rfind('.');
+            const bool hasExtension = dot != std::string::npos && dot > 0;
+            const std::string stem = hasExtension ? move.name.substr(0, dot) : move.name;
+            const std::string extension = hasExtension ? move.name.substr(dot) : "";
+            for (std::size_t n = 2; move.newName.empty() || taken[folder].count(move.newName) != 0; ++n) {
+                move.newName = stem + " (" + std::to_string(n) + ")" + extension;
+            }
+        }
+        taken[folder].insert(move.targetName());
+        SFM_LOG(Trace, "Plan: {} → {}/{}", files.path(i), plan.folders[folder], move.targetName());
+        plan.moves.push_back(std::move(move));
+    }
+    return plan;
+}
+
+/**
+ * @brief Applies a plan
+ * 
+ * ALGORITHM:
+ * 1. Create each plan folder once; moves into a folder that cannot be
+ *    created are dropped from the plan and counted as failed
+ * 2. OrganizeJournal::apply(): journal the plan, then move everything
+ *    with the OrganizeEngine (parallel, batched, renameat2 with
+ *    RENAME_NOREPLACE on Linux, verified copy across filesystems)
+ * 
+ * ERROR HANDLING STRATEGY (unchanged):
+ * - Graceful degradation: a failing file is logged and counted,
+ *   the others still move
+ * - Name conflicts are skipped, never overwritten
+ */
+OrganizeStats FileSorter::applyPlan(const OrganizePlan& plan) {
+    Logger::getInstance().log("Starting file organization in: " + plan.baseDirectory);
+    
+    std::vector<bool> usable(plan.folders.size(), false);
+    bool allUsable = true;
+    for (std::size_t f = 0; f < plan.folders.size(); ++f) {
+        usable[f] = createDirectoryIfNotExists(plan.folders[f]);
+        if (!usable[f]) {
+            Logger::getInstance().log("ERROR: Failed to create directory: " + plan.folders[f]);
+            allUsable = false;
+        }
+    }
+    
+    OrganizeEngine engine;
+    OrganizeStats result;
+    if (allUsable) {
+        result = OrganizeJournal::apply(plan, engine);
+    } else {
+        OrganizePlan reduced = plan;
+        reduced.moves.clear();
+        std::size_t dropped = 0;
+        for (const PlannedMove& move : plan.moves) {
+            if (usable[move.folder]) {
+                reduced.moves.push_back(move);
+            } else {
+                ++dropped;
+            }
         }
+        result = OrganizeJournal::apply(reduced, engine);
+        result.failed += dropped;
     }
     
     Logger::getInstance().log("Organization complete: " + 
-                            std::to_string(movedCount) + " files moved");
-    return movedCount;
+                            std::to_string(result.moved) + " files moved");
+    return result;
+}
+
+/**
+ * @brief Main organization algorithm: plan, then apply
+ * @param files Catalog of files to organize
+ * @param baseDirectory Root directory for organization
+ * @param stats Optional: receives the engine's counters
+ * @return Number of files successfully moved
+ */
+int FileSorter::organizeByExtension(const FileCatalog& files, 
+                                    const std::string& baseDirectory,
+                                    OrganizeStats* stats) {
+    const OrganizeStats result = applyPlan(planOrganize(files, baseDirectory));
+    if (stats != nullptr) {
+        *stats = result;
+    }
+    return static_cast<int>(result.moved);
 }
 
 /**
@@ -360,7 +609,7 @@ int FileSorter::organizeByExtension(const std::vector<FileInfo>& files,
  * - pair.second = value (category)
  * 
  * C++17 STRUCTURED BINDINGS (cleaner alternative):
- * for (const auto& [ext, cat] : extensionCategories) {
+ * for (const auto& [ext, cat] : effective) {
  *     std::cout << ext << " → " << cat << "\n";
  * }
  * 
@@ -381,13 +630,23 @@ void FileSorter::displayCategories() const {
      * Goal: category → [list of extensions]
      * 
      * Algorithm:
-     * 1. Iterate through extension map
+     * 1. Iterate through built-in table + user overrides
      * 2. For each (ext, cat) pair:
      *    - Add ext to categoryGroups[cat] vector
      * 3. Result: Grouped view
      */
-    for (const auto& [ext, cat] : extensionCategories) {
-        categoryGroups[cat].push_back(ext);
+    std::map<std::string, FileCategory> effective;   // extension → category after overrides
+    for (const BuiltinMapping& mapping : kBuiltinMappings) {
+        effective[std::string(mapping.extension)] = categorize(mapping.extension);
+    }
+    for (const auto& [key, category] : packedOverrides) {
+        effective[unpackExtension(key)] = category;
+    }
+    for (const auto& [extension, category] : longOverrides) {
+        effective[extension] = category;
+    }
+    for (const auto& [ext, cat] : effective) {
+        categoryGroups[std::string(categoryName(cat))].push_back(ext);
     }
     
     // Display grouped
@@ -409,16 +668,15 @@ void FileSorter::displayCategories() const {
  * KEY TAKEAWAYS FROM FILESORTER IMPLEMENTATION
  * =============================================================================
  * 
- * 1. STD::MAP MASTERY:
- *    - Insertion with []
- *    - Safe lookup with find()
- *    - Iteration with range-based for
- *    - Key-value pair access (.first, .second)
+ * 1. LOOKUP TABLES:
+ *    - Fixed keys → constexpr perfect hash (one multiply, one compare)
+ *    - User keys → hash map / std::map with transparent lookup
+ *    - Iteration with range-based for and structured bindings
  * 
  * 2. FILE OPERATIONS:
- *    - fs::rename() for moving files
- *    - fs::create_directories() for folder creation
- *    - fs::exists() for conflict detection
+ *    - fs::create_directories() for folder creation, once per category
+ *    - A complete plan first (dry run for free), then a journaled apply
+ *    - Moves delegated to OrganizeEngine (atomic no-replace renames)
  * 
  * 3. ERROR HANDLING:
  *    - Per-item try-catch (graceful degradation)
@@ -0,0 +1,123 @@
+#include "../include/FuzzyMatcher.h"
+#include <algorithm>
+
+/**
+ * =============================================================================
+ * FUZZYMATCHER IMPLEMENTATION - MYERS' BIT-VECTOR EDIT DISTANCE
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Encoding a dynamic-programming column as bit vectors
+ * 2. Using addition carries to propagate "runs" through a word
+ * 3. Early exit from a bound on what the rest of the text can achieve
+ */
+
+FuzzyMatcher::FuzzyMatcher(std::string_view lowerTerm)
+    : length(std::min(lowerTerm.size(), kMaxTermLength)) {
+    for (std::size_t j = 0; j < length; ++j) {
+        masks[static_cast<unsigned char>(lowerTerm[j])] |= std::uint64_t(1) << j;
+    }
+    lastRow = length == 0 ? 0 : std::uint64_t(1) << (length - 1);
+}
+
+/**
+ * @brief Runs the bit-parallel DP over the text, one byte per step
+ *
+ * ALGORITHM (search variant - a match may start anywhere in the text):
+ * State per column: Pv / Mv = rows where the value goes up / down by 1
+ * going down the column; score = value of the last row.
+ * For each text byte c with match mask Eq:
+ *   Xv = Eq | Mv
+ *   Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq     ← the carry chain does the work
+ *   Ph = Mv | ~(Xh | Pv)                  horizontal +1
+ *   Mh = Pv & Xh                          horizontal -1
+ *   score += (Ph has last row) - (Mh has last row)
+ *   Ph <<= 1; Mh <<= 1                    (row 0 is always 0: free start)
+ *   Pv = Mh | ~(Xv | Ph);  Mv = Ph & Xv
+ * Answer = smallest score seen over all columns.
+ *
+ * EARLY EXIT: the score drops by at most 1 per byte, so once
+ * score - bytesLeft > maxErrors no later column can get within budget.
+ *
+ * Bits above the term length hold garbage, but carries only move
+ * upwards and only the last row's bit is read - they never matter.
+ */
+std::uint32_t FuzzyMatcher::distance(std::string_view lowerText, std::uint32_t maxErrors) const {
+    const std::uint32_t over = maxErrors + 1;
+    if (length == 0) {
+        return 0;
+    }
+    if (lowerText.size() + maxErrors < length) {
+        return over;   // Too short even if every missing byte is an insertion
+    }
+
+    /**
+     * Teaching Point: A CHEAP NECESSARY CONDITION FIRST
+     * With ≤ maxErrors edits, all but maxErrors term bytes are matched by
+     * EQUAL bytes somewhere in the text. OR-ing the masks of all text
+     * bytes marks every term position that could be matched at all; too
+     * few of them and the DP cannot succeed. The OR loop has no dependency
+     * chain worth mentioning - it runs several times faster than the DP.
+     */
+    std::uint64_t reachable = 0;
+    for (char c : lowerText) {
+        reachable |= masks[static_cast<unsigned char>(c)];
+    }
+    if (static_cast<std::size_t>(__builtin_popcountll(reachable)) + maxErrors < length) {
+        return over;
+    }
+
+    std::uint64_t pv = ~std::uint64_t(0);
+    std::uint64_t mv = 0;
+    std::size_t score = length;
+    std::size_t best = length;
+    std::size_t left = lowerText.size();
+    for (char c : lowerText) {
+        const std::uint64_t eq = masks[static_cast<unsigned char>(c)];
+        const std::uint64_t xv = eq | mv;
+        const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        score += static_cast<std::size_t>((ph & lastRow) != 0);   // Branch-free: the
+        score -= static_cast<std::size_t>((mh & lastRow) != 0);   // sign is unpredictable
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        best = std::min(best, score);
+        if (best == 0) {
+            return 0;
+        }
+        --left;
+        if (score > left + maxErrors && best > maxErrors) {
+            return over;
+        }
+    }
+    return best > maxErrors ? over : static_cast<std::uint32_t>(best);
+}
+
+std::uint32_t FuzzyMatcher::defaultMaxErrors(std::size_t termLength) {
+    if (termLength <= 4) {
+        return 1;
+    }
+    if (termLength <= 8) {
+        return 2;
+    }
+    return static_cast<std::uint32_t>(std::min(termLength, kMaxTermLength) / 4);
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM FUZZYMATCHER IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. BITS AS SMALL INTEGERS:
+ *    - When neighbouring DP cells differ by ±1, a column fits in two words
+ *
+ * 2. PRECOMPUTE PER QUERY, NOT PER ROW:
+ *    - 256 masks built once make each text byte a single table lookup
+ *
+ * 3. BOUNDS PRUNE WORK:
+ *    - Knowing how fast the score can still fall lets hopeless names stop early
+ */
@@ -0,0 +1,469 @@
+#include "../include/HashCache.h"
+#include "../include/FileLock.h"
+#include "../include/Logger.h"
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+/**
+ * =============================================================================
+ * HASHCACHE IMPLEMENTATION - AN APPEND-ONLY LOG OF CONTENT HASHES
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Log-structured storage (append, replay, compact)
+ * 2. Composite keys in std::unordered_map (custom hasher)
+ * 3. Tolerating torn writes after a crash
+ * 4. Eviction: newest version per file, age-out of unused entries
+ * 5. Sharing one file between processes (flock + merge before rewrite)
+ */
+
+namespace {
+
+    constexpr char kMagic[8] = {'S', 'F', 'M', 'H', 'A', 'S', 'H', '\0'};
+    constexpr std::uint32_t kEndianMarker = 0x01020304u;
+    constexpr std::uint64_t kCompactSlack = 4096;   // Dead records tolerated before compacting
+
+    struct CacheHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t endianMarker;
+    };
+
+    static_assert(sizeof(CacheHeader) == 16, "header layout is part of the file format");
+}
+
+std::string HashCache::defaultPath() {
+    return (fs::path(".sfm_cache") / "hashes.sfmhc").string();
+}
+
+/**
+ * Teaching Point: COMBINING HASHES
+ * Multiplying by an odd constant and rotating between fields spreads each
+ * field over all bits, so (dev=1, ino=2) and (dev=2, ino=1) differ.
+ */
+std::size_t HashCache::IdentityHasher::operator()(const FileIdentity& id) const {
+    std::uint64_t h = id.inode * 0x9E3779B97F4A7C15ULL;
+    h ^= (h >> 29) + id.device;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= (h >> 31) + id.size;
+    h *= 0x94D049BB133111EBULL;
+    h ^= (h >> 32) + static_cast<std::uint64_t>(id.mtimeNs);
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+HashCache::HashCache(std::string cachePath) : path(std::move(cachePath)) {
+    using Days = std::chrono::duration<std::int64_t, std::ratio<86400>>;
+    today = static_cast<std::uint32_t>(
+        std::chrono::duration_cast<Days>(std::chrono::system_clock::now().time_since_epoch()).count());
+    load();
+}
+
+HashCache::~HashCache() {
+    flush();
+}
+
+/**
+ * @brief Reads the cache file under a shared lock
+ *
+ * A missing, foreign or torn file is rewritten on the next flush.
+ */
+void HashCache::load() {
+    FileLock lock(path + ".lock", FileLock::Mode::Shared);
+    bool torn = false;
+    if (!replay(recordsOnDisk, torn) || torn) {
+        rewriteNeeded = true;
+    }
+    if (recordsOnDisk > 0) {
+        Logger::getInstance().log("Hash cache loaded: " + std::to_string(entries.size()) +
+                                  " files from " + path);
+    }
+}
+
+/**
+ * @brief Applies every record of the file on disk to the in-memory table
+ * @param records Receives the number of complete records in the file
+ * @param torn Set if the file ends in a partial record
+ * @return false if the file is missing or not a cache file
+ *
+ * ALGORITHM:
+ * 1. mmap the file; check magic, version, endian marker
+ * 2. Every complete 48-byte record is applied in file order
+ * 3. Leftover bytes (a record torn by a crash) are ignored
+ *
+ * Applying a record twice is harmless - the hash of an identity never
+ * changes and days only move forward - so the same file can be replayed
+ * again to pick up what other processes wrote.
+ */
+bool HashCache::replay(std::uint64_t& records, bool& torn) {
+    static_assert(sizeof(DiskRecord) == 48, "record layout is part of the file format");
+    static_assert(std::is_trivially_copyable<DiskRecord>::value, "raw record block");
+
+    records = 0;
+    MappedFile file(path);
+    CacheHeader header;
+    if (!file.isOpen() || file.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.endianMarker != kEndianMarker) {
+        Logger::getInstance().log("Hash cache ignored (incompatible or damaged): " + path);
+        return false;
+    }
+
+    const std::size_t body = file.size() - sizeof(header);
+    const std::size_t count = body / sizeof(DiskRecord);
+    torn = body % sizeof(DiskRecord) != 0;
+    if (torn) {
+        Logger::getInstance().log("Hash cache: ignoring torn record at the end of " + path);
+    }
+    entries.reserve(entries.size() + count);
+    const char* cursor = file.data() + sizeof(header);
+    for (std::size_t r = 0; r < count; ++r, cursor += sizeof(DiskRecord)) {
+        DiskRecord record;
+        std::memcpy(&record, cursor, sizeof(record));
+        apply(record);
+    }
+    records = count;
+    return true;
+}
+
+void HashCache::apply(const DiskRecord& record) {
+    FileIdentity identity;
+    identity.device = record.device;
+    identity.inode = record.inode;
+    identity.size = record.size;
+    identity.mtimeNs = record.mtimeNs;
+    Entry& entry = entries[identity];
+    entry.day = std::max(entry.day, record.day == 0 ? today : record.day);   // 0: written before days
+    if (record.kind == static_cast<std::uint32_t>(Kind::Partial)) {
+        entry.partial = record.hash;
+        entry.hasPartial = true;
+    } else if (record.kind == static_cast<std::uint32_t>(Kind::Full)) {
+        entry.full = record.hash;
+        entry.hasFull = true;
+    } else if (record.kind == static_cast<std::uint32_t>(Kind::Sniff)) {
+        entry.sniff = record.hash;
+        entry.hasSniff = true;
+    }
+}
+
+/**
+ * Teaching Point: One private lookup, three public names - callers say
+ * what they want, and the kind can never be mixed up by a wrong enum.
+ */
+bool HashCache::lookup(const FileIdentity& identity, Kind kind, std::uint64_t& value) const {
+    if (!identity.known()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(identity);
+    if (it == entries.end()) {
+        return false;
+    }
+    const Entry& entry = it->second;
+    bool hit = false;
+    switch (kind) {
+        case Kind::Partial: value = entry.partial; hit = entry.hasPartial; break;
+        case Kind::Full: value = entry.full; hit = entry.hasFull; break;
+        case Kind::Sniff: value = entry.sniff; hit = entry.hasSniff; break;
+    }
+    if (hit && entry.day + kRefreshDays < today) {
+        refreshed.push_back(identity);   // Still in use - re-dated by the next flush
+    }
+    return hit;
+}
+
+bool HashCache::lookupPartial(const FileIdentity& identity, std::uint64_t& hash) const {
+    return lookup(identity, Kind::Partial, hash);
+}
+
+bool HashCache::lookupFull(const FileIdentity& identity, std::uint64_t& hash) const {
+    return lookup(identity, Kind::Full, hash);
+}
+
+bool HashCache::lookupSniff(const FileIdentity& identity, std::uint64_t& value) const {
+    return lookup(identity, Kind::Sniff, value);
+}
+
+void HashCache::storePartial(const FileIdentity& identity, std::uint64_t hash) {
+    store(identity, hash, Kind::Partial);
+}
+
+void HashCache::storeFull(const FileIdentity& identity, std::uint64_t hash) {
+    store(identity, hash, Kind::Full);
+}
+
+void HashCache::storeSniff(const FileIdentity& identity, std::uint64_t value) {
+    store(identity, value, Kind::Sniff);
+}
+
+void HashCache::store(const FileIdentity& identity, std::uint64_t hash, Kind kind) {
+    if (!identity.known()) {
+        return;
+    }
+    DiskRecord record{};
+    record.device = identity.device;
+    record.inode = identity.inode;
+    record.size = identity.size;
+    record.mtimeNs = identity.mtimeNs;
+    record.hash = hash;
+    record.kind = static_cast<std::uint32_t>(kind);
+    record.day = today;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(identity);
+    if (it != entries.end()) {
+        const Entry& known = it->second;
+        bool same = kind == Kind::Partial ? (known.hasPartial && known.partial == hash)
+                  : kind == Kind::Full    ? (known.hasFull && known.full == hash)
+                                          : (known.hasSniff && known.sniff == hash);
+        if (same) {
+            return;   // Nothing new - keep the log short
+        }
+    }
+    apply(record);
+    pending.push_back(record);
+}
+
+std::size_t HashCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+/**
+ * @brief Drops entries no run will ask for again (mutex held)
+ *
+ * ALGORITHM:
+ * 1. Entries unused for kKeepDays are expired
+ * 2. Per (device, inode), the newest remaining version wins (mtime, then
+ *    the more recently used) - older versions describe content that is gone
+ * 3. Everything else is erased; its records become dead records on disk
+ */
+void HashCache::prune() {
+    auto expired = [this](const Entry& entry) { return entry.day + kKeepDays < today; };
+    auto inodeOf = [](const FileIdentity& identity) {
+        FileIdentity key;
+        key.device = identity.device;
+        key.inode = identity.inode;
+        return key;
+    };
+    std::unordered_map<FileIdentity, std::pair<FileIdentity, std::uint32_t>, IdentityHasher> newest;
+    newest.reserve(entries.size());
+    for (const auto& item : entries) {
+        if (expired(item.second)) {
+            continue;
+        }
+        auto inserted = newest.try_emplace(inodeOf(item.first), item.first, item.second.day);
+        auto& best = inserted.first->second;
+        if (!inserted.second && (item.first.mtimeNs > best.first.mtimeNs ||
+                                 (item.first.mtimeNs == best.first.mtimeNs && item.second.day > best.second))) {
+            best = {item.first, item.second.day};
+        }
+    }
+    const std::size_t before = entries.size();
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto best = newest.find(inodeOf(it->first));
+        if (best == newest.end() || best->second.first != it->first) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (entries.size() != before) {
+        Logger::getInstance().log("Hash cache: dropped " + std::to_string(before - entries.size()) +
+                                  " stale or unused files");
+    }
+}
+
+void HashCache::recordsOf(const FileIdentity& identity, const Entry& entry, std::vector<DiskRecord>& out) {
+    DiskRecord record{};
+    record.device = identity.device;
+    record.inode = identity.inode;
+    record.size = identity.size;
+    record.mtimeNs = identity.mtimeNs;
+    record.day = entry.day;
+    const std::pair<bool, std::pair<std::uint64_t, Kind>> values[] = {
+        {entry.hasPartial, {entry.partial, Kind::Partial}},
+        {entry.hasFull, {entry.full, Kind::Full}},
+        {entry.hasSniff, {entry.sniff, Kind::Sniff}},
+    };
+    for (const auto& value : values) {
+        if (value.first) {
+            record.hash = value.second.first;
+            record.kind = static_cast<std::uint32_t>(value.second.second);
+            out.push_back(record);
+        }
+    }
+}
+
+std::size_t HashCache::liveRecords() const {
+    std::size_t live = 0;
+    for (const auto& item : entries) {
+        live += (item.second.hasPartial ? 1 : 0) + (item.second.hasFull ? 1 : 0) +
+                (item.second.hasSniff ? 1 : 0);
+    }
+    return live;
+}
+
+/**
+ * @brief Writes the pending records
+ *
+ * ALGORITHM:
+ * 1. Re-date entries hit since they got old; prune() the rest
+ * 2. Take the exclusive lock; measure the file as it is NOW (other
+ *    processes may have appended or rewritten it since load())
+ * 3. File unusable or misaligned, or dead records exceed live ones
+ *    (+ slack) → rewrite()
+ * 4. Nothing pending → done
+ * 5. Otherwise append the pending block - under the lock, so records of
+ *    two processes never interleave
+ */
+bool HashCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const FileIdentity& identity : refreshed) {
+        auto it = entries.find(identity);
+        if (it != entries.end() && it->second.day + kRefreshDays < today) {
+            it->second.day = today;
+            recordsOf(it->first, it->second, pending);
+        }
+    }
+    refreshed.clear();
+    prune();
+    if (entries.empty() && recordsOnDisk == 0) {
+        pending.clear();
+        return true;   // Never create an empty cache file
+    }
+    if (pending.empty() && !rewriteNeeded && recordsOnDisk <= 2 * liveRecords() + kCompactSlack) {
+        return true;   // Nothing to write - no need to lock out other processes
+    }
+
+    std::error_code ec;
+    const fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+    FileLock fileLock(path + ".lock", FileLock::Mode::Exclusive);
+    if (!fileLock.held()) {
+        Logger::getInstance().log("ERROR: Cannot lock hash cache: " + path);
+        return false;
+    }
+    const std::uint64_t bytes = fs::file_size(target, ec);
+    const bool aligned = !ec && bytes >= sizeof(CacheHeader) &&
+                         (bytes - sizeof(CacheHeader)) % sizeof(DiskRecord) == 0;
+    if (aligned) {
+        recordsOnDisk = (bytes - sizeof(CacheHeader)) / sizeof(DiskRecord);
+    }
+
+    std::uint64_t total = recordsOnDisk + pending.size();
+    if (rewriteNeeded || !aligned || total > 2 * liveRecords() + kCompactSlack) {
+        return rewrite();
+    }
+    if (pending.empty()) {
+        return true;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    if (!out) {
+        Logger::getInstance().log("ERROR: Cannot append to hash cache: " + path);
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(pending.data()),
+              static_cast<std::streamsize>(pending.size() * sizeof(DiskRecord)));
+    out.flush();   // Before the lock is released
+    if (!out) {
+        Logger::getInstance().log("ERROR: Writing hash cache failed: " + path);
+        rewriteNeeded = true;   // Possibly torn - rewrite it next time
+        return false;
+    }
+    recordsOnDisk = total;
+    pending.clear();
+    return true;
+}
+
+/**
+ * @brief Replaces the log with one record per live value (temp + rename)
+ *
+ * Called with the exclusive file lock held. The file is replayed first:
+ * records other processes appended since our load() would otherwise be
+ * lost by the rename. The temporary is per process, so even a writer
+ * that bypasses the lock cannot scribble into ours.
+ */
+bool HashCache::rewrite() {
+    std::uint64_t onDisk = 0;
+    bool torn = false;
+    replay(onDisk, torn);
+    prune();
+
+    std::error_code ec;
+    const std::string tempPath = FileLock::temporaryPath(path);
+    std::uint64_t written = 0;
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Logger::getInstance().log("ERROR: Cannot write hash cache: " + tempPath);
+            return false;
+        }
+        CacheHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.endianMarker = kEndianMarker;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<DiskRecord> records;
+        records.reserve(liveRecords());
+        for (const auto& item : entries) {
+            recordsOf(item.first, item.second, records);
+        }
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(DiskRecord)));
+        written = records.size();
+        if (!out) {
+            Logger::getInstance().log("ERROR: Writing hash cache failed: " + tempPath);
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        Logger::getInstance().log("ERROR: Cannot replace hash cache: " + ec.message());
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    recordsOnDisk = written;
+    pending.clear();
+    rewriteNeeded = false;
+    Logger::getInstance().log("Hash cache written: " + std::to_string(entries.size()) +
+                              " files to " + path);
+    return true;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM HASHCACHE IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. IDENTITY INSTEAD OF CONTENT:
+ *    - (device, inode, size, mtime) answers "did it change?" from metadata
+ *
+ * 2. LOG-STRUCTURED STORAGE:
+ *    - Appends are cheap and crash-tolerant; compaction keeps the file small
+ *
+ * 3. FAIL SOFT:
+ *    - A missing, foreign or torn cache only costs re-reading files
+ *
+ * 4. A SHARED FILE NEEDS A PROTOCOL:
+ *    - Appends and rewrites happen under one cross-process lock, and a
+ *      rewrite first merges what others wrote since we read the file
+ *
+ * 5. EVERY CACHE NEEDS AN EVICTION RULE:
+ *    - Keys that can never be asked for again (old versions, deleted
+ *      files) are dropped, so the file tracks what exists, not history
+ */
@@ -0,0 +1,355 @@
+#include "../include/ScanBackend.h"
+#include "../include/DeviceScheduler.h"
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+/**
+ * =============================================================================
+ * LINUX SCAN BACKEND - TALKING TO THE KERNEL DIRECTLY
+ * =============================================================================
+ *
+ * std::filesystem is portable, but it hides how many system calls it makes.
+ * On a 2M-file volume, syscalls ARE the cost of a scan. This backend:
+ *
+ * 1. Opens each directory ONCE and keeps the file descriptor
+ * 2. Reads entries with getdents64 into a large buffer (thousands per call)
+ * 3. Trusts d_type to classify entries without calling stat
+ * 4. Calls statx(dirfd, name, ...) only when metadata is needed, relative to
+ *    the open directory - the kernel never re-walks the full path
+ *
+ * Teaching Point: RAW SYSCALLS
+ * getdents64 has no portable libc wrapper on every glibc version, so we
+ * call it through syscall(SYS_getdents64, ...) and decode the records.
+ */
+
+namespace {
+
+    /**
+     * @brief Record layout written by getdents64 (see `man 2 getdents`)
+     *
+     * Teaching Point: d_name is a flexible array - the record length
+     * d_reclen tells us where the next record starts.
+     */
+    struct LinuxDirent64 {
+        std::uint64_t d_ino;
+        std::int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    constexpr std::size_t kDirentBufferSize = 128 * 1024;
+
+    /**
+     * @brief Closes a file descriptor when it goes out of scope (RAII)
+     */
+    class FdGuard {
+    public:
+        explicit FdGuard(int f) : fd(f) {}
+        ~FdGuard() { if (fd >= 0) ::close(fd); }
+        FdGuard(const FdGuard&) = delete;
+        FdGuard& operator=(const FdGuard&) = delete;
+        int get() const { return fd; }
+    private:
+        int fd;
+    };
+
+#ifdef STATX_TYPE
+    // Flipped once if the kernel (or a seccomp sandbox) rejects statx
+    std::atomic<bool> statxUnavailable{false};
+#endif
+
+    std::int64_t toNanoseconds(const struct timespec& ts) {
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    /**
+     * @brief What one stat call tells us about an entry
+     */
+    struct EntryMetadata {
+        EntryType type = EntryType::Other;
+        std::uintmax_t size = 0;
+        std::int64_t mtimeNs = 0;
+        std::uint64_t inode = 0;
+        std::uint64_t device = 0;
+    };
+
+    /**
+     * @brief Minimal metadata lookup relative to a directory fd
+     * @param dirFd Open directory (AT_FDCWD to resolve name as a path)
+     * @param name Entry name inside that directory
+     * @param follow Follow a trailing symlink
+     * @param wantType Also report the file type (needed for DT_UNKNOWN / links)
+     * @param meta Receives size, mtime, inode, device (and the type if wantType)
+     * @param stats Syscall counters
+     * @param cached Allow attributes from the client's cache (AT_STATX_DONT_SYNC)
+     * @return true on success
+     *
+     * Teaching Point: statx lets us ask for ONLY the fields we need. With
+     * STATX_SIZE | STATX_MTIME | STATX_INO, network filesystems can skip
+     * fetching attributes we would throw away. AT_STATX_DONT_SYNC would also
+     * let NFS answer from its attribute cache - but a stale size/mtime there
+     * becomes the HashCache key of a file that has since changed on the
+     * server. So it is only used where the cache cannot be stale: local
+     * filesystems, where it is a no-op anyway.
+     */
+    bool statRelative(int dirFd, const char* name, bool follow, bool wantType,
+                      EntryMetadata& meta, ScanStats& stats, bool cached) {
+        stats.syscalls += 1;
+        stats.statCalls += 1;
+
+        unsigned int mode = 0;
+        bool haveMetadata = false;
+#ifdef STATX_TYPE
+        if (!statxUnavailable.load(std::memory_order_relaxed)) {
+            struct statx stx;
+            int flags = (cached ? AT_STATX_DONT_SYNC : AT_STATX_SYNC_AS_STAT) |
+                        (follow ? 0 : AT_SYMLINK_NOFOLLOW);
+            unsigned int mask = STATX_SIZE | STATX_MTIME | STATX_INO | (wantType ? STATX_TYPE : 0u);
+            if (::statx(dirFd, name, flags, mask, &stx) == 0) {
+                meta.size = stx.stx_size;
+                meta.mtimeNs = static_cast<std::int64_t>(stx.stx_mtime.tv_sec) * 1000000000LL +
+                               stx.stx_mtime.tv_nsec;
+                meta.inode = stx.stx_ino;
+                meta.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+                mode = stx.stx_mode;
+                haveMetadata = true;
+            } else if (errno == ENOSYS || errno == EPERM) {
+                statxUnavailable.store(true, std::memory_order_relaxed);
+            } else {
+                return false;
+            }
+        }
+#endif
+        if (!haveMetadata) {
+            struct stat st;
+            if (::fstatat(dirFd, name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) != 0) {
+                return false;
+            }
+            meta.size = static_cast<std::uintmax_t>(st.st_size);
+            meta.mtimeNs = toNanoseconds(st.st_mtim);
+            meta.inode = st.st_ino;
+            meta.device = st.st_dev;
+            mode = st.st_mode;
+        }
+        if (wantType) {
+            if (S_ISREG(mode))       meta.type = EntryType::Regular;
+            else if (S_ISDIR(mode))  meta.type = EntryType::Directory;
+            else if (S_ISLNK(mode))  meta.type = EntryType::Symlink;
+            else                     meta.type = EntryType::Other;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Copies content identity into an entry
+     *
+     * Teaching Point: The catalog stores ONE device per directory. A file
+     * on another device (link target elsewhere, bind-mounted file) would
+     * pair its inode with the wrong device, so it gets inode 0 = "unknown".
+     */
+    void setIdentity(ScanEntry& entry, const EntryMetadata& meta, std::uint64_t directoryDevice) {
+        entry.size = meta.size;
+        entry.mtimeNs = meta.mtimeNs;
+        entry.inode = meta.device == directoryDevice ? meta.inode : 0;
+    }
+
+    /**
+     * @brief True if the device is a network filesystem (NFS, SMB, ...)
+     *
+     * Teaching Point: Nearly every directory a worker lists is on the same
+     * device as the one before, so a one-entry per-thread memo answers
+     * without a statfs() per directory.
+     */
+    bool onNetwork(std::uint64_t device, const fs::path& dir) {
+        thread_local std::uint64_t lastDevice = 0;
+        thread_local bool lastNetwork = false;
+        if (device != lastDevice) {
+            lastNetwork = classifyDevice(device, dir.string()) == DeviceClass::Network;
+            lastDevice = device;
+        }
+        return lastNetwork;
+    }
+
+    EntryType fromDType(unsigned char dType) {
+        switch (dType) {
+            case DT_REG: return EntryType::Regular;
+            case DT_DIR: return EntryType::Directory;
+            case DT_LNK: return EntryType::Symlink;
+            default:     return EntryType::Other;
+        }
+    }
+}
+
+/**
+ * @brief Lists one directory with getdents64 + statx
+ *
+ * ALGORITHM:
+ * 1. open(dir, O_DIRECTORY)
+ * 2. Repeat getdents64 into a reused 128 KiB per-thread buffer until it returns 0
+ * 3. For each record:
+ *    - skip "." and ".."
+ *    - DT_DIR / DT_FIFO / ...: classified for free from d_type
+ *    - DT_REG: one statx for the size
+ *    - DT_LNK: one statx through the link when the caller wants targets
+ *    - DT_UNKNOWN (some filesystems never fill d_type): one statx for type+size
+ */
+bool LinuxScanBackend::listDirectory(const fs::path& dir, bool resolveLinks,
+                                     DirectoryListing& out, ScanStats& stats,
+                                     std::error_code& ec) const {
+    stats.syscalls += 1;
+    FdGuard dirFd(::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (dirFd.get() < 0) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+
+    // mtime BEFORE reading: a change made while we list bumps the mtime
+    // past this value, so the next incremental rescan lists it again
+    struct stat dirStat;
+    stats.syscalls += 1;
+    stats.statCalls += 1;
+    if (::fstat(dirFd.get(), &dirStat) != 0) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    out.mtimeNs = toNanoseconds(dirStat.st_mtim);
+    out.device = dirStat.st_dev;
+    const bool cached = !onNetwork(out.device, dir);
+
+    // Teaching Point: thread_local buffer - allocated once per worker
+    // thread, reused for every directory that worker lists.
+    thread_local std::vector<char> buffer(kDirentBufferSize);
+
+    while (true) {
+        stats.syscalls += 1;
+        stats.readdirCalls += 1;
+        long bytes = ::syscall(SYS_getdents64, dirFd.get(), buffer.data(), buffer.size());
+        if (bytes < 0) {
+            ec = std::error_code(errno, std::generic_category());
+            stats.syscalls += 1;  // close() in FdGuard
+            return false;
+        }
+        if (bytes == 0) {
+            break;
+        }
+
+        for (long offset = 0; offset < bytes;) {
+            const auto* record = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+            offset += record->d_reclen;
+
+            const char* name = record->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            ScanEntry entry;
+            entry.type = fromDType(record->d_type);
+            bool ok = true;
+            EntryMetadata meta;
+
+            if (record->d_type == DT_UNKNOWN || entry.type == EntryType::Regular) {
+                meta.type = entry.type;
+                ok = statRelative(dirFd.get(), name, false, record->d_type == DT_UNKNOWN, meta, stats,
+                                  cached);
+                entry.type = meta.type;
+                setIdentity(entry, meta, out.device);
+            }
+
+            if (ok && entry.type == EntryType::Symlink && resolveLinks) {
+                // A dangling link fails here; keep it with targetType = Other
+                EntryMetadata target;
+                if (statRelative(dirFd.get(), name, true, true, target, stats, cached)) {
+                    entry.targetType = target.type;
+                    setIdentity(entry, target, out.device);
+                } else {
+                    entry.targetType = EntryType::Other;
+                }
+            }
+
+            if (!ok) {
+                continue;  // Entry vanished between getdents64 and statx
+            }
+
+            entry.name.assign(name, std::strlen(name));
+            out.entries.push_back(std::move(entry));
+            stats.entries += 1;
+        }
+    }
+
+    stats.syscalls += 1;  // close() in FdGuard
+    stats.directories += 1;
+    return true;
+}
+
+bool LinuxScanBackend::directoryMtime(const fs::path& dir, std::int64_t& mtimeNs,
+                                      ScanStats& stats, std::error_code& ec) const {
+    struct stat st;
+    stats.syscalls += 1;
+    stats.statCalls += 1;
+    if (::stat(dir.c_str(), &st) != 0) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        ec = std::make_error_code(std::errc::not_a_directory);
+        return false;
+    }
+    mtimeNs = toNanoseconds(st.st_mtim);
+    return true;
+}
+
+/**
+ * @brief One statx following links, for a single path
+ */
+bool LinuxScanBackend::fileMetadata(const fs::path& file, ScanEntry& out,
+                                    std::uint64_t& device, ScanStats& stats,
+                                    std::error_code& ec) const {
+    EntryMetadata meta;
+    // Device unknown before the call: a single file is worth the round-trip
+    if (!statRelative(AT_FDCWD, file.c_str(), true, true, meta, stats, false)) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    out.type = meta.type;
+    out.targetType = meta.type;
+    out.size = meta.size;
+    out.mtimeNs = meta.mtimeNs;
+    out.inode = meta.inode;
+    device = meta.device;
+    return true;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM THE LINUX SCAN BACKEND
+ * =============================================================================
+ *
+ * 1. SYSCALL ECONOMY:
+ *    - Batch directory reads (getdents64) instead of one entry per call
+ *    - Use d_type before reaching for stat
+ *    - Resolve names relative to an open directory fd (no path rebuilding)
+ *
+ * 2. GRACEFUL FALLBACKS:
+ *    - DT_UNKNOWN → statx for the type
+ *    - statx missing (old kernel, sandbox) → fstatat, decided once
+ *
+ * 3. RAII FOR OS HANDLES:
+ *    - FdGuard closes the directory on every return path
+ *
+ * 4. CHEAP IS NOT WORTH STALE:
+ *    - Scanned size/mtime key the hash cache; on network filesystems
+ *      they are fetched from the server, not the client's attribute cache
+ */
+
+#endif // __linux__
@@ -1,8 +1,7 @@
 #include "../include/Logger.h"
 #include <iostream>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <ctime>
 
 /**
  * =============================================================================
@@ -14,6 +13,7 @@
  * 2. Thread-safe file operations using std::mutex
  * 3. RAII (Resource Acquisition Is Initialization)
  * 4. Modern C++ chrono library for timestamps
+ * 5. A lock-free multi-producer ring buffer with one consumer thread
  */
 
 /**
@@ -51,6 +51,7 @@ Logger::Logger() {
  * - Early return/exit
  */
 Logger::~Logger() {
+    stopAsync();
     if (logFile.is_open()) {
         log("=== File Management System Stopped ===");
         logFile.close();
@@ -81,6 +82,68 @@ Logger& Logger::getInstance() {
     return instance;
 }
 
+namespace {
+
+    /**
+     * @brief Appends "YYYY-MM-DD HH:MM:SS" for the current second
+     *
+     * Teaching Point: CACHE WHAT CHANGES ONCE PER SECOND
+     * localtime() consults the time zone database and put_time() runs a
+     * locale-aware formatter - far more work than the rest of log().
+     * Each thread keeps the text of the last second it formatted; within
+     * that second a timestamp is a 19-byte copy. thread_local means no
+     * thread ever waits for another to update the cache.
+     */
+    void appendTimestamp(std::string& out) {
+        struct Cache {
+            std::time_t second = -1;
+            char text[32] = {};
+            std::size_t length = 0;
+        };
+        thread_local Cache cache;
+        const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (now != cache.second) {
+            std::tm parts{};
+#ifdef _WIN32
+            localtime_s(&parts, &now);
+#else
+            localtime_r(&now, &parts);   // Reentrant: std::localtime shares one static buffer
+#endif
+            cache.length = std::strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &parts);
+            cache.second = now;
+        }
+        out.append(cache.text, cache.length);
+    }
+
+    /**
+     * @brief Level of an untyped log(message) call, read from its prefix
+     */
+    LogLevel levelOfText(const std::string& message) {
+        if (message.compare(0, 5, "ERROR") == 0 || message.compare(0, 5, "FATAL") == 0) {
+            return LogLevel::Error;
+        }
+        if (message.compare(0, 7, "WARNING") == 0) {
+            return LogLevel::Warn;
+        }
+        return LogLevel::Info;
+    }
+
+    std::string_view prefixOf(LogLevel level) {
+        switch (level) {
+            case LogLevel::Trace: return "TRACE: ";
+            case LogLevel::Debug: return "DEBUG: ";
+            case LogLevel::Warn:  return "WARNING: ";
+            case LogLevel::Error: return "ERROR: ";
+            default:              return "";
+        }
+    }
+
+    std::int64_t steadySecond() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
 /**
  * @brief Main logging method
  * @param message Text to log
@@ -104,23 +167,290 @@ Logger& Logger::getInstance() {
  * 4. Thread 2 now acquires lock and proceeds
  * 
  * Result: Serialized access, no corruption
+ * 
+ * ASYNCHRONOUS MODE: the line is built OUTSIDE any lock (timestamp from
+ * the per-second cache), then handed to the ring. The caller's cost is
+ * one allocation, one CAS and one store - the disk is the writer's job.
  */
 void Logger::log(const std::string& message) {
+    write(levelOfText(message), std::string_view(), message);   // Text carries its own prefix
+}
+
+/**
+ * @brief Levelled logging - prefixes "WARNING: ", "ERROR: " etc.
+ */
+void Logger::log(LogLevel level, const std::string& message) {
+    write(level, prefixOf(level), message);
+}
+
+/**
+ * @brief Filters by the runtime threshold and writes one line
+ *
+ * Records at Error are flushed before returning (in both modes).
+ * A producer blocked on a full ring (LogOverflow::Block) re-checks that
+ * the writer still exists and falls back to the synchronous path when
+ * stopAsync() ends it - otherwise it would spin forever.
+ */
+void Logger::write(LogLevel level, std::string_view prefix, const std::string& message) {
+    if (!enabled(level)) {
+        return;
+    }
+
+    // Format: [2026-01-28 14:30:45] User action performed
+    std::string line;
+    line.reserve(message.size() + prefix.size() + 24);
+    line += '[';
+    appendTimestamp(line);
+    line += "] ";
+    line += prefix;
+    line += message;
+    line += '\n';
+    
+    if (asyncActive.load(std::memory_order_acquire)) {
+        std::size_t ticket = 0;
+        bool queued = tryPush(line, ticket);
+        if (!queued && asyncOptions.overflow == LogOverflow::Drop) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Block: wait for the writer to free slots - unless stopAsync() took
+        // it away meanwhile; then nobody will, and the line goes out below
+        while (!queued && asyncActive.load(std::memory_order_acquire)) {
+            wakeWriter();
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                progress.wait_for(lock, std::chrono::milliseconds(1));
+            }
+            queued = tryPush(line, ticket);
+        }
+        if (queued) {
+            if (writerSleeping.load()) {
+                wakeWriter();
+            }
+            if (level >= LogLevel::Error) {
+                waitWritten(ticket + 1);   // An error must survive a crash right after it
+            }
+            return;
+        }
+    }
+    
     // RAII lock - automatically releases when function exits
     std::lock_guard<std::mutex> lock(logMutex);
     
     if (logFile.is_open()) {
-        // Format: [2026-01-28 14:30:45] User action performed
-        logFile << "[" << getCurrentTimestamp() << "] " << message << std::endl;
+        logFile << line;
+        logFile.flush();
         
-        // std::endl does two things:
-        // 1. Inserts newline (\n)
-        // 2. Flushes buffer (ensures immediate write to disk)
-        // 
-        // Why flush? Logs should be immediately visible, especially for debugging
+        // Why flush? Logs should be immediately visible, especially for debugging.
+        // (This per-line flush is exactly what asynchronous mode batches away.)
+    }
+}
+
+/**
+ * @brief Claims a ring slot and publishes the line in it
+ * @return false if the ring is full
+ *
+ * Teaching Point: BOUNDED MPSC QUEUE WITH PER-SLOT SEQUENCE NUMBERS
+ * Slot k starts with sequence k. A producer holding ticket t may fill
+ * slot t & mask only when its sequence == t (the writer has emptied it).
+ * It claims the ticket with one CAS on head, writes the text, then
+ * stores sequence = t + 1: "full, ready to read". The writer empties it
+ * and stores t + capacity: "free for the producer one lap later".
+ * No lock anywhere - a producer only ever waits when the ring is full.
+ */
+bool Logger::tryPush(std::string& line, std::size_t& ticket) {
+    std::size_t position = head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = ring[position & ringMask];
+        const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if (difference == 0) {
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.text = std::move(line);
+                slot.sequence.store(position + 1, std::memory_order_release);
+                ticket = position;
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;   // Slot still holds a record from the previous lap
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
     }
 }
 
+void Logger::wakeWriter() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);   // Closes the check-then-sleep window
+    }
+    wake.notify_one();
+}
+
+void Logger::waitWritten(std::size_t count) {
+    wakeWriter();
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    progress.wait(lock, [this, count] {
+        return written.load() >= count || !asyncActive.load();
+    });
+}
+
+/**
+ * @brief The background writer
+ *
+ * ALGORITHM:
+ * 1. Move up to batchRecords ready lines into one buffer
+ * 2. If records were dropped since the last batch, add one line saying so
+ * 3. One write() + flush for the whole buffer; publish `written`
+ * 4. Nothing ready: sleep until woken (or 100 ms), exit once stopping
+ *    and the ring is empty
+ */
+void Logger::writerLoop() {
+    std::string buffer;
+    buffer.reserve(64 * 1024);
+    std::uint64_t reportedDrops = dropped.load();
+    for (;;) {
+        std::size_t batch = 0;
+        while (batch < asyncOptions.batchRecords) {
+            Slot& slot = ring[tail & ringMask];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                break;
+            }
+            buffer += slot.text;
+            slot.text.clear();
+            slot.sequence.store(tail + ringMask + 1, std::memory_order_release);
+            ++tail;
+            ++batch;
+        }
+        const std::uint64_t drops = dropped.load(std::memory_order_relaxed);
+        if (drops != reportedDrops) {
+            buffer += '[';
+            appendTimestamp(buffer);
+            buffer += "] WARNING: log buffer full, " + std::to_string(drops - reportedDrops) +
+                      " records dropped\n";
+            reportedDrops = drops;
+        }
+        if (!buffer.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(logMutex);
+                logFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                logFile.flush();
+            }
+            buffer.clear();
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                written.store(tail);
+            }
+            progress.notify_all();
+            continue;
+        }
+        if (head.load() != tail) {
+            std::this_thread::yield();   // A producer claimed a slot but has not filled it yet
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping && head.load() == tail) {
+            break;
+        }
+        writerSleeping.store(true);
+        wake.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return stopping || head.load() != tail;
+        });
+        writerSleeping.store(false);
+    }
+}
+
+bool Logger::startAsync(const LoggerOptions& options) {
+    std::lock_guard<std::mutex> lock(logMutex);   // Synchronous writers finish first
+    if (asyncActive.load() || !logFile.is_open()) {
+        return false;
+    }
+    std::size_t capacity = 2;
+    while (capacity < options.capacity) {
+        capacity <<= 1;
+    }
+    asyncOptions = options;
+    if (asyncOptions.batchRecords == 0) {
+        asyncOptions.batchRecords = 1;
+    }
+    ring.reset(new Slot[capacity]);
+    ringMask = capacity - 1;
+    for (std::size_t k = 0; k < capacity; ++k) {
+        ring[k].sequence.store(k, std::memory_order_relaxed);
+    }
+    head.store(0);
+    tail = 0;
+    written.store(0);
+    stopping = false;
+    writer = std::thread(&Logger::writerLoop, this);
+    asyncActive.store(true, std::memory_order_release);
+    return true;
+}
+
+/**
+ * Teaching Point: The writer drains the ring before it exits, so every
+ * record logged before stopAsync() was called reaches the file. Lines
+ * other threads log WHILE it runs may be lost - stop the logger last.
+ */
+void Logger::stopAsync() {
+    if (!asyncActive.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    progress.notify_all();   // Release anyone still in waitWritten()
+}
+
+void Logger::flush() {
+    if (asyncActive.load(std::memory_order_acquire)) {
+        waitWritten(head.load());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(logMutex);
+    logFile.flush();
+}
+
+/**
+ * @brief Maps a level name (command line, environment) to a LogLevel
+ */
+bool Logger::parseLevel(std::string_view text, LogLevel& level) {
+    static constexpr struct { std::string_view name; LogLevel level; } kNames[] = {
+        {"trace", LogLevel::Trace}, {"debug", LogLevel::Debug}, {"info", LogLevel::Info},
+        {"warn", LogLevel::Warn}, {"warning", LogLevel::Warn}, {"error", LogLevel::Error},
+        {"off", LogLevel::Off},
+    };
+    for (const auto& entry : kNames) {
+        if (text == entry.name) {
+            level = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Per-second budget of one call site
+ *
+ * The first caller in a new second resets the window; a race around the
+ * boundary can let a record or two more through, which is harmless.
+ */
+bool LogRateLimiter::allow(std::uint64_t& suppressed) {
+    const std::int64_t now = steadySecond();
+    std::int64_t window = windowSecond.load(std::memory_order_relaxed);
+    if (window != now && windowSecond.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        inWindow.store(0, std::memory_order_relaxed);
+    }
+    if (inWindow.fetch_add(1, std::memory_order_relaxed) < limit) {
+        suppressed = heldBack.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    heldBack.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
 /**
  * @brief Generates timestamp for log entries
  * @return Formatted string: "YYYY-MM-DD HH:MM:SS"
@@ -136,24 +466,14 @@ void Logger::log(const std::string& message) {
  * - Portable across platforms
  * - More precise (nanosecond resolution available)
  * - Better integration with C++ STL
+ * 
+ * The formatting itself happens at most once per second per thread
+ * (see appendTimestamp above).
  */
 std::string Logger::getCurrentTimestamp() const {
-    // Get current time point
-    auto now = std::chrono::system_clock::now();
-    
-    // Convert to time_t for formatting (C++ chrono doesn't have great formatting yet)
-    // Note: C++20 adds std::format for better time formatting
-    auto time = std::chrono::system_clock::to_time_t(now);
-    
-    // Create string stream for formatting
-    std::stringstream ss;
-    
-    // std::put_time: Formats time according to format string
-    // %Y = 4-digit year, %m = month, %d = day
-    // %H = hour (24h), %M = minute, %S = second
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    
-    return ss.str();
+    std::string text;
+    appendTimestamp(text);
+    return text;
 }
 
 /**
@@ -171,17 +491,27 @@ std::string Logger::getCurrentTimestamp() const {
  *    - std::lock_guard provides RAII-based locking
  *    - Magic statics ensure thread-safe initialization
  * 
- * 3. RAII PRINCIPLE:
+ * 3. ASYNCHRONOUS LOGGING:
+ *    - Producers format outside any lock and publish with one CAS
+ *    - One writer turns thousands of lines into one write()
+ *    - Errors are flushed synchronously; overflow blocks or drops by policy
+ * 
+ * 4. LEVELS AND SAMPLING:
+ *    - if constexpr against SFM_LOG_MIN_LEVEL removes trace calls from release builds
+ *    - logf() formats "{}" arguments only after the threshold check
+ *    - A per-call-site rate limiter keeps hot-loop failures from flooding the log
+ * 
+ * 5. RAII PRINCIPLE:
  *    - File opened in constructor, closed in destructor
  *    - Lock acquired by lock_guard, released automatically
  *    - Exception-safe resource management
  * 
- * 4. MODERN C++:
+ * 6. MODERN C++:
  *    - <chrono> for time handling
  *    - <filesystem> compatibility (used by other classes)
  *    - Smart pointers readiness (this class works with unique_ptr/shared_ptr)
  * 
- * 5. BEST PRACTICES:
+ * 7. BEST PRACTICES:
  *    - Const correctness (getCurrentTimestamp is const)
  *    - Error handling (check if file is open)
  *    - Clear method names (self-documenting code)
@@ -0,0 +1,121 @@
+#include "../include/MappedFile.h"
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SFM_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * =============================================================================
+ * MAPPEDFILE IMPLEMENTATION - mmap WITH A PORTABLE FALLBACK
+ * =============================================================================
+ */
+
+/**
+ * @brief Opens and maps a file
+ *
+ * ALGORITHM (POSIX):
+ * 1. open() + fstat() for the size
+ * 2. mmap(PROT_READ, MAP_PRIVATE)
+ * 3. close() the descriptor - the mapping stays valid without it
+ *
+ * Teaching Point: An empty file cannot be mapped (mmap of length 0 fails),
+ * so it is treated as "not open".
+ */
+MappedFile::MappedFile(const std::string& path) {
+#ifdef SFM_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* address = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                               PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mappedData = static_cast<const char*>(address);
+            mappedSize = static_cast<std::size_t>(st.st_size);
+            usingMmap = true;
+        }
+    }
+    ::close(fd);
+    if (usingMmap) {
+        return;
+    }
+#endif
+    // Fallback: read the whole file into memory
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return;
+    }
+    std::streamoff length = in.tellg();
+    if (length <= 0) {
+        return;
+    }
+    fallbackBuffer.resize(static_cast<std::size_t>(length));
+    in.seekg(0);
+    if (in.read(fallbackBuffer.data(), length)) {
+        mappedData = fallbackBuffer.data();
+        mappedSize = fallbackBuffer.size();
+    } else {
+        fallbackBuffer.clear();
+    }
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+void MappedFile::release() {
+#ifdef SFM_HAVE_MMAP
+    if (usingMmap && mappedData != nullptr) {
+        ::munmap(const_cast<char*>(mappedData), mappedSize);
+    }
+#endif
+    mappedData = nullptr;
+    mappedSize = 0;
+    usingMmap = false;
+    fallbackBuffer.clear();
+}
+
+/**
+ * Teaching Point: A moved-from MappedFile must not unmap anything, so the
+ * source is reset to the empty state. For the fallback the vector moves
+ * its heap block, so mappedData (pointing into it) stays valid.
+ */
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mappedData(std::exchange(other.mappedData, nullptr)),
+      mappedSize(std::exchange(other.mappedSize, 0)),
+      usingMmap(std::exchange(other.usingMmap, false)),
+      fallbackBuffer(std::move(other.fallbackBuffer)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+        usingMmap = std::exchange(other.usingMmap, false);
+        fallbackBuffer = std::move(other.fallbackBuffer);
+    }
+    return *this;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM MAPPEDFILE IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. ZERO-COPY READS:
+ *    - mmap exposes the page cache directly; nothing is copied up front
+ *
+ * 2. RAII + MOVE-ONLY:
+ *    - Exactly one owner per mapping, released on every path
+ *
+ * 3. GRACEFUL FALLBACK:
+ *    - No mmap → plain ifstream read behind the same interface
+ */
@@ -1,9 +1,14 @@
 #include "../include/Menu.h"
 #include "../include/Logger.h"
+#include "../include/Metrics.h"
 #include <iostream>
 #include <limits>
 #include <iomanip>
+#include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
 
 /**
  * =============================================================================
@@ -127,16 +132,26 @@ void Menu::displayMainMenu() const {
     clearScreen();
     
     std::cout << "\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
-    std::cout << "  📂 Current Directory: " << currentDirectory << "\n";
+    std::cout << "  📂 Current Directory: " << currentDirectory;
+    if (fileManager->getRoots().size() > 1) {
+        std::cout << "  (+" << fileManager->getRoots().size() - 1 << " more roots)";
+    }
+    std::cout << "\n";
     std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n";
     
     std::cout << "  1️⃣  Scan Directory\n";
     std::cout << "  2️⃣  Organize Files by Extension\n";
     std::cout << "  3️⃣  Search Files by Name\n";
-    std::cout << "  4️⃣  Find Duplicate Files\n";
+    std::cout << "  4️⃣  Find Duplicate & Similar Files\n";
     std::cout << "  5️⃣  Display All Files\n";
-    std::cout << "  6️⃣  Change Directory\n";
+    std::cout << "  6️⃣  Change Directory / Roots\n";
     std::cout << "  7️⃣  View Category Mappings\n";
+    std::cout << "  8️⃣  Quick Rescan (changed directories only)\n";
+    std::cout << "  9️⃣  Live Watch Mode " << (fileManager->isWatching() ? "[ON]" : "[OFF]") << "\n";
+    std::cout << "  🔟 Query Files (size, type, date, name)\n";
+    std::cout << "  1️⃣1️⃣ Undo Last Organize\n";
+    std::cout << "  1️⃣2️⃣ Performance Metrics\n";
+    std::cout << "  1️⃣3️⃣ Disk Usage (largest directories & files)\n";
     std::cout << "  0️⃣  Exit\n\n";
     std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
 }
@@ -183,11 +198,29 @@ void Menu::processChoice(int choice) {
             fileSorter->displayCategories();
             pauseScreen();
             break;
+        case 8:
+            handleQuickRescan();
+            break;
+        case 9:
+            handleToggleWatch();
+            break;
+        case 10:
+            handleQueryFiles();
+            break;
+        case 11:
+            handleUndoOrganize();
+            break;
+        case 12:
+            handleShowMetrics();
+            break;
+        case 13:
+            handleDiskUsage();
+            break;
         case 0:
             exit();
             break;
         default:
-            std::cout << "\n❌ Invalid choice! Please enter 0-7.\n";
+            std::cout << "\n❌ Invalid choice! Please enter 0-13.\n";
             pauseScreen();
     }
 }
@@ -205,12 +238,37 @@ void Menu::processChoice(int choice) {
  * - Clear code organization
  */
 void Menu::handleScanDirectory() {
+    ScanOptions options = fileManager->getScanOptions();
+    
+    std::string answer = getUserInput("\nInclude subdirectories? (yes/no): ");
+    std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+    options.recursive = (answer == "yes" || answer == "y");
+    
+    if (options.recursive) {
+        options.maxDepth = getIntInput("Maximum depth (-1 = unlimited): ");
+        
+        answer = getUserInput("Follow symbolic links to directories? (yes/no): ");
+        std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+        options.symlinks = (answer == "yes" || answer == "y")
+                               ? SymlinkPolicy::FollowAll
+                               : SymlinkPolicy::FollowFiles;
+    }
+    
+    // Remember the choice so the rescan after organizing uses it too
+    fileManager->setScanOptions(options);
+    
     std::cout << "\n🔍 Scanning directory: " << currentDirectory << "\n\n";
     
     int count = fileManager->scanDirectory();
     
     if (count > 0) {
-        std::cout << "✅ Found " << count << " files!\n";
+        const ScanStats& stats = fileManager->getLastScanStats();
+        std::cout << "✅ Found " << count << " files in " << stats.directories
+                  << " directories!\n";
+        std::cout << "   Backend: " << fileManager->getScanBackend().name()
+                  << " | syscalls: " << stats.syscalls
+                  << " (" << std::fixed << std::setprecision(2)
+                  << static_cast<double>(stats.syscalls) / count << " per file)\n";
     } else {
         std::cout << "⚠️  No files found or directory is empty.\n";
     }
@@ -218,27 +276,132 @@ void Menu::handleScanDirectory() {
     pauseScreen();
 }
 
+/**
+ * @brief Handler: Incremental rescan using directory mtimes
+ * 
+ * Teaching Point: Same feedback as a full scan, plus how much work was
+ * saved - users trust a shortcut more when they can see what it skipped.
+ */
+void Menu::handleQuickRescan() {
+    std::cout << "\n🔄 Rescanning changed directories in: " << currentDirectory << "\n\n";
+    
+    int count = fileManager->rescanIncremental();
+    const ScanStats& stats = fileManager->getLastScanStats();
+    
+    if (count > 0) {
+        std::cout << "✅ " << count << " files | " << stats.reusedDirectories
+                  << " directories unchanged, " << stats.directories << " re-listed\n";
+        std::cout << "   syscalls: " << stats.syscalls << "\n";
+    } else {
+        std::cout << "⚠️  No files found or directory is empty.\n";
+    }
+    
+    pauseScreen();
+}
+
+/**
+ * @brief Handler: Turn live watch mode on or off
+ */
+void Menu::handleToggleWatch() {
+    if (fileManager->isWatching()) {
+        WatchStats stats = fileManager->getWatchStats();
+        fileManager->stopWatching();
+        std::cout << "\n⏹  Watch mode stopped. " << stats.batches << " batches applied ("
+                  << stats.filesAdded << " added, " << stats.filesRemoved << " removed, "
+                  << stats.filesUpdated << " updated).\n";
+    } else if (fileManager->startWatching()) {
+        auto lock = fileManager->lockCatalog();
+        std::cout << "\n👁  Watching " << fileManager->getFiles().directoryCount()
+                  << " directories - changes are applied automatically.\n";
+    } else {
+        std::cout << "\n❌ Watch mode could not be started (see file_manager.log).\n";
+    }
+    // While watching, files change under us: hash with pread, never mmap
+    ReaderOptions reader = fileSearcher->getReaderOptions();
+    reader.mapFiles = !fileManager->isWatching();
+    fileSearcher->setReaderOptions(reader);
+    pauseScreen();
+}
+
 /**
  * @brief Handler: Organize files into categories
  * 
  * Teaching Point: USER CONFIRMATION PATTERN
  * 
  * For destructive operations (moving files), always:
- * 1. Show what will happen
+ * 1. Show what will happen (a dry run of the real plan)
  * 2. Ask for confirmation
  * 3. Provide clear success/failure feedback
  */
 void Menu::handleOrganizeFiles() {
-    const auto& files = fileManager->getFiles();
+    if (handleInterruptedOrganize()) {
+        return;
+    }
+    if (fileManager->getRoots().size() > 1) {
+        // Category folders live in ONE directory; files of other mounts
+        // would be copied across filesystems into it
+        std::cout << "\n⚠️  Organizing works on a single root - drop the other "
+                  << fileManager->getRoots().size() - 1 << " root(s) first (option 6).\n";
+        pauseScreen();
+        return;
+    }
     
-    if (files.empty()) {
+    OrganizePlan plan;
+    std::size_t fileCount = 0;
+    {
+        // Shared lock only while planning - applying needs no catalog
+        auto lock = fileManager->lockCatalog();
+        fileCount = fileManager->getFiles().size();
+        if (fileCount > 0) {
+            plan = fileSorter->planOrganize(fileManager->getFiles(), currentDirectory);
+        }
+    }
+    
+    if (fileCount == 0) {
         std::cout << "\n⚠️  No files scanned yet. Please scan directory first.\n";
         pauseScreen();
         return;
     }
     
-    std::cout << "\n📁 Ready to organize " << files.size() << " files.\n";
-    std::cout << "Files will be moved into category-based subfolders.\n\n";
+    if (plan.conflicts > 0) {
+        std::cout << "\n⚠️  " << plan.conflicts << " files have a name that is already taken "
+                  << "in their category folder.\n";
+        std::string rename = getUserInput("Move them as \"name (2).ext\" instead of skipping? (yes/no): ");
+        std::transform(rename.begin(), rename.end(), rename.begin(), ::tolower);
+        if (rename == "yes" || rename == "y") {
+            auto lock = fileManager->lockCatalog();
+            plan = fileSorter->planOrganize(fileManager->getFiles(), currentDirectory,
+                                            ConflictPolicy::Rename);
+        }
+    }
+    
+    // The dry run: exactly what applyPlan() will do
+    std::vector<std::size_t> perFolder(plan.folders.size(), 0);
+    for (const PlannedMove& move : plan.moves) {
+        perFolder[move.folder] += 1;
+    }
+    std::cout << "\n📁 Plan for " << fileCount << " files:\n";
+    for (std::size_t f = 0; f < plan.folders.size(); ++f) {
+        if (perFolder[f] > 0) {
+            std::cout << "   " << std::setw(8) << perFolder[f] << "  → " << plan.folders[f] << "\n";
+        }
+    }
+    const std::size_t preview = std::min<std::size_t>(plan.moves.size(), 10);
+    for (std::size_t k = 0; k < preview; ++k) {
+        std::cout << "   " << plan.sourcePath(plan.moves[k]) << "\n      → "
+                  << plan.destinationPath(plan.moves[k]) << "\n";
+    }
+    if (plan.moves.size() > preview) {
+        std::cout << "   ... and " << (plan.moves.size() - preview) << " more\n";
+    }
+    std::cout << "   " << plan.alreadyPlaced << " already in place, "
+              << plan.conflicts << " name conflicts\n\n";
+    
+    if (plan.moves.empty()) {
+        std::cout << "✅ Nothing to move.\n";
+        pauseScreen();
+        return;
+    }
     
     std::string confirm = getUserInput("Proceed with organization? (yes/no): ");
     
@@ -260,18 +423,184 @@ void Menu::handleOrganizeFiles() {
     }
     
     std::cout << "\n🔄 Organizing files...\n\n";
-    int movedCount = fileSorter->organizeByExtension(files, currentDirectory);
+    const OrganizeStats stats = fileSorter->applyPlan(plan);
     
-    std::cout << "\n✅ Organization complete! " << movedCount 
+    std::cout << "\n✅ Organization complete! " << stats.moved 
               << " files moved.\n";
+    if (stats.copied > 0) {
+        std::cout << "   " << stats.copied << " copied to another filesystem ("
+                  << stats.copiedBytes / (1024 * 1024) << " MB, "
+                  << stats.reflinked << " as reflinks).\n";
+    }
+    if (stats.skipped > 0 || stats.failed > 0) {
+        std::cout << "   " << stats.skipped << " skipped (name already taken), "
+                  << stats.failed << " failed - see the log.\n";
+    }
+    std::cout << "   ↩  Option 11 moves everything back.\n";
+    
+    refreshAfterMoves();
+    pauseScreen();
+}
+
+/**
+ * @brief Offers to finish or revert an interrupted organize run
+ * 
+ * Teaching Point: The journal makes both directions cheap - neither
+ * needs a scan, only the files the interrupted run still had to touch.
+ */
+bool Menu::handleInterruptedOrganize() {
+    std::size_t finished = 0, total = 0;
+    const OrganizeJournal::State state = OrganizeJournal::inspect(currentDirectory, &finished, &total);
+    if (state == OrganizeJournal::State::Unreadable) {
+        std::cout << "\n⚠️  " << OrganizeJournal::pathFor(currentDirectory)
+                  << " is damaged - undo/resume are not available.\n";
+        return false;
+    }
+    if (state != OrganizeJournal::State::Incomplete) {
+        return false;
+    }
+    
+    std::cout << "\n⚠️  An organize run here was interrupted (" << finished << " of "
+              << total << " moves recorded).\n";
+    std::string answer = getUserInput("(r)esume it, (u)ndo it, or (c)ancel: ");
+    std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+    OrganizeEngine engine;
+    OrganizeStats stats;
+    if (answer == "r" || answer == "resume") {
+        stats = OrganizeJournal::resume(currentDirectory, engine);
+        std::cout << "\n✅ Resumed: " << stats.moved << " more files moved, "
+                  << stats.failed << " failed.\n";
+    } else if (answer == "u" || answer == "undo") {
+        stats = OrganizeJournal::undo(currentDirectory, engine);
+        std::cout << "\n↩  Rolled back: " << stats.moved << " files moved back, "
+                  << (stats.skipped + stats.failed) << " left in place.\n";
+    } else {
+        std::cout << "\n❌ Cancelled - the journal is kept.\n";
+        pauseScreen();
+        return true;
+    }
+    refreshAfterMoves();
+    pauseScreen();
+    return true;
+}
+
+/**
+ * @brief Handler: Move the files of the last organize run back
+ */
+void Menu::handleUndoOrganize() {
+    if (handleInterruptedOrganize()) {
+        return;
+    }
+    std::size_t total = 0;
+    if (OrganizeJournal::inspect(currentDirectory, nullptr, &total) != OrganizeJournal::State::Complete) {
+        std::cout << "\nℹ️  No organize run to undo in " << currentDirectory << ".\n";
+        pauseScreen();
+        return;
+    }
+    
+    std::string confirm = getUserInput("Move the " + std::to_string(total) +
+                                       " files of the last organize run back? (yes/no): ");
+    std::transform(confirm.begin(), confirm.end(), confirm.begin(), ::tolower);
+    if (confirm != "yes" && confirm != "y") {
+        std::cout << "\n❌ Undo cancelled.\n";
+        pauseScreen();
+        return;
+    }
+    
+    OrganizeEngine engine;
+    const OrganizeStats stats = OrganizeJournal::undo(currentDirectory, engine);
+    std::cout << "\n↩  " << stats.moved << " files moved back.\n";
+    if (stats.skipped > 0 || stats.failed > 0) {
+        std::cout << "   " << stats.skipped << " skipped (original name taken again), "
+                  << stats.failed << " failed - run undo again after fixing them.\n";
+    }
+    refreshAfterMoves();
+    pauseScreen();
+}
+
+/**
+ * @brief Handler: Show counters and latency percentiles, optionally export them
+ * 
+ * Teaching Point: The numbers cover the whole session (every scan, search,
+ * duplicate run and organize so far); the Prometheus file is the same data
+ * for a monitoring system.
+ */
+void Menu::handleShowMetrics() {
+    std::cout << "\n📈 Performance metrics (this session)\n\n";
+    std::cout << Metrics::getInstance().summaryTable();
     
-    // Rescan to update file list after organization
-    std::cout << "\n🔄 Rescanning directory...\n";
-    fileManager->scanDirectory();
+    const std::string path = Metrics::defaultPrometheusPath();
+    std::string answer = getUserInput("\nExport to " + path + " (Prometheus format)? (yes/no): ");
+    std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+    if (answer == "yes" || answer == "y") {
+        if (Metrics::getInstance().writePrometheus(path)) {
+            std::cout << "\n✅ Metrics written to " << path << "\n";
+            Logger::getInstance().log("Metrics exported to " + path);
+        } else {
+            std::cout << "\n❌ Could not write " << path << " (see log)\n";
+        }
+    }
+    pauseScreen();
+}
+
+/**
+ * @brief Handler: Largest directories (including subdirectories) and files
+ * 
+ * Teaching Point: Nothing is read from disk here - the totals were
+ * rolled up when the catalog was scanned and watch mode keeps them
+ * current, so this answers instantly even for millions of files.
+ */
+void Menu::handleDiskUsage() {
+    auto lock = fileManager->lockCatalog();
+    const auto& files = fileManager->getFiles();
+    const DiskUsage& usage = fileManager->getDiskUsage();
+    
+    if (files.directoryCount() == 0 || !usage.covers(files)) {
+        std::cout << "\n⚠️  No files scanned yet. Please scan directory first.\n";
+        pauseScreen();
+        return;
+    }
+    
+    auto megabytes = [](std::uint64_t bytes) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MB";
+        return text.str();
+    };
+    
+    const DirectoryUsage total = usage.total();
+    std::cout << "\n💽 " << megabytes(total.bytes) << " in " << total.files << " files, "
+              << total.directories << " directories\n";
+    
+    constexpr std::size_t kShown = 15;
+    std::cout << "\n📁 Largest directories (with everything below them):\n";
+    std::cout << std::string(60, '-') << "\n";
+    for (const DirectorySize& entry : usage.largestDirectories(kShown)) {
+        std::cout << std::setw(12) << megabytes(entry.usage.bytes) << std::setw(10) << entry.usage.files
+                  << " files  " << files.directoryPath(entry.directory) << "\n";
+    }
     
+    std::cout << "\n📄 Largest files:\n";
+    std::cout << std::string(60, '-') << "\n";
+    for (FileCatalog::Index i : DiskUsage::largestFiles(files, kShown)) {
+        std::cout << std::setw(12) << megabytes(files.fileSize(i)) << "  " << files.path(i) << "\n";
+    }
     pauseScreen();
 }
 
+/**
+ * @brief Brings the file list up to date after files were moved
+ */
+void Menu::refreshAfterMoves() {
+    if (fileManager->isWatching()) {
+        // Teaching Point: Watch mode already sees every move as an event
+        std::cout << "\n👁  Watch mode is on - the file list updates by itself.\n";
+    } else {
+        // Rescan to update file list after organization
+        std::cout << "\n🔄 Rescanning directory...\n";
+        fileManager->scanDirectory();
+    }
+}
+
 /**
  * @brief Handler: Search files by name
  * 
@@ -279,10 +608,11 @@ void Menu::handleOrganizeFiles() {
  * 
  * 1. Get search term from user
  * 2. Validate input (not empty)
- * 3. Perform search
+ * 3. Perform search (ranked fuzzy search if nothing matches exactly)
  * 4. Display results
  */
 void Menu::handleSearchFiles() {
+    auto lock = fileManager->lockCatalog();
     const auto& files = fileManager->getFiles();
     
     if (files.empty()) {
@@ -302,9 +632,70 @@ void Menu::handleSearchFiles() {
     std::cout << "\n🔍 Searching for: " << searchTerm << "\n";
     
     auto results = fileSearcher->searchByName(files, searchTerm);
-    fileSearcher->displaySearchResults(results);
+    if (results.empty()) {
+        /**
+         * Teaching Point: No exact hit usually means a typo - show the
+         * closest names instead of an empty table (best first).
+         */
+        auto ranked = fileSearcher->searchByNameFuzzy(files, searchTerm, 20);
+        if (!ranked.empty()) {
+            std::cout << "\n💡 No exact matches - closest names (fewest typos first):\n";
+            for (const FuzzyMatch& match : ranked) {
+                results.push_back(match.file);
+            }
+        }
+    }
+    if (results.empty()) {
+        fileSearcher->displaySearchResults(files, results);
+        pauseScreen();
+        return;
+    }
+    listing.showRows(files, std::move(results));
+    pageListing("🔍 SEARCH RESULTS for \"" + searchTerm + "\"");
+}
+
+/**
+ * @brief Handler: Query files by several attributes at once
+ * 
+ * Teaching Point: PARSE, THEN RUN
+ * A typo is reported before any file is looked at; the plan shows which
+ * index the engine started from and how many rows it had to examine.
+ */
+void Menu::handleQueryFiles() {
+    auto lock = fileManager->lockCatalog();
+    const auto& files = fileManager->getFiles();
     
-    pauseScreen();
+    if (files.empty()) {
+        std::cout << "\n⚠️  No files scanned yet. Please scan directory first.\n";
+        pauseScreen();
+        return;
+    }
+    
+    std::cout << "\nConditions (all must match):\n";
+    std::cout << "  raw  glob:*.tar.gz  regex:^img_[0-9]+  ext:mkv,mp4\n";
+    std::cout << "  size>1G  size:10M..2G  mtime>=2024-01-01  mtime:2024-01-01..2024-01-31\n";
+    std::string text = getUserInput("\nEnter query: ");
+    
+    FileQuery query;
+    std::string error;
+    if (!FileQuery::parse(text, query, error) || query.empty()) {
+        std::cout << "\n❌ Invalid query: " << (error.empty() ? "no conditions" : error) << "\n";
+        pauseScreen();
+        return;
+    }
+    
+    QueryStats stats;
+    auto results = fileSearcher->query(files, query, &stats);
+    std::cout << "\n🧭 Plan: " << stats.plan << "\n";
+    std::cout << "   " << stats.candidates << " of " << stats.rows << " files were candidates, "
+              << stats.stringChecks << " name checks\n";
+    if (results.empty()) {
+        fileSearcher->displaySearchResults(files, results);
+        pauseScreen();
+        return;
+    }
+    listing.showRows(files, std::move(results));
+    pageListing("🧭 QUERY RESULTS (" + stats.plan + ")");
 }
 
 /**
@@ -317,6 +708,7 @@ void Menu::handleSearchFiles() {
  * - Results found: Display them
  */
 void Menu::handleFindDuplicates() {
+    auto lock = fileManager->lockCatalog();
     const auto& files = fileManager->getFiles();
     
     if (files.empty()) {
@@ -328,7 +720,24 @@ void Menu::handleFindDuplicates() {
     std::cout << "\n🔍 Analyzing " << files.size() << " files for duplicates...\n";
     
     auto duplicates = fileSearcher->findDuplicates(files);
-    fileSearcher->displayDuplicates(duplicates);
+    fileSearcher->displayDuplicates(files, duplicates);
+    
+    /**
+     * Teaching Point: OPT-IN FOR THE EXPENSIVE PASS
+     * Exact duplicates mostly need 8 KB per file; near-duplicates need
+     * every byte of every large file (once - the chunk index remembers).
+     * So the user decides, after seeing what the cheap pass found.
+     */
+    const NearDuplicateOptions nearOptions;
+    std::string answer = getUserInput("🧩 Also look for near-duplicates (edited copies, files of " +
+                                      std::to_string(nearOptions.minSize / (1024 * 1024)) +
+                                      " MB or more)? (yes/no): ");
+    std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+    if (answer == "yes" || answer == "y") {
+        std::cout << "\n🔬 Chunking large files...\n";
+        auto nearDuplicates = fileSearcher->findNearDuplicates(files, nearOptions);
+        fileSearcher->displayNearDuplicates(files, nearDuplicates);
+    }
     
     pauseScreen();
 }
@@ -336,16 +745,18 @@ void Menu::handleFindDuplicates() {
 /**
  * @brief Handler: Display all scanned files
  * 
- * Teaching Point: PAGINATION CONCEPT
+ * Teaching Point: PAGINATION
  * 
- * For production code with many files, implement pagination:
- * - Show 20 files per page
- * - "Press any key for next page"
- * - Prevents overwhelming the user
- * 
- * Here we show all (educational simplicity)
+ * Printing every row of a million-file catalog keeps the terminal busy
+ * for minutes and cannot be interrupted. The listing formats one page
+ * at a time instead:
+ * - 20 files per page, Enter for the next one, "g N" jumps to page N
+ * - n / s / e sort by name, size or extension, r reverses the order
+ * - The sort orders are index permutations built once per catalog
+ *   revision - jumping pages or switching keys copies no file data
  */
 void Menu::handleDisplayFiles() {
+    auto lock = fileManager->lockCatalog();
     const auto& files = fileManager->getFiles();
     
     if (files.empty()) {
@@ -354,29 +765,76 @@ void Menu::handleDisplayFiles() {
         return;
     }
     
-    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
-    std::cout << "║         ALL FILES (" << files.size() << " total)";
-    int padding = 59 - std::to_string(files.size()).length() - 17;
-    std::cout << std::string(padding, ' ') << "║\n";
-    std::cout << "╚════════════════════════════════════════════════════════════╝\n\n";
-    
-    std::cout << std::left
-              << std::setw(40) << "Filename"
-              << std::setw(15) << "Size"
-              << std::setw(10) << "Extension" << "\n";
-    std::cout << std::string(65, '-') << "\n";
+    listing.showAll(files);
+    pageListing("📄 ALL FILES");
+}
+
+/**
+ * @brief Shows `listing` page by page and handles the paging commands
+ * 
+ * ALGORITHM (one iteration per screen):
+ * 1. Format the header and the rows of the current page into one string
+ * 2. Clear the screen and write the string in one call
+ * 3. Read a command: next/previous/go to page, sort key, reverse, quit
+ * 
+ * Enter on the last page (or end of input) leaves the listing.
+ */
+void Menu::pageListing(const std::string& title) {
+    std::size_t page = 0;
+    std::string screen;
     
-    for (const auto& file : files) {
-        std::string sizeStr = std::to_string(file.size) + " B";
+    while (true) {
+        const std::size_t pages = listing.pageCount();
+        page = std::min(page, pages - 1);
+        
+        screen.clear();
+        screen += "\n" + title + " - " + std::to_string(listing.size()) + " files, by ";
+        screen += FileListing::sortName(listing.sortKey());
+        screen += listing.isDescending() ? " (descending)" : "";
+        screen += " - page " + std::to_string(page + 1) + " of " + std::to_string(pages) + "\n\n";
+        listing.renderPage(screen, page);
+        screen += "\n[Enter] next  [p] previous  [g N] page N  "
+                  "sort: [n]ame [s]ize [e]xtension [o]riginal  [r]everse  [q]uit\n";
+        
+        clearScreen();
+        std::cout.write(screen.data(), static_cast<std::streamsize>(screen.size()));
+        
+        std::string command = getUserInput("> ");
+        if (!std::cin) {
+            std::cin.clear();
+            return;
+        }
+        std::transform(command.begin(), command.end(), command.begin(), ::tolower);
         
-        std::cout << std::left
-                  << std::setw(40) << file.name
-                  << std::setw(15) << sizeStr
-                  << std::setw(10) << file.extension << "\n";
+        if (command.empty()) {
+            if (page + 1 >= pages) {
+                return;
+            }
+            ++page;
+        } else if (command == "q") {
+            return;
+        } else if (command == "p") {
+            page = page > 0 ? page - 1 : 0;
+        } else if (command[0] == 'g' || std::isdigit(static_cast<unsigned char>(command[0]))) {
+            // "g 120", "g120" or just "120" (1-based)
+            const std::size_t digits = command.find_first_of("0123456789");
+            if (digits != std::string::npos) {
+                const unsigned long long wanted = std::strtoull(command.c_str() + digits, nullptr, 10);
+                page = wanted > 0 ? static_cast<std::size_t>(std::min<unsigned long long>(wanted, pages)) - 1 : 0;
+            }
+        } else if (command == "r") {
+            listing.sortBy(listing.sortKey(), !listing.isDescending());
+            page = 0;
+        } else if (command == "n" || command == "s" || command == "e" || command == "o") {
+            const ListingSort key = command == "n" ? ListingSort::Name
+                                  : command == "s" ? ListingSort::Size
+                                  : command == "e" ? ListingSort::Extension
+                                  : ListingSort::Original;
+            // Sizes are most useful largest first
+            listing.sortBy(key, key == ListingSort::Size);
+            page = 0;
+        }
     }
-    
-    std::cout << "\n";
-    pauseScreen();
 }
 
 /**
@@ -390,8 +848,47 @@ void Menu::handleDisplayFiles() {
  * 3. Update state (currentDirectory)
  * 4. Update dependencies (fileManager)
  * 5. Clear old data (rescan needed)
+ * 
+ * Adding or dropping a ROOT keeps the catalog: only the added directory
+ * is scanned, only the dropped one's files are removed.
  */
 void Menu::handleChangeDirectory() {
+    const std::vector<std::string>& roots = fileManager->getRoots();
+    std::cout << "\n📂 Roots of this catalog:\n";
+    for (std::size_t r = 0; r < roots.size(); ++r) {
+        std::cout << "   " << (r + 1) << ". " << roots[r] << (r == 0 ? "  (primary)" : "") << "\n";
+    }
+    std::cout << "\n  c) Change directory (new catalog)\n"
+              << "  a) Add a root (scans only the new root)\n"
+              << "  d) Drop a root\n";
+    std::string action = getUserInput("Choice (c/a/d): ");
+    std::transform(action.begin(), action.end(), action.begin(), ::tolower);
+    
+    if (action == "a" || action == "d") {
+        std::string path = getUserInput(action == "a" ? "Directory to add: " : "Root to drop: ");
+        std::string error;
+        const auto start = std::chrono::steady_clock::now();
+        const bool done = action == "a" ? fileManager->addRoot(path, &error) : fileManager->removeRoot(path, &error);
+        if (done) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            auto lock = fileManager->lockCatalog();
+            std::cout << "\n✅ " << (action == "a" ? "Root added" : "Root dropped") << " in "
+                      << ms << " ms - " << fileManager->getFiles().size()
+                      << " files in " << fileManager->getRoots().size() << " root(s).\n";
+        } else {
+            std::cout << "\n❌ " << error << "\n";
+        }
+        currentDirectory = fileManager->getDirectory();
+        pauseScreen();
+        return;
+    }
+    if (action != "c") {
+        std::cout << "\n❌ Invalid choice.\n";
+        pauseScreen();
+        return;
+    }
+    
     std::string newDir = getUserInput("\nEnter new directory path: ");
     
     if (newDir.empty()) {
@@ -416,6 +913,7 @@ void Menu::handleChangeDirectory() {
         }
         
         // Validation passed, update state
+        testManager->setScanOptions(fileManager->getScanOptions());
         currentDirectory = newDir;
         fileManager = testManager;  // Replace with validated manager
         
@@ -528,12 +1026,14 @@ void Menu::pauseScreen() const {
  * 
  * Teaching Point: PLATFORM-SPECIFIC CODE
  * 
- * Screen clearing is platform-dependent:
- * - Windows: system("cls")
- * - Unix/Linux: system("clear")
+ * system("clear") starts a shell, which starts /usr/bin/clear - two
+ * processes every time the menu is drawn. The ANSI escape sequence does
+ * the same with one write:
+ *   \033[2J  erase the whole screen
+ *   \033[H   move the cursor to the top-left corner
  * 
- * Better approach: ANSI escape codes (more portable)
- * std::cout << "\033[2J\033[1;1H";
+ * Every Unix terminal understands it; the classic Windows console does
+ * not, so Windows keeps system("cls").
  * 
  * For production: Use library like ncurses
  */
@@ -541,7 +1041,7 @@ void Menu::clearScreen() const {
     #ifdef _WIN32
         system("cls");
     #else
-        system("clear");
+        std::cout << "\033[2J\033[H" << std::flush;
     #endif
 }
 
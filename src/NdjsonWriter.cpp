@@ -0,0 +1,251 @@
+#include "../include/NdjsonWriter.h"
+#include <cerrno>
+#include <cmath>
+
+/**
+ * =============================================================================
+ * NDJSONWRITER IMPLEMENTATION
+ * =============================================================================
+ */
+
+namespace {
+
+    constexpr char kHex[] = "0123456789abcdef";
+
+    /**
+     * @brief Length of the valid UTF-8 sequence starting at text[i], or 0
+     *
+     * Teaching Point: Besides the bit patterns, UTF-8 forbids overlong forms
+     * (0xC0 0x80 for NUL), UTF-16 surrogates (ED A0..BF) and values above
+     * U+10FFFF (F4 90.. and F5..FF) - the second byte's allowed range
+     * depends on the first byte.
+     */
+    std::size_t utf8SequenceLength(std::string_view text, std::size_t i) {
+        const auto byte = [&](std::size_t k) { return static_cast<unsigned char>(text[k]); };
+        const unsigned char lead = byte(i);
+        std::size_t length = 0;
+        unsigned char low = 0x80, high = 0xBF;      // Allowed range of the second byte
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0) low = 0xA0;
+            if (lead == 0xED) high = 0x9F;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0) low = 0x90;
+            if (lead == 0xF4) high = 0x8F;
+        } else {
+            return 0;
+        }
+        if (i + length > text.size() || byte(i + 1) < low || byte(i + 1) > high) {
+            return 0;
+        }
+        for (std::size_t k = 2; k < length; ++k) {
+            if ((byte(i + k) & 0xC0) != 0x80) {
+                return 0;
+            }
+        }
+        return length;
+    }
+
+}  // namespace
+
+NdjsonWriter::NdjsonWriter(std::FILE* out, std::size_t flushThreshold)
+    : stream(out), flushBytes(flushThreshold) {
+    buffer.reserve(flushBytes + 4096);
+}
+
+NdjsonWriter::~NdjsonWriter() {
+    flush();
+}
+
+NdjsonWriter& NdjsonWriter::begin() {
+    buffer.push_back('{');
+    needComma = false;
+    return *this;
+}
+
+void NdjsonWriter::end() {
+    buffer.append("}\n", 2);
+    needComma = false;
+    recordCount += 1;
+    if (buffer.size() >= flushBytes) {
+        flush();
+    }
+}
+
+void NdjsonWriter::appendKey(std::string_view key) {
+    if (needComma) {
+        buffer.push_back(',');
+    }
+    needComma = true;
+    appendString(key);
+    buffer.push_back(':');
+}
+
+/**
+ * @brief Appends a quoted, escaped JSON string
+ *
+ * ALGORITHM:
+ * 1. Copy the longest run of bytes that need no attention in one append
+ *    (printable ASCII other than '"' and '\\' - nearly every file name)
+ * 2. Escape '"', '\\' and control characters; copy valid UTF-8 sequences;
+ *    replace any other byte with U+FFFD
+ */
+void NdjsonWriter::appendString(std::string_view text) {
+    buffer.push_back('"');
+    std::size_t i = 0;
+    while (i < text.size()) {
+        std::size_t run = i;
+        while (run < text.size()) {
+            const unsigned char c = static_cast<unsigned char>(text[run]);
+            if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') {
+                break;
+            }
+            ++run;
+        }
+        buffer.append(text.data() + i, run - i);
+        i = run;
+        if (i == text.size()) {
+            break;
+        }
+
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x80) {
+            const std::size_t length = utf8SequenceLength(text, i);
+            if (length == 0) {
+                buffer.append("\\ufffd", 6);
+                i += 1;
+            } else {
+                buffer.append(text.data() + i, length);
+                i += length;
+            }
+            continue;
+        }
+        switch (c) {
+            case '"':  buffer.append("\\\"", 2); break;
+            case '\\': buffer.append("\\\\", 2); break;
+            case '\n': buffer.append("\\n", 2); break;
+            case '\r': buffer.append("\\r", 2); break;
+            case '\t': buffer.append("\\t", 2); break;
+            default: {
+                const char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                buffer.append(escaped, sizeof(escaped));
+            }
+        }
+        i += 1;
+    }
+    buffer.push_back('"');
+}
+
+NdjsonWriter& NdjsonWriter::field(std::string_view key, std::string_view value) {
+    appendKey(key);
+    appendString(value);
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::field(std::string_view key, bool value) {
+    appendKey(key);
+    buffer.append(value ? "true" : "false");
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::field(std::string_view key, double value) {
+    appendKey(key);
+    if (!std::isfinite(value)) {
+        buffer.append("null", 4);
+        return *this;
+    }
+    char digits[32];
+    const int length = std::snprintf(digits, sizeof(digits), "%.9g", value);
+    buffer.append(digits, static_cast<std::size_t>(length));
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::beginArray(std::string_view key) {
+    appendKey(key);
+    buffer.push_back('[');
+    needComma = false;
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::element(std::string_view value) {
+    if (needComma) {
+        buffer.push_back(',');
+    }
+    needComma = true;
+    appendString(value);
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::endArray() {
+    buffer.push_back(']');
+    needComma = true;
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::beginObject(std::string_view key) {
+    appendKey(key);
+    buffer.push_back('{');
+    needComma = false;
+    return *this;
+}
+
+NdjsonWriter& NdjsonWriter::endObject() {
+    buffer.push_back('}');
+    needComma = true;
+    return *this;
+}
+
+/**
+ * @brief Hands the buffer to the stream in one fwrite
+ *
+ * Teaching Point: After the first failure nothing more is written - a
+ * reader that went away will not come back, and retrying every record
+ * would only repeat the same error a million times.
+ */
+bool NdjsonWriter::flush() {
+    if (writeFailed) {
+        buffer.clear();
+        return false;
+    }
+    if (!buffer.empty()) {
+        errno = 0;
+        const std::size_t written = std::fwrite(buffer.data(), 1, buffer.size(), stream);
+        if (written != buffer.size()) {
+            writeFailed = true;
+            writeErrno = errno;
+        }
+        buffer.clear();
+    }
+    if (!writeFailed && std::fflush(stream) != 0) {
+        writeFailed = true;
+        writeErrno = errno;
+    }
+    return !writeFailed;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM NDJSONWRITER
+ * =============================================================================
+ *
+ * 1. NDJSON: one complete JSON object per line - consumers (jq, log
+ *    shippers, `while read`) can process a stream without ever holding
+ *    the whole document.
+ *
+ * 2. BUFFER, THEN WRITE: appending to a std::string is cheap; system calls
+ *    are not. One fwrite per megabyte keeps output off the profile.
+ *
+ * 3. COPY RUNS, ESCAPE RARELY: the scan for "needs escaping" is a tight
+ *    loop over plain ASCII, and the common case is a single append.
+ *
+ * 4. VALID OUTPUT FOR ANY INPUT: file names are bytes, JSON is UTF-8 -
+ *    invalid sequences are replaced rather than passed through.
+ *
+ * 5. FAIL ONCE: the first write error (EPIPE when the reader exits) is
+ *    remembered so the producer can stop early.
+ *
+ * =============================================================================
+ */
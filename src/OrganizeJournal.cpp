@@ -0,0 +1,598 @@
+#include "../include/OrganizeJournal.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+/**
+ * =============================================================================
+ * ORGANIZEJOURNAL IMPLEMENTATION - WRITE-AHEAD LOG FOR FILE MOVES
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Write-ahead logging: record the intent durably, then act
+ * 2. Idempotent recovery: decide "done or not" from the file system itself
+ * 3. Atomic file replacement (write temp, fsync, rename)
+ */
+
+namespace {
+
+    const char* const kHeader = "SFMJ 1";
+    const char* const kJournalName = ".sfm_journal";
+
+    std::string escapeField(const std::string& text) {
+        std::string out;
+        out.reserve(text.size());
+        for (char c : text) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                default: out += c;
+            }
+        }
+        return out;
+    }
+
+    std::string unescapeField(const std::string& text) {
+        std::string out;
+        out.reserve(text.size());
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\\' && i + 1 < text.size()) {
+                const char next = text[++i];
+                out += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+            } else {
+                out += text[i];
+            }
+        }
+        return out;
+    }
+
+    std::vector<std::string> splitFields(const std::string& line) {
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+        for (std::size_t tab = line.find('\t'); tab != std::string::npos; tab = line.find('\t', start)) {
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+        fields.push_back(line.substr(start));
+        return fields;
+    }
+
+    bool parseNumber(const std::string& text, std::uint64_t& value) {
+        if (text.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtoull(text.c_str(), &end, 10);
+        return *end == '\0';
+    }
+
+    /**
+     * @brief Flushes a stdio stream all the way to the disk
+     *
+     * Teaching Point: fflush() only hands the data to the kernel; fsync()
+     * waits until the kernel has written it to the device.
+     */
+    bool syncFile(std::FILE* file) {
+        if (std::fflush(file) != 0) {
+            return false;
+        }
+#ifdef __linux__
+        return ::fsync(::fileno(file)) == 0;
+#else
+        return true;
+#endif
+    }
+
+    void syncDirectory(const std::string& path) {
+#ifdef __linux__
+        const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    std::uint64_t deviceOf(const std::string& directory) {
+#ifdef __linux__
+        struct stat info;
+        if (::stat(directory.c_str(), &info) == 0) {
+            return static_cast<std::uint64_t>(info.st_dev);
+        }
+#else
+        (void)directory;
+#endif
+        return 0;
+    }
+
+    bool pathExists(const std::string& path) {
+        std::error_code error;
+        return fs::exists(fs::symlink_status(path, error));
+    }
+
+    /**
+     * @brief Absolute, normalised form of a path (as typed if that fails)
+     *
+     * Teaching Point: The journal outlives the working directory it was
+     * written from - "tree/docs" means nothing to an undo started in /tmp.
+     */
+    std::string absolutePath(const std::string& path) {
+        std::error_code error;
+        const fs::path absolute = fs::weakly_canonical(fs::absolute(path, error), error);
+        return error ? path : absolute.string();
+    }
+
+    /**
+     * @brief Removes partial copies a crashed cross-device move left in
+     *        any directory the plan writes to (folders, and sources on undo)
+     */
+    void removeStalePartials(const OrganizePlan& plan) {
+        for (const std::string& folder : plan.folders) {
+            FileCopier::removeStaleTemporaries(folder);
+        }
+        for (const std::string& directory : plan.sourceDirectories) {
+            FileCopier::removeStaleTemporaries(directory);
+        }
+    }
+}
+
+std::string OrganizeJournal::pathFor(const std::string& baseDirectory) {
+    return baseDirectory + "/" + kJournalName;
+}
+
+OrganizeJournal::~OrganizeJournal() {
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+/**
+ * @brief Appends one D line for a finished engine batch
+ *
+ * No fsync here: losing a D line costs one lstat during recovery, while
+ * syncing every batch would cost a disk flush per 256 moves.
+ */
+void OrganizeJournal::recordDone(const std::vector<std::uint32_t>& planIds) {
+    if (planIds.empty()) {
+        return;
+    }
+    std::string line = "D";
+    for (std::uint32_t id : planIds) {
+        line += '\t';
+        line += std::to_string(id);
+    }
+    line += '\n';
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::fwrite(line.data(), 1, line.size(), file);
+    std::fflush(file);   // One write() per batch - a crash tears at most the last line
+}
+
+bool OrganizeJournal::commit() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return std::fputs("C\n", file) >= 0 && syncFile(file);
+}
+
+bool OrganizeJournal::load(const std::string& path, OrganizePlan& plan, std::vector<bool>& done,
+                           bool& complete) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    const std::string content = buffer.str();
+
+    plan = OrganizePlan();
+    done.clear();
+    complete = false;
+    bool header = false;
+    bool planned = false;
+    std::size_t start = 0;
+    for (std::size_t end = content.find('\n'); end != std::string::npos; end = content.find('\n', start)) {
+        const std::string line = content.substr(start, end - start);
+        start = end + 1;
+        if (!header) {
+            if (line != kHeader) {
+                return false;
+            }
+            header = true;
+            continue;
+        }
+        const std::vector<std::string> fields = splitFields(line);
+        const std::string& kind = fields[0];
+        if (kind == "B" && fields.size() == 2) {
+            plan.baseDirectory = unescapeField(fields[1]);
+        } else if (kind == "S" && fields.size() == 2) {
+            plan.sourceDirectories.push_back(unescapeField(fields[1]));
+        } else if (kind == "F" && fields.size() == 2) {
+            plan.folders.push_back(unescapeField(fields[1]));
+        } else if (kind == "M" && fields.size() == 6) {
+            std::uint64_t size = 0, source = 0, folder = 0;
+            if (!parseNumber(fields[1], size) || !parseNumber(fields[2], source) ||
+                !parseNumber(fields[3], folder) || source >= plan.sourceDirectories.size() ||
+                folder >= plan.folders.size()) {
+                return false;
+            }
+            plan.moves.push_back(PlannedMove{static_cast<std::uint32_t>(source),
+                                             static_cast<std::uint16_t>(folder), size,
+                                             unescapeField(fields[4]), unescapeField(fields[5])});
+        } else if (kind == "P") {
+            planned = true;
+            done.assign(plan.moves.size(), false);
+        } else if (kind == "D" && planned) {
+            for (std::size_t f = 1; f < fields.size(); ++f) {
+                std::uint64_t id = 0;
+                if (parseNumber(fields[f], id) && id < done.size()) {
+                    done[id] = true;
+                }
+            }
+        } else if (kind == "C" && planned) {
+            complete = true;
+        } else {
+            return false;
+        }
+    }
+    return planned;   // No P: the plan itself was never finished - unusable
+}
+
+OrganizeJournal::State OrganizeJournal::inspect(const std::string& baseDirectory,
+                                                std::size_t* finished, std::size_t* total) {
+    const std::string path = pathFor(baseDirectory);
+    if (!pathExists(path)) {
+        return State::None;
+    }
+    OrganizePlan plan;
+    std::vector<bool> done;
+    bool complete = false;
+    if (!load(path, plan, done, complete)) {
+        return State::Unreadable;
+    }
+    if (finished != nullptr) {
+        *finished = static_cast<std::size_t>(std::count(done.begin(), done.end(), true));
+    }
+    if (total != nullptr) {
+        *total = plan.moves.size();
+    }
+    return complete ? State::Complete : State::Incomplete;
+}
+
+/**
+ * @brief Hands a subset of the plan to the engine
+ *
+ * ALGORITHM:
+ * 1. Build a small FileCatalog from the plan - one directory entry per
+ *    source directory (one stat() for its device), one row per move.
+ *    No scan: everything else is already in the journal.
+ * 2. Forward: rows live in the source directories, engine folders are
+ *    the plan's folders. Reverse: rows live in the plan's folders, and
+ *    the engine folders are the original directories.
+ * 3. The engine's batchDone hook translates rows back to plan ids for
+ *    the D records.
+ *
+ * Engine folder ids are 16-bit, so a reverse run over more than 65535
+ * original directories is split into several engine runs.
+ */
+OrganizeStats OrganizeJournal::execute(const OrganizePlan& plan, const std::vector<std::uint32_t>& ids,
+                                       bool reverse, const OrganizeEngine& engine,
+                                       OrganizeJournal* journal) {
+    OrganizeStats total;
+    std::size_t next = 0;
+    while (next < ids.size()) {
+        FileCatalog files;
+        std::vector<std::string> folders;
+        std::vector<OrganizeMove> moves;
+        std::vector<std::string> newNames;
+        std::vector<std::uint32_t> planIdOfRow;
+        std::unordered_map<std::uint32_t, FileCatalog::DirectoryId> catalogDirectory;
+        std::unordered_map<std::uint32_t, std::uint16_t> engineFolder;
+
+        if (!reverse) {
+            folders = plan.folders;
+        }
+        for (; next < ids.size(); ++next) {
+            const PlannedMove& move = plan.moves[ids[next]];
+            const std::uint32_t from = reverse ? move.folder : move.sourceDirectory;
+            const std::uint32_t to = reverse ? move.sourceDirectory : move.folder;
+            std::uint16_t folder = static_cast<std::uint16_t>(to);
+            if (reverse) {
+                auto found = engineFolder.find(to);
+                if (found == engineFolder.end()) {
+                    if (folders.size() == 0xFFFF) {
+                        break;   // Engine folder ids exhausted: run what we have
+                    }
+                    found = engineFolder.emplace(to, static_cast<std::uint16_t>(folders.size())).first;
+                    folders.push_back(plan.sourceDirectories[to]);
+                }
+                folder = found->second;
+            }
+            auto directory = catalogDirectory.find(from);
+            if (directory == catalogDirectory.end()) {
+                const std::string& path = reverse ? plan.folders[from] : plan.sourceDirectories[from];
+                directory = catalogDirectory.emplace(from, files.addDirectory(path, 0, 0, deviceOf(path))).first;
+            }
+            const FileCatalog::Index row = files.add(directory->second,
+                                                     reverse ? move.targetName() : move.name,
+                                                     "", move.size);
+            moves.push_back(OrganizeMove{row, folder});
+            newNames.push_back(reverse ? (move.newName.empty() ? std::string() : move.name) : move.newName);
+            planIdOfRow.push_back(ids[next]);
+        }
+
+        OrganizeHooks hooks;
+        hooks.newNames = &newNames;
+        if (journal != nullptr) {
+            hooks.batchDone = [journal, &planIdOfRow](const std::vector<FileCatalog::Index>& rows) {
+                std::vector<std::uint32_t> planIds;
+                planIds.reserve(rows.size());
+                for (FileCatalog::Index row : rows) {
+                    planIds.push_back(planIdOfRow[row]);
+                }
+                journal->recordDone(planIds);
+            };
+        }
+        OrganizeStats stats = engine.run(files, folders, std::move(moves), hooks);
+        total += stats;
+        total.devices = std::max(total.devices, stats.devices);
+        total.tasks += stats.tasks;
+        total.milliseconds += stats.milliseconds;
+    }
+    return total;
+}
+
+/**
+ * @brief Write-ahead: the whole plan is on disk before the first move
+ *
+ * ALGORITHM:
+ * 1. Write header, directories, folders and moves to "<journal>.tmp",
+ *    end with P, fsync. Directories are stored ABSOLUTE, so resume and
+ *    undo work from any working directory
+ * 2. rename() over the journal, fsync the base directory
+ *    (a crash leaves either the old journal or the complete new one)
+ * 3. Run all moves; workers append D lines
+ * 4. Append C and fsync
+ */
+OrganizeStats OrganizeJournal::apply(const OrganizePlan& typedPlan, const OrganizeEngine& engine) {
+    OrganizePlan plan = typedPlan;
+    plan.baseDirectory = absolutePath(plan.baseDirectory);
+    for (std::string& directory : plan.sourceDirectories) {
+        directory = absolutePath(directory);
+    }
+    for (std::string& folder : plan.folders) {
+        folder = absolutePath(folder);
+    }
+    const std::string path = pathFor(plan.baseDirectory);
+    if (inspect(plan.baseDirectory) == State::Incomplete) {
+        Logger::getInstance().log("ERROR: unfinished organize run in " + plan.baseDirectory +
+                                  " - resume or undo it first");
+        return OrganizeStats();
+    }
+
+    const std::string temporary = path + ".tmp";
+    std::FILE* out = std::fopen(temporary.c_str(), "wb");
+    if (out == nullptr) {
+        Logger::getInstance().log("ERROR: cannot write journal " + temporary + " - nothing moved");
+        return OrganizeStats();
+    }
+    std::string text = std::string(kHeader) + "\nB\t" + escapeField(plan.baseDirectory) + "\n";
+    for (const std::string& directory : plan.sourceDirectories) {
+        text.append("S\t").append(escapeField(directory)).append("\n");
+    }
+    for (const std::string& folder : plan.folders) {
+        text.append("F\t").append(escapeField(folder)).append("\n");
+    }
+    for (const PlannedMove& move : plan.moves) {
+        text.append("M\t").append(std::to_string(move.size)).append("\t")
+            .append(std::to_string(move.sourceDirectory)).append("\t")
+            .append(std::to_string(move.folder)).append("\t")
+            .append(escapeField(move.name)).append("\t").append(escapeField(move.newName)).append("\n");
+    }
+    text += "P\n";
+    const bool written = std::fwrite(text.data(), 1, text.size(), out) == text.size() && syncFile(out);
+    std::fclose(out);
+    std::error_code error;
+    if (written) {
+        fs::rename(temporary, path, error);
+    }
+    if (!written || error) {
+        fs::remove(temporary, error);
+        Logger::getInstance().log("ERROR: cannot write journal " + path + " - nothing moved");
+        return OrganizeStats();
+    }
+    syncDirectory(plan.baseDirectory);
+
+    std::FILE* append = std::fopen(path.c_str(), "ab");
+    if (append == nullptr) {
+        Logger::getInstance().log("ERROR: cannot append to journal " + path + " - nothing moved");
+        return OrganizeStats();
+    }
+    OrganizeJournal journal(append);
+    std::vector<std::uint32_t> ids(plan.moves.size());
+    for (std::uint32_t k = 0; k < ids.size(); ++k) {
+        ids[k] = k;
+    }
+    OrganizeStats stats = execute(plan, ids, false, engine, &journal);
+    journal.commit();
+    Logger::getInstance().log("Journal " + path + ": " + std::to_string(plan.moves.size()) +
+                              " planned, " + std::to_string(stats.moved) + " moved");
+    return stats;
+}
+
+/**
+ * @brief Roll an interrupted run forward
+ *
+ * Per move without a D record:
+ *   source present                 → still to do
+ *   source gone, destination there → done (the D line was lost)
+ *   both gone                      → changed by someone else, reported
+ *
+ * If NO open move is found anywhere, the journal does not describe this
+ * tree (moved, or an old journal with relative paths): it is left
+ * incomplete and every open move is reported as failed.
+ *
+ * A cross-device move cut short leaves a ".sfm-*.partial" copy in its
+ * folder (the source is still intact); those are removed first.
+ */
+OrganizeStats OrganizeJournal::resume(const std::string& baseDirectory, const OrganizeEngine& engine) {
+    const std::string path = pathFor(baseDirectory);
+    OrganizePlan plan;
+    std::vector<bool> done;
+    bool complete = false;
+    if (!load(path, plan, done, complete)) {
+        Logger::getInstance().log("ERROR: no usable journal in " + baseDirectory);
+        return OrganizeStats();
+    }
+    if (complete) {
+        return OrganizeStats();
+    }
+
+    std::vector<std::uint32_t> pending, recovered;
+    std::size_t missing = 0;
+    for (std::uint32_t k = 0; k < plan.moves.size(); ++k) {
+        if (done[k]) {
+            continue;
+        }
+        if (pathExists(plan.sourcePath(plan.moves[k]))) {
+            pending.push_back(k);
+        } else if (pathExists(plan.destinationPath(plan.moves[k]))) {
+            recovered.push_back(k);
+        } else {
+            ++missing;
+            SFM_LOG_SAMPLED(Warn, 20, "{} disappeared during the interrupted run",
+                            plan.sourcePath(plan.moves[k]));
+        }
+    }
+    if (missing > 0 && pending.empty() && recovered.empty()) {
+        Logger::getInstance().log("ERROR: journal in " + baseDirectory + " matches no file on disk - " +
+                                  "nothing resumed, journal kept");
+        OrganizeStats stats;
+        stats.failed = missing;
+        return stats;
+    }
+    removeStalePartials(plan);
+    for (const std::string& folder : plan.folders) {
+        std::error_code error;
+        fs::create_directories(folder, error);   // Engine reports folders that still fail
+    }
+
+    std::FILE* append = std::fopen(path.c_str(), "ab");
+    if (append == nullptr) {
+        Logger::getInstance().log("ERROR: cannot append to journal " + path);
+        return OrganizeStats();
+    }
+    OrganizeJournal journal(append);
+    journal.recordDone(recovered);
+    OrganizeStats stats = execute(plan, pending, false, engine, &journal);
+    stats.failed += missing;
+    journal.commit();
+    Logger::getInstance().log("Resumed organize in " + baseDirectory + ": " +
+                              std::to_string(recovered.size()) + " found done, " +
+                              std::to_string(stats.moved) + " moved now");
+    return stats;
+}
+
+/**
+ * @brief Reverse every move that happened
+ *
+ * A move is reverted when its destination exists and either it is
+ * recorded as done or its source is gone (done, D line lost). Files
+ * already moved back by an earlier, interrupted undo have no
+ * destination any more and are left alone - undo is idempotent.
+ *
+ * The journal is only deleted once every move that happened is VERIFIED
+ * back at its source: it is the only record of where the files came
+ * from. A plan of which no file is found at either end (the tree moved,
+ * or an old journal with relative paths read from another directory)
+ * is a failure, not an empty success.
+ */
+OrganizeStats OrganizeJournal::undo(const std::string& baseDirectory, const OrganizeEngine& engine) {
+    const std::string path = pathFor(baseDirectory);
+    OrganizePlan plan;
+    std::vector<bool> done;
+    bool complete = false;
+    if (!load(path, plan, done, complete)) {
+        Logger::getInstance().log("ERROR: no usable journal in " + baseDirectory);
+        return OrganizeStats();
+    }
+
+    std::vector<std::uint32_t> revert;
+    std::vector<bool> happened = done;
+    std::size_t unmatched = 0;   // Neither at the source nor at the destination
+    for (std::uint32_t k = 0; k < plan.moves.size(); ++k) {
+        const PlannedMove& move = plan.moves[k];
+        const bool atDestination = pathExists(plan.destinationPath(move));
+        const bool atSource = pathExists(plan.sourcePath(move));
+        if (atDestination && (done[k] || !atSource)) {
+            revert.push_back(k);
+            happened[k] = true;
+        } else if (!atDestination && !atSource) {
+            ++unmatched;
+        }
+    }
+    if (!plan.moves.empty() && unmatched == plan.moves.size()) {
+        Logger::getInstance().log("ERROR: journal in " + baseDirectory + " matches no file on disk - " +
+                                  "nothing undone, journal kept");
+        OrganizeStats stats;
+        stats.failed = unmatched;
+        return stats;
+    }
+    removeStalePartials(plan);
+    OrganizeStats stats = execute(plan, revert, true, engine, nullptr);
+
+    std::size_t notBack = 0;
+    for (std::uint32_t k = 0; k < plan.moves.size(); ++k) {
+        if (happened[k] && !pathExists(plan.sourcePath(plan.moves[k]))) {
+            ++notBack;
+        }
+    }
+    // Skipped and failed moves are not back either - count each file once
+    stats.failed = std::max(stats.failed, notBack > stats.skipped ? notBack - stats.skipped : 0);
+
+    if (notBack == 0 && stats.skipped == 0 && stats.failed == 0) {
+        std::error_code error;
+        for (const std::string& folder : plan.folders) {
+            fs::remove(folder, error);   // Only succeeds if the folder is empty again
+        }
+        fs::remove(path, error);
+        syncDirectory(baseDirectory);
+    } else {
+        Logger::getInstance().log("Undo in " + baseDirectory + " left " +
+                                  std::to_string(stats.skipped + stats.failed) +
+                                  " files in place - journal kept for another try");
+    }
+    Logger::getInstance().log("Undo organize in " + baseDirectory + ": " +
+                              std::to_string(stats.moved) + " moved back");
+    return stats;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM ORGANIZEJOURNAL IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. WRITE THE INTENT BEFORE THE ACTION:
+ *    - With the plan durable, every crash state is explainable
+ *
+ * 2. RECOVERY FROM STATE, NOT FROM THE LOG ALONE:
+ *    - "Source gone, destination present" is proof of a finished move,
+ *      so progress records can be cheap and unsynced
+ *
+ * 3. IDEMPOTENT OPERATIONS:
+ *    - resume() and undo() can themselves be interrupted and rerun
+ *    - Both first sweep the half-written copies the crash left behind
+ */
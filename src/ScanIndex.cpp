@@ -0,0 +1,374 @@
+#include "../include/ScanIndex.h"
+#include "../include/Logger.h"
+#include "../include/MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+/**
+ * =============================================================================
+ * SCANINDEX IMPLEMENTATION - COLUMNS STRAIGHT TO DISK AND BACK
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. Binary file formats with a fixed header and aligned sections
+ * 2. Validating untrusted input before using any offset from it
+ * 3. Atomic file replacement (write temp, then rename)
+ */
+
+namespace {
+
+    constexpr char kMagic[8] = {'S', 'F', 'M', 'I', 'D', 'X', '\0', '\0'};
+    constexpr std::uint32_t kEndianMarker = 0x01020304u;
+
+    /**
+     * @brief Fixed-size file header
+     *
+     * Teaching Point: Only fixed-width integer types, largest first, so
+     * the struct has the same layout with every compiler for this ABI.
+     */
+    struct IndexHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t endianMarker;      // Reads back as 0x04030201 on the "wrong" endianness
+
+        std::uint64_t fileCount;
+        std::uint64_t directoryCount;
+        std::uint64_t extensionCount;
+        std::uint64_t arenaBytes;
+
+        std::uint64_t rootOffset;
+        std::uint64_t rootLength;
+        std::uint64_t recordsOffset;
+        std::uint64_t sizesOffset;
+        std::uint64_t hashesOffset;
+        std::uint64_t fileDirectoriesOffset;
+        std::uint64_t mtimesOffset;
+        std::uint64_t inodesOffset;
+        std::uint64_t directoriesOffset;
+        std::uint64_t arenaOffset;
+        std::uint64_t extensionsOffset;
+        std::uint64_t extensionsBytes;
+        std::uint64_t totalBytes;
+
+        std::int32_t maxDepth;
+        std::uint8_t recursive;
+        std::uint8_t symlinks;
+        std::uint8_t reserved[2];
+        char backendName[64];
+    };
+
+    std::uint64_t alignUp(std::uint64_t value) {
+        return (value + 7) & ~static_cast<std::uint64_t>(7);
+    }
+
+    /**
+     * @brief True if [offset, offset+length) lies inside a file of fileSize bytes
+     *
+     * Teaching Point: Written so that no addition can overflow - a damaged
+     * header with huge values must fail the check, not wrap around.
+     */
+    bool inBounds(std::uint64_t offset, std::uint64_t length, std::uint64_t fileSize) {
+        return offset <= fileSize && length <= fileSize - offset;
+    }
+
+    /**
+     * @brief Writes a column and pads the stream to the next 8-byte boundary
+     */
+    void writeBlock(std::ofstream& out, const void* data, std::uint64_t bytes,
+                    std::uint64_t& position) {
+        if (bytes > 0) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        }
+        position += bytes;
+        static const char zeros[8] = {};
+        std::uint64_t padded = alignUp(position);
+        out.write(zeros, static_cast<std::streamsize>(padded - position));
+        position = padded;
+    }
+
+    /**
+     * @brief Copies a raw column out of the mapping
+     */
+    template <typename T>
+    void readColumn(const MappedFile& file, std::uint64_t offset, std::uint64_t count,
+                    std::vector<T>& column) {
+        static_assert(std::is_trivially_copyable<T>::value, "columns must be plain data");
+        column.resize(static_cast<std::size_t>(count));
+        if (count > 0) {
+            std::memcpy(column.data(), file.data() + offset, count * sizeof(T));
+        }
+    }
+}
+
+/**
+ * @brief Picks the cache file for a target directory
+ *
+ * Teaching Point: FNV-1a turns an arbitrary path into a short, stable
+ * filename - no escaping of '/' or ':' needed.
+ */
+std::string ScanIndex::defaultPath(const std::string& targetDirectory) {
+    return defaultPath(std::vector<std::string>{targetDirectory});
+}
+
+std::string ScanIndex::defaultPath(const std::vector<std::string>& roots) {
+    std::string key;
+    for (const std::string& root : roots) {
+        std::error_code ec;
+        fs::path absolute = fs::absolute(root, ec);
+        key += (key.empty() ? "" : "\n") + (ec ? root : absolute.lexically_normal().string());
+    }
+
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char name[40];
+    std::snprintf(name, sizeof(name), "index-%016llx.sfmidx",
+                  static_cast<unsigned long long>(hash));
+    return (fs::path(".sfm_cache") / name).string();
+}
+
+/**
+ * @brief Saves a catalog
+ *
+ * ALGORITHM:
+ * 1. Compute every section offset first (header needs them)
+ * 2. Write header + sections to "<index>.tmp"
+ * 3. rename() over the old index - readers see either old or new, never half
+ */
+bool ScanIndex::save(const std::string& indexPath, const FileCatalog& files,
+                     const ScanIndexInfo& info) {
+    static_assert(std::is_trivially_copyable<FileCatalog::Record>::value, "raw record block");
+    static_assert(std::is_trivially_copyable<FileCatalog::DirectoryRecord>::value, "raw record block");
+
+    std::string extensionBlock;
+    for (std::size_t id = 0; id < files.extensionNames.size(); ++id) {
+        const std::string& ext = files.extensionNames[id];
+        auto length = static_cast<std::uint16_t>(ext.size());
+        extensionBlock.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        extensionBlock.append(ext);
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endianMarker = kEndianMarker;
+    header.fileCount = files.records.size();
+    header.directoryCount = files.directories.size();
+    header.extensionCount = files.extensionNames.size();
+    header.arenaBytes = files.pathArena.size();
+    header.maxDepth = info.options.maxDepth;
+    header.recursive = info.options.recursive ? 1 : 0;
+    header.symlinks = static_cast<std::uint8_t>(info.options.symlinks);
+    std::strncpy(header.backendName, info.backendName.c_str(), sizeof(header.backendName) - 1);
+
+    std::uint64_t position = alignUp(sizeof(IndexHeader));
+    auto place = [&position](std::uint64_t& offset, std::uint64_t bytes) {
+        offset = position;
+        position = alignUp(position + bytes);
+    };
+    header.rootLength = info.rootPath.size();
+    place(header.rootOffset, header.rootLength);
+    place(header.recordsOffset, header.fileCount * sizeof(FileCatalog::Record));
+    place(header.sizesOffset, header.fileCount * sizeof(std::uint64_t));
+    place(header.hashesOffset, header.fileCount * sizeof(std::uint64_t));
+    place(header.fileDirectoriesOffset, header.fileCount * sizeof(FileCatalog::DirectoryId));
+    place(header.mtimesOffset, header.fileCount * sizeof(std::int64_t));
+    place(header.inodesOffset, header.fileCount * sizeof(std::uint64_t));
+    place(header.directoriesOffset, header.directoryCount * sizeof(FileCatalog::DirectoryRecord));
+    place(header.arenaOffset, header.arenaBytes);
+    header.extensionsBytes = extensionBlock.size();
+    place(header.extensionsOffset, header.extensionsBytes);
+    header.totalBytes = position;
+
+    std::error_code ec;
+    fs::path target(indexPath);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+    std::string tempPath = indexPath + ".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            Logger::getInstance().log("ERROR: Cannot write scan index: " + tempPath);
+            return false;
+        }
+        std::uint64_t written = 0;
+        writeBlock(out, &header, sizeof(header), written);
+        writeBlock(out, info.rootPath.data(), header.rootLength, written);
+        writeBlock(out, files.records.data(), header.fileCount * sizeof(FileCatalog::Record), written);
+        writeBlock(out, files.sizes.data(), header.fileCount * sizeof(std::uint64_t), written);
+        writeBlock(out, files.hashes.data(), header.fileCount * sizeof(std::uint64_t), written);
+        writeBlock(out, files.fileDirectories.data(),
+                   header.fileCount * sizeof(FileCatalog::DirectoryId), written);
+        writeBlock(out, files.mtimes.data(), header.fileCount * sizeof(std::int64_t), written);
+        writeBlock(out, files.inodes.data(), header.fileCount * sizeof(std::uint64_t), written);
+        writeBlock(out, files.directories.data(),
+                   header.directoryCount * sizeof(FileCatalog::DirectoryRecord), written);
+        writeBlock(out, files.pathArena.data(), header.arenaBytes, written);
+        writeBlock(out, extensionBlock.data(), header.extensionsBytes, written);
+        if (!out) {
+            Logger::getInstance().log("ERROR: Writing scan index failed: " + tempPath);
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tempPath, indexPath, ec);
+    if (ec) {
+        Logger::getInstance().log("ERROR: Cannot replace scan index: " + ec.message());
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    Logger::getInstance().log("Scan index saved: " + indexPath + " (" +
+                              std::to_string(header.totalBytes) + " bytes)");
+    return true;
+}
+
+/**
+ * @brief Loads a catalog
+ *
+ * ALGORITHM:
+ * 1. mmap the file
+ * 2. Validate header and every section's bounds BEFORE touching data
+ * 3. memcpy each column into the catalog's vectors
+ * 4. Re-intern the (few) extensions so IDs map to the same strings
+ */
+bool ScanIndex::load(const std::string& indexPath, FileCatalog& files, ScanIndexInfo& info) {
+    MappedFile file(indexPath);
+    if (!file.isOpen() || file.size() < sizeof(IndexHeader)) {
+        return false;
+    }
+
+    IndexHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const std::uint64_t fileSize = file.size();
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.endianMarker != kEndianMarker ||
+        header.totalBytes != fileSize ||
+        header.fileCount > 0xFFFFFFFFull || header.directoryCount > 0xFFFFFFFFull ||
+        header.extensionCount == 0 || header.extensionCount > 0x10000ull ||
+        header.symlinks > static_cast<std::uint8_t>(SymlinkPolicy::FollowAll)) {
+        Logger::getInstance().log("Scan index ignored (incompatible or damaged): " + indexPath);
+        return false;
+    }
+
+    // Per-column byte counts cannot overflow: counts are capped at 2^32 above
+    bool sectionsOk =
+        inBounds(header.rootOffset, header.rootLength, fileSize) &&
+        inBounds(header.recordsOffset, header.fileCount * sizeof(FileCatalog::Record), fileSize) &&
+        inBounds(header.sizesOffset, header.fileCount * sizeof(std::uint64_t), fileSize) &&
+        inBounds(header.hashesOffset, header.fileCount * sizeof(std::uint64_t), fileSize) &&
+        inBounds(header.fileDirectoriesOffset,
+                 header.fileCount * sizeof(FileCatalog::DirectoryId), fileSize) &&
+        inBounds(header.mtimesOffset, header.fileCount * sizeof(std::int64_t), fileSize) &&
+        inBounds(header.inodesOffset, header.fileCount * sizeof(std::uint64_t), fileSize) &&
+        inBounds(header.directoriesOffset,
+                 header.directoryCount * sizeof(FileCatalog::DirectoryRecord), fileSize) &&
+        inBounds(header.arenaOffset, header.arenaBytes, fileSize) &&
+        inBounds(header.extensionsOffset, header.extensionsBytes, fileSize);
+    if (!sectionsOk) {
+        Logger::getInstance().log("Scan index ignored (section out of bounds): " + indexPath);
+        return false;
+    }
+
+    FileCatalog loaded;
+    readColumn(file, header.recordsOffset, header.fileCount, loaded.records);
+    readColumn(file, header.sizesOffset, header.fileCount, loaded.sizes);
+    readColumn(file, header.hashesOffset, header.fileCount, loaded.hashes);
+    readColumn(file, header.fileDirectoriesOffset, header.fileCount, loaded.fileDirectories);
+    readColumn(file, header.mtimesOffset, header.fileCount, loaded.mtimes);
+    readColumn(file, header.inodesOffset, header.fileCount, loaded.inodes);
+    readColumn(file, header.directoriesOffset, header.directoryCount, loaded.directories);
+    loaded.pathArena.assign(file.data() + header.arenaOffset,
+                            static_cast<std::size_t>(header.arenaBytes));
+
+    // Extensions: ID 0 is "" in every catalog, the rest are interned in order
+    const char* cursor = file.data() + header.extensionsOffset;
+    const char* end = cursor + header.extensionsBytes;
+    for (std::uint64_t id = 0; id < header.extensionCount; ++id) {
+        std::uint16_t length;
+        if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(length))) {
+            return false;
+        }
+        std::memcpy(&length, cursor, sizeof(length));
+        cursor += sizeof(length);
+        if (end - cursor < length) {
+            return false;
+        }
+        std::string_view ext(cursor, length);
+        cursor += length;
+        if (loaded.internExtension(ext) != id) {
+            return false;   // Duplicate or out-of-order extension table
+        }
+    }
+
+    // Cross-column checks: every reference must point inside its target
+    for (const FileCatalog::Record& record : loaded.records) {
+        if (!inBounds(record.pathOffset, record.pathLength, header.arenaBytes) ||
+            record.nameLength > record.pathLength ||
+            record.extensionId >= header.extensionCount) {
+            return false;
+        }
+    }
+    for (FileCatalog::DirectoryId d : loaded.fileDirectories) {
+        if (d >= header.directoryCount) {
+            return false;
+        }
+    }
+    // A parent must exist and sit strictly higher: depths then fall along
+    // every chain, so a damaged file cannot smuggle in a cycle
+    for (FileCatalog::DirectoryId d = 0; d < loaded.directories.size(); ++d) {
+        const FileCatalog::DirectoryRecord& dir = loaded.directories[d];
+        if (!inBounds(dir.pathOffset, dir.pathLength, header.arenaBytes)) {
+            return false;
+        }
+        if (dir.parent == FileCatalog::kNoDirectory) {
+            continue;
+        }
+        if (dir.parent >= header.directoryCount || dir.depth == 0 ||
+            loaded.directories[dir.parent].depth >= dir.depth) {
+            return false;
+        }
+    }
+
+    loaded.rebuildLowerNames();   // Derived column - recomputed, not stored
+    loaded.rebuildDirectoryTotals();
+
+    info.rootPath.assign(file.data() + header.rootOffset, static_cast<std::size_t>(header.rootLength));
+    header.backendName[sizeof(header.backendName) - 1] = '\0';
+    info.backendName = header.backendName;
+    info.options = ScanOptions();
+    info.options.recursive = header.recursive != 0;
+    info.options.maxDepth = header.maxDepth;
+    info.options.symlinks = static_cast<SymlinkPolicy>(header.symlinks);
+
+    files = std::move(loaded);
+    return true;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM SCANINDEX IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. DESIGN DATA FOR THE DISK:
+ *    - Offsets instead of pointers make in-memory columns valid on disk too
+ *    - Fixed-width types + alignment = no per-record encoding
+ *
+ * 2. NEVER TRUST A FILE:
+ *    - Magic, version and endian marker reject foreign files
+ *    - Every offset is bounds-checked without overflow
+ *    - Every reference (directory, parent, extension, enum) is range-checked
+ *
+ * 3. CRASH SAFETY:
+ *    - Write to a temporary file, then rename() atomically
+ *
+ * 4. FAIL SOFT:
+ *    - A bad index only costs a full rescan, never wrong results
+ */
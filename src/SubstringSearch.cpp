@@ -0,0 +1,215 @@
+#include "../include/SubstringSearch.h"
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SFM_SUBSTRING_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define SFM_SUBSTRING_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * =============================================================================
+ * SUBSTRINGSEARCH IMPLEMENTATION - VECTOR FILTER + SCALAR VERIFY
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. SIMD compares producing bit masks (one bit per byte position)
+ * 2. Iterating set bits with count-trailing-zeros
+ * 3. Per-function target attributes and CPU feature detection
+ */
+
+namespace {
+
+    using Kernel = std::size_t (*)(const char*, std::size_t, const char*, std::size_t);
+
+    /**
+     * @brief memchr for the first byte, memcmp for the rest
+     *
+     * Used on CPUs without a vector kernel and for the tail of the text
+     * that is shorter than one vector block.
+     */
+    std::size_t findScalar(const char* text, std::size_t length,
+                           const char* needle, std::size_t needleLength) {
+        if (needleLength == 0) {
+            return 0;
+        }
+        if (needleLength > length) {
+            return SubstringSearch::npos;
+        }
+        const char* position = text;
+        const char* lastStart = text + (length - needleLength);
+        while (position <= lastStart) {
+            const void* hit = std::memchr(position, needle[0],
+                                          static_cast<std::size_t>(lastStart - position) + 1);
+            if (hit == nullptr) {
+                break;
+            }
+            position = static_cast<const char*>(hit);
+            if (std::memcmp(position + 1, needle + 1, needleLength - 1) == 0) {
+                return static_cast<std::size_t>(position - text);
+            }
+            ++position;
+        }
+        return SubstringSearch::npos;
+    }
+
+    /**
+     * @brief Checks the candidate positions of one block
+     * @param mask Bit b set → position start + b has matching first/last byte
+     *
+     * Teaching Point: mask & (mask - 1) clears the lowest set bit, so the
+     * loop runs once per candidate, not once per position.
+     */
+    inline bool verifyCandidates(std::uint64_t mask, int bitsPerByte, const char* start,
+                                 const char* needle, std::size_t needleLength,
+                                 std::size_t& offset) {
+        while (mask != 0) {
+            auto bit = static_cast<std::size_t>(__builtin_ctzll(mask)) / static_cast<std::size_t>(bitsPerByte);
+            if (std::memcmp(start + bit + 1, needle + 1, needleLength - 2) == 0) {
+                offset = bit;
+                return true;
+            }
+            // Clear every bit of this byte position (NEON uses 4 bits per byte)
+            mask &= ~((bitsPerByte == 1 ? 1ull : 0xFull) << (bit * static_cast<std::size_t>(bitsPerByte)));
+        }
+        return false;
+    }
+
+#if defined(SFM_SUBSTRING_X86)
+    std::size_t findSse2(const char* text, std::size_t length,
+                         const char* needle, std::size_t needleLength) {
+        if (needleLength < 2 || needleLength > length) {
+            return findScalar(text, length, needle, needleLength);
+        }
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+        std::size_t i = 0;
+        for (; i + needleLength - 1 + 16 <= length; i += 16) {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + needleLength - 1));
+            __m128i both = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                         _mm_cmpeq_epi8(blockLast, last));
+            auto mask = static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(both)));
+            std::size_t offset;
+            if (verifyCandidates(mask, 1, text + i, needle, needleLength, offset)) {
+                return i + offset;
+            }
+        }
+        std::size_t tail = findScalar(text + i, length - i, needle, needleLength);
+        return tail == SubstringSearch::npos ? tail : i + tail;
+    }
+
+#if defined(__GNUC__)
+    __attribute__((target("avx2")))
+    std::size_t findAvx2(const char* text, std::size_t length,
+                         const char* needle, std::size_t needleLength) {
+        if (needleLength < 2 || needleLength > length) {
+            return findScalar(text, length, needle, needleLength);
+        }
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+        std::size_t i = 0;
+        for (; i + needleLength - 1 + 32 <= length; i += 32) {
+            __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + needleLength - 1));
+            __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first),
+                                            _mm256_cmpeq_epi8(blockLast, last));
+            auto mask = static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(both)));
+            std::size_t offset;
+            if (verifyCandidates(mask, 1, text + i, needle, needleLength, offset)) {
+                return i + offset;
+            }
+        }
+        std::size_t tail = findSse2(text + i, length - i, needle, needleLength);
+        return tail == SubstringSearch::npos ? tail : i + tail;
+    }
+#endif
+#endif
+
+#if defined(SFM_SUBSTRING_NEON)
+    /**
+     * Teaching Point: NEON has no movemask. Narrowing each 16-bit lane by 4
+     * bits (vshrn) packs the 16 byte results into a 64-bit value with 4
+     * bits per byte position - the same information, just wider.
+     */
+    std::size_t findNeon(const char* text, std::size_t length,
+                         const char* needle, std::size_t needleLength) {
+        if (needleLength < 2 || needleLength > length) {
+            return findScalar(text, length, needle, needleLength);
+        }
+        const uint8x16_t first = vdupq_n_u8(static_cast<std::uint8_t>(needle[0]));
+        const uint8x16_t last = vdupq_n_u8(static_cast<std::uint8_t>(needle[needleLength - 1]));
+        std::size_t i = 0;
+        for (; i + needleLength - 1 + 16 <= length; i += 16) {
+            uint8x16_t blockFirst = vld1q_u8(reinterpret_cast<const std::uint8_t*>(text + i));
+            uint8x16_t blockLast = vld1q_u8(reinterpret_cast<const std::uint8_t*>(text + i + needleLength - 1));
+            uint8x16_t both = vandq_u8(vceqq_u8(blockFirst, first), vceqq_u8(blockLast, last));
+            uint8x8_t packed = vshrn_n_u16(vreinterpretq_u16_u8(both), 4);
+            std::uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(packed), 0);
+            std::size_t offset;
+            if (verifyCandidates(mask, 4, text + i, needle, needleLength, offset)) {
+                return i + offset;
+            }
+        }
+        std::size_t tail = findScalar(text + i, length - i, needle, needleLength);
+        return tail == SubstringSearch::npos ? tail : i + tail;
+    }
+#endif
+
+    struct Selected {
+        Kernel kernel;
+        const char* name;
+    };
+
+    Selected select() {
+#if defined(SFM_SUBSTRING_X86)
+#if defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {findAvx2, "avx2"};
+        }
+#endif
+        return {findSse2, "sse2"};   // Part of every x86-64 CPU
+#elif defined(SFM_SUBSTRING_NEON)
+        return {findNeon, "neon"};   // Part of every ARM64 CPU
+#else
+        return {findScalar, "scalar"};
+#endif
+    }
+
+    /**
+     * Teaching Point: A function-local static is initialized exactly once,
+     * thread-safely (C++11), on first use - the CPU is probed once.
+     */
+    const Selected& selected() {
+        static const Selected choice = select();
+        return choice;
+    }
+}
+
+std::size_t SubstringSearch::find(const char* text, std::size_t length,
+                                  const char* needle, std::size_t needleLength) {
+    return selected().kernel(text, length, needle, needleLength);
+}
+
+const char* SubstringSearch::implementation() {
+    return selected().name;
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM SUBSTRINGSEARCH IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. FILTER WIDE, VERIFY NARROW:
+ *    - Two compares per 16/32 positions reject nearly everything
+ *
+ * 2. DISPATCH ONCE:
+ *    - Probe the CPU on first use, then call through a function pointer
+ *
+ * 3. ALWAYS HAVE A SCALAR PATH:
+ *    - For tails, short needles and CPUs without a vector kernel
+ */
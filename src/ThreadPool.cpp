@@ -0,0 +1,228 @@
+#include "../include/ThreadPool.h"
+#include "../include/Logger.h"
+#include <exception>
+#include <algorithm>
+
+/**
+ * =============================================================================
+ * THREADPOOL IMPLEMENTATION - WORK STEALING WITH std::thread
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. std::thread lifecycle (create, run, join)
+ * 2. Condition variables for sleeping/waking threads
+ * 3. thread_local storage for per-thread identity
+ * 4. Atomic counters for lock-free bookkeeping
+ */
+
+namespace {
+    /**
+     * Teaching Point: thread_local
+     *
+     * Every thread gets its OWN copy of these variables.
+     * A worker sets them once at startup; any code running on that
+     * worker can then ask "which worker am I?" without locking.
+     */
+    thread_local const ThreadPool* tlsPool = nullptr;
+    thread_local int tlsWorkerIndex = -1;
+}
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+    : pendingTasks(0), queuedTasks(0), nextQueue(0), stopping(false) {
+
+    if (threadCount == 0) {
+        // hardware_concurrency() may return 0 when unknown - fall back to 1
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Create ALL queues before starting ANY worker: a worker may try to
+    // steal from a sibling queue as soon as it starts running.
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+int ThreadPool::currentWorkerIndex() {
+    return tlsWorkerIndex;
+}
+
+/**
+ * @brief Schedules a task
+ *
+ * Teaching Point: LOST WAKE-UP PROBLEM
+ *
+ * A worker decides to sleep by checking "queuedTasks > 0" while holding
+ * stateMutex. If we bumped the counter and notified WITHOUT touching that
+ * mutex, the notify could land between the worker's check and its wait,
+ * and the worker would sleep forever with work in the queue.
+ * Briefly taking stateMutex before notifying closes that window.
+ */
+void ThreadPool::submit(std::function<void()> task) {
+    pendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+    std::size_t target;
+    if (tlsPool == this) {
+        target = static_cast<std::size_t>(tlsWorkerIndex);  // Own queue (LIFO end)
+    } else {
+        target = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+
+    // Count first, push second: the counter may briefly over-report,
+    // but it can never drop below zero when a thief is faster than us.
+    queuedTasks.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+    }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this] {
+        return pendingTasks.load(std::memory_order_acquire) == 0;
+    });
+}
+
+/**
+ * @brief Finds the next task for a worker
+ *
+ * ALGORITHM:
+ * 1. Pop from the BACK of our own queue (most recently discovered work)
+ * 2. Otherwise visit the siblings, starting with our right-hand neighbour,
+ *    and steal from the FRONT of the first non-empty queue
+ */
+bool ThreadPool::findTask(std::size_t index, std::function<void()>& task) {
+    {
+        WorkerQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask(std::function<void()>& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        Logger::getInstance().log("ERROR in worker task: " + std::string(e.what()));
+    } catch (...) {
+        Logger::getInstance().log("ERROR in worker task: unknown exception");
+    }
+    task = nullptr;  // Release captured state before signalling completion
+
+    if (pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        allDone.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    tlsPool = this;
+    tlsWorkerIndex = static_cast<int>(index);
+
+    std::function<void()> task;
+    while (true) {
+        if (findTask(index, task)) {
+            runTask(task);
+            continue;
+        }
+
+        // Nothing to do anywhere - sleep until a submit() or shutdown
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this] {
+            return stopping.load() || queuedTasks.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping.load() && queuedTasks.load() == 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * Teaching Point: The counter drops in a guard's destructor, so a task
+ * that throws (runTask() logs and swallows it) still counts as finished.
+ */
+void TaskGroup::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+    pool.submit([this, task = std::move(task)] {
+        struct Done {
+            TaskGroup& group;
+            ~Done() {
+                std::lock_guard<std::mutex> lock(group.mutex);
+                if (--group.pending == 0) {
+                    group.finished.notify_all();
+                }
+            }
+        } done{*this};
+        task();
+    });
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return pending == 0; });
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM THREADPOOL IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. WORK STEALING:
+ *    - Own queue used LIFO, victims robbed FIFO
+ *    - Recursive tasks stay local until someone is idle
+ *
+ * 2. SYNCHRONIZATION:
+ *    - One mutex per queue (low contention)
+ *    - Condition variables instead of busy-waiting
+ *    - Atomic counters for "how much work is left"
+ *
+ * 3. RAII:
+ *    - Destructor drains the queues and joins every thread
+ *    - No thread is ever left running after the pool is gone
+ *
+ * 4. SHARED POOLS NEED PER-CALLER WAITS:
+ *    - TaskGroup waits for its own tasks, not for everybody's
+ */
@@ -0,0 +1,211 @@
+#include "../include/TrigramIndex.h"
+#include <algorithm>
+
+/**
+ * =============================================================================
+ * TRIGRAMINDEX IMPLEMENTATION - INVERTED INDEX WITH VARINT POSTING LISTS
+ * =============================================================================
+ *
+ * This file demonstrates:
+ * 1. A rolling 24-bit key over a sliding 3-byte window
+ * 2. Gap + varint ("VByte") compression of sorted integer lists
+ * 3. Intersecting sorted lists, smallest first
+ */
+
+namespace {
+
+    inline std::uint8_t lowerByte(char c) {
+        auto byte = static_cast<std::uint8_t>(c);
+        return (byte >= 'A' && byte <= 'Z') ? static_cast<std::uint8_t>(byte + ('a' - 'A')) : byte;
+    }
+
+    /**
+     * Teaching Point: VARINT - 7 payload bits per byte, the high bit says
+     * "another byte follows". Values < 128 take one byte.
+     */
+    void writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    /**
+     * @brief Walks one posting list, yielding file indices in order
+     */
+    class ListCursor {
+    private:
+        const std::uint8_t* position;
+        const std::uint8_t* end;
+        std::uint32_t current = 0;    // Last file index + 1 (gaps are ≥ 1)
+
+    public:
+        ListCursor(const std::uint8_t* data, std::size_t bytes) : position(data), end(data + bytes) {}
+
+        bool next(FileCatalog::Index& file) {
+            if (position == end) {
+                return false;
+            }
+            std::uint32_t gap = 0;
+            int shift = 0;
+            while (position != end) {
+                std::uint8_t byte = *position++;
+                gap |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+                shift += 7;
+            }
+            current += gap;
+            file = current - 1;
+            return true;
+        }
+    };
+}
+
+/**
+ * @brief Builds all posting lists in one pass over the names
+ *
+ * ALGORITHM:
+ * 1. Slide a 3-byte window over each lowercase name (stored by
+ *    FileCatalog at scan time); the window is the 24-bit key
+ *    (b0 << 16 | b1 << 8 | b2)
+ * 2. Append the file to that trigram's list - unless it is already the
+ *    list's last entry (same trigram twice in one name)
+ * 3. Files are visited in index order, so every list comes out sorted
+ *    and can be gap-encoded on the fly
+ * 4. Concatenate the per-trigram buffers into one array
+ */
+void TrigramIndex::build(const FileCatalog& files) {
+    listByTrigram.clear();
+    lists.clear();
+    postings.clear();
+
+    std::vector<std::vector<std::uint8_t>> encoded;
+    std::vector<std::uint32_t> lastPlusOne;    // Per list: last file added + 1
+    std::vector<std::uint32_t> counts;
+
+    for (FileCatalog::Index i = 0; i < files.size(); ++i) {
+        std::string_view name = files.lowerName(i);   // Lowercased at scan time
+        if (name.size() < kGramLength) {
+            continue;
+        }
+        std::uint32_t key = (static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[0])) << 8) |
+                            static_cast<std::uint8_t>(name[1]);
+        for (std::size_t j = 2; j < name.size(); ++j) {
+            key = ((key << 8) | static_cast<std::uint8_t>(name[j])) & 0xFFFFFFu;
+            auto inserted = listByTrigram.try_emplace(key, static_cast<std::uint32_t>(encoded.size()));
+            std::uint32_t list = inserted.first->second;
+            if (inserted.second) {
+                encoded.emplace_back();
+                lastPlusOne.push_back(0);
+                counts.push_back(0);
+            }
+            if (lastPlusOne[list] == i + 1) {
+                continue;   // Trigram repeats inside this name
+            }
+            writeVarint(encoded[list], i + 1 - lastPlusOne[list]);
+            lastPlusOne[list] = i + 1;
+            counts[list] += 1;
+        }
+    }
+
+    std::size_t total = 0;
+    for (const auto& list : encoded) {
+        total += list.size();
+    }
+    postings.reserve(total);
+    lists.reserve(encoded.size());
+    for (std::size_t list = 0; list < encoded.size(); ++list) {
+        PostingList entry;
+        entry.offset = postings.size();
+        entry.bytes = static_cast<std::uint32_t>(encoded[list].size());
+        entry.count = counts[list];
+        lists.push_back(entry);
+        postings.insert(postings.end(), encoded[list].begin(), encoded[list].end());
+    }
+
+    revision = files.revision();
+    fileCount = files.size();
+    built = true;
+}
+
+/**
+ * @brief Intersects the posting lists of every trigram in the term
+ *
+ * Teaching Point: SMALLEST LIST FIRST
+ * The result can never be larger than the shortest list, so that one is
+ * decoded into `out`; every further list only filters `out` in place with
+ * a two-pointer merge. A rare trigram ("xyz") makes the whole query cheap.
+ */
+void TrigramIndex::candidates(std::string_view lowerTerm,
+                              std::vector<FileCatalog::Index>& out) const {
+    out.clear();
+    if (lowerTerm.size() < kGramLength) {
+        return;
+    }
+
+    std::vector<std::uint32_t> wanted;
+    std::uint32_t key = (static_cast<std::uint32_t>(lowerByte(lowerTerm[0])) << 8) |
+                        lowerByte(lowerTerm[1]);
+    for (std::size_t j = 2; j < lowerTerm.size(); ++j) {
+        key = ((key << 8) | lowerByte(lowerTerm[j])) & 0xFFFFFFu;
+        auto it = listByTrigram.find(key);
+        if (it == listByTrigram.end()) {
+            return;   // No name contains this trigram → no match at all
+        }
+        wanted.push_back(it->second);
+    }
+    std::sort(wanted.begin(), wanted.end());
+    wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+    std::sort(wanted.begin(), wanted.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return lists[a].count < lists[b].count;
+    });
+
+    const PostingList& smallest = lists[wanted[0]];
+    out.reserve(smallest.count);
+    ListCursor first(postings.data() + smallest.offset, smallest.bytes);
+    FileCatalog::Index file;
+    while (first.next(file)) {
+        out.push_back(file);
+    }
+
+    for (std::size_t w = 1; w < wanted.size() && !out.empty(); ++w) {
+        const PostingList& list = lists[wanted[w]];
+        ListCursor cursor(postings.data() + list.offset, list.bytes);
+        std::size_t kept = 0;
+        bool more = cursor.next(file);
+        for (std::size_t k = 0; k < out.size() && more; ++k) {
+            while (more && file < out[k]) {
+                more = cursor.next(file);
+            }
+            if (more && file == out[k]) {
+                out[kept++] = out[k];
+            }
+        }
+        out.resize(kept);
+    }
+}
+
+std::size_t TrigramIndex::memoryUsage() const {
+    return postings.capacity() +
+           lists.capacity() * sizeof(PostingList) +
+           listByTrigram.size() * (sizeof(std::uint32_t) * 2 + sizeof(void*)) +
+           listByTrigram.bucket_count() * sizeof(void*);
+}
+
+/**
+ * =============================================================================
+ * KEY TAKEAWAYS FROM TRIGRAMINDEX IMPLEMENTATION
+ * =============================================================================
+ *
+ * 1. FILTER, THEN VERIFY:
+ *    - The index only narrows the search; the exact check stays the truth
+ *
+ * 2. COMPRESSION IS SPEED:
+ *    - Gap + varint lists are small, so they stay in cache while decoding
+ *
+ * 3. ORDER OF INTERSECTION:
+ *    - Start with the rarest trigram - the work is bounded by its list
+ */
@@ -1,11 +1,16 @@
 #include <iostream>
 #include <memory>
 #include <filesystem>
+#include <cstdlib>
 #include "FileManager.h"
 #include "FileSorter.h"
 #include "FileSearcher.h"
+#include "HashCache.h"
+#include "ChunkIndex.h"
 #include "Menu.h"
+#include "BatchRunner.h"
 #include "Logger.h"
+#include "Metrics.h"
 
 /**
  * =============================================================================
@@ -121,26 +126,65 @@ int main(int argc, char* argv[]) {
          * 6. Start application
          */
         
+        /**
+         * Teaching Point: TWO FRONT ENDS, ONE BOOTSTRAP
+         * "SmartFileManager scan DIR ..." runs one command headless (NDJSON
+         * on stdout, see BatchRunner); anything else starts the menu. The
+         * banner and the "Press Enter" prompt belong to the menu only -
+         * a script must never see or wait for them.
+         */
+        const bool batchMode = argc > 1 && BatchRunner::isCommand(argv[1]);
+        
         // Step 1: Welcome message
-        std::cout << "\n";
-        std::cout << "╔══════════════════════════════════════════════════════════╗\n";
-        std::cout << "║                                                          ║\n";
-        std::cout << "║        SMART FILE MANAGEMENT SYSTEM                      ║\n";
-        std::cout << "║        Modern C++17 Solution                             ║\n";
-        std::cout << "║                                                          ║\n";
-        std::cout << "║        Features:                                         ║\n";
-        std::cout << "║        • Smart file organization by extension            ║\n";
-        std::cout << "║        • Intelligent file search                         ║\n";
-        std::cout << "║        • Duplicate file detection                        ║\n";
-        std::cout << "║        • Comprehensive activity logging                  ║\n";
-        std::cout << "║                                                          ║\n";
-        std::cout << "╚══════════════════════════════════════════════════════════╝\n";
-        std::cout << "\n";
+        if (!batchMode) {
+            std::cout << "\n";
+            std::cout << "╔══════════════════════════════════════════════════════════╗\n";
+            std::cout << "║                                                          ║\n";
+            std::cout << "║        SMART FILE MANAGEMENT SYSTEM                      ║\n";
+            std::cout << "║        Modern C++17 Solution                             ║\n";
+            std::cout << "║                                                          ║\n";
+            std::cout << "║        Features:                                         ║\n";
+            std::cout << "║        • Smart file organization by extension            ║\n";
+            std::cout << "║        • Intelligent file search                         ║\n";
+            std::cout << "║        • Duplicate file detection                        ║\n";
+            std::cout << "║        • Comprehensive activity logging                  ║\n";
+            std::cout << "║                                                          ║\n";
+            std::cout << "╚══════════════════════════════════════════════════════════╝\n";
+            std::cout << "\n";
+        }
         
         // Step 2: Initialize logger (singleton - only logs initialization)
         Logger::getInstance().log("=== Application Starting ===");
         Logger::getInstance().log("Smart File Management System v1.0");
         
+        // SFM_LOG_LEVEL=trace|debug|info|warn|error|off (default info)
+        if (const char* level = std::getenv("SFM_LOG_LEVEL")) {
+            LogLevel parsed = LogLevel::Info;
+            if (Logger::parseLevel(level, parsed)) {
+                Logger::getInstance().setLevel(parsed);
+            } else {
+                Logger::getInstance().log(std::string("WARNING: unknown SFM_LOG_LEVEL ignored: ") + level);
+            }
+        }
+        Logger::getInstance().startAsync();   // Scans log per file: keep the disk off their path
+        
+        if (batchMode) {
+            auto fileSorter = std::make_shared<FileSorter>();
+            fileSorter->loadMappings(FileSorter::defaultConfigPath());
+            auto hashCache = std::make_shared<HashCache>(HashCache::defaultPath());
+            fileSorter->setContentSniffer(std::make_shared<ContentSniffer>(hashCache));
+            auto fileSearcher = std::make_shared<FileSearcher>();
+            fileSearcher->setHashCache(hashCache);
+            fileSearcher->setChunkIndex(std::make_shared<ChunkIndex>(ChunkIndex::defaultPath()));
+            
+            BatchRunner runner(fileSorter, fileSearcher, hashCache);
+            const int code = runner.run(argc - 1, argv + 1);
+            if (std::getenv("SFM_METRICS_FILE") != nullptr) {
+                Metrics::getInstance().writePrometheus(Metrics::defaultPrometheusPath());
+            }
+            return code;
+        }
+        
         // Step 3: Parse command-line arguments
         std::string targetDirectory;
         
@@ -179,7 +223,12 @@ int main(int argc, char* argv[]) {
         
         auto fileManager = std::make_shared<FileManager>(targetDirectory);
         auto fileSorter = std::make_shared<FileSorter>();
+        fileSorter->loadMappings(FileSorter::defaultConfigPath());   // Optional user mappings
+        auto hashCache = std::make_shared<HashCache>(HashCache::defaultPath());
+        fileSorter->setContentSniffer(std::make_shared<ContentSniffer>(hashCache));   // Extensionless files
         auto fileSearcher = std::make_shared<FileSearcher>();
+        fileSearcher->setHashCache(hashCache);   // Shared: one file, one identity index
+        fileSearcher->setChunkIndex(std::make_shared<ChunkIndex>(ChunkIndex::defaultPath()));   // Loaded on first use
         
         /**
          * Teaching Point: DEPENDENCY INJECTION IN ACTION
@@ -207,6 +256,11 @@ int main(int argc, char* argv[]) {
         // Step 5: Start application (blocking call - runs until user exits)
         menu->run();
         
+        // Production runs: leave the session's numbers for a textfile collector
+        if (std::getenv("SFM_METRICS_FILE") != nullptr) {
+            Metrics::getInstance().writePrometheus(Metrics::defaultPrometheusPath());
+        }
+        
         /**
          * Teaching Point: CLEANUP
          * 